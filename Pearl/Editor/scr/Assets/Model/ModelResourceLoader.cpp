@@ -97,6 +97,8 @@ struct ModelLoaderHelper
 	void GatherTextures(const aiScene* p_scene);
 	void GatherLights(const aiScene* p_scene);
 
+	void PreloadTextures();
+
 	void CreateEntityGraph(const aiNode* p_objectNode, ModelEntityNode* p_EntityNode);
 	void CreateEntityGraphRecursive(const aiNode* p_objectNode, ModelEntityNode* p_EntityNode, int depth = 0);
 };
@@ -461,6 +463,33 @@ void ModelLoaderHelper::GatherTextures(const aiScene* p_scene)
 	}
 }
 
+void ModelLoaderHelper::PreloadTextures()
+{
+	// Texture types read by GetOrCreateMaterial, the textures of all materials decode in parallel before the materials are created
+	constexpr aiTextureType textureTypes[] = {
+		aiTextureType_DIFFUSE,
+		aiTextureType_NORMALS,
+		aiTextureType_DIFFUSE_ROUGHNESS,
+		aiTextureType_METALNESS,
+		aiTextureType_AMBIENT_OCCLUSION,
+		aiTextureType_EMISSIVE
+	};
+
+	std::vector<PrCore::Resources::ResourceDependency> textureFiles;
+	for (auto material : materials)
+	{
+		for (auto textureType : textureTypes)
+		{
+			aiString texPath;
+			if (AI_SUCCESS == material->GetTexture(textureType, 0, &texPath) && scene->GetEmbeddedTexture(texPath.C_Str()) == nullptr)
+				textureFiles.push_back(PrCore::Resources::ResourceDependency::Of<Texture>(texPath.C_Str()));
+		}
+	}
+
+	auto& resourceSystem = PrCore::Resources::ResourceSystem::GetInstance();
+	resourceSystem.WaitForPreload(resourceSystem.Preload(textureFiles));
+}
+
 void ModelLoaderHelper::CreateEntityGraph(const aiNode* p_node, ModelEntityNode* p_EntityNode)
 {
 	ModelEntity* modelEntity = new ModelEntity();
@@ -578,6 +607,7 @@ PrCore::Resources::IResourceDataPtr ModelResourceLoader::LoadResource(const std:
 	helper.GatherMaterials(scene);
 	helper.GatherLights(scene);
 	helper.GatherTextures(scene);
+	helper.PreloadTextures();
 
 	auto root = new ModelEntityNode();
 	root->nodePath = PrCore::PathUtils::GetFilenameInPlace(p_path);
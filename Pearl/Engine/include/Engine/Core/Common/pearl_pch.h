@@ -1,8 +1,10 @@
 #pragma once
 
 //Windows
+#ifdef _WIN32
 #include<Windows.h>
 #include<winbase.h>
+#endif
 
 //STD Algorythms
 #include<memory>
@@ -28,4 +28,11 @@ namespace PrCore::ECS {
 
 		return component;
 	}
+
+	// Resources referenced by the serialized component, only components loading resources are listed
+	void GatherComponentResources(const std::string& p_typeName, const Utils::JSON::json& p_serialized, std::vector<Resources::ResourceDependency>& p_resources)
+	{
+		//Renderer
+		if (p_typeName == typeid(MeshRendererComponent).name())		MeshRendererComponent::GatherResources(p_serialized, p_resources);
+	}
 }
\ No newline at end of file
@@ -64,51 +64,72 @@ namespace PrCore::ECS {
 			p_serialized["MaterialList"] = jsonMaterials;
 		}
 
+		// Binds the handles without waiting, file resources resolve when their loads complete
+		// SceneManager::LoadScene preloads them together before the entities are built, see GatherResources
 		virtual void OnDeserialize(const Utils::JSON::json& p_deserialized) override
 		{
-			std::string meshName = p_deserialized["Mesh"];
-			if (meshName.find("Primitive_Cube") != std::string::npos)
-				mesh = PrRenderer::Resources::Mesh::CreatePrimitive(PrRenderer::Resources::PrimitiveType::Cube);
-			else if (meshName.find("Primitive_Sphere") != std::string::npos)
-				mesh = PrRenderer::Resources::Mesh::CreatePrimitive(PrRenderer::Resources::PrimitiveType::Sphere);
-			else if (meshName.find("Primitive_Capsule") != std::string::npos)
-				mesh = PrRenderer::Resources::Mesh::CreatePrimitive(PrRenderer::Resources::PrimitiveType::Capsule);
-			else if (meshName.find("Primitive_Cylinder") != std::string::npos)
-				mesh = PrRenderer::Resources::Mesh::CreatePrimitive(PrRenderer::Resources::PrimitiveType::Cylinder);
-			else if (meshName.find("Primitive_Plane") != std::string::npos)
-				mesh = PrRenderer::Resources::Mesh::CreatePrimitive(PrRenderer::Resources::PrimitiveType::Plane);
-			else if (meshName.find("Primitive_Quad") != std::string::npos)
-				mesh = PrRenderer::Resources::Mesh::CreatePrimitive(PrRenderer::Resources::PrimitiveType::Quad);
-			else
-				mesh = Resources::ResourceSystem::GetInstance().Load<PrRenderer::Resources::Mesh>(static_cast<std::string>(p_deserialized["Mesh"]));
+			mesh = DeserializeMesh(static_cast<std::string>(p_deserialized["Mesh"]));
 
 			auto shadowMeshIt = p_deserialized.find("ShadowMesh");
 			if (shadowMeshIt != p_deserialized.end())
-			{
-				std::string meshName = p_deserialized["ShadowMesh"];
-				if (meshName.find("Primitive_Cube") != std::string::npos)
-					shadowMesh = PrRenderer::Resources::Mesh::CreatePrimitive(PrRenderer::Resources::PrimitiveType::Cube);
-				else if (meshName.find("Primitive_Sphere") != std::string::npos)
-					shadowMesh = PrRenderer::Resources::Mesh::CreatePrimitive(PrRenderer::Resources::PrimitiveType::Sphere);
-				else if (meshName.find("Primitive_Capsule") != std::string::npos)
-					shadowMesh = PrRenderer::Resources::Mesh::CreatePrimitive(PrRenderer::Resources::PrimitiveType::Capsule);
-				else if (meshName.find("Primitive_Cylinder") != std::string::npos)
-					shadowMesh = PrRenderer::Resources::Mesh::CreatePrimitive(PrRenderer::Resources::PrimitiveType::Cylinder);
-				else if (meshName.find("Primitive_Plane") != std::string::npos)
-					shadowMesh = PrRenderer::Resources::Mesh::CreatePrimitive(PrRenderer::Resources::PrimitiveType::Plane);
-				else if (meshName.find("Primitive_Quad") != std::string::npos)
-					shadowMesh = PrRenderer::Resources::Mesh::CreatePrimitive(PrRenderer::Resources::PrimitiveType::Quad);
-				else
-					shadowMesh = Resources::ResourceSystem::GetInstance().Load<PrRenderer::Resources::Mesh>(static_cast<std::string>(p_deserialized["ShadowMesh"]));
-			}
+				shadowMesh = DeserializeMesh(static_cast<std::string>(*shadowMeshIt));
 
 			auto materialJson = p_deserialized["MaterialList"];
 			materials.resize(materialJson.size());
 			for (int i = 0; i < materialJson.size(); ++i)
+				materials[i] = Resources::ResourceSystem::GetInstance().LoadAsync<PrRenderer::Resources::Material>(static_cast<std::string>(materialJson.at(i)["Path"]));
+		}
+
+		// Adds the file resources referenced by the serialized component
+		static void GatherResources(const Utils::JSON::json& p_deserialized, std::vector<Resources::ResourceDependency>& p_resources)
+		{
+			PrRenderer::Resources::PrimitiveType primitiveType;
+
+			std::string meshName = p_deserialized["Mesh"];
+			if (!FindPrimitiveType(meshName, primitiveType))
+				p_resources.push_back(Resources::ResourceDependency::Of<PrRenderer::Resources::Mesh>(meshName));
+
+			auto shadowMeshIt = p_deserialized.find("ShadowMesh");
+			if (shadowMeshIt != p_deserialized.end())
 			{
-				auto mat = Resources::ResourceSystem::GetInstance().Load<PrRenderer::Resources::Material>(static_cast<std::string>(materialJson.at(i)["Path"]));
-				materials[i] = mat;
+				std::string shadowMeshName = *shadowMeshIt;
+				if (!FindPrimitiveType(shadowMeshName, primitiveType))
+					p_resources.push_back(Resources::ResourceDependency::Of<PrRenderer::Resources::Mesh>(shadowMeshName));
 			}
+
+			for (auto& materialJson : p_deserialized["MaterialList"])
+				p_resources.push_back(Resources::ResourceDependency::Of<PrRenderer::Resources::Material>(static_cast<std::string>(materialJson["Path"])));
+		}
+
+	private:
+		// Primitive meshes are serialized by name and created in code
+		static bool FindPrimitiveType(const std::string& p_meshName, PrRenderer::Resources::PrimitiveType& p_primitiveType)
+		{
+			if (p_meshName.find("Primitive_Cube") != std::string::npos)
+				p_primitiveType = PrRenderer::Resources::PrimitiveType::Cube;
+			else if (p_meshName.find("Primitive_Sphere") != std::string::npos)
+				p_primitiveType = PrRenderer::Resources::PrimitiveType::Sphere;
+			else if (p_meshName.find("Primitive_Capsule") != std::string::npos)
+				p_primitiveType = PrRenderer::Resources::PrimitiveType::Capsule;
+			else if (p_meshName.find("Primitive_Cylinder") != std::string::npos)
+				p_primitiveType = PrRenderer::Resources::PrimitiveType::Cylinder;
+			else if (p_meshName.find("Primitive_Plane") != std::string::npos)
+				p_primitiveType = PrRenderer::Resources::PrimitiveType::Plane;
+			else if (p_meshName.find("Primitive_Quad") != std::string::npos)
+				p_primitiveType = PrRenderer::Resources::PrimitiveType::Quad;
+			else
+				return false;
+
+			return true;
+		}
+
+		static PrRenderer::Resources::MeshHandle DeserializeMesh(const std::string& p_meshName)
+		{
+			PrRenderer::Resources::PrimitiveType primitiveType;
+			if (FindPrimitiveType(p_meshName, primitiveType))
+				return PrRenderer::Resources::Mesh::CreatePrimitive(primitiveType);
+
+			return Resources::ResourceSystem::GetInstance().LoadAsync<PrRenderer::Resources::Mesh>(p_meshName);
 		}
 	};
 
@@ -3,6 +3,7 @@
 
 #include "Core/Utils/NonCopyable.h"
 #include "Core/Utils/ISerializable.h"
+#include "Core/Resources/IResourceDataLoader.h"
 
 #include"Core/Events/Event.h"
 
@@ -393,6 +394,9 @@ namespace PrCore::ECS {
 		void OnSerialize(Utils::JSON::json& p_serialized) override;
 		void OnDeserialize(const Utils::JSON::json& p_serialized) override;
 
+		// Adds the file resources referenced by the serialized entities without creating them
+		static void GatherResources(const Utils::JSON::json& p_serialized, std::vector<Resources::ResourceDependency>& p_resources);
+
 	private:
 		void FireEntityCreated(Entity p_entity);
 		void FireEntityDestoryed(Entity p_entity);
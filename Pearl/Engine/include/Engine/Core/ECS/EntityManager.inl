@@ -100,14 +100,14 @@ namespace PrCore::ECS {
 	template<class T>
 	void EntityManager::FireComponentAdded(Entity p_entity, T* p_component)
 	{
-		Events::EventPtr event = std::make_shared<Events::ComponentAddedEvent<T>>(p_entity, p_component);
+		Events::ComponentAddedEvent<T> event(p_entity, p_component);
 		Events::EventManager::GetInstance().FireEvent(event);
 	}
 
 	template<class T>
 	void EntityManager::FireComponentRemoved(Entity p_entity, T* p_component)
 	{
-		Events::EventPtr event = std::make_shared<Events::ComponentRemovedEvent<T>>(p_entity, p_component);
+		Events::ComponentRemovedEvent<T> event(p_entity, p_component);
 		Events::EventManager::GetInstance().FireEvent(event);
 	}
 
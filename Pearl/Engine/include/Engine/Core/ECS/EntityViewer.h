@@ -23,12 +23,13 @@ namespace PrCore::ECS {
 		Threading::BatchJobState batchState;
 		while (itBegin != itEnd)
 		{
-			batchState += jobPtr->Schedule("ECS_Batch_Work", &JobBatchWork<T, Func>, itBegin, itEnd, batchSize, funcPtr);
+			jobPtr->Schedule(Threading::JobPriority::Critical, batchState, "ECS_Batch_Work", &JobBatchWork<T, Func>, itBegin, itEnd, batchSize, funcPtr);
 
 			for (int i = 0; i < batchSize && itBegin != itEnd; i++)
 				++itBegin;
 		}
 
+		batchState.Close();
 		return batchState;
 	}
 
@@ -39,6 +39,7 @@ namespace PrCore::Events {
 		ECS::Entity m_entity;
 		Component* m_component;
 
+		DEFINE_EVENT_TYPE_INDEX()
 		virtual inline EventType GetType() const { return s_type; }
 		const static EventType s_type;
 	};
@@ -57,6 +58,7 @@ namespace PrCore::Events {
 		ECS::Entity m_entity;
 		Component* m_component;
 
+		DEFINE_EVENT_TYPE_INDEX()
 		virtual inline EventType GetType() const { return s_type; }
 		const static EventType s_type;
 	};
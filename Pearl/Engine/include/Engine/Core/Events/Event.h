@@ -3,28 +3,51 @@
 #include<memory>
 
 namespace PrCore::Events {
-	
+
 	using  EventType = uint32_t;
-	using  EventID = unsigned int;
-	
+	using  EventTypeIndex = uint32_t;
+
+	// Dense index of the event type used to index the listener table, the same GUID always gets the same index
+	EventTypeIndex RegisterEventType(EventType p_type);
+
+	// How queued events of one type are merged before they reach the listeners, declared with DEFINE_EVENT_COALESCING
+	// KeepLatest and Accumulate keep one pending event per type and producer thread, it is dispatched at the position of the first one
+	enum class EventCoalescing {
+		KeepAll,
+		KeepLatest,
+		Accumulate // Event type provides void Accumulate(const T& p_previous)
+	};
+
+	// Events are never deleted through the base, queued events live in the queue memory and are not destroyed at all
 	class Event {
 	public:
 		Event() {}
 
-		virtual ~Event() { s_eventID++; }
+		virtual inline EventType      GetType() const = 0;
+		virtual inline EventTypeIndex GetTypeIndex() const = 0;
 
-		virtual inline EventType GetType() const = 0;
+		static constexpr EventCoalescing s_coalescing = EventCoalescing::KeepAll;
 
-		inline EventID GetID() const { return s_eventID; }
-
-	private:
-		inline static EventID s_eventID = 0;
+	protected:
+		~Event() = default;
 	};
-	
-	typedef std::shared_ptr<Event> EventPtr;
+
+	typedef Event* EventPtr;
+
+#define DEFINE_EVENT_TYPE_INDEX() \
+	virtual inline EventTypeIndex GetTypeIndex() const { return GetStaticTypeIndex(); } \
+	static EventTypeIndex GetStaticTypeIndex() \
+	{ \
+		static const EventTypeIndex s_typeIndex = ::PrCore::Events::RegisterEventType(s_type); \
+		return s_typeIndex; \
+	}
+
+#define DEFINE_EVENT_COALESCING(policy) \
+	static constexpr ::PrCore::Events::EventCoalescing s_coalescing = policy
 
 #define DEFINE_EVENT_GUID(guid) \
+	DEFINE_EVENT_TYPE_INDEX() \
 	virtual inline EventType GetType() const { return s_type; } \
 	inline const static EventType s_type = guid
 
-}
\ No newline at end of file
+}
@@ -1,12 +1,10 @@
 #pragma once
 #include"Event.h"
+#include"EventQueue.h"
 #include"Core/Utils/Singleton.h"
 
 #include"entt.hpp"
-#include<map>
-#include<list>
-
-#define EVENTQUEUE_NUM 2
+#include<vector>
 
 namespace PrCore::Events {
 
@@ -14,25 +12,47 @@ namespace PrCore::Events {
 
 	class EventManager: public Utils::Singleton<EventManager> {
 
-		typedef std::list<EventListener> EventListenerList;
-		typedef std::map<EventType, EventListenerList> EventMap;
-		typedef std::list<EventPtr> EventQueue;
+		typedef std::vector<EventListener> EventListenerList;
+		typedef std::vector<EventListenerList> EventListenerTable;
 
 	public:
+		// Listeners, FireEvent and Update are main thread only
 		bool AddListener(const EventListener& p_listener, EventType p_type);
 		bool RemoveListener(const EventListener& p_listener, EventType p_type);
 
-		bool FireEvent(EventPtr& p_event);
-		bool QueueEvent(EventPtr& p_event);
+		// Dispatches straight away, the event can live on the stack
+		bool FireEvent(Event& p_event);
+
+		// Safe from any thread, the event is created in the queue memory of the calling thread, see EventQueue::Emplace
+		// Events are coalesced here according to the policy of their type, events without listeners are dropped in Update
+		// Strings the event copies with EventQueue::CopyString live as long as the event
+		template<typename T, typename... Args>
+		void QueueEvent(Args&&... p_args);
 
+		// Dispatches the events queued before the call, producers are drained in registration order
+		// Queued events and their strings are released when the call returns, listeners copy what they keep
 		void Update();
 
 	private:
 		EventManager();
-		EventMap m_eventMap;
-		EventQueue m_eventQueue[EVENTQUEUE_NUM];
-		int m_activeQueue;
+
+		bool Dispatch(EventPtr p_event);
+
+		// Indexed by EventTypeIndex
+		EventListenerTable m_listeners;
+		EventQueue         m_eventQueue;
+		std::thread::id    m_mainThreadId;
 
 		friend Singleton<EventManager>;
 	};
-}
\ No newline at end of file
+
+	template<typename T, typename... Args>
+	void EventManager::QueueEvent(Args&&... p_args)
+	{
+		static_assert(std::is_base_of_v<Event, T>, "Queued type is not an event");
+		static_assert(T::s_coalescing != EventCoalescing::Accumulate || requires(T& p_event) { p_event.Accumulate(p_event); },
+			"Accumulated event type has to provide Accumulate");
+
+		m_eventQueue.Emplace<T>(std::forward<Args>(p_args)...);
+	}
+}
@@ -0,0 +1,275 @@
+#pragma once
+#include"Event.h"
+#include"Core/Memory/LinearAllocator.h"
+
+#include<array>
+#include<atomic>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+namespace PrCore::Events {
+
+	constexpr size_t g_eventProducerCapacity = 1024;
+	constexpr size_t g_maxEventProducers = 64;
+	constexpr size_t g_maxCoalescedEventTypes = 32;
+	constexpr size_t g_eventArenaCapacity = 16 * 1024;
+
+	// Multi producer single consumer queue of events
+	// Every producer thread stages events in its own lock-free ring, the consumer drains the producers in registration order
+	// Events are created in two arenas of the producer, the consumer resets the drained one while the producer fills the other
+	// Pushing takes no lock unless the ring is full or the thread is above the producer limit, then the overflow is locked
+	class EventQueue {
+	public:
+		explicit EventQueue(size_t p_producerCapacity = g_eventProducerCapacity);
+		~EventQueue() = default;
+
+		EventQueue(const EventQueue&) = delete;
+		EventQueue& operator=(const EventQueue&) = delete;
+
+		// Safe from any thread, creates the event in the queue memory, it stays valid until Drain dispatches it
+		// Events are coalesced according to the policy of their type, see EventCoalescing
+		// Allocates only on the first push of the thread, when its ring is full or when its arena grows
+		template<typename T, typename... Args>
+		void Emplace(Args&&... p_args);
+
+		// Copies the string next to the event being created by Emplace, so it lives as long as the event
+		// Outside of Emplace the string is returned as it is, events fired on the stack do not outlive it
+		static std::string_view CopyString(std::string_view p_string);
+
+		// Consumer thread only, events pushed while draining are left for the next call
+		// Memory of the dispatched events is released when the call returns
+		template<typename Func>
+		void Drain(Func&& p_function);
+
+		void Clear();
+
+	private:
+		// Coalesced events are queued as a marker, the consumer takes the latest event from the slot
+		struct QueuedEvent
+		{
+			EventPtr event;
+			size_t   coalescedSlot;
+		};
+
+		struct CoalescedSlot
+		{
+			std::atomic<EventPtr> event = nullptr;
+			std::atomic<bool>     queued = false;
+		};
+
+		struct Producer
+		{
+			Producer(size_t p_capacity, std::thread::id p_threadId);
+
+			bool TryPush(const QueuedEvent& p_event);
+
+			std::vector<QueuedEvent>         ring;
+			size_t                           mask;
+			std::thread::id                  threadId;
+
+			alignas(64) std::atomic<size_t>  head;
+			alignas(64) std::atomic<size_t>  tail;
+
+			// Events that did not fit into the ring, producer keeps using it until drained to preserve the order
+			std::mutex                       overflowLock;
+			std::vector<QueuedEvent>         overflow;
+			std::atomic<bool>                hasOverflow;
+
+			std::array<CoalescedSlot, g_maxCoalescedEventTypes> coalesced;
+
+			// Waits until the owner thread leaves the Emplace it is in, returns right away if it is not in one
+			void WaitForEmplace() const;
+
+			// Odd while the owner thread creates and pushes an event
+			// The consumer switches the arenas and waits for the epoch to move before it snapshots or resets them
+			alignas(64) std::atomic<uint64_t>                      emplaceEpoch;
+			std::array<std::unique_ptr<Memory::LinearAllocator>, 2> arenas;
+			std::atomic<size_t>                                    activeArena;
+		};
+
+		void PushToProducer(Producer* p_producer, const QueuedEvent& p_event);
+
+		template<typename T, typename... Args>
+		static T* CreateEvent(Memory::LinearAllocator& p_arena, Args&&... p_args);
+
+		// Merges the event with the pending event of the same type pushed by this thread
+		template<typename T>
+		void PushCoalesced(Producer* p_producer, T* p_event);
+
+		template<typename Func>
+		void DispatchQueued(Producer& p_producer, const QueuedEvent& p_event, Func& p_function);
+
+		// Returns nullptr when the producer limit is reached
+		Producer* GetThreadProducer();
+
+		struct ThreadCache
+		{
+			uint64_t  instanceId = 0;
+			Producer* producer = nullptr;
+		};
+		static thread_local ThreadCache s_threadCache;
+
+		// Arena of the event the thread is creating, used by CopyString
+		static thread_local Memory::LinearAllocator* s_eventArena;
+
+		inline static std::atomic<size_t> s_coalescedSlotCount = 0;
+
+		std::array<std::unique_ptr<Producer>, g_maxEventProducers> m_producers;
+		std::atomic<size_t>                                       m_producerCount;
+		std::mutex                                                m_producersLock;
+
+		// Threads above the producer limit create their events here under the lock, they are drained with the first producer
+		std::mutex                                                m_sharedArenaLock;
+		std::array<std::unique_ptr<Memory::LinearAllocator>, 2>   m_sharedArenas;
+		size_t                                                    m_sharedActiveArena;
+
+		// Consumer side buffer, keeps its capacity between drains
+		std::vector<QueuedEvent>                                  m_drainedOverflow;
+
+		size_t                                                    m_producerCapacity;
+		uint64_t                                                  m_instanceId;
+	};
+
+	template<typename T, typename... Args>
+	void EventQueue::Emplace(Args&&... p_args)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "Queued events are never destroyed, payload has to be trivially destructible");
+
+		// Threads above the producer limit share the locked arenas and the overflow of the first producer
+		auto producer = GetThreadProducer();
+		if (producer == nullptr)
+		{
+			std::lock_guard lock{ m_sharedArenaLock };
+			auto event = CreateEvent<T>(*m_sharedArenas[m_sharedActiveArena], std::forward<Args>(p_args)...);
+			PushToProducer(nullptr, { event, 0 });
+			return;
+		}
+
+		// Entering is sequentially consistent with the consumer switching the arenas,
+		// either this thread reads the new arena or the consumer sees the odd epoch and waits
+		producer->emplaceEpoch.fetch_add(1, std::memory_order_seq_cst);
+		auto& arena = *producer->arenas[producer->activeArena.load(std::memory_order_seq_cst)];
+		auto event = CreateEvent<T>(arena, std::forward<Args>(p_args)...);
+
+		if constexpr (T::s_coalescing == EventCoalescing::KeepAll)
+			PushToProducer(producer, { event, 0 });
+		else
+			PushCoalesced(producer, event);
+
+		producer->emplaceEpoch.fetch_add(1, std::memory_order_release);
+	}
+
+	template<typename T, typename... Args>
+	T* EventQueue::CreateEvent(Memory::LinearAllocator& p_arena, Args&&... p_args)
+	{
+		auto previousArena = s_eventArena;
+		s_eventArena = &p_arena;
+		auto event = p_arena.New<T>(std::forward<Args>(p_args)...);
+		s_eventArena = previousArena;
+
+		return event;
+	}
+
+	template<typename T>
+	void EventQueue::PushCoalesced(Producer* p_producer, T* p_event)
+	{
+		// Slots are assigned per event type, types above the limit are not coalesced
+		static const size_t slotIndex = s_coalescedSlotCount++;
+
+		if (p_producer == nullptr || slotIndex >= g_maxCoalescedEventTypes)
+		{
+			PushToProducer(p_producer, { p_event, 0 });
+			return;
+		}
+
+		auto& slot = p_producer->coalesced[slotIndex];
+		if constexpr (T::s_coalescing == EventCoalescing::Accumulate)
+		{
+			// Consumer may take the pending event meanwhile, it is then dispatched on its own
+			if (auto previous = slot.event.exchange(nullptr))
+				p_event->Accumulate(*static_cast<T*>(previous));
+		}
+
+		// Replaced event stays in the arena until it is reset
+		slot.event.store(p_event);
+
+		// Consumer clears the flag before it takes the event, so a marker is always queued for the stored event
+		if (!slot.queued.exchange(true))
+			PushToProducer(p_producer, { nullptr, slotIndex });
+	}
+
+	template<typename Func>
+	void EventQueue::DispatchQueued(Producer& p_producer, const QueuedEvent& p_event, Func& p_function)
+	{
+		if (p_event.event != nullptr)
+		{
+			p_function(p_event.event);
+			return;
+		}
+
+		auto& slot = p_producer.coalesced[p_event.coalescedSlot];
+		slot.queued.store(false);
+		if (auto event = slot.event.exchange(nullptr))
+			p_function(event);
+	}
+
+	template<typename Func>
+	void EventQueue::Drain(Func&& p_function)
+	{
+		size_t producerCount = m_producerCount.load(std::memory_order_acquire);
+		for (size_t i = 0; i < producerCount; i++)
+		{
+			auto& producer = *m_producers[i];
+
+			// Events created from now on go to the other arena, the event being created in the drained one is pushed before the snapshot
+			size_t drainedArena = producer.activeArena.load(std::memory_order_relaxed);
+			producer.activeArena.store(1 - drainedArena, std::memory_order_seq_cst);
+			producer.WaitForEmplace();
+
+			size_t sharedDrainedArena = 0;
+			if (i == 0)
+			{
+				std::lock_guard lock{ m_sharedArenaLock };
+				sharedDrainedArena = m_sharedActiveArena;
+				m_sharedActiveArena = 1 - sharedDrainedArena;
+			}
+
+			// Producer stops writing to the ring while it has overflow, so the ring snapshot always precedes the overflow
+			size_t tail = 0;
+			if (producer.hasOverflow.load(std::memory_order_acquire))
+			{
+				std::lock_guard lock{ producer.overflowLock };
+				tail = producer.tail.load(std::memory_order_acquire);
+				m_drainedOverflow.swap(producer.overflow);
+				producer.hasOverflow.store(false, std::memory_order_release);
+			}
+			else
+			{
+				tail = producer.tail.load(std::memory_order_acquire);
+			}
+
+			for (size_t head = producer.head.load(std::memory_order_relaxed); head != tail; head++)
+			{
+				// Slot is released before dispatch so listeners can queue new events
+				QueuedEvent event = producer.ring[head & producer.mask];
+				producer.head.store(head + 1, std::memory_order_release);
+				DispatchQueued(producer, event, p_function);
+			}
+
+			for (auto& event : m_drainedOverflow)
+				DispatchQueued(producer, event, p_function);
+			m_drainedOverflow.clear();
+
+			// Accumulating producer may still read an event of the drained arena it took from a coalesced slot
+			producer.WaitForEmplace();
+			producer.arenas[drainedArena]->Reset();
+
+			if (i == 0)
+			{
+				std::lock_guard lock{ m_sharedArenaLock };
+				m_sharedArenas[sharedDrainedArena]->Reset();
+			}
+		}
+	}
+}
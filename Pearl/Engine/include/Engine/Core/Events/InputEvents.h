@@ -64,6 +64,8 @@ namespace PrCore::Events {
 		double m_xPos;
 		double m_yPos;
 
+		// Only the last position of the frame matters
+		DEFINE_EVENT_COALESCING(EventCoalescing::KeepLatest);
 		DEFINE_EVENT_GUID(0x57ac3e95);
 	};
 
@@ -74,9 +76,27 @@ namespace PrCore::Events {
 			m_yOffset(p_yOffset)
 		{}
 
+		void Accumulate(const MouseScrollEvent& p_previous)
+		{
+			m_xOffset += p_previous.m_xOffset;
+			m_yOffset += p_previous.m_yOffset;
+		}
+
 		double m_xOffset;
 		double m_yOffset;
 
+		DEFINE_EVENT_COALESCING(EventCoalescing::Accumulate);
 		DEFINE_EVENT_GUID(0x934ff217);
 	};
-}
+
+	class CharInputEvent : public Event {
+	public:
+		CharInputEvent(unsigned int p_codepoint) :
+			m_codepoint(p_codepoint)
+		{}
+
+		uint32_t m_codepoint;
+
+		DEFINE_EVENT_GUID(0xc5e1a4b8);
+	};
+}
\ No newline at end of file
@@ -1,73 +1,83 @@
 #pragma once
 
 #include"Event.h"
+#include"EventQueue.h"
 #include"Core/Resources/IResource.h"
 
+#include<string_view>
+
 namespace PrCore::Events{
 
+	// Resource events are queued from loading threads, the path is copied next to the queued event
+	// Path is valid only while the event is dispatched
+	inline std::string_view CopyPath(std::string_view p_path)
+	{
+		return EventQueue::CopyString(p_path);
+	}
+
 	class ResourceUnloadedEventv2 : public Event {
 	public:
-		ResourceUnloadedEventv2(Resources::ResourceID p_id, const std::string& p_path) :
+		ResourceUnloadedEventv2(Resources::ResourceID p_id, std::string_view p_path) :
 			m_id(p_id),
-			m_path(p_path)
+			m_path(CopyPath(p_path))
 		{}
 
 		Resources::ResourceID  m_id;
-		std::string            m_path;
+		std::string_view       m_path;
 
 		DEFINE_EVENT_GUID(0x627b347d);
 	};
 
 	class ResourceLoadedEventv2 : public Event {
 	public:
-		ResourceLoadedEventv2(Resources::ResourceID p_id, const std::string& p_path) :
+		ResourceLoadedEventv2(Resources::ResourceID p_id, std::string_view p_path) :
 			m_id(p_id),
-			m_path(p_path)
+			m_path(CopyPath(p_path))
 		{}
 
 		Resources::ResourceID  m_id;
-		std::string            m_path;
+		std::string_view       m_path;
 
 		DEFINE_EVENT_GUID(0x531d7fe);
 	};
 
 	class ResourceCorruptedEventv2 : public Event {
 	public:
-		ResourceCorruptedEventv2(Resources::ResourceID p_id, const std::string& p_path) :
+		ResourceCorruptedEventv2(Resources::ResourceID p_id, std::string_view p_path) :
 			m_id(p_id),
-			m_path(p_path)
+			m_path(CopyPath(p_path))
 		{}
 
 		Resources::ResourceID  m_id;
-		std::string            m_path;
+		std::string_view       m_path;
 
 		DEFINE_EVENT_GUID(0x98fb1b9e);
 	};
 
 	class CacheMissEventv2 : public Event {
 	public:
-		CacheMissEventv2(Resources::ResourceID p_id, const std::string& p_path) :
+		CacheMissEventv2(Resources::ResourceID p_id, std::string_view p_path) :
 			m_id(p_id),
-			m_path(p_path)
+			m_path(CopyPath(p_path))
 		{}
 
 		Resources::ResourceID  m_id;
-		std::string            m_path;
+		std::string_view       m_path;
 
 		DEFINE_EVENT_GUID(0xd28d9ae4);
 	};
 
 	class BudgetExceededv2 : public Event {
 	public:
-		BudgetExceededv2(Resources::ResourceID p_id, const std::string& p_path, size_t p_usage, size_t p_budget) :
+		BudgetExceededv2(Resources::ResourceID p_id, std::string_view p_path, size_t p_usage, size_t p_budget) :
 			m_id(p_id),
-			m_path(p_path),
+			m_path(CopyPath(p_path)),
 			m_usage(p_usage),
 			m_budget(p_budget)
 		{}
 
 		Resources::ResourceID  m_id;
-		std::string            m_path;
+		std::string_view       m_path;
 		size_t                 m_usage;
 		size_t                 m_budget;
 
@@ -4,8 +4,7 @@ namespace PrCore::Events {
 
 	class WindowCloseEvent: public Event {
 	public:
-		virtual inline EventType GetType() const { return s_type; }
-		inline const static EventType s_type = 0x1cd2925a;
+		DEFINE_EVENT_GUID(0x1cd2925a);
 	};
 
 	class WindowResizeEvent: public Event {
@@ -17,6 +16,8 @@ namespace PrCore::Events {
 		float m_width;
 		float m_height;
 
+		// Dragging the window border resizes it many times per frame, buffers are regenerated once
+		DEFINE_EVENT_COALESCING(EventCoalescing::KeepLatest);
 		DEFINE_EVENT_GUID(0x9162135b);
 	};
 
@@ -18,14 +18,16 @@ namespace PrCore::File {
 	// IMPORTANT!! FileSystem expects string_view paths to be NULL-terminated
 	class FileSystem : public Utils::Singleton<FileSystem> {
 	public:
-		// Mounts the directory to the seach paths, last opened has the highest priority
-		void MountDir(std::string_view p_path, std::string_view p_mountPoint = "/");
+		// Mounts the directory to the seach paths, first mounted has the highest priority
+		// unless p_highestPriority puts the directory before the mounted ones
+		void MountDir(std::string_view p_path, std::string_view p_mountPoint = "/", bool p_highestPriority = false);
 		
 		// Unmounts the directory from the seach path
 		void UnmountDir(std::string_view p_path);
 
-		// To be used later, open and close zip archives, bind the zip to the mountPoint
-		void OpenArchive(std::string_view p_path, std::string_view p_mountPoint = "/");
+		// Opens and closes zip or engine pack (".prpak", see PackFile) archives, binds the archive to the mountPoint
+		// Archives share the search paths and priority rules with the directories
+		void OpenArchive(std::string_view p_path, std::string_view p_mountPoint = "/", bool p_highestPriority = false);
 		void CloseArchive(std::string_view p_path);
 
 		// Writing directory is a directory where file system can write files
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Core/Utils/NonCopyable.h"
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PrCore::File {
+
+	// Written file by its FileSystem path and its path on disk
+	struct FileChange
+	{
+		std::string path;
+		std::string nativePath;
+
+		bool operator<(const FileChange& p_other) const { return path < p_other.path; }
+		bool operator==(const FileChange& p_other) const { return path == p_other.path; }
+	};
+
+	// Reports the files written in the watched directories and their subdirectories
+	// Paths are relative to the mount point like FileSystem paths, so they match the resource paths
+	// Uses inotify on Linux, other platforms or a failed inotify fall back to polling the modification times
+	// An overflowed inotify queue reports every file of the watched directories
+	class FileWatcher : public Utils::NonCopyable {
+	public:
+		explicit FileWatcher(bool p_forcePolling = false);
+		~FileWatcher() override;
+
+		// p_dirPath is a native directory path, p_mountPoint is the point it is mounted at in FileSystem
+		void Watch(std::string_view p_dirPath, std::string_view p_mountPoint = "/");
+		void Unwatch(std::string_view p_dirPath);
+
+		// Files created, written or moved in since the last call, every path once. Never blocks
+		std::vector<FileChange> PollChanges();
+
+		// Polling rescans the directories at most once per interval
+		void SetPollInterval(std::chrono::milliseconds p_interval) { m_pollInterval = p_interval; }
+		bool IsPolling() const { return m_notifyHandle < 0; }
+
+	private:
+		struct FileStamp
+		{
+			std::filesystem::file_time_type writeTime;
+			uintmax_t                       size = 0;
+
+			bool operator==(const FileStamp& p_other) const { return writeTime == p_other.writeTime && size == p_other.size; }
+		};
+
+		struct WatchedDir
+		{
+			std::filesystem::path            root;
+			std::string                      mountPrefix;
+
+			// Polling only, stamps of the previous scan by the native path
+			std::map<std::string, FileStamp> files;
+		};
+
+		FileChange MakeChange(const WatchedDir& p_dir, const std::filesystem::path& p_filePath) const;
+
+		void ScanDir(WatchedDir& p_dir, std::vector<FileChange>* p_changes);
+		void PollNotifications(std::vector<FileChange>& p_changes);
+
+		void AddNotifyWatches(const std::string& p_rootKey, const std::filesystem::path& p_dirPath, std::vector<FileChange>* p_changes);
+		void RemoveNotifyWatches(const std::string& p_rootKey);
+
+		// Keyed by the normalized native root path
+		std::map<std::string, WatchedDir> m_dirs;
+
+		// inotify descriptor and the watched directory of every watch descriptor, -1 when polling
+		int                                                           m_notifyHandle;
+		std::map<int, std::pair<std::string, std::filesystem::path>> m_notifyWatches;
+
+		std::chrono::milliseconds              m_pollInterval;
+		std::chrono::steady_clock::time_point  m_lastPoll;
+	};
+}
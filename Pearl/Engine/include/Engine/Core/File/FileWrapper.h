@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace PrCore::File {
 
 	using FileHandle = void*;
@@ -14,10 +16,10 @@ namespace PrCore::File {
 
 	struct FileStats
 	{
-		int fileSize = 0;
-		int modTime = 0;
-		int createTime = 0;
-		int accessTime = 0;
+		int64_t fileSize = 0;
+		int64_t modTime = 0;    // Seconds since the epoch, -1 if the archive does not know it
+		int64_t createTime = 0;
+		int64_t accessTime = 0;
 
 		FileType type = FileType::Other;
 		bool readOnly = false;
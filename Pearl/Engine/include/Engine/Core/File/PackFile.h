@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Core/Utils/NonCopyable.h"
+#include "Core/Utils/FlatHashMap.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PrCore::File {
+
+	// Pack file layout: header, entry data aligned to the pack alignment, table of contents, path names
+	struct PackHeader
+	{
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint32_t entryCount = 0;
+		uint32_t alignment = 0;
+		uint64_t tocOffset = 0;
+		uint64_t namesOffset = 0;
+		uint64_t namesSize = 0;
+	};
+	static_assert(sizeof(PackHeader) == 40, "PackHeader layout is part of the file format");
+
+	enum PackEntryFlags : uint32_t
+	{
+		PackEntryCompressed = 1,
+	};
+
+	// Table of contents entry, the table is sorted by the path hash
+	struct PackEntry
+	{
+		uint64_t pathHash = 0;    // PathUtils::HashPath of the path
+		uint64_t dataOffset = 0;
+		uint64_t storedSize = 0;  // Size in the pack, compressed entries are smaller than the file
+		uint64_t size = 0;
+		uint32_t nameOffset = 0;  // Path in the names block, without a terminator
+		uint32_t nameLength = 0;
+		uint32_t flags = 0;
+		uint32_t reserved = 0;
+	};
+	static_assert(sizeof(PackEntry) == 48, "PackEntry layout is part of the file format");
+
+	// Engine asset pack, the whole file is memory mapped when opened
+	// Finding a file is a binary search in the table of contents and reading it is a pointer into the mapping,
+	// compressed entries are decompressed from the mapping
+	// Directories are indexed by the path hash when the pack is opened
+	// FileSystem mounts packs like directories, see RegisterPackArchiver
+	// Read only, safe from any thread
+	class PackFile : public Utils::NonCopyable {
+	public:
+		~PackFile() override;
+
+		// Returns nullptr if the file is not a valid pack
+		static std::unique_ptr<PackFile> Open(std::string_view p_nativePath);
+
+		// Pack read into memory, for packs without a native file
+		static std::unique_ptr<PackFile> OpenFromMemory(std::vector<uint8_t> p_data);
+
+		// Paths are compared like PathUtils::Sanitize writes them, returns nullptr if there is no such file
+		const PackEntry* Find(std::string_view p_path) const;
+
+		// Directories are the path prefixes of the files
+		bool             IsDirectory(std::string_view p_path) const;
+
+		// Sorted names of the files and directories directly inside the directory, "" is the root
+		const std::vector<std::string>& EnumerateDirectory(std::string_view p_path) const;
+
+		std::string_view GetEntryPath(const PackEntry& p_entry) const;
+
+		// Stored bytes of the entry inside the mapping, compressed for compressed entries
+		const uint8_t*   GetData(const PackEntry& p_entry) const { return m_data + p_entry.dataOffset; }
+
+		// Decompressed contents of the entry
+		bool             Read(const PackEntry& p_entry, std::vector<uint8_t>& p_data) const;
+
+		const PackEntry* GetEntries() const { return m_entries; }
+		size_t           GetEntryCount() const { return m_entryCount; }
+
+		static constexpr uint32_t Magic = 'P' | 'R' << 8 | 'P' << 16 | 'K' << 24;
+		static constexpr uint32_t Version = 1;
+
+	private:
+		// Every prefix of a file path, the path points into the names block
+		struct PackDirectory
+		{
+			std::string_view         path;
+			std::vector<std::string> children;
+			size_t                   nextSameHash = SIZE_MAX; // Next directory in m_directories with the same path hash
+		};
+
+		PackFile() = default;
+
+		bool Validate();
+		void BuildDirectories();
+
+		const PackDirectory* FindDirectory(std::string_view p_path) const;
+		PackDirectory&       GetOrAddDirectory(std::string_view p_path);
+
+		const uint8_t*   m_data = nullptr;
+		size_t           m_size = 0;
+		const PackEntry* m_entries = nullptr;
+		size_t           m_entryCount = 0;
+		const char*      m_names = nullptr;
+
+		std::vector<PackDirectory> m_directories;
+		Utils::FlatHashMap<size_t> m_directoryIndices; // Path hash to the first directory with the hash
+
+		// Mapping of the native file, or the memory the pack was read into
+		void*                m_mapping = nullptr;
+		void*                m_mappingHandle = nullptr;
+		std::vector<uint8_t> m_memory;
+	};
+
+	// Builds pack files, usually from the asset directories when the game is shipped
+	class PackWriter {
+	public:
+		explicit PackWriter(uint32_t p_alignment = 64);
+
+		// File replaces a file added with the same path, compressed only if it gets smaller
+		void   AddFile(std::string_view p_path, std::vector<uint8_t> p_data, bool p_compress = true);
+
+		// Adds the files of the native directory and its subdirectories, paths are relative to the directory
+		// Returns the number of added files
+		size_t AddDirectory(std::string_view p_nativeDir, bool p_compress = true);
+
+		bool   Write(std::string_view p_nativePath) const;
+
+		size_t GetFileCount() const { return m_files.size(); }
+
+	private:
+		struct PackedFile
+		{
+			std::string          path;
+			std::vector<uint8_t> data;
+			uint64_t             size = 0;
+			bool                 compressed = false;
+			size_t               nextSameHash = SIZE_MAX; // Next file in m_files with the same path hash
+		};
+
+		std::vector<PackedFile>    m_files;
+		Utils::FlatHashMap<size_t> m_fileIndices; // Path hash to the first file with the hash
+		uint32_t                   m_alignment;
+	};
+
+	// Registers the pack format with PhysFS so MountDir and OpenArchive mount ".prpak" files, called by FileSystem
+	bool RegisterPackArchiver();
+}
@@ -2,21 +2,24 @@
 #include"PrKey.h"
 #include"PrMouseButton.h"
 #include"PrKeyState.h"
+#include"InputStateTable.h"
 
 #include"Core/Utils/Singleton.h"
 #include"Core/Events/Event.h"
 #include"Core/Math/Math.h"
 
-#include<unordered_map>
+#include<array>
 
 namespace PrCore::Input {
 
+	constexpr size_t g_keyTableSize = 512;
+	constexpr size_t g_mouseButtonTableSize = 8;
+	constexpr size_t g_charInputCapacity = 32;
+
 	class InputManager: public Utils::Singleton<InputManager> {
 
-		typedef std::unordered_map<PrKey, PrInputState>				KeyStateMap;
-		typedef std::unordered_map<PrKey, bool>						KeyHoldMap;
-		typedef std::unordered_map<PrMouseButton, PrInputState>		ButtonStateMap;
-		typedef std::unordered_map<PrMouseButton, bool>				ButtonHoldMap;
+		typedef InputStateTable<g_keyTableSize>         KeyStateTable;
+		typedef InputStateTable<g_mouseButtonTableSize> ButtonStateTable;
 
 	public:
 		bool IsKeyPressed(PrKey p_key) const;
@@ -35,6 +38,11 @@ namespace PrCore::Input {
 		double GetMouseY() const;
 		Math::vec2 GetMousePosition() const;
 
+		// Unicode code points typed this frame, the oldest are dropped above g_charInputCapacity
+		size_t   GetCharInputCount() const;
+		uint32_t GetCharInput(size_t p_index) const;
+
+		// Moves the state to the next frame, call before the events of the next frame are dispatched
 		void ResetFlags();
 
 	private:
@@ -50,17 +58,18 @@ namespace PrCore::Input {
 		void OnMouseMoved(Events::EventPtr p_event);
 		void OnMouseScroll(Events::EventPtr p_event);
 
-		KeyStateMap s_keyState;
-		KeyHoldMap s_keyHold;
-		ButtonStateMap s_buttonState;
-		ButtonHoldMap s_buttonHold;
-		
+		void OnCharInput(Events::EventPtr p_event);
+
+		KeyStateTable    m_keyState;
+		ButtonStateTable m_buttonState;
+
 		double s_mouseXPos;
 		double s_mouseYPos;
 		double s_mouseScroll;
 
-		bool s_anyPressed;
-		bool s_anyHold;
+		std::array<uint32_t, g_charInputCapacity> m_charInput;
+		size_t                                    m_charInputHead;
+		size_t                                    m_charInputCount;
 
 		friend Singleton<InputManager>;
 	};
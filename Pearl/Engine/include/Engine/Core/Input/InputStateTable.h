@@ -0,0 +1,79 @@
+#pragma once
+
+#include<bitset>
+
+namespace PrCore::Input {
+
+	// Down state of Size inputs for the current and the previous frame, edges are the XOR of both
+	// Codes outside of the table like PrKey::UNKNOWN map to InvalidIndex, it is never down and cannot be pressed
+	// The tables keep a bit for InvalidIndex that is never set, so the queries read it without a bounds check
+	template<size_t Size>
+	class InputStateTable {
+	public:
+		static constexpr size_t InvalidIndex = Size;
+
+		static constexpr size_t ToIndex(int p_input)
+		{
+			return p_input >= 0 && static_cast<size_t>(p_input) < Size ? static_cast<size_t>(p_input) : InvalidIndex;
+		}
+
+		void Press(size_t p_index)
+		{
+			if (p_index >= Size)
+				return;
+
+			m_current.set(p_index);
+			m_pendingRelease.reset(p_index);
+		}
+
+		// Input pressed and released within one frame stays down until the next frame, so the press is not lost
+		void Release(size_t p_index)
+		{
+			if (p_index >= Size)
+				return;
+
+			if (m_previous[p_index])
+				m_current.reset(p_index);
+			else
+				m_pendingRelease.set(p_index);
+		}
+
+		// Queries take the indices returned by ToIndex
+		bool IsDown(size_t p_index) const
+		{
+			return m_current[p_index];
+		}
+
+		bool IsPressed(size_t p_index) const
+		{
+			return (m_current[p_index] ^ m_previous[p_index]) & m_current[p_index];
+		}
+
+		bool IsReleased(size_t p_index) const
+		{
+			return (m_current[p_index] ^ m_previous[p_index]) & m_previous[p_index];
+		}
+
+		bool IsAnyPressed() const
+		{
+			return ((m_current ^ m_previous) & m_current).any();
+		}
+
+		bool IsAnyDown() const
+		{
+			return m_current.any();
+		}
+
+		void NewFrame()
+		{
+			m_previous = m_current;
+			m_current &= ~m_pendingRelease;
+			m_pendingRelease.reset();
+		}
+
+	private:
+		std::bitset<Size + 1> m_current;
+		std::bitset<Size + 1> m_previous;
+		std::bitset<Size + 1> m_pendingRelease;
+	};
+}
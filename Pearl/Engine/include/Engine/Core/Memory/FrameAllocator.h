@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Core/Memory/LinearAllocator.h"
+#include "Core/Utils/Singleton.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace PrCore::Memory {
+
+	constexpr size_t g_defaultFrameAllocatorCapacity = 1024 * 1024;
+	constexpr size_t g_defaultFrameAllocatorFrames = 2;
+
+	// Per thread scratch memory reset wholesale at the frame boundary
+	// Memory allocated in a frame stays valid for the next p_frameCount - 1 frames
+	class FrameAllocator : public Utils::Singleton<FrameAllocator> {
+	public:
+		FrameAllocator(size_t p_threadCapacity = g_defaultFrameAllocatorCapacity, size_t p_frameCount = g_defaultFrameAllocatorFrames);
+		~FrameAllocator();
+
+		// Allocator of the current frame for the calling thread, created on the first use
+		LinearAllocator& GetThreadAllocator();
+
+		void* Allocate(size_t p_size, size_t p_alignment = alignof(std::max_align_t))
+		{
+			return GetThreadAllocator().Allocate(p_size, p_alignment);
+		}
+
+		// Containers using it must not outlive the frames or be grown from other threads
+		template<typename T>
+		LinearStlAllocator<T> GetStlAllocator()
+		{
+			return LinearStlAllocator<T>(GetThreadAllocator());
+		}
+
+		// Resets the oldest frame of every thread, call when no job uses the scratch memory
+		void NewFrame();
+
+		size_t GetFrameIndex() const { return m_frameIndex.load(); }
+		size_t GetFrameCount() const { return m_frameCount; }
+
+	private:
+		struct ThreadFrames
+		{
+			std::vector<std::unique_ptr<LinearAllocator>> frames;
+		};
+
+		// Thread caches its frames, instance id invalidates the cache after the allocator is recreated
+		struct ThreadCache
+		{
+			uint64_t      instanceId = 0;
+			ThreadFrames* threadFrames = nullptr;
+		};
+		static thread_local ThreadCache s_threadCache;
+
+		std::vector<std::unique_ptr<ThreadFrames>> m_threadFrames;
+		std::mutex                                 m_threadFramesLock;
+
+		size_t                                     m_threadCapacity;
+		size_t                                     m_frameCount;
+		std::atomic<size_t>                        m_frameIndex;
+		uint64_t                                   m_instanceId;
+	};
+
+	template<typename T>
+	using FrameVector = std::vector<T, LinearStlAllocator<T>>;
+}
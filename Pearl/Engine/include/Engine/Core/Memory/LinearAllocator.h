@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Core/Utils/NonCopyable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Debug builds poison the memory and guard every allocation to catch overruns
+#ifdef PR_ASSERTENABLE
+	#define PR_SCRATCH_DEBUG 1
+#else
+	#define PR_SCRATCH_DEBUG 0
+#endif
+
+namespace PrCore::Memory {
+
+	// Bump allocator that is released only as a whole with Reset, individual allocations are never freed
+	// Not thread safe, every thread should use its own allocator
+	class LinearAllocator : public Utils::NonCopyable {
+	public:
+		explicit LinearAllocator(size_t p_capacity);
+		~LinearAllocator();
+
+		// Never fails, allocations that do not fit go to the heap blocks until the next Reset
+		void* Allocate(size_t p_size, size_t p_alignment = alignof(std::max_align_t));
+
+		// Destructor is never called, use only for trivially destructible types or destroy manually
+		template<typename T, typename... Args>
+		T* New(Args&&... p_args)
+		{
+			return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(p_args)...);
+		}
+
+		// Copy is not null terminated and lives until the next Reset
+		std::string_view CopyString(std::string_view p_string)
+		{
+			auto data = static_cast<char*>(Allocate(p_string.size(), 1));
+			std::memcpy(data, p_string.data(), p_string.size());
+			return std::string_view(data, p_string.size());
+		}
+
+		// Releases all allocations, the capacity grows to fit the whole previous usage after an overflow
+		void Reset();
+
+		// Checks the guards of all live allocations, no-op in release
+		void Validate() const;
+
+		bool   Owns(const void* p_ptr) const;
+		size_t GetUsedSize() const { return m_offset + m_overflowSize; }
+		size_t GetCapacity() const { return m_capacity; }
+
+	private:
+		uint8_t* AllocateOverflow(size_t p_size, size_t p_alignment);
+
+		std::unique_ptr<uint8_t[]> m_buffer;
+		size_t                     m_capacity;
+		size_t                     m_offset;
+
+		struct OverflowBlock
+		{
+			std::unique_ptr<uint8_t[]> data;
+			size_t                     capacity;
+			size_t                     offset;
+		};
+		std::vector<OverflowBlock> m_overflowBlocks;
+		size_t                     m_overflowSize;
+
+#if PR_SCRATCH_DEBUG
+		// Guard of the last allocation, every guard links to the previous one
+		uint8_t*                   m_lastGuard = nullptr;
+#endif
+	};
+
+	// Allocator adapter for the STL containers, deallocation is a no-op
+	template<typename T>
+	class LinearStlAllocator {
+	public:
+		using value_type = T;
+
+		LinearStlAllocator(LinearAllocator& p_allocator) noexcept :
+			m_allocator(&p_allocator)
+		{}
+
+		template<typename U>
+		LinearStlAllocator(const LinearStlAllocator<U>& p_other) noexcept :
+			m_allocator(p_other.GetAllocator())
+		{}
+
+		T* allocate(size_t p_count)
+		{
+			return static_cast<T*>(m_allocator->Allocate(p_count * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T*, size_t) noexcept {}
+
+		LinearAllocator* GetAllocator() const noexcept { return m_allocator; }
+
+		template<typename U>
+		bool operator==(const LinearStlAllocator<U>& p_other) const noexcept { return m_allocator == p_other.GetAllocator(); }
+
+		template<typename U>
+		bool operator!=(const LinearStlAllocator<U>& p_other) const noexcept { return m_allocator != p_other.GetAllocator(); }
+
+	private:
+		LinearAllocator* m_allocator;
+	};
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "IResource.h"
+
+#include "Core/Utils/FlatHashMap.h"
+#include "Core/Utils/PathUtils.h"
+
+#include "json/json.hpp"
+
+#include <shared_mutex>
+
+namespace PrCore::Resources {
+
+	struct AssetRecord
+	{
+		std::string    path;
+		ResourceID     id = InvalidID;
+
+		// Hash of the source bytes last seen, 0 before the file is hashed
+		uint64_t       contentHash = 0;
+
+		// Hash was taken in this run, a hash opened from the file may be older than the file
+		bool           hashVerified = false;
+
+		// Size and modification time of the file the hash was taken from, -1 if unknown
+		int64_t        fileSize = -1;
+		int64_t        modTime = -1;
+
+		// Source hash and settings of the last import, the import is up to date while both match
+		uint64_t       importHash = 0;
+		nlohmann::json importSettings;
+	};
+
+	// Persistent record of the file assets by their normalized path, saved between the runs
+	// IDs are derived from the path so the same asset has the same ID in every run and on every machine,
+	// derived data caches and scene references can be keyed on them
+	// Content hashes tell the changed files apart from the touched ones, so unchanged assets are not reloaded or imported again
+	// Safe from any thread
+	class AssetRegistry {
+	public:
+		AssetRegistry() = default;
+		~AssetRegistry() = default;
+
+		// ID of the file resource, the registry does not have to know the path
+		static ResourceID MakeID(std::string_view p_path) { return PathUtils::HashPath(p_path); }
+
+		static uint64_t HashContent(const void* p_data, size_t p_size);
+
+		// Read and written through FileSystem, missing file is an empty registry
+		bool OpenFromFile(std::string_view p_filePath);
+		bool SaveToFile(std::string_view p_filePath);
+
+		void Serialize(nlohmann::json& p_serialized) const;
+		void Deserialize(const nlohmann::json& p_serialized);
+
+		// Changed since opened or saved
+		bool IsDirty() const;
+
+		// Copies the record, returns false if the path has no record
+		bool   FindRecord(std::string_view p_path, AssetRecord& p_record) const;
+		void   RemoveRecord(std::string_view p_path);
+		size_t GetRecordCount() const;
+
+		// Records the hash of the source bytes, returns false if it is the one recorded in this run
+		// Size and modification time of the hashed file let the next run trust the hash, see VerifyFromFile
+		bool UpdateContentHash(std::string_view p_path, uint64_t p_contentHash, int64_t p_fileSize = -1, int64_t p_modTime = -1);
+
+		// Hashes the file read through FileSystem, returns false if the content did not change or the file cannot be read
+		bool UpdateFromFile(std::string_view p_path);
+
+		// Makes the hash of the file current for this run, returns false if the file cannot be read
+		// Hash of an earlier run is trusted while the file has the recorded size and modification time, otherwise the file is hashed
+		// Used on the first load, changes while running are reported by FileWatcher and hashed with UpdateFromNativeFile
+		bool VerifyFromFile(std::string_view p_path);
+
+		// Same for the file read from disk, p_nativePath is where the asset of p_path lives, for example reported by FileWatcher
+		bool UpdateFromNativeFile(std::string_view p_path, const std::string& p_nativePath);
+
+		// Next VerifyFromFile hashes the file again, used for the files changed while none of their resources is loaded
+		void InvalidateHash(std::string_view p_path);
+
+		// Import is skipped if the source and the settings are the ones of the last recorded import
+		bool NeedsImport(std::string_view p_path, uint64_t p_contentHash, const nlohmann::json& p_importSettings = {}) const;
+		void RecordImport(std::string_view p_path, uint64_t p_contentHash, const nlohmann::json& p_importSettings = {});
+
+	private:
+		AssetRecord& GetOrAddRecord(std::string_view p_path);
+
+		static constexpr int s_version = 1;
+
+		Utils::FlatHashMap<AssetRecord> m_records;
+		bool                            m_dirty = false;
+
+		mutable std::shared_mutex       m_lock;
+	};
+}
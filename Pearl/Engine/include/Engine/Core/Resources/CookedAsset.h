@@ -0,0 +1,132 @@
+#pragma once
+
+#include "json/json.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace PrCore::Resources {
+
+	// Header of every cooked file, the payload of the asset type follows it
+	struct CookedAssetHeader
+	{
+		uint32_t magic = 0;
+		uint32_t assetType = 0;      // FourCC of the payload format
+		uint32_t formatVersion = 0;  // Payload version of the loader, files of other versions are cooked again
+		uint32_t headerSize = 0;
+		uint64_t sourceHash = 0;     // Content hash of the source the file was cooked from
+		uint64_t payloadSize = 0;
+	};
+	static_assert(sizeof(CookedAssetHeader) == 32, "CookedAssetHeader layout is part of the file format");
+
+	// Engine native binary files cooked from the source assets, loading one is a file read and a header check
+	// Cooked files are written under "cooked/" in the write directory and read through FileSystem like the sources
+	// A cooked file is used while its header matches the loader format and the source hash in the asset registry,
+	// without the source, as in the shipped builds, the header check is enough
+	// Safe from any thread
+	class CookedAsset {
+	public:
+		static constexpr uint32_t MakeFourCC(char p_a, char p_b, char p_c, char p_d)
+		{
+			return static_cast<uint32_t>(static_cast<uint8_t>(p_a)) | static_cast<uint32_t>(static_cast<uint8_t>(p_b)) << 8 |
+				static_cast<uint32_t>(static_cast<uint8_t>(p_c)) << 16 | static_cast<uint32_t>(static_cast<uint8_t>(p_d)) << 24;
+		}
+
+		static std::string GetCookedPath(std::string_view p_sourcePath);
+		static bool        IsCookedPath(std::string_view p_path);
+
+		// Reads the payload of the cooked file of the source, returns false if there is no valid one
+		static bool Read(std::string_view p_sourcePath, uint32_t p_assetType, uint32_t p_formatVersion, std::vector<uint8_t>& p_payload);
+
+		// Writes the cooked file and records the import in the asset registry
+		static bool Write(std::string_view p_sourcePath, uint32_t p_assetType, uint32_t p_formatVersion, uint64_t p_sourceHash, const std::vector<uint8_t>& p_payload, const nlohmann::json& p_importSettings = {});
+
+		// Reads the source bytes the loaders parse, records their hash in the asset registry
+		static bool ReadSource(std::string_view p_sourcePath, std::vector<uint8_t>& p_source, uint64_t& p_sourceHash);
+
+		// Offline cooking skips the sources imported with the same content and settings into a valid cooked file
+		static bool IsUpToDate(std::string_view p_sourcePath, uint32_t p_assetType, uint32_t p_formatVersion, uint64_t p_sourceHash, const nlohmann::json& p_importSettings = {});
+
+		// Loaders cook the sources they parse so the next load reads the cooked file
+		static void SetCookOnLoad(bool p_cookOnLoad) { s_cookOnLoad = p_cookOnLoad; }
+		static bool IsCookOnLoad() { return s_cookOnLoad; }
+
+	private:
+		static bool ReadHeader(std::string_view p_cookedPath, CookedAssetHeader& p_header, std::vector<uint8_t>* p_payload);
+		static bool IsHeaderValid(const CookedAssetHeader& p_header, uint32_t p_assetType, uint32_t p_formatVersion);
+
+		inline static std::atomic<bool> s_cookOnLoad = true;
+	};
+
+	// Appends the values and arrays of the cooked payload, the layout is the in memory one of the engine platforms
+	class CookedWriter {
+	public:
+		explicit CookedWriter(std::vector<uint8_t>& p_payload) : m_payload(p_payload) {}
+
+		template<class T>
+		void Write(const T& p_value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Cooked values are copied bytewise");
+			auto bytes = reinterpret_cast<const uint8_t*>(&p_value);
+			m_payload.insert(m_payload.end(), bytes, bytes + sizeof(T));
+		}
+
+		// Element count followed by the elements
+		template<class T>
+		void WriteArray(const std::vector<T>& p_values)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Cooked values are copied bytewise");
+			Write(static_cast<uint64_t>(p_values.size()));
+			auto bytes = reinterpret_cast<const uint8_t*>(p_values.data());
+			m_payload.insert(m_payload.end(), bytes, bytes + p_values.size() * sizeof(T));
+		}
+
+	private:
+		std::vector<uint8_t>& m_payload;
+	};
+
+	// Reads the payload written by CookedWriter, every read fails once the payload is too short
+	class CookedReader {
+	public:
+		explicit CookedReader(const std::vector<uint8_t>& p_payload) : m_payload(p_payload) {}
+
+		template<class T>
+		bool Read(T& p_value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Cooked values are copied bytewise");
+			if (!m_valid || m_payload.size() - m_offset < sizeof(T))
+				return m_valid = false;
+
+			std::memcpy(&p_value, m_payload.data() + m_offset, sizeof(T));
+			m_offset += sizeof(T);
+			return true;
+		}
+
+		template<class T>
+		bool ReadArray(std::vector<T>& p_values)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Cooked values are copied bytewise");
+			uint64_t count = 0;
+			if (!Read(count) || count > (m_payload.size() - m_offset) / sizeof(T))
+				return m_valid = false;
+
+			p_values.resize(static_cast<size_t>(count));
+			std::memcpy(p_values.data(), m_payload.data() + m_offset, static_cast<size_t>(count) * sizeof(T));
+			m_offset += static_cast<size_t>(count) * sizeof(T);
+			return true;
+		}
+
+		// Whole payload read without a failure
+		bool IsComplete() const { return m_valid && m_offset == m_payload.size(); }
+
+	private:
+		const std::vector<uint8_t>& m_payload;
+		size_t                      m_offset = 0;
+		bool                        m_valid = true;
+	};
+}
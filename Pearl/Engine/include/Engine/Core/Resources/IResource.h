@@ -1,4 +1,6 @@
 #pragma once
+#include<atomic>
+#include<functional>
 #include<string>
 #include<memory>
 
@@ -29,7 +31,11 @@ namespace PrCore::Resources {
 
 		// There was an attempt to load the resource but it failed
 		// Only Resource created from file can have this state
-		Corrupted = 4
+		Corrupted = 4,
+
+		// Asynchronous load is in progress, the data is not available yet
+		// Only Resources created from file can have this state
+		Loading = 5
 	};
 
 	/*
@@ -39,6 +45,7 @@ namespace PrCore::Resources {
 	| |		    |                           -->            |
 	| |Unmanaged| --> Registered --> Loaded <-- Unloaded   |
 	| |		    |        |          Corrupted       |      |
+	| |		    |        |          Loading         |      |
 	| |---------|  <---------------------------------      |
 	|______________________________________________________|
 	========================================================
@@ -72,6 +79,14 @@ namespace PrCore::Resources {
 		// Return size of loaded resource this should update during asset manipulations and calculate current size.
 		virtual size_t GetByteSize() const = 0;
 
+		// Copy-on-write blocks of the data with their byte size, the blocks are included in GetByteSize
+		// Copies share the blocks, the database counts a block held by several resources once
+		using BlockVisitor = std::function<void(const std::shared_ptr<const void>&, size_t)>;
+		virtual void ForEachBlock(const BlockVisitor& p_visitor) const {}
+
+		// Copy used by ResourceSystem::Copy for the types without a usable copy constructor, nullptr if not supported
+		virtual std::shared_ptr<IResourceData> Clone() const { return nullptr; }
+
 		// These functions allow adding resource name. It is used for only logging and debug purpose.
 		// Name is automatically set by the IResourceDatabase but you can set your custom name too.
 		const std::string& GetName() const { return m_name; }
@@ -83,39 +98,126 @@ namespace PrCore::Resources {
 	using IResourceDataPtr = std::shared_ptr<IResourceData>;
 
 
+	// Raw data pointer read together with the counters published with it, see ResourceDesc::ReadData
+	struct ResourceDataSnapshot {
+		IResourceData* data = nullptr;
+		uint32_t       generation = 0;
+		uint32_t       slot = 0;
+	};
+
 	// The Resource descriptor storing resource data and metadata
-	// To access resource data call GetData() and cast to correct type
+	// To access resource data call GetData() or GetRawData() and cast to correct type
 	struct ResourceDesc final {
 	public:
 		ResourceDesc() :
-			data(nullptr),
+			size(0),
 			id(InvalidID),
-			filePath(""),
 			state(ResourceState::Unmanaged),
 			origin(ResourceOrigin::Memory),
-			size(0)
+			filePath("")
 		{}
 
 		ResourceDesc(IResourceDataPtr p_data) :
-			data(p_data),
+			size(0),
 			id(InvalidID),
-			filePath(""),
 			state(ResourceState::Unmanaged),
 			origin(ResourceOrigin::Memory),
-			size(0)
-		{}
+			filePath("")
+		{
+			SetData(std::move(p_data));
+		}
+
+		// Data, state and counters are atomic, they are copied as a snapshot
+		ResourceDesc(const ResourceDesc& p_other) :
+			size(p_other.size.load()),
+			id(p_other.id),
+			state(p_other.state.load()),
+			origin(p_other.origin),
+			filePath(p_other.filePath),
+			lastAccess(p_other.lastAccess.load()),
+			pinCount(p_other.pinCount)
+		{
+			CopyData(p_other);
+		}
+
+		ResourceDesc& operator=(const ResourceDesc& p_other)
+		{
+			CopyData(p_other);
+			size = p_other.size.load();
+			id = p_other.id;
+			state = p_other.state.load();
+			origin = p_other.origin;
+			filePath = p_other.filePath;
+			lastAccess = p_other.lastAccess.load();
+			pinCount = p_other.pinCount;
+
+			return *this;
+		}
+
+		// Resource data, readers without the database lock get the previous or the new data, never a torn pointer
+		// The data of a loaded resource can still be unloaded by another thread, keep the descriptor or pin the resource to prevent eviction
+		IResourceDataPtr GetData() const { return m_data.load(std::memory_order_acquire); }
+
+		// Raw access without touching the reference counters, valid while the resource stays loaded
+		IResourceData*   GetRawData() const { return ReadData().data; }
+
+		// Incremented every time the data changes, raw data pointers cached with a generation are valid while it matches
+		uint32_t         GetGeneration() const { return ReadData().generation; }
+
+		// Incremented when the descriptor is removed from its database, handles created before see no data afterwards
+		uint32_t         GetSlot() const { return ReadData().slot; }
+
+		// Data pointer with the generation and slot it was published with, retried while a writer publishes
+		ResourceDataSnapshot ReadData() const
+		{
+			ResourceDataSnapshot snapshot;
+			uint32_t sequence;
+			do
+			{
+				sequence = m_sequence.load(std::memory_order_acquire);
+				snapshot.data = m_rawData.load(std::memory_order_relaxed);
+				snapshot.generation = m_generation.load(std::memory_order_relaxed);
+				snapshot.slot = m_slot.load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+			} while ((sequence & 1) != 0 || sequence != m_sequence.load(std::memory_order_relaxed));
+
+			return snapshot;
+		}
+
+		// Writers below are called by the owning database under its lock
+		// Replaces the data and starts a new generation
+		void             SetData(IResourceDataPtr p_data)
+		{
+			auto snapshot = ReadData();
+			Publish(p_data.get(), snapshot.generation + 1, snapshot.slot);
+			m_data.store(std::move(p_data), std::memory_order_release);
+		}
+
+		// Starts a new generation without changing the data
+		void             NextGeneration()
+		{
+			auto snapshot = ReadData();
+			Publish(snapshot.data, snapshot.generation + 1, snapshot.slot);
+		}
 
-		// Resource data 
-		IResourceDataPtr data;
+		// Drops the data of a descriptor removed from its database
+		void             ReleaseSlot()
+		{
+			auto snapshot = ReadData();
+			Publish(nullptr, snapshot.generation + 1, snapshot.slot + 1);
+			m_data.store(nullptr, std::memory_order_release);
+		}
 
 		// Size in bytes snapshot created during loading, it is not guaranteed to refresh if the resource data changes
-		size_t          size;
+		std::atomic<size_t> size;
 
 		// Unique ID assigned by resource database
+		// Hash of the normalized path for file resources, stable between the runs
 		ResourceID      id{};
 
-		// Current resource state
-		ResourceState   state;
+		// Current resource state, written by the owning database under its lock and read lock-free
+		// The data, size and generation are published before the state changes to Loaded
+		std::atomic<ResourceState> state;
 
 		// Resource origin can be file or memory
 		ResourceOrigin  origin;
@@ -123,6 +225,41 @@ namespace PrCore::Resources {
 		// If resource origin is file this stores the file path, empty otherwise
 		std::string     filePath;
 
+		// Access tick of the owning database, the least recently used resources are evicted first
+		std::atomic<uint64_t> lastAccess = 0;
+
+		// Pinned resources are never evicted, see IResourceDatabase::Pin
+		uint32_t        pinCount = 0;
+
+	private:
+		// Sequence lock write, the sequence is odd while the values change
+		void Publish(IResourceData* p_rawData, uint32_t p_generation, uint32_t p_slot)
+		{
+			auto sequence = m_sequence.load(std::memory_order_relaxed);
+			m_sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			m_rawData.store(p_rawData, std::memory_order_relaxed);
+			m_generation.store(p_generation, std::memory_order_relaxed);
+			m_slot.store(p_slot, std::memory_order_relaxed);
+
+			m_sequence.store(sequence + 2, std::memory_order_release);
+		}
+
+		void CopyData(const ResourceDesc& p_other)
+		{
+			auto data = p_other.GetData();
+			auto snapshot = p_other.ReadData();
+			Publish(data.get(), snapshot.generation, snapshot.slot);
+			m_data.store(std::move(data), std::memory_order_release);
+		}
+
+		std::atomic<IResourceDataPtr> m_data;
+
+		std::atomic<uint32_t>         m_sequence = 0;
+		std::atomic<IResourceData*>   m_rawData = nullptr;
+		std::atomic<uint32_t>         m_generation = 0;
+		std::atomic<uint32_t>         m_slot = 0;
 	};
 	using ResourceDescPtr = std::shared_ptr<ResourceDesc>;
 	using ResourceDescConstPtr = std::shared_ptr<const ResourceDesc>;
@@ -134,35 +271,42 @@ namespace PrCore::Resources {
 	class ResourceHandle final {
 	public:
 		ResourceHandle() :
-			m_resourceDesc(nullptr)
+			m_resourceDesc(nullptr),
+			m_slot(0)
 		{}
 
 		ResourceHandle(const ResourceHandle<T>& p_ref) :
-			m_resourceDesc(p_ref.m_resourceDesc)
+			m_resourceDesc(p_ref.m_resourceDesc),
+			m_slot(p_ref.m_slot)
 		{}
 
-		ResourceHandle(ResourceHandle<T>&& p_ref) :
-			m_resourceDesc(p_ref.m_resourceDesc)
+		ResourceHandle(ResourceHandle<T>&& p_ref) noexcept :
+			m_resourceDesc(std::move(p_ref.m_resourceDesc)),
+			m_slot(p_ref.m_slot)
 		{}
 
 		ResourceHandle(const ResourceDescPtr& p_resourceDesc) :
-			m_resourceDesc(p_resourceDesc)
+			m_resourceDesc(p_resourceDesc),
+			m_slot(p_resourceDesc ? p_resourceDesc->GetSlot() : 0)
 		{}
 
 		// Create ResourceHandle from the stack allocated ResourceDesc
 		ResourceHandle(const ResourceDesc& p_resourceDesc) :
-			m_resourceDesc(std::make_shared<ResourceDesc>(p_resourceDesc))
+			m_resourceDesc(std::make_shared<ResourceDesc>(p_resourceDesc)),
+			m_slot(m_resourceDesc->GetSlot())
 		{}
 
 		// Create ResourceHandle from the stack allocated ResourceDesc 
 		ResourceHandle(ResourceDesc&& p_resourceDesc) :
-			m_resourceDesc(std::make_shared<ResourceDesc>(std::move(p_resourceDesc)))
+			m_resourceDesc(std::make_shared<ResourceDesc>(std::move(p_resourceDesc))),
+			m_slot(m_resourceDesc->GetSlot())
 		{}
 
 		// Create ResourceHandle from resource data 
 		// Useful when creating resource data manually and want to wrap with the handler
 		// IMPORTANT! This constructor is implicit
-		ResourceHandle(std::shared_ptr<T> p_dataPtr)
+		ResourceHandle(std::shared_ptr<T> p_dataPtr) :
+			m_slot(0)
 		{
 			m_resourceDesc = std::make_shared<ResourceDesc>(p_dataPtr);
 		}
@@ -173,6 +317,7 @@ namespace PrCore::Resources {
 			if (this != &p_ref)
 			{
 				m_resourceDesc = p_ref.m_resourceDesc;
+				m_slot = p_ref.m_slot;
 			}
 
 			return *this;
@@ -183,6 +328,7 @@ namespace PrCore::Resources {
 			if (this != &p_ref)
 			{
 				m_resourceDesc = std::move(p_ref.m_resourceDesc);
+				m_slot = p_ref.m_slot;
 			}
 
 			return *this;
@@ -194,39 +340,55 @@ namespace PrCore::Resources {
 		ResourceOrigin      GetOrigin() const { return m_resourceDesc->origin; }
 		size_t              GetSize() const { return m_resourceDesc->size; }
 
+		uint32_t            GetGeneration() const { return m_resourceDesc->GetGeneration(); }
+
 		// Gets IResourceData from the descriptor. If descriptor is nullptr the function returns nullptr
-		std::shared_ptr<T>  GetData() 
+		// Shares the ownership, use it only when the data has to outlive the resource in the database
+		std::shared_ptr<T>  GetData() const
+		{
+			if (m_resourceDesc == nullptr)
+				return nullptr;
+
+			return std::static_pointer_cast<T>(m_resourceDesc->GetData());
+		}
+
+		// Raw access without touching the reference counters, valid while the resource stays loaded
+		// Follows the reloads of the resource, returns nullptr once the descriptor was removed from its database
+		T*                  Get() const
 		{
 			if (m_resourceDesc == nullptr)
 				return nullptr;
 
-			return std::static_pointer_cast<T>(m_resourceDesc->data); 
+			auto snapshot = m_resourceDesc->ReadData();
+			return snapshot.slot == m_slot ? static_cast<T*>(snapshot.data) : nullptr;
 		}
 
 		// Checks if the handle holds valid resource descriptor
-		bool               IsValid() { return m_resourceDesc != nullptr; }
+		bool               IsValid() const { return m_resourceDesc != nullptr; }
 
 		// Proxy functions to access IResourceData directly
 		// Use these functions instead of GetData()
-		std::shared_ptr<T> operator->() { return GetData(); }
+		T* operator->() const { return Get(); }
+		T& operator*() const { return *Get(); }
+
 		bool operator==(const IResourceDataPtr& p_ptr) const 
 		{ 
-			if (m_resourceDesc == nullptr)
-				return p_ptr == nullptr;
-
-			return std::static_pointer_cast<const T>(m_resourceDesc->data) == p_ptr; 
+			return Get() == p_ptr.get();
 		}
 
 		bool operator!=(const IResourceDataPtr& p_ptr) const
 		{
-			if (m_resourceDesc == nullptr)
-				return p_ptr != nullptr;
-
-			return std::static_pointer_cast<const T>(m_resourceDesc->data) != p_ptr;
+			return Get() != p_ptr.get();
 		}
 
+		bool operator==(std::nullptr_t) const { return Get() == nullptr; }
+		bool operator!=(std::nullptr_t) const { return Get() != nullptr; }
+
 	protected:
 		ResourceDescPtr m_resourceDesc;
+
+		// Descriptor slot the handle was created for, see ResourceDesc::GetSlot
+		uint32_t        m_slot;
 	};
 
 #define REGISTRER_RESOURCE_HANDLE(ResourceName) \
@@ -1,9 +1,28 @@
 #pragma once
 #include "Core/Resources/IResource.h"
 
+#include <typeinfo>
+#include <vector>
 
 namespace PrCore::Resources {
 
+	// Resource loaded together with another resource, the type selects the resource database like in ResourceSystem
+	struct ResourceDependency
+	{
+		std::string path;
+		size_t      resourceType = 0;
+
+		template<class T>
+		static ResourceDependency Of(std::string p_path) { return { std::move(p_path), typeid(T).hash_code() }; }
+	};
+
+	// CPU side result of the asynchronous load step, handed to FinalizeResource on the main thread
+	class IResourceStagingData {
+	public:
+		virtual ~IResourceStagingData() = default;
+	};
+	using IResourceStagingDataPtr = std::unique_ptr<IResourceStagingData>;
+
 	class IResourceDataLoader {
 	public:
 		IResourceDataLoader() = default;
@@ -13,8 +32,40 @@ namespace PrCore::Resources {
 		virtual void UnloadResource(IResourceDataPtr p_resourceData) = 0;
 
 		virtual bool SaveResourceOnDisc(IResourceDataPtr p_resourceData, const std::string& p_path) = 0;
-		
-		// virtual ResourcePtr LoadResourceAsync(const std::string& p_path, size_t& p_dataSize) = 0;
-		// virtual ResourcePtr UnloadResourceAsync(const std::string& p_path) = 0;
+
+		// Loader that does not need the main thread in LoadResource, FinalizeResource and UnloadResource, for example does not touch the graphics context
+		// Resources of the other loaders are loaded, finalized and unloaded only on the thread finalizing the loads
+		virtual bool IsThreadSafe() const { return false; }
+
+		// Asynchronous loading is split into a job worker step (file read and decode) and a main thread step (for example graphics upload)
+		// Loaders without the support are loaded with LoadResource in the main thread step
+		virtual bool SupportsAsyncLoad() const { return false; }
+
+		// Called on a job worker, must not touch the graphics context or the resource database
+		virtual IResourceStagingDataPtr LoadResourceAsync(const std::string& p_path) { return nullptr; }
+
+		// Called on the main thread with the result of LoadResourceAsync, staging data is nullptr if the worker step failed
+		virtual IResourceDataPtr FinalizeResource(IResourceStagingDataPtr p_stagingData, const std::string& p_path) { return nullptr; }
+
+		// Resources the loader loads with the resource, read from a header or manifest without loading the resource itself
+		// ResourceSystem::Preload loads them first and in parallel, so the loader finds them already loaded
+		virtual std::vector<ResourceDependency> GetDependencies(const std::string& p_path) { return {}; }
+
+		// Writes the engine native cooked file of the source without loading the resource, see CookedAsset
+		// Loaders with a cooked format read it instead of the source when it is up to date
+		virtual bool CookResource(const std::string& p_path) { return false; }
+
+		// Compressed residency tier, evicted resources are kept as a compressed copy of their cooked payload, see ResourceEvictionPolicy
+		// Called on a job worker when the resource is evicted, returns false if the loader has no cooked format
+		virtual bool ReadCookedPayload(const std::string& p_path, std::vector<uint8_t>& p_payload) { return false; }
+
+		// Worker step of loading the resource from the payload instead of the file, the result is finalized with FinalizeResource
+		virtual IResourceStagingDataPtr LoadCookedResourceAsync(const std::string& p_path, const std::vector<uint8_t>& p_payload) { return nullptr; }
+
+		// Loaders without asynchronous loading override this one
+		virtual IResourceDataPtr LoadCookedResource(const std::string& p_path, const std::vector<uint8_t>& p_payload)
+		{
+			return SupportsAsyncLoad() ? FinalizeResource(LoadCookedResourceAsync(p_path, p_payload), p_path) : nullptr;
+		}
 	};
 }
@@ -1,13 +1,55 @@
 #pragma once
 
 #include "IResource.h"
+#include "IResourceDataLoader.h"
+
+#include <chrono>
 #include <functional>
+#include <string_view>
 
 namespace PrCore::Resources {
 
-	class IResourceDataLoader;
-
 	using ResourceVisitor = std::function<void(ResourceDescConstPtr)>;
+	using ResourceLoadCallback = std::function<void(ResourceDescPtr)>;
+
+	// Called in the reload job before the file is read, the reload keeps the current data if it returns false
+	using ResourceReloadCheck = std::function<bool()>;
+
+	// Called from any thread after a load is queued for the finalize step
+	using FinalizeQueuedCallback = std::function<void()>;
+
+	// Watermarks are fractions of the memory budget
+	// Eviction starts when the usage passes the high watermark and unloads until it drops under the low one
+	// Evicted resources with a cooked format can be kept as a compressed copy of the cooked payload within their own budget,
+	// loading them again decompresses the copy instead of reading the file
+	struct ResourceEvictionPolicy
+	{
+		bool  enabled = false;
+		float highWatermark = 1.0f;
+		float lowWatermark = 0.9f;
+		bool  compressEvicted = false;
+	};
+
+	// Memory of both residency tiers and the load latency of the resource type
+	// Loads from the compressed copies and from the files are timed from the request until the resource is loaded
+	struct ResourceResidencyStats
+	{
+		size_t   residentCount = 0;
+		size_t   residentBytes = 0;
+
+		size_t   compressedCount = 0;
+		size_t   compressedBytes = 0;
+		size_t   payloadBytes = 0;      // Cooked bytes the compressed copies decompress to
+
+		uint64_t demotions = 0;
+		uint64_t promotions = 0;
+		uint64_t fileLoads = 0;
+		std::chrono::microseconds promotionTime{ 0 };
+		std::chrono::microseconds fileLoadTime{ 0 };
+
+		std::chrono::microseconds AveragePromotionTime() const { return promotions ? promotionTime / static_cast<std::chrono::microseconds::rep>(promotions) : std::chrono::microseconds(0); }
+		std::chrono::microseconds AverageFileLoadTime() const { return fileLoads ? fileLoadTime / static_cast<std::chrono::microseconds::rep>(fileLoads) : std::chrono::microseconds(0); }
+	};
 
 	// IResourceDatabase interface that is responsible for storing and managing resources. 
 	// Every resource type should have separate database instance
@@ -16,29 +58,52 @@ namespace PrCore::Resources {
 	public:
 		virtual ~IResourceDatabase() = default;
 
-		virtual ResourceDescPtr Load(const std::string& p_path, std::shared_ptr<IResourceDataLoader> p_loader = nullptr) = 0;
+		virtual ResourceDescPtr Load(std::string_view p_path, std::shared_ptr<IResourceDataLoader> p_loader = nullptr) = 0;
 		virtual ResourceDescPtr Load(ResourceID p_id, std::shared_ptr<IResourceDataLoader> p_loader = nullptr) = 0;
 
-		//IResourcePtr LoadAsync(const std::string p_path, const IResourceLoader* p_loader = nullptr);
-		//IResourcePtr LoadAsync(ResourceID p_id);
+		// Returns immediately with the resource in Loading state, the callback is called on the main thread when loading finishes
+		virtual ResourceDescPtr LoadAsync(std::string_view p_path, ResourceLoadCallback p_callback = nullptr, std::shared_ptr<IResourceDataLoader> p_loader = nullptr) = 0;
+		virtual ResourceDescPtr LoadAsync(ResourceID p_id, ResourceLoadCallback p_callback = nullptr, std::shared_ptr<IResourceDataLoader> p_loader = nullptr) = 0;
+
+		// Blocks until the resource in Loading state is finalized, other threads finalize the async loads of thread safe loaders themselves
+		// and return right away for the loads that need the finalize thread
+		virtual void WaitForLoad(ResourceID p_id) = 0;
+
+		// Loads the file of the loaded resource again in place, the ID and handles stay valid
+		// The current data is used until the new data is finalized on the main thread, a failed reload keeps it
+		// Resources that are not loaded read the new file on their next load, the callback is called right away for them
+		// Returns nullptr and does not call the callback if the path is not registered
+		// A reload replacing a pending one of the resource reads the file whatever p_check returns, the pending one may have passed its check
+		virtual ResourceDescPtr Reload(std::string_view p_path, ResourceLoadCallback p_callback = nullptr, ResourceReloadCheck p_check = nullptr) = 0;
+
+		// Finalizes async loads decoded by the workers until the deadline, at least one per call
+		virtual void FinalizeLoads(std::chrono::steady_clock::time_point p_deadline) = 0;
+
+		// Loads waiting for FinalizeLoads, the callback lets the finalize thread sleep until there are some
+		virtual bool HasQueuedFinalizes() const = 0;
+		virtual void SetFinalizeQueuedCallback(FinalizeQueuedCallback p_callback) = 0;
 
-		virtual void Unload(const std::string& p_path) = 0;
+		virtual void Unload(std::string_view p_path) = 0;
 		virtual void Unload(ResourceID p_id) = 0;
 		virtual void UnloadAll() = 0;
 
-		//void UnloadAsync(const std::string p_path, const IResourceLoader* p_loader = nullptr);
-		//void UnloadAsync(ResourceID p_id);
-
 		// Assures that resource data is loaded and available
+		// Off the finalize thread resources of loaders that are not thread safe are returned in Loading state, see IResourceDataLoader::IsThreadSafe
 		virtual ResourceDescPtr Get(ResourceID p_id) = 0;
-		virtual ResourceDescPtr Get(const std::string& p_path) = 0;
+		virtual ResourceDescPtr Get(std::string_view p_path) = 0;
 
 		// Does not guarantee that resource data is loaded and available.
 		virtual ResourceDescPtr GetMetadata(ResourceID p_id) = 0;
-		virtual ResourceDescPtr GetMetadata(const std::string& p_path) = 0;
+		virtual ResourceDescPtr GetMetadata(std::string_view p_path) = 0;
+
+		// Asks the loader of the path, the resource does not have to be registered
+		virtual std::vector<ResourceDependency> GetDependencies(std::string_view p_path) = 0;
+
+		// Cooks the file with the loader of the path without loading it
+		virtual bool Cook(std::string_view p_path) = 0;
 
 		virtual ResourceDescPtr Register(IResourceDataPtr p_resourceData) = 0;
-		virtual ResourceDescPtr Register(const std::string& p_path) = 0;
+		virtual ResourceDescPtr Register(std::string_view p_path) = 0;
 
 		virtual bool Remove(ResourceID p_id) = 0;
 		virtual void RemoveAll() = 0;
@@ -48,10 +113,29 @@ namespace PrCore::Resources {
 		virtual bool SaveToFile(ResourceID p_sourceId, const std::string& p_path) = 0;
 		virtual ResourceDescPtr SaveToFileAndLoad(ResourceID p_sourceId, const std::string& p_path) = 0;
 
+		// Counts the memory of the resource again, the size snapshot and the shared copy-on-write blocks are refreshed
+		virtual void NotifyChanged(ResourceID p_id) = 0;
+
 		virtual size_t GetMemoryUsage() const = 0;
 		virtual void   SetMemoryBudget(size_t p_budget) = 0;
 		virtual size_t GetMemoryBudget() const = 0;
 
+		// Only loaded file resources without handles or data pointers held outside of the database are evicted, in LRU order
+		// Evicted resources are Unloaded and loaded again on the next Get or Load
+		virtual void                          SetEvictionPolicy(const ResourceEvictionPolicy& p_policy) = 0;
+		virtual const ResourceEvictionPolicy& GetEvictionPolicy() const = 0;
+
+		// Compressed copies over the budget are dropped in LRU order, the resources load from the files again
+		virtual size_t GetCompressedMemoryUsage() const = 0;
+		virtual void   SetCompressedMemoryBudget(size_t p_budget) = 0;
+		virtual size_t GetCompressedMemoryBudget() const = 0;
+
+		virtual ResourceResidencyStats GetResidencyStats() = 0;
+
+		// Pins are counted, the resource can be evicted after the last Unpin
+		virtual void Pin(ResourceID p_id) = 0;
+		virtual void Unpin(ResourceID p_id) = 0;
+
 		virtual void                                  RegisterLoader(const std::string& p_fileExtension, std::unique_ptr<IResourceDataLoader> p_loader) = 0;
 		virtual IResourceDataLoader* GetLoader(const std::string& p_fileExtension) = 0;
 		virtual void                                  UnregisterLoader(const std::string& p_fileExtension) = 0;
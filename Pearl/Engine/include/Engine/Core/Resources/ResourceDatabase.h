@@ -1,44 +1,82 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 
 #include "IResource.h"
 #include "IResourceDatabase.h"
+#include "IResourceDataLoader.h"
+
+#include "Core/Threading/JobDefines.h"
+#include "Core/Utils/FlatHashMap.h"
 
 namespace PrCore::Resources {
 
+	constexpr size_t g_resourceShardBits = 4;
+	constexpr size_t g_resourceShardCount = 1 << g_resourceShardBits;
+
+	// Get, Load and Register can be called from any thread, lookups of loaded resources take only a shared lock of one shard
+	// Loaders run on the calling thread only if they are thread safe, see IResourceDataLoader::IsThreadSafe
+	// Other threads requesting a resource of the other loaders get it in Loading state and the load finishes on the finalize thread,
+	// they never wait for the finalize thread, it may be waiting for them
+	// Descriptor state changes are serialized by the state lock, the loads themselves run outside of it
+	// Async loads are finalized and loaders are registered by the thread that created the database
+	// Eviction skips referenced resources only, threads sharing a resource keep a handle or pin it
+	// Copy-on-write blocks shared by several resources are counted in the memory usage once
+	// Blocks are counted when the data is committed or registered, a copy detaching its blocks later is counted again after NotifyChanged
+	// Evicted resources may be demoted to a compressed copy of their cooked payload, loads promote them back, see ResourceEvictionPolicy
 	class ResourceDatabase : public IResourceDatabase {
 	public:
 		ResourceDatabase() :
 			m_memoryUsage(0),
-			m_memoryBudget(0)
+			m_memoryBudget(0),
+			m_compressedMemoryUsage(0),
+			m_compressedMemoryBudget(0),
+			m_accessTick(0),
+			m_syncLoadCount(0),
+			m_finalizeThread(std::this_thread::get_id())
 		{}
 
 		~ResourceDatabase() override;
 
-		ResourceDescPtr Load(const std::string& p_path, std::shared_ptr<IResourceDataLoader> p_loader = nullptr) override;
+		ResourceDescPtr Load(std::string_view p_path, std::shared_ptr<IResourceDataLoader> p_loader = nullptr) override;
 		ResourceDescPtr Load(ResourceID p_id, std::shared_ptr<IResourceDataLoader> p_loader = nullptr) override;
 
-		//IResourcePtr LoadAsync(const std::string p_path, const IResourceLoader* p_loader = nullptr);
-		//IResourcePtr LoadAsync(ResourceID p_id);
+		ResourceDescPtr LoadAsync(std::string_view p_path, ResourceLoadCallback p_callback = nullptr, std::shared_ptr<IResourceDataLoader> p_loader = nullptr) override;
+		ResourceDescPtr LoadAsync(ResourceID p_id, ResourceLoadCallback p_callback = nullptr, std::shared_ptr<IResourceDataLoader> p_loader = nullptr) override;
+
+		ResourceDescPtr Reload(std::string_view p_path, ResourceLoadCallback p_callback = nullptr, ResourceReloadCheck p_check = nullptr) override;
 
-		void Unload(const std::string& p_path) override;
+		void WaitForLoad(ResourceID p_id) override;
+		void FinalizeLoads(std::chrono::steady_clock::time_point p_deadline) override;
+
+		bool HasQueuedFinalizes() const override;
+		void SetFinalizeQueuedCallback(FinalizeQueuedCallback p_callback) override { m_finalizeQueuedCallback = std::move(p_callback); }
+
+		void Unload(std::string_view p_path) override;
 		void Unload(ResourceID p_id) override;
 		void UnloadAll() override;
 
-		//void UnloadAsync(const std::string p_path, const IResourceLoader* p_loader = nullptr);
-		//void UnloadAsync(ResourceID p_id);
-
 		// Assures that resource data is loaded and available
 		ResourceDescPtr Get(ResourceID p_id) override;
-		ResourceDescPtr Get(const std::string& p_path) override;
+		ResourceDescPtr Get(std::string_view p_path) override;
 
 		// Does not assures that resource data is loaded and available.
 		ResourceDescPtr GetMetadata(ResourceID p_id) override;
-		ResourceDescPtr GetMetadata(const std::string& p_path) override;
+		ResourceDescPtr GetMetadata(std::string_view p_path) override;
+
+		std::vector<ResourceDependency> GetDependencies(std::string_view p_path) override;
+
+		bool Cook(std::string_view p_path) override;
 
 		ResourceDescPtr Register(IResourceDataPtr p_resourceData) override;
-		ResourceDescPtr Register(const std::string& p_path) override;
+		ResourceDescPtr Register(std::string_view p_path) override;
 
 		bool Remove(ResourceID p_id) override;
 		void RemoveAll() override;
@@ -48,26 +86,131 @@ namespace PrCore::Resources {
 		bool SaveToFile(ResourceID p_sourceId, const std::string& p_path) override;
 		ResourceDescPtr SaveToFileAndLoad(ResourceID p_sourceId, const std::string& p_path) override;
 
+		void NotifyChanged(ResourceID p_id) override;
+
 		size_t GetMemoryUsage() const  override { return m_memoryUsage; }
 		void   SetMemoryBudget(size_t p_budget) override { m_memoryBudget = p_budget; }
 		size_t GetMemoryBudget() const override { return m_memoryBudget; }
 
+		void                          SetEvictionPolicy(const ResourceEvictionPolicy& p_policy) override;
+		const ResourceEvictionPolicy& GetEvictionPolicy() const override { return m_evictionPolicy; }
+
+		size_t GetCompressedMemoryUsage() const override { return m_compressedMemoryUsage; }
+		void   SetCompressedMemoryBudget(size_t p_budget) override;
+		size_t GetCompressedMemoryBudget() const override { return m_compressedMemoryBudget; }
+
+		ResourceResidencyStats GetResidencyStats() override;
+
+		void Pin(ResourceID p_id) override;
+		void Unpin(ResourceID p_id) override;
+
 		void                  RegisterLoader(const std::string& p_fileExtension, std::unique_ptr<IResourceDataLoader> p_loader) override;
 		IResourceDataLoader*  GetLoader(const std::string& p_fileExtension) override;
 		void                  UnregisterLoader(const std::string& p_fileExtension) override;
 		void                  UnregisterAllLoaders() override;
 
 	private:
+		// Compressed cooked payload of a demoted resource, the resource is Unloaded while it is kept
+		struct CompressedResource
+		{
+			std::vector<uint8_t> data;
+			size_t               payloadSize = 0;
+			uint64_t             lastAccess = 0;
+		};
+		using CompressedResourcePtr = std::shared_ptr<CompressedResource>;
+
+		// Load in flight, other threads requesting the resource wait for it instead of loading again
+		// Async loads are finalized on the finalize thread, the worker only fills the staging data
+		struct PendingLoad
+		{
+			ResourceDescPtr                      resourceDesc;
+			std::string                          path;
+			IResourceDataLoader*                 loader = nullptr;
+			std::shared_ptr<IResourceDataLoader> customLoader; // Keeps the custom loader alive while the worker uses it
+			IResourceStagingDataPtr              stagingData;
+			CompressedResourcePtr                compressed;   // Taken from the compressed tier, the load falls back to the file if it fails
+			std::chrono::steady_clock::time_point startTime;
+			std::vector<ResourceLoadCallback>    callbacks;
+			ResourceReloadCheck                  reloadCheck;
+			Threading::JobStatePtr               jobState;
+			bool                                 synchronous = false;
+			bool                                 reload = false;
+			bool                                 promoted = false;
+			bool                                 unchanged = false; // Reload check failed, the current data stays
+			std::atomic<bool>                    cancelled = false;
+		};
+		using PendingLoadPtr = std::shared_ptr<PendingLoad>;
+
+		// Data released on the finalize thread, the custom loader is kept alive until then
+		struct DeferredUnload
+		{
+			IResourceDataPtr                     data;
+			IResourceDataLoader*                 loader = nullptr;
+			std::shared_ptr<IResourceDataLoader> customLoader;
+		};
+
+		using StateLock = std::unique_lock<std::mutex>;
+
+		// Returns true if this call performed the load, false if the resource was loaded or another thread loaded it
 		bool LoadResourcePrivate(const ResourceDescPtr& p_resourceDesc, std::shared_ptr<IResourceDataLoader> p_loader = nullptr);
+		ResourceDescPtr LoadAsyncPrivate(const ResourceDescPtr& p_resourceDesc, ResourceLoadCallback p_callback, std::shared_ptr<IResourceDataLoader> p_loader);
+		void ReloadPrivate(const ResourceDescPtr& p_resourceDesc, ResourceLoadCallback p_callback, ResourceReloadCheck p_check);
+		void ScheduleLoadPrivate(const PendingLoadPtr& p_pendingLoad);
+		void QueueFinalizePrivate(const PendingLoadPtr& p_pendingLoad);
+		void FinalizeLoadPrivate(const PendingLoadPtr& p_pendingLoad);
+		// Returns with the resource still Loading if the load needs the finalize thread and this is another thread
+		void WaitWhileLoading(StateLock& p_lock, const ResourceDescPtr& p_resourceDesc);
+		bool CanUseLoader(const IResourceDataLoader* p_loader) const { return p_loader == nullptr || p_loader->IsThreadSafe() || std::this_thread::get_id() == m_finalizeThread; }
+		void WaitForAllLoadsPrivate();
+
+		// Synchronous loads cannot be cancelled, they are waited for. Callbacks of the cancelled load are called by the caller after unlocking
+		PendingLoadPtr CancelLoadPrivate(StateLock& p_lock, const ResourceDescPtr& p_resourceDesc);
+		static void CallLoadCallbacks(const PendingLoadPtr& p_pendingLoad);
+
+		// Reloads replace the data of the loaded resource, the resource stays Loaded while they are pending
+		void CommitReloadedData(const PendingLoadPtr& p_pendingLoad, IResourceDataPtr p_resourceData);
+		PendingLoadPtr CancelReloadPrivate(const ResourceDescPtr& p_resourceDesc);
+
+		// Picks the custom loader of the resource or the extension loader, binds p_loader to the resource if passed
+		IResourceDataLoader* ResolveLoader(const ResourceDescPtr& p_resourceDesc, const std::shared_ptr<IResourceDataLoader>& p_loader);
+		bool CommitLoadedData(const ResourceDescPtr& p_resourceDesc, IResourceDataPtr p_resourceData);
+
+		// Size of the descriptor is set to the bytes counted for its data, blocks held by other resources are not counted again
+		void AddMemoryPrivate(const ResourceDescPtr& p_resourceDesc);
+		void ReleaseMemoryPrivate(const ResourceDescPtr& p_resourceDesc);
 		void UnloadResourcePrivate(const ResourceDescPtr& p_resourceDesc);
 
-		ResourceDescPtr RegisterFileResourcePrivate(const std::string& p_path);
+		// Unload in two steps, the data is detached from the descriptor and then released by its loader
+		// Loaders that are not thread safe release the data on the finalize thread, see FinalizeLoads
+		IResourceDataPtr DetachDataPrivate(const ResourceDescPtr& p_resourceDesc);
+		void ReleaseDataPrivate(const ResourceDescPtr& p_resourceDesc, IResourceDataPtr p_resourceData);
+
+		ResourceDescPtr RegisterFileResourcePrivate(std::string_view p_path);
 		ResourceDescPtr RegisterMemoryResourcePrivate(const IResourceDataPtr& p_resourceData);
 
+		// Expects the path sanitized by the caller
+		bool SaveToFilePrivate(ResourceID p_sourceId, const std::string& p_filePath);
+
 		ResourceDescPtr ResourceByID(ResourceID p_id);
-		ResourceDescPtr ResourceByPath(const std::string& p_path);
+		ResourceDescPtr ResourceByPath(std::string_view p_path);
+		IResourceDataLoader* LoaderByExtension(std::string_view p_path);
+		std::shared_ptr<IResourceDataLoader> FindCustomLoader(ResourceID p_id);
 
 		void CheckMemoryBudget(ResourceDescPtr p_resource);
+		void EvictResources(size_t p_targetUsage);
+		// p_ownedReferences are the descriptor references held by the database itself
+		bool IsReferenced(const ResourceDescPtr& p_resourceDesc, long p_ownedReferences) const;
+
+		// Demotion reads and compresses the payload on a worker, the copy is dropped if the resource changed meanwhile
+		void DemoteResourcePrivate(const ResourceDescPtr& p_resourceDesc);
+		void TrimCompressedResources(size_t p_targetUsage);
+		CompressedResourcePtr TakeCompressedPrivate(ResourceID p_id);
+		void DropCompressedPrivate(const ResourceDescPtr& p_resourceDesc);
+		IResourceDataPtr PromoteResourcePrivate(const PendingLoadPtr& p_pendingLoad);
+		IResourceStagingDataPtr PromoteResourceAsyncPrivate(const PendingLoadPtr& p_pendingLoad);
+		void RecordLoadTime(const PendingLoadPtr& p_pendingLoad);
+		bool IsCompressionEnabled() const { return m_evictionPolicy.enabled && m_evictionPolicy.compressEvicted && m_compressedMemoryBudget > 0; }
+		void MarkAccessed(const ResourceDescPtr& p_resourceDesc) { p_resourceDesc->lastAccess.store(++m_accessTick, std::memory_order_relaxed); }
 
 		void FireUnloadedEvent(ResourceID p_id, const std::string& p_path);
 		void FireLoadedEvent(ResourceID p_id, const std::string& p_path);
@@ -76,17 +219,98 @@ namespace PrCore::Resources {
 		void FireCacheMiss(ResourceID p_id, const std::string& p_path);
 		void FireBudgetExceeded(ResourceID p_id, const std::string& p_path, size_t p_usage, size_t p_budget);
 
-		using IDMap = std::map<ResourceID, ResourceDescPtr>;
-		using PathMap = std::map<std::string, ResourceDescPtr>;
-		using LoaderMap = std::map<std::string, std::unique_ptr<IResourceDataLoader>>;
-		using CustomLoaderMap = std::map<ResourceID, std::shared_ptr<IResourceDataLoader>>;
+		// Paths and extensions are keyed by PathUtils::HashPath
+		using ResourceMap = Utils::FlatHashMap<ResourceDescPtr>;
+		using LoaderMap = Utils::FlatHashMap<std::unique_ptr<IResourceDataLoader>>;
+		using CustomLoaderMap = Utils::FlatHashMap<std::shared_ptr<IResourceDataLoader>>;
+
+		using PendingLoadMap = Utils::FlatHashMap<PendingLoadPtr>;
+		using CompressedResourceMap = Utils::FlatHashMap<CompressedResourcePtr>;
+
+		// Copy-on-write block counted until its last holder is released, the weak reference keeps the address from being reused meanwhile
+		struct SharedBlock
+		{
+			std::weak_ptr<const void> block;
+			size_t                    size = 0;
+			uint32_t                  holders = 0;
+		};
+
+		// Blocks of the data counted for the resource and the rest of its bytes
+		struct ResourceBlocks
+		{
+			std::vector<uint64_t> blocks;
+			size_t                exclusiveSize = 0;
+		};
+
+		using SharedBlockMap = Utils::FlatHashMap<SharedBlock>;
+		using ResourceBlocksMap = Utils::FlatHashMap<ResourceBlocks>;
+
+		struct ResourceShard
+		{
+			mutable std::shared_mutex lock;
+			ResourceMap               resources;
+		};
+		using ResourceShards = std::array<ResourceShard, g_resourceShardCount>;
+
+		static ResourceShard& ShardFor(ResourceShards& p_shards, uint64_t p_key)
+		{
+			// Top bits of the Fibonacci hash, the shard map uses the lower ones
+			return p_shards[(p_key * 0x9E3779B97F4A7C15ull) >> (64 - g_resourceShardBits)];
+		}
+
+		// Copies the descriptors so the visitor runs without the shard locks
+		std::vector<ResourceDescPtr> SnapshotResources(ResourceShards& p_shards);
+
+		// A shard lock is taken alone or under the state lock, the path shard is locked before the ID shard
+		ResourceShards m_resourcesID;
+		ResourceShards m_resourcesPaths;
+
+		LoaderMap                 m_loaders;
+		mutable std::shared_mutex m_loadersLock;
+
+		// Guards the descriptor state changes, pin counts, custom loaders and pending loads
+		std::mutex               m_stateLock;
+		std::condition_variable  m_stateChanged;
 
-		IDMap m_resourcesID;
-		PathMap m_resourcesPaths;
-		LoaderMap m_loaders;
 		CustomLoaderMap m_customLoaders;
 
-		size_t m_memoryUsage;
-		size_t m_memoryBudget;
+		// Workers push the decoded loads into the finalize queue
+		PendingLoadMap              m_pendingLoads;
+		PendingLoadMap              m_pendingReloads;
+		std::deque<PendingLoadPtr>  m_finalizeQueue;
+		mutable std::mutex          m_finalizeQueueLock;
+
+		// Set on registration, not changed while loads are scheduled
+		FinalizeQueuedCallback      m_finalizeQueuedCallback;
+
+		// Jobs of cancelled loads still run, they are waited before the loaders are released
+		std::vector<Threading::JobStatePtr> m_loadJobs;
+
+		// Guarded by the state lock
+		std::vector<DeferredUnload> m_deferredUnloads;
+
+		std::atomic<size_t> m_memoryUsage;
+
+		// Keyed by the block address and the resource ID, guarded by the state lock
+		SharedBlockMap    m_sharedBlocks;
+		ResourceBlocksMap m_resourceBlocks;
+		std::atomic<size_t> m_memoryBudget;
+
+		// Compressed tier is guarded by the state lock, the counters are reported with GetResidencyStats
+		CompressedResourceMap  m_compressedResources;
+		std::atomic<size_t>    m_compressedMemoryUsage;
+		std::atomic<size_t>    m_compressedMemoryBudget;
+		size_t                 m_compressedPayloadSize = 0;
+		uint64_t               m_demotions = 0;
+		uint64_t               m_promotions = 0;
+		uint64_t               m_fileLoads = 0;
+		std::chrono::microseconds m_promotionTime{ 0 };
+		std::chrono::microseconds m_fileLoadTime{ 0 };
+
+		ResourceEvictionPolicy m_evictionPolicy;
+		std::atomic<uint64_t>  m_accessTick;
+
+		size_t          m_syncLoadCount;
+		std::thread::id m_finalizeThread;
 	};
 }
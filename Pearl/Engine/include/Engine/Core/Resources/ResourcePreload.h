@@ -0,0 +1,62 @@
+#pragma once
+
+#include "IResourceDataLoader.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace PrCore::Resources {
+
+	class IResourceDatabase;
+
+	// Dependency graph of one ResourceSystem::Preload or Reload call, every resource is a node loaded once
+	// A node starts loading when all its dependencies finished, the leaves start together
+	class ResourcePreload {
+	public:
+		bool   IsDone() const { return m_pendingNodes.load(std::memory_order_acquire) == 0; }
+
+		size_t GetResourceCount() const { return m_nodes.size(); }
+		size_t GetPendingCount() const { return m_pendingNodes.load(std::memory_order_acquire); }
+
+	private:
+		friend class ResourceSystem;
+
+		// File written while watched, hashed once by the first reload job of its resources
+		struct ChangedFile
+		{
+			std::string    path;
+			std::string    nativePath;
+			std::once_flag    hashed;
+			std::atomic<bool> changed = false;
+		};
+
+		struct Node
+		{
+			ResourceDependency           resource;
+			IResourceDatabase*           database = nullptr;
+			std::vector<size_t>          parents;
+			size_t                       dependencyCount = 0;
+			bool                         discovered = false;
+
+			// Reload graph only, dependents reload after a dependency reloaded and changed files after their content changed
+			bool                         dependent = false;
+			std::shared_ptr<ChangedFile> changedFile;
+		};
+
+		// Nodes are immutable once the loads start, only the counters change
+		std::vector<Node>                      m_nodes;
+		std::unique_ptr<std::atomic<size_t>[]> m_pendingDependencies;
+		std::unique_ptr<std::atomic<bool>[]>   m_dependencyReloaded;
+		std::atomic<size_t>                    m_pendingNodes = 0;
+
+		// Set when a load is cancelled, the remaining nodes finish without loading
+		std::atomic<bool>                      m_cancelled = false;
+
+		// Reload graph reloads the loaded nodes in place instead of loading them
+		bool                                   m_reload = false;
+	};
+	using ResourcePreloadPtr = std::shared_ptr<ResourcePreload>;
+}
@@ -1,33 +1,91 @@
 #pragma once
 
+#include "AssetRegistry.h"
 #include "IResource.h"
 #include "IResourceDataLoader.h"
 #include "IResourceDatabase.h"
+#include "ResourcePreload.h"
 
+#include "Core/File/FileWatcher.h"
+#include "Core/Utils/FlatHashMap.h"
 #include "Core/Utils/Singleton.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <limits>
 #include <map>
+#include <mutex>
 
 namespace PrCore::Resources {
 
+	template<class T>
+	using ResourceLoadedCallback = std::function<void(ResourceHandle<T>)>;
+
 	class ResourceSystem: public Utils::Singleton<ResourceSystem> {
 	public:
 		ResourceSystem() = default;
 		~ResourceSystem();
 
+		//-----------------------------------------------------------------------------
+		// Resource functions are safe from any thread once the databases are registered
+		// Concurrent requests of one unloaded resource load it once, the other threads wait for the result
+
 		//-----------------------------------------------------------------------------
 		// Loads Resource into memory, only file originated resource can be loaded
 		// Resources created manually in code should be Registered with IResourceDataPtr only
 		// Pass p_loader when want to load resource differently. This loader is bound to the resource Id until it is Removed from the database.
 		template<class T>
-		ResourceHandle<T> Load(const std::string& p_path, std::shared_ptr<IResourceDataLoader> p_loader = nullptr);
+		ResourceHandle<T> Load(std::string_view p_path, std::shared_ptr<IResourceDataLoader> p_loader = nullptr);
 
 		template<class T>
 		ResourceHandle<T> Load(ResourceID p_id, std::shared_ptr<IResourceDataLoader> p_loader = nullptr);
 
-		////Implement Later
-		////IResource LoadAsync(const std::string p_path, const IResourceLoader* p_loader = nullptr);
-		////IResource LoadAsync(ResourceID p_id);
+
+		//-----------------------------------------------------------------------------
+		// Starts loading the resource on the job workers and returns immediately with the resource in Loading state
+		// Decoding runs on a worker if the loader supports it, the final step runs on the main thread in Update()
+		// Completion can be polled with GetState(), observed with the callback or forced with WaitForLoad()
+		// Loading the resource that is already loading joins it, the callback is called by the thread completing the load, the main thread for async loads
+		template<class T>
+		ResourceHandle<T> LoadAsync(std::string_view p_path, ResourceLoadedCallback<T> p_callback = nullptr, std::shared_ptr<IResourceDataLoader> p_loader = nullptr);
+
+		template<class T>
+		ResourceHandle<T> LoadAsync(ResourceID p_id, ResourceLoadedCallback<T> p_callback = nullptr, std::shared_ptr<IResourceDataLoader> p_loader = nullptr);
+
+		// Blocks until the resource is loaded, Load and Get wait the same way for the resources in Loading state
+		template<class T>
+		void WaitForLoad(const ResourceHandle<T>& p_handle);
+
+		// Finalizes the async loads on the main thread, stops after the budget if more loads are ready
+		void Update(std::chrono::microseconds p_finalizeBudget = std::chrono::microseconds(2000));
+
+
+		//-----------------------------------------------------------------------------
+		// Loads the resources with the dependencies reported by their loaders, returns immediately
+		// Independent resources load in parallel as in LoadAsync, a resource starts when its dependencies are loaded
+		// Dependencies shared by many resources are loaded once, a dependency cycle is broken with a warning
+		ResourcePreloadPtr Preload(const std::vector<ResourceDependency>& p_resources);
+
+		// Finalizes the loads until the preload is done, main thread only
+		// Sleeps while the workers decode, wakes up for the queued finalizes and the end of the preload
+		void WaitForPreload(const ResourcePreloadPtr& p_preload);
+
+
+		//-----------------------------------------------------------------------------
+		// Reloads the loaded resources of the paths in every database, in place so IDs and handles stay valid
+		// Loaded resources depending on them are reloaded after their dependencies, the graph can be waited with WaitForPreload
+		// Resources that are not loaded read the new file on their next load
+		ResourcePreloadPtr Reload(const std::vector<std::string>& p_paths);
+
+		// Hot reload, files written in the watched directories are reloaded in Update, batched per frame
+		// Files saved with the same content as recorded in the asset registry are not reloaded, the reload jobs hash them
+		// p_dirPath is a native directory path, p_mountPoint is the point it is mounted at in FileSystem
+		void WatchDirectory(std::string_view p_dirPath, std::string_view p_mountPoint = "/");
+		void UnwatchDirectory(std::string_view p_dirPath);
+
+		// Stable IDs and content hashes of the file assets, opened at startup and saved on shutdown by the application
+		AssetRegistry&       GetAssetRegistry() { return m_assetRegistry; }
+		const AssetRegistry& GetAssetRegistry() const { return m_assetRegistry; }
 
 
 		//-----------------------------------------------------------------------------
@@ -35,7 +93,7 @@ namespace PrCore::Resources {
 		// Unloads with default extension loader or uses custom loader pass during loading
 		// Resources created manually in code cannot be unloaded and should be removed
 		template<class T>
-		void Unload(const std::string& p_path);
+		void Unload(std::string_view p_path);
 
 		template<class T>
 		void Unload(ResourceID p_id);
@@ -43,9 +101,7 @@ namespace PrCore::Resources {
 		template<class T>
 		void UnloadAll();
 
-		//Implement Later
-		//void UnloadAsync(const std::string p_path, const IResourceLoader* p_loader = nullptr);
-		//void UnloadAsync(ResourceID p_id);
+		// Unloading the resource in Loading state cancels the load
 
 
 		//-----------------------------------------------------------------------------
@@ -56,7 +112,7 @@ namespace PrCore::Resources {
 		ResourceHandle<T> Get(ResourceID p_id);
 
 		template<class T>
-		ResourceHandle<T> Get(const std::string& p_path);
+		ResourceHandle<T> Get(std::string_view p_path);
 
 
 		//-----------------------------------------------------------------------------
@@ -66,7 +122,7 @@ namespace PrCore::Resources {
 		ResourceHandle<T> GetMetadata(ResourceID p_id);
 
 		template<class T>
-		ResourceHandle<T> GetMetadata(const std::string& p_path);
+		ResourceHandle<T> GetMetadata(std::string_view p_path);
 
 
 		//-----------------------------------------------------------------------------
@@ -77,7 +133,7 @@ namespace PrCore::Resources {
 		ResourceHandle<T> Register(IResourceDataPtr p_resourceData);
 
 		template<class T>
-		ResourceHandle<T> Register(const std::string& p_path);
+		ResourceHandle<T> Register(std::string_view p_path);
 
 
 		//-----------------------------------------------------------------------------
@@ -88,7 +144,7 @@ namespace PrCore::Resources {
 		bool Remove(ResourceID p_id);
 
 		template<class T>
-		bool Remove(const std::string& p_path);
+		bool Remove(std::string_view p_path);
 
 		template<class T>
 		void RemoveAll();
@@ -110,14 +166,27 @@ namespace PrCore::Resources {
 		ResourceHandle<T> SaveToFileAndLoad(ResourceID p_sourceId, const std::string& p_path);
 
 
+		//-----------------------------------------------------------------------------
+		// Offline cooking, writes the engine native file of the source so the loads skip parsing it
+		// Sources imported with the same content and settings are skipped, loaders also cook the sources they load, see CookedAsset
+		template<class T>
+		bool Cook(std::string_view p_path);
+
+
 		//-----------------------------------------------------------------------------
 		// Copies the IResourceData and returns the pointer it does not register the data into the database
 		// The data has to be registered manually by callig Register()
+		// Copy-on-write blocks like material uniforms and mesh vertex streams are shared until the copy changes them
 		template<class T>
 		std::shared_ptr<T> Copy(ResourceID p_sourceId);
 
 		template<class T>
-		std::shared_ptr<T> Copy(const std::string& p_path);
+		std::shared_ptr<T> Copy(std::string_view p_path);
+
+		// Counts the memory of the registered resource again after its data changed
+		// Call after changing a copy, the blocks it detached from the source are not counted until then
+		template<class T>
+		void NotifyChanged(ResourceID p_id);
 
 
 		//-----------------------------------------------------------------------------
@@ -132,6 +201,37 @@ namespace PrCore::Resources {
 		size_t GetMemoryBudget() const;
 
 
+		//-----------------------------------------------------------------------------
+		// Eviction policy of the resource type, resources over the budget are unloaded in LRU order when enabled
+		// Resources with handles or data pointers held by the client are never evicted, pin the ones that have to stay loaded without
+		template<class T>
+		void SetEvictionPolicy(const ResourceEvictionPolicy& p_policy);
+
+		template<class T>
+		const ResourceEvictionPolicy& GetEvictionPolicy() const;
+
+		//-----------------------------------------------------------------------------
+		// Budget of the compressed copies of evicted resources, see ResourceEvictionPolicy::compressEvicted
+		template<class T>
+		size_t GetCompressedMemoryUsage() const;
+
+		template<class T>
+		void   SetCompressedMemoryBudget(size_t p_budget);
+
+		template<class T>
+		size_t GetCompressedMemoryBudget() const;
+
+		// Memory of the residency tiers and load latencies of the resource type
+		template<class T>
+		ResourceResidencyStats GetResidencyStats() const;
+
+		template<class T>
+		void Pin(ResourceID p_id);
+
+		template<class T>
+		void Unpin(ResourceID p_id);
+
+
 		//-----------------------------------------------------------------------------
 		//Registers the loaders
 		template<class T>
@@ -162,9 +262,51 @@ namespace PrCore::Resources {
 		template<class T>
 		const std::unique_ptr<IResourceDatabase>& GetResourceDatabase() const;
 
+		template<class T>
+		static std::shared_ptr<T> CopyData(const IResourceDataPtr& p_resourceData);
+
+		IResourceDatabase* FindResourceDatabase(size_t p_resourceType);
+
+		static constexpr size_t s_invalidPreloadNode = std::numeric_limits<size_t>::max();
+
+		// Returns the dependencies of the node resource added to the graph
+		using DependencyQuery = std::function<std::vector<ResourceDependency>(IResourceDatabase*, const ResourceDependency&)>;
+
+		// The same path of another type is another resource
+		static uint64_t PreloadNodeKey(const ResourceDependency& p_resource);
+
+		size_t DiscoverPreloadNode(ResourcePreload& p_preload, const ResourceDependency& p_resource, Utils::FlatHashMap<size_t>& p_nodeIndices, const DependencyQuery& p_dependencyQuery);
+		void   StartPreload(const ResourcePreloadPtr& p_preload);
+		void   StartPreloadNode(const ResourcePreloadPtr& p_preload, size_t p_nodeIndex);
+		void   FinishPreloadNode(const ResourcePreloadPtr& p_preload, size_t p_nodeIndex, bool p_reloaded = true);
+
+		// Wakes WaitForPreload, the state it waits for is changed before
+		void NotifyPreloadWaiters();
+		bool HasQueuedFinalizes() const;
+
+		// Native paths of the changes are hashed in the reload jobs, the changes without a native path are reloaded
+		ResourcePreloadPtr ReloadPrivate(const std::vector<File::FileChange>& p_changes);
+
+		// Dependencies of the loaded file resources by the node key, the loaders are asked again when the resource generation changes
+		struct LoadedDependencies
+		{
+			ResourceDependency              resource;
+			uint32_t                        generation = 0;
+			std::vector<ResourceDependency> dependencies;
+		};
+		void UpdateLoadedDependencies();
+
 		using ResourceDatabaseTypeMap = std::map<size_t, std::unique_ptr<IResourceDatabase>>;
 
 		ResourceDatabaseTypeMap m_resourceDatabaseTypes;
+
+		AssetRegistry                          m_assetRegistry;
+
+		std::unique_ptr<File::FileWatcher>    m_fileWatcher;
+
+		std::mutex                             m_preloadWaitLock;
+		std::condition_variable                m_preloadWaitCondition;
+		Utils::FlatHashMap<LoadedDependencies> m_loadedDependencies;
 	};
 }
 
@@ -4,7 +4,7 @@
 namespace PrCore::Resources {
 
 	template<class T>
-	ResourceHandle<T> ResourceSystem::Load(const std::string& p_path, std::shared_ptr<IResourceDataLoader> p_loader /*= nullptr*/)
+	ResourceHandle<T> ResourceSystem::Load(std::string_view p_path, std::shared_ptr<IResourceDataLoader> p_loader /*= nullptr*/)
 	{
 		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
 		auto resourceDesc = GetResourceDatabase<T>()->Load(p_path, p_loader);
@@ -20,7 +20,38 @@ namespace PrCore::Resources {
 	}
 
 	template<class T>
-	void ResourceSystem::Unload(const std::string& p_path)
+	ResourceHandle<T> ResourceSystem::LoadAsync(std::string_view p_path, ResourceLoadedCallback<T> p_callback /*= nullptr*/, std::shared_ptr<IResourceDataLoader> p_loader /*= nullptr*/)
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		ResourceLoadCallback callback = nullptr;
+		if (p_callback)
+			callback = [callback = std::move(p_callback)](ResourceDescPtr p_resourceDesc) { callback(ResourceHandle<T>(p_resourceDesc)); };
+
+		auto resourceDesc = GetResourceDatabase<T>()->LoadAsync(p_path, std::move(callback), p_loader);
+		return ResourceHandle<T>(resourceDesc);
+	}
+
+	template<class T>
+	ResourceHandle<T> ResourceSystem::LoadAsync(ResourceID p_id, ResourceLoadedCallback<T> p_callback /*= nullptr*/, std::shared_ptr<IResourceDataLoader> p_loader /*= nullptr*/)
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		ResourceLoadCallback callback = nullptr;
+		if (p_callback)
+			callback = [callback = std::move(p_callback)](ResourceDescPtr p_resourceDesc) { callback(ResourceHandle<T>(p_resourceDesc)); };
+
+		auto resourceDesc = GetResourceDatabase<T>()->LoadAsync(p_id, std::move(callback), p_loader);
+		return ResourceHandle<T>(resourceDesc);
+	}
+
+	template<class T>
+	void ResourceSystem::WaitForLoad(const ResourceHandle<T>& p_handle)
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		GetResourceDatabase<T>()->WaitForLoad(p_handle.GetID());
+	}
+
+	template<class T>
+	void ResourceSystem::Unload(std::string_view p_path)
 	{
 		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
 		GetResourceDatabase<T>()->Unload(p_path);
@@ -49,7 +80,7 @@ namespace PrCore::Resources {
 	}	
 	
 	template<class T>
-	ResourceHandle<T> ResourceSystem::Get(const std::string& p_path)
+	ResourceHandle<T> ResourceSystem::Get(std::string_view p_path)
 	{
 		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
 		auto resourceDesc = GetResourceDatabase<T>()->Get(p_path);
@@ -65,7 +96,7 @@ namespace PrCore::Resources {
 	}
 
 	template<class T>
-	ResourceHandle<T> ResourceSystem::GetMetadata(const std::string& p_path)
+	ResourceHandle<T> ResourceSystem::GetMetadata(std::string_view p_path)
 	{
 		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
 		auto resourceDesc = GetResourceDatabase<T>()->GetMetadata(p_path);
@@ -81,7 +112,7 @@ namespace PrCore::Resources {
 	}
 
 	template<class T>
-	ResourceHandle<T> ResourceSystem::Register(const std::string& p_path)
+	ResourceHandle<T> ResourceSystem::Register(std::string_view p_path)
 	{
 		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
 		auto resourceDesc = GetResourceDatabase<T>()->Register(p_path);
@@ -96,7 +127,7 @@ namespace PrCore::Resources {
 	}
 
 	template<class T>
-	bool ResourceSystem::Remove(const std::string& p_path)
+	bool ResourceSystem::Remove(std::string_view p_path)
 	{
 		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
 		ResourceID id = GetResourceDatabase<T>()->GetMetadata(p_path)->id;
@@ -132,20 +163,48 @@ namespace PrCore::Resources {
 		return ResourceHandle<T>(resourceDesc);
 	}
 
+	template<class T>
+	bool ResourceSystem::Cook(std::string_view p_path)
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		return GetResourceDatabase<T>()->Cook(p_path);
+	}
+
 	template<class T>
 	std::shared_ptr<T> ResourceSystem::Copy(ResourceID p_sourceId)
 	{
 		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
-		auto resourceData = GetResourceDatabase<T>()->Get(p_sourceId)->data;
-		return std::make_shared<T>(*std::static_pointer_cast<T>(resourceData));
+		auto resourceData = GetResourceDatabase<T>()->Get(p_sourceId)->GetData();
+		return CopyData<T>(resourceData);
+	}
+
+	template<class T>
+	std::shared_ptr<T> ResourceSystem::Copy(std::string_view p_path)
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		auto resourceData = GetResourceDatabase<T>()->Get(p_path)->GetData();
+		return CopyData<T>(resourceData);
 	}
 
 	template<class T>
-	std::shared_ptr<T> ResourceSystem::Copy(const std::string& p_path)
+	void ResourceSystem::NotifyChanged(ResourceID p_id)
 	{
 		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
-		auto resourceData = GetResourceDatabase<T>()->Get(p_path)->data;
-		return std::make_shared<T>(*std::static_pointer_cast<T>(resourceData));
+		GetResourceDatabase<T>()->NotifyChanged(p_id);
+	}
+
+	template<class T>
+	std::shared_ptr<T> ResourceSystem::CopyData(const IResourceDataPtr& p_resourceData)
+	{
+		// Corrupted, or still loading on the finalize thread
+		if (p_resourceData == nullptr)
+			return nullptr;
+
+		// Abstract types are copied by the implementation
+		if constexpr (std::is_abstract<T>::value)
+			return std::static_pointer_cast<T>(p_resourceData->Clone());
+		else
+			return std::make_shared<T>(*std::static_pointer_cast<T>(p_resourceData));
 	}
 
 	template<class T>
@@ -169,6 +228,62 @@ namespace PrCore::Resources {
 		return GetResourceDatabase<T>()->GetMemoryBudget();
 	}
 
+	template<class T>
+	void ResourceSystem::SetEvictionPolicy(const ResourceEvictionPolicy& p_policy)
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		GetResourceDatabase<T>()->SetEvictionPolicy(p_policy);
+	}
+
+	template<class T>
+	const ResourceEvictionPolicy& ResourceSystem::GetEvictionPolicy() const
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		return GetResourceDatabase<T>()->GetEvictionPolicy();
+	}
+
+	template<class T>
+	size_t ResourceSystem::GetCompressedMemoryUsage() const
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		return GetResourceDatabase<T>()->GetCompressedMemoryUsage();
+	}
+
+	template<class T>
+	void ResourceSystem::SetCompressedMemoryBudget(size_t p_budget)
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		GetResourceDatabase<T>()->SetCompressedMemoryBudget(p_budget);
+	}
+
+	template<class T>
+	size_t ResourceSystem::GetCompressedMemoryBudget() const
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		return GetResourceDatabase<T>()->GetCompressedMemoryBudget();
+	}
+
+	template<class T>
+	ResourceResidencyStats ResourceSystem::GetResidencyStats() const
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		return GetResourceDatabase<T>()->GetResidencyStats();
+	}
+
+	template<class T>
+	void ResourceSystem::Pin(ResourceID p_id)
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		GetResourceDatabase<T>()->Pin(p_id);
+	}
+
+	template<class T>
+	void ResourceSystem::Unpin(ResourceID p_id)
+	{
+		static_assert(std::is_base_of<IResourceData, T>::value, "T has to be base of IResourceData.");
+		GetResourceDatabase<T>()->Unpin(p_id);
+	}
+
 	template<class T>
 	void ResourceSystem::RegisterLoader(const std::string& p_fileExtension, IResourceDataLoader* p_loader)
 	{
@@ -217,6 +332,9 @@ namespace PrCore::Resources {
 		auto databaseIt = m_resourceDatabaseTypes.find(typeid(T).hash_code());
 		PR_ASSERT(databaseIt == m_resourceDatabaseTypes.end(), "Database already registered. Resource Type: " + std::string(typeid(T).name()));
 
+		p_database->SetFinalizeQueuedCallback([this]() {
+			NotifyPreloadWaiters();
+			});
 		m_resourceDatabaseTypes.insert({ typeid(T).hash_code(), std::move(p_database) });
 	}
 
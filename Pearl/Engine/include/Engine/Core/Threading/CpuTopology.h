@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace PrCore::Threading {
+
+	struct LogicalProcessor
+	{
+		uint32_t id = 0;          // OS processor index, bit in the affinity mask
+		uint32_t coreId = 0;      // Physical core, SMT siblings share it
+		uint32_t cacheDomain = 0; // Last level cache shared by the processor
+		uint32_t numaNode = 0;
+	};
+
+	class CpuTopology {
+	public:
+		// Reads sysfs and /proc/cpuinfo on Linux, GetLogicalProcessorInformation on Windows
+		// Only the processors in the affinity of the process are kept, cgroup cpusets included
+		static CpuTopology Discover();
+
+		size_t GetLogicalProcessorNum() const { return m_processors.size(); }
+		size_t GetPhysicalCoreNum() const { return m_physicalCoreNum; }
+		size_t GetCacheDomainNum() const { return m_cacheDomainNum; }
+		size_t GetNumaNodeNum() const { return m_numaNodeNum; }
+
+		const std::vector<LogicalProcessor>& GetLogicalProcessors() const { return m_processors; }
+
+		// One processor per physical core, each NUMA node and cache domain is filled before the next one
+		std::vector<LogicalProcessor> GetCoreOrder() const;
+
+	private:
+		// Remaps raw OS ids to dense indices and counts the domains
+		void Normalize();
+
+		std::vector<LogicalProcessor> m_processors;
+		size_t                        m_physicalCoreNum = 0;
+		size_t                        m_cacheDomainNum = 0;
+		size_t                        m_numaNodeNum = 0;
+	};
+}
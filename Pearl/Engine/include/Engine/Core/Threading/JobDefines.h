@@ -4,12 +4,39 @@
 #include <condition_variable>
 #include <functional>
 #include <queue>
+#include <utility>
 
 #define JOB_SYSTEM_DEBUG_LOG 0
 
+// Hint for the core that the thread is spinning, releases the pipeline to the SMT sibling
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define PR_CPU_PAUSE() _mm_pause()
+#elif defined(_M_ARM64) || defined(_M_ARM)
+	#define PR_CPU_PAUSE() __yield()
+#elif defined(__aarch64__) || defined(__arm__)
+	#define PR_CPU_PAUSE() asm volatile("yield")
+#else
+	#define PR_CPU_PAUSE() ((void)0)
+#endif
+
 namespace PrCore::Threading {
 	class JobWorker;
+	class JobSystem;
+
+	using JobPtr = std::function<void()>;
 
+	// Workers always drain higher priorities first
+	// Background jobs wait in JobSystem and run only on a limited number of workers at once
+	enum class JobPriority : uint8_t
+	{
+		Critical = 0,
+		Normal,
+		Background
+	};
+
+	// JobState is a counter of unfinished jobs, it is done when the counter reaches zero
+	// Single job owns its own state, many jobs can share one state to be tracked as a group
 	class JobState {
 	public:
 		JobState() = default;
@@ -18,57 +45,114 @@ namespace PrCore::Threading {
 		bool IsDone();
 
 	private:
-		std::atomic<bool>       m_isDone = false;
+		void Increment();
+		void Decrement();
+
+		// Continuation runs on the thread that finishes the last job, or immediately if the state is already done
+		void AddContinuation(JobPtr&& p_continuation);
+
+		std::atomic<size_t>     m_pendingJobs = 0;
+		std::vector<JobPtr>     m_continuations;
 		std::condition_variable m_finishedCondition;
 		std::mutex              m_finishedLock;
 
 		friend JobWorker;
+		friend JobSystem;
+		friend class BatchJobState;
+		friend class TaskStateBase;
+		friend class JobStateAwaiter;
 	};
 	using JobStatePtr = std::shared_ptr<JobState>;
-	using JobPtr = std::function<void()>;
+	using JobDependencies = std::vector<JobStatePtr>;
 
+	// Batch shares one counter between all of its jobs, it is done when the last job finishes
+	// Open batch holds an extra count so a job finishing while the rest is scheduled does not complete the state,
+	// jobs scheduled after the state are released by Close
 	class BatchJobState {
 	public:
-		BatchJobState()
+		BatchJobState() :
+			m_state(std::make_shared<JobState>()),
+			m_open(true)
+		{
+			m_state->Increment();
+		}
+
+		~BatchJobState()
 		{
-			m_stateVector.reserve(64);
+			Close();
 		}
 
+		BatchJobState(const BatchJobState&) = delete;
+		BatchJobState& operator=(const BatchJobState&) = delete;
+
+		BatchJobState(BatchJobState&& p_other) noexcept :
+			m_state(std::move(p_other.m_state)),
+			m_open(std::exchange(p_other.m_open, false))
+		{}
+
+		BatchJobState& operator=(BatchJobState&& p_other) noexcept
+		{
+			if (this != &p_other)
+			{
+				Close();
+				m_state = std::move(p_other.m_state);
+				m_open = std::exchange(p_other.m_open, false);
+			}
+			return *this;
+		}
+
+		// Call after the last job is scheduled, the state can complete from then on
+		void Close()
+		{
+			if (std::exchange(m_open, false))
+				m_state->Decrement();
+		}
+
+		// Closes the batch before waiting
 		void Wait()
 		{
-			for (auto& state : m_stateVector)
-				state->Wait();
+			Close();
+			m_state->Wait();
 		}
 
+		// All jobs scheduled so far are done
 		bool IsDone()
 		{
-			bool done = false;
-			for (auto& state : m_stateVector)
-				done &= state->IsDone();
-
-			return done;
+			return m_state->m_pendingJobs.load() == (m_open ? 1 : 0);
 		}
 
 		void Append(JobStatePtr&& p_statePtr)
 		{
-			m_stateVector.push_back(std::move(p_statePtr));
+			// Jobs scheduled outside of the batch are counted through continuation
+			m_state->Increment();
+			p_statePtr->AddContinuation([state = m_state]() {
+				state->Decrement();
+				});
 		}
 
 		BatchJobState& operator+=(JobStatePtr&& p_statePtr)
 		{
-			m_stateVector.push_back(std::move(p_statePtr));
+			Append(std::move(p_statePtr));
 			return *this;
 		}
 
+		// Use to schedule jobs after the whole batch, they wait for Close
+		const JobStatePtr& GetState() const
+		{
+			return m_state;
+		}
+
 	private:
-		std::vector<JobStatePtr> m_stateVector;
+		JobStatePtr m_state;
+		bool        m_open;
 	};
 
 	struct JobDesc
 	{
 		JobPtr      functionPtr;
 		JobStatePtr state;
+		JobPriority priority = JobPriority::Normal;
 		size_t      id;
 		std::string name;
 	};
-}
\ No newline at end of file
+}
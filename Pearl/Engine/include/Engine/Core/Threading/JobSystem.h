@@ -2,35 +2,97 @@
 
 #include "JobDefines.h"
 #include "JobWorker.h"
+#include "CpuTopology.h"
 
 #include "Core/Utils/Singleton.h"
 
 namespace PrCore::Threading {
 
+	// Zero worker numbers are derived from the CPU topology
+	struct JobSystemSettings
+	{
+		size_t workerNumber = 0;           // One worker per physical core minus reserved ones by default
+		size_t backgroundWorkerNumber = 0; // Quarter of the workers by default
+		size_t reservedThreads = 1;        // Cores left for the main thread and other engine threads
+		bool   pinWorkers = true;          // Pins each worker to its own physical core
+	};
+
 	class JobSystem : public Utils::Singleton<JobSystem> {
 	public:
-		JobSystem(size_t p_workerNumber);
+		// Background worker number limits how many workers can run background jobs at the same time
+		JobSystem(size_t p_workerNumber, size_t p_backgroundWorkerNumber = 1);
+		explicit JobSystem(const JobSystemSettings& p_settings);
 		~JobSystem();
 
 		template<typename Func, typename... Args>
 		JobStatePtr Schedule(std::string_view p_name, Func&& p_function, Args&&... p_args);
 
+		template<typename Func, typename... Args>
+		JobStatePtr Schedule(JobPriority p_priority, std::string_view p_name, Func&& p_function, Args&&... p_args);
+
+		// Job is counted in the batch state instead of getting its own state
+		template<typename Func, typename... Args>
+		void Schedule(BatchJobState& p_batchState, std::string_view p_name, Func&& p_function, Args&&... p_args);
+
+		template<typename Func, typename... Args>
+		void Schedule(JobPriority p_priority, BatchJobState& p_batchState, std::string_view p_name, Func&& p_function, Args&&... p_args);
+
+		// Job is submitted to the workers when all dependencies are done, it does not block any thread
+		template<typename Func, typename... Args>
+		JobStatePtr ScheduleAfter(std::string_view p_name, const JobDependencies& p_dependencies, Func&& p_function, Args&&... p_args);
+
+		template<typename Func, typename... Args>
+		JobStatePtr ScheduleAfter(JobPriority p_priority, std::string_view p_name, const JobDependencies& p_dependencies, Func&& p_function, Args&&... p_args);
+
 		// To add later
 		//template<typename Func, typename... Args>
 		//JobStatePtr ScheduleBatch(size_t p_batchSize, size_t p_jobNumber, std::string_view p_name, Func&& p_function, Args&&... p_args);
 
 		void   WaitAll();
 
+		// Runs one pending critical or normal job on the calling thread, used by the waits to help instead of sleeping
+		bool   TryExecuteJob();
+
 		void   PauseWorkers(bool p_pause);
 		bool   GetWorkersPaused();
 		size_t GetWorkerNum();
+		size_t GetBackgroundWorkerNum();
+
+		const CpuTopology& GetTopology() const { return m_topology; }
 
 	private:
+		void   CreateWorkers(size_t p_workerNumber, size_t p_backgroundWorkerNumber, bool p_pinWorkers, size_t p_reservedThreads);
+
+		template<typename Func, typename... Args>
+		JobDesc CreateJobDesc(JobPriority p_priority, JobStatePtr p_state, std::string_view p_name, Func&& p_function, Args&&... p_args);
+
+		void   SubmitJob(JobDesc&& p_jobDesc);
+		void   SubmitJobAfter(JobDesc&& p_jobDesc, const JobDependencies& p_dependencies);
+		size_t NextWorker();
+
+		// Syscall free when no worker is parked
+		void   WakeSleepingWorker();
+
+		// Called by the workers when they run out of critical and normal jobs
+		bool   TryExecuteBackgroundJob(JobWorker& p_worker);
+		bool   HasRunnableBackgroundJob();
+
+		CpuTopology               m_topology;
 		std::vector<JobWorkerPtr> m_workers;
 		std::atomic<size_t>       m_nextWorker;
+		std::atomic<size_t>       m_queuedJobs;
+		std::atomic<size_t>       m_sleepingWorkers;
 		std::atomic<bool>         m_paused;
 
+		std::deque<JobDesc>       m_backgroundJobs;
+		std::mutex                m_backgroundLock;
+		std::atomic<size_t>       m_backgroundJobCount;
+		std::atomic<size_t>       m_runningBackgroundJobs;
+		size_t                    m_backgroundWorkerNumber;
+
 		std::atomic<size_t>       m_nextJobId;
+
+		friend JobWorker;
 	};
 }
 
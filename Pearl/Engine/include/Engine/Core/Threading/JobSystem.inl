@@ -2,29 +2,67 @@ namespace PrCore::Threading {
 
 	template<typename Func, typename... Args>
 	JobStatePtr JobSystem::Schedule(std::string_view p_name, Func&& p_function, Args&&... p_args)
+	{
+		return Schedule(JobPriority::Normal, p_name, std::forward<Func>(p_function), std::forward<Args>(p_args)...);
+	}
+
+	template<typename Func, typename... Args>
+	JobStatePtr JobSystem::Schedule(JobPriority p_priority, std::string_view p_name, Func&& p_function, Args&&... p_args)
+	{
+		auto jobDesc = CreateJobDesc(p_priority, std::make_shared<JobState>(), p_name, std::forward<Func>(p_function), std::forward<Args>(p_args)...);
+		auto jobState = jobDesc.state;
+
+		SubmitJob(std::move(jobDesc));
+
+		return jobState;
+	}
+
+	template<typename Func, typename... Args>
+	void JobSystem::Schedule(BatchJobState& p_batchState, std::string_view p_name, Func&& p_function, Args&&... p_args)
+	{
+		Schedule(JobPriority::Normal, p_batchState, p_name, std::forward<Func>(p_function), std::forward<Args>(p_args)...);
+	}
+
+	template<typename Func, typename... Args>
+	void JobSystem::Schedule(JobPriority p_priority, BatchJobState& p_batchState, std::string_view p_name, Func&& p_function, Args&&... p_args)
+	{
+		SubmitJob(CreateJobDesc(p_priority, p_batchState.GetState(), p_name, std::forward<Func>(p_function), std::forward<Args>(p_args)...));
+	}
+
+	template<typename Func, typename... Args>
+	JobStatePtr JobSystem::ScheduleAfter(std::string_view p_name, const JobDependencies& p_dependencies, Func&& p_function, Args&&... p_args)
+	{
+		return ScheduleAfter(JobPriority::Normal, p_name, p_dependencies, std::forward<Func>(p_function), std::forward<Args>(p_args)...);
+	}
+
+	template<typename Func, typename... Args>
+	JobStatePtr JobSystem::ScheduleAfter(JobPriority p_priority, std::string_view p_name, const JobDependencies& p_dependencies, Func&& p_function, Args&&... p_args)
+	{
+		auto jobDesc = CreateJobDesc(p_priority, std::make_shared<JobState>(), p_name, std::forward<Func>(p_function), std::forward<Args>(p_args)...);
+		auto jobState = jobDesc.state;
+
+		SubmitJobAfter(std::move(jobDesc), p_dependencies);
+
+		return jobState;
+	}
+
+	template<typename Func, typename... Args>
+	JobDesc JobSystem::CreateJobDesc(JobPriority p_priority, JobStatePtr p_state, std::string_view p_name, Func&& p_function, Args&&... p_args)
 	{
 		static_assert(std::is_pointer_v<Func> && std::is_function_v<std::remove_pointer_t<Func>>
 			|| std::is_invocable_v<Func, Args...>
 			|| std::is_member_function_pointer_v<Func>, "Func has to be a function pointer, member function pointer or lambda");
 
-		auto jobState = std::make_shared<JobState>();
+		// State is pending from the moment of scheduling so it can be waited on or used as a dependency
+		p_state->Increment();
+
 		JobDesc jobDesc;
 		jobDesc.id = m_nextJobId++;
 		jobDesc.name = p_name;
 		jobDesc.functionPtr = std::bind(p_function, std::forward<Args>(p_args)...);
-		jobDesc.state = jobState;
+		jobDesc.state = std::move(p_state);
+		jobDesc.priority = p_priority;
 
-		// acquire active queue and increment the value
-		size_t activeWorker = 0;
-		size_t nextActiveWorker = 0;
-		do {
-			activeWorker = m_nextWorker.load();
-			nextActiveWorker = (activeWorker + 1) % m_workers.size();
-
-		} while (!m_nextWorker.compare_exchange_weak(activeWorker, nextActiveWorker));
-
-		m_workers[activeWorker]->AddJobRequest(std::move(jobDesc));
-
-		return jobState;
+		return jobDesc;
 	}
-}
\ No newline at end of file
+}
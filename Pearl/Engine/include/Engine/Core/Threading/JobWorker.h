@@ -3,24 +3,39 @@
 #include "IThread.h"
 #include "JobDefines.h"
 
+#include <array>
 #include <optional>
 
 namespace PrCore::Threading {
 
+	class JobSystem;
+
 	class JobWorker : public IThread {
 	public:
-		JobWorker(std::string_view p_name);
+		JobWorker(std::string_view p_name, JobSystem* p_jobSystem, uint32_t p_cacheDomain = 0);
 		~JobWorker();
 
 		int ThreadLoop() override;
 
+		// Accepts critical and normal jobs, background jobs are queued in JobSystem
+		// Worker is not woken up, the caller wakes sleeping workers through JobSystem
 		void                    AddJobRequest(JobDesc&& p_jobDesc);
-		std::optional<JobDesc>  StealJob();
+		std::optional<JobDesc>  PopJob(JobPriority p_priority);
+		std::optional<JobDesc>  StealJob(JobPriority p_priority);
+		void                    Wake();
+		bool                    WakeIfSleeping();
+		bool                    IsSleeping() { return m_sleeping.load(); }
+		void                    ProcessJob(const JobDesc& p_jobDesc);
+
+		// Worker that runs on the calling thread, nullptr for non worker threads
+		static JobWorker*       GetCurrentWorker();
 
 		bool IsBusy();
 		void WaitForIdle();
 
+		// Workers sharing the cache domain are tried first, the rest is rotated to spread the contention
 		void SetStealWorkers(const std::vector<std::shared_ptr<JobWorker>>& p_workers);
+		uint32_t GetCacheDomain() const { return m_cacheDomain; }
 
 	protected:
 		bool ShouldPause() override { return m_pause.load(); }
@@ -32,12 +47,22 @@ namespace PrCore::Threading {
 		bool IsPaused() override { return m_pause; }
 		bool IsTerminated() override { return m_terminate; }
 
-		void ProcessJob(const JobDesc& p_jobDesc);
+		std::optional<JobDesc> StealFromWorkers(JobPriority p_priority);
+		bool                   HasJobs();
+		void                   NotifyIdle();
+
+		// Spins and then yields while waiting for new work, returns false when the worker should park
+		bool                   SpinForWork();
+		bool                   HasPendingWork();
+
+		static constexpr size_t s_queueCount = static_cast<size_t>(JobPriority::Background);
 
 		std::string       m_name;
 		size_t            m_id;
+		JobSystem*        m_jobSystem;
+		uint32_t          m_cacheDomain;
 
-		std::deque<JobDesc> m_jobBuffer;
+		std::array<std::deque<JobDesc>, s_queueCount> m_jobBuffers;
 
 		std::condition_variable  m_idleCondition;
 		std::mutex               m_idleLock;
@@ -47,6 +72,11 @@ namespace PrCore::Threading {
 
 		std::vector<std::weak_ptr<JobWorker>> m_stealWorkers;
 
+		// Spin limit grows when spinning finds work and shrinks when the worker parks anyway
+		size_t                  m_spinLimit;
+		size_t                  m_maxSpinLimit;
+
+		std::atomic<bool>       m_sleeping;
 		std::atomic<bool>       m_isBusy;
 		std::atomic<bool>       m_pause;
 		std::atomic<bool>       m_terminate;
@@ -0,0 +1,333 @@
+#pragma once
+
+#include "JobDefines.h"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+
+namespace PrCore::Threading {
+
+	template<typename T = void>
+	class Task;
+
+	// Schedules the coroutine resumption as a job, the coroutine continues on a worker
+	void ResumeOnWorker(std::coroutine_handle<> p_handle, JobPriority p_priority);
+
+	// Result shared by the task handles and the coroutine, the coroutine frame destroys itself when finished
+	class TaskStateBase {
+	public:
+		TaskStateBase() :
+			m_state(std::make_shared<JobState>())
+		{
+			m_state->Increment();
+		}
+
+		// Use to schedule jobs after the task
+		const JobStatePtr& GetState() const
+		{
+			return m_state;
+		}
+
+		void Complete()
+		{
+			m_state->Decrement();
+		}
+
+		void SetException(std::exception_ptr p_exception)
+		{
+			m_exception = p_exception;
+		}
+
+	protected:
+		void RethrowException() const
+		{
+			if (m_exception)
+				std::rethrow_exception(m_exception);
+		}
+
+		JobStatePtr        m_state;
+		std::exception_ptr m_exception;
+	};
+
+	template<typename T>
+	class TaskState : public TaskStateBase {
+	public:
+		template<typename U>
+		void SetResult(U&& p_result)
+		{
+			m_result.emplace(std::forward<U>(p_result));
+		}
+
+		T& GetResult()
+		{
+			RethrowException();
+			return *m_result;
+		}
+
+	private:
+		std::optional<T> m_result;
+	};
+
+	template<>
+	class TaskState<void> : public TaskStateBase {
+	public:
+		void GetResult()
+		{
+			RethrowException();
+		}
+	};
+
+	// Suspends the coroutine until the job state is done, the coroutine is resumed with its own priority
+	class JobStateAwaiter {
+	public:
+		explicit JobStateAwaiter(JobStatePtr p_state) :
+			m_state(std::move(p_state))
+		{}
+
+		bool await_ready() const
+		{
+			return m_state->IsDone();
+		}
+
+		template<typename Promise>
+		void await_suspend(std::coroutine_handle<Promise> p_handle)
+		{
+			JobPriority priority = JobPriority::Normal;
+			if constexpr (requires { p_handle.promise().GetPriority(); })
+				priority = p_handle.promise().GetPriority();
+
+			m_state->AddContinuation([p_handle, priority]() {
+				ResumeOnWorker(p_handle, priority);
+				});
+		}
+
+		void await_resume() const {}
+
+	protected:
+		JobStatePtr m_state;
+	};
+
+	inline JobStateAwaiter operator co_await(const JobStatePtr& p_state)
+	{
+		return JobStateAwaiter(p_state);
+	}
+
+	// Awaiting closes the batch
+	inline JobStateAwaiter operator co_await(BatchJobState& p_batchState)
+	{
+		p_batchState.Close();
+		return JobStateAwaiter(p_batchState.GetState());
+	}
+
+	// Moves the coroutine to a job of the given priority, later resumptions keep the priority
+	class ResumeOnAwaiter {
+	public:
+		explicit ResumeOnAwaiter(JobPriority p_priority) :
+			m_priority(p_priority)
+		{}
+
+		bool await_ready() const { return false; }
+
+		template<typename Promise>
+		void await_suspend(std::coroutine_handle<Promise> p_handle)
+		{
+			if constexpr (requires { p_handle.promise().SetPriority(m_priority); })
+				p_handle.promise().SetPriority(m_priority);
+
+			ResumeOnWorker(p_handle, m_priority);
+		}
+
+		void await_resume() const {}
+
+	private:
+		JobPriority m_priority;
+	};
+
+	inline ResumeOnAwaiter ResumeOn(JobPriority p_priority)
+	{
+		return ResumeOnAwaiter(p_priority);
+	}
+
+	class TaskPromiseBase {
+	public:
+		JobPriority GetPriority() const { return m_priority; }
+		void        SetPriority(JobPriority p_priority) { m_priority = p_priority; }
+
+		// Coroutine body starts on a worker, the caller continues straight away
+		ResumeOnAwaiter initial_suspend() noexcept
+		{
+			return ResumeOnAwaiter(m_priority);
+		}
+
+		std::suspend_never final_suspend() noexcept
+		{
+			m_baseState->Complete();
+			return {};
+		}
+
+		void unhandled_exception()
+		{
+			m_baseState->SetException(std::current_exception());
+		}
+
+	protected:
+		std::shared_ptr<TaskStateBase> m_baseState;
+		JobPriority                    m_priority = JobPriority::Normal;
+	};
+
+	template<typename T>
+	class TaskPromise : public TaskPromiseBase {
+	public:
+		TaskPromise() :
+			m_state(std::make_shared<TaskState<T>>())
+		{
+			m_baseState = m_state;
+		}
+
+		Task<T> get_return_object()
+		{
+			return Task<T>(m_state);
+		}
+
+		template<typename U>
+		void return_value(U&& p_result)
+		{
+			m_state->SetResult(std::forward<U>(p_result));
+		}
+
+	private:
+		std::shared_ptr<TaskState<T>> m_state;
+	};
+
+	template<>
+	class TaskPromise<void> : public TaskPromiseBase {
+	public:
+		TaskPromise() :
+			m_state(std::make_shared<TaskState<void>>())
+		{
+			m_baseState = m_state;
+		}
+
+		Task<void> get_return_object();
+
+		void return_void() {}
+
+	private:
+		std::shared_ptr<TaskState<void>> m_state;
+	};
+
+	// Coroutine running on the job system, it can co_await jobs, batches, other tasks and TaskCompletions
+	// The task runs to the end even if all handles are destroyed
+	template<typename T>
+	class Task {
+	public:
+		using promise_type = TaskPromise<T>;
+
+		Task() = default;
+		explicit Task(std::shared_ptr<TaskState<T>> p_state) :
+			m_state(std::move(p_state))
+		{}
+
+		bool IsValid() const
+		{
+			return m_state != nullptr;
+		}
+
+		bool IsDone() const
+		{
+			return m_state->GetState()->IsDone();
+		}
+
+		// Blocking wait for non coroutine code, helps with pending jobs meanwhile
+		void Wait() const
+		{
+			m_state->GetState()->Wait();
+		}
+
+		decltype(auto) GetResult() const
+		{
+			Wait();
+			return m_state->GetResult();
+		}
+
+		const JobStatePtr& GetState() const
+		{
+			return m_state->GetState();
+		}
+
+		auto operator co_await() const&
+		{
+			return Awaiter<false>(m_state);
+		}
+
+		auto operator co_await() const&&
+		{
+			return Awaiter<true>(m_state);
+		}
+
+	private:
+		// Temporary task moves its result out, named task gives a reference
+		template<bool MoveResult>
+		class Awaiter : public JobStateAwaiter {
+		public:
+			explicit Awaiter(std::shared_ptr<TaskState<T>> p_state) :
+				JobStateAwaiter(p_state->GetState()),
+				m_taskState(std::move(p_state))
+			{}
+
+			decltype(auto) await_resume() const
+			{
+				if constexpr (std::is_void_v<T>)
+					m_taskState->GetResult();
+				else if constexpr (MoveResult)
+					return std::move(m_taskState->GetResult());
+				else
+					return static_cast<const T&>(m_taskState->GetResult());
+			}
+
+		private:
+			std::shared_ptr<TaskState<T>> m_taskState;
+		};
+
+		std::shared_ptr<TaskState<T>> m_state;
+	};
+
+	inline Task<void> TaskPromise<void>::get_return_object()
+	{
+		return Task<void>(m_state);
+	}
+
+	// Completes a task from outside of the job system, for example from an I/O callback
+	template<typename T = void>
+	class TaskCompletion {
+	public:
+		TaskCompletion() :
+			m_state(std::make_shared<TaskState<T>>())
+		{}
+
+		Task<T> GetTask() const
+		{
+			return Task<T>(m_state);
+		}
+
+		// Call exactly once, tasks awaiting the completion are resumed on the workers
+		template<typename... Args>
+		void SetResult(Args&&... p_args)
+		{
+			if constexpr (!std::is_void_v<T>)
+				m_state->SetResult(std::forward<Args>(p_args)...);
+
+			m_state->Complete();
+		}
+
+		void SetException(std::exception_ptr p_exception)
+		{
+			m_state->SetException(p_exception);
+			m_state->Complete();
+		}
+
+	private:
+		std::shared_ptr<TaskState<T>> m_state;
+	};
+}
@@ -3,6 +3,7 @@
 #include "IThread.h"
 #include "Core/Utils/Singleton.h"
 
+#include <condition_variable>
 #include <shared_mutex>
 #include <string>
 
@@ -21,7 +22,7 @@ namespace PrCore::Threading {
 	struct ThreadConfig
 	{
 		std::string name = "PearlThread";
-		uint64_t    affinityMask = 0xFFFFFFFF;
+		uint64_t    affinityMask = 0; // Bit N pins to processor N, 0 keeps the affinity of the process
 		uint64_t    stackSize = 0;
 		bool        startPaused = false;
 	};
@@ -42,15 +43,33 @@ namespace PrCore::Threading {
 		size_t     GetThreadNum();
 		ThreadInfo GetThreadInfo(IThreadPtr p_thread);
 
+		// OS thread id of the calling thread
+		static uint64_t GetCurrentThreadId();
+
 	private:
+#ifndef _WIN32
+		// Pthreads can be joined only once, JoinThread waits for this signal instead
+		struct ThreadExitSignal
+		{
+			std::mutex              exitLock;
+			std::condition_variable exitCondition;
+			bool                    exited = false;
+		};
+		using ThreadExitSignalPtr = std::shared_ptr<ThreadExitSignal>;
+#endif
+
 		struct ThreadDesc
 		{
 			IThreadPtr  threadPtr = nullptr;
 			std::string name = "PearlThread";
-			uint64_t    affinityMask = 0xFFFFFFFF;
+			uint64_t    affinityMask = 0;
 			uint64_t    stackSize = 0;
 
+#ifdef _WIN32
 			void*       nativeHandle = 0;
+#else
+			ThreadExitSignalPtr exitSignal = nullptr;
+#endif
 			uint64_t    threadId = 0;
 		};
 
@@ -74,11 +93,22 @@ namespace PrCore::Threading {
 			}
 		};
 
+		// Removes the thread from the registry when its loop has finished
+		void UnregisterThread(const IThreadPtr& p_thread);
+
+#ifdef _WIN32
 		void* GetThreadHandle(IThreadPtr p_thread);
+#else
+		ThreadExitSignalPtr GetThreadExitSignal(IThreadPtr p_thread);
+#endif
 
 		std::set<ThreadDesc, ThreadDescComparator>  m_activeThreads;
 		std::shared_mutex                           m_activeThreadLock;
 
+#ifdef _WIN32
 		friend DWORD WINAPI ThreadEntry(LPVOID p_thread);
+#else
+		friend void* ThreadEntry(void* p_thread);
+#endif
 	};
 }
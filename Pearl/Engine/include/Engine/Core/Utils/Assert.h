@@ -1,6 +1,13 @@
 #pragma once
 #include"Core/Utils/Logger.h"
 
+#ifdef _WIN32
+	#define PR_DEBUGBREAK() __debugbreak()
+#else
+	#include <csignal>
+	#define PR_DEBUGBREAK() std::raise(SIGTRAP)
+#endif
+
 namespace PrCore::Utils {
 	
 	template<typename ...Args>
@@ -20,5 +27,5 @@ template<typename ...Args>
 inline void PrCore::Utils::pearl_assert(const char* p_msg, const char* p_file, int p_line, std::string p_info)
 {
 	PRLOG_ERROR("ASSERTION FILED! \nFILE: {0}\nLINE: {1}\nASSERT CAUSE: {2}\nINFO: {3}", p_file, p_line, p_msg, p_info);
-	__debugbreak();
+	PR_DEBUGBREAK();
 }
\ No newline at end of file
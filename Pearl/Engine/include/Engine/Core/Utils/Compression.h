@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace PrCore::Utils {
+
+	// LZ4 block format, fast enough to decompress on load instead of reading more bytes from the disk
+	// Blocks have no header, the caller stores the compressed and the decompressed sizes
+
+	// Largest compressed size of p_size bytes, incompressible data grows slightly
+	size_t CompressBound(size_t p_size);
+
+	// Returns the compressed size, 0 if the block does not fit in p_dstCapacity
+	size_t Compress(const void* p_src, size_t p_srcSize, void* p_dst, size_t p_dstCapacity);
+
+	// Safe on corrupted blocks, fails unless the block decompresses to exactly p_dstSize bytes
+	bool   Decompress(const void* p_src, size_t p_srcSize, void* p_dst, size_t p_dstSize);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <memory>
+
+namespace PrCore::Utils {
+
+	// Value shared by the copies until one of them changes it, the changed copy detaches with its own value
+	// Read with Get or the operators, change with Write or by assigning a new value
+	// Copies on different threads are safe, one copy is not safe to change and read from several threads
+	template<typename T>
+	class CopyOnWrite {
+	public:
+		CopyOnWrite() :
+			m_value(std::make_shared<T>())
+		{}
+
+		CopyOnWrite(T p_value) :
+			m_value(std::make_shared<T>(std::move(p_value)))
+		{}
+
+		// New value does not change the copies sharing the previous one
+		CopyOnWrite& operator=(T p_value)
+		{
+			m_value = std::make_shared<T>(std::move(p_value));
+			return *this;
+		}
+
+		const T& Get() const { return *m_value; }
+		const T& operator*() const { return *m_value; }
+		const T* operator->() const { return m_value.get(); }
+
+		// Detaches from the copies before the change
+		T& Write()
+		{
+			if (m_value.use_count() > 1)
+				m_value = std::make_shared<T>(*m_value);
+
+			return *m_value;
+		}
+
+		bool IsShared() const { return m_value.use_count() > 1; }
+
+		// Identity of the shared value, see IResourceData::ForEachBlock
+		std::shared_ptr<const void> GetBlock() const { return m_value; }
+
+	private:
+		std::shared_ptr<T> m_value;
+	};
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "Core/Utils/Assert.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace PrCore::Utils {
+
+	// Open addressing hash map with linear probing for 64-bit keys that are already well distributed, like hashes or UUIDs
+	// Key 0 marks an empty slot and cannot be stored, erasing shifts the following entries back so there are no tombstones
+	// Pointers to values are invalidated by any insert or erase
+	template<typename Value>
+	class FlatHashMap {
+	public:
+		using Key = uint64_t;
+
+		struct Slot
+		{
+			Key   key = 0;
+			Value value{};
+		};
+
+		template<typename SlotType>
+		class Iterator {
+		public:
+			Iterator(SlotType* p_slot, SlotType* p_end) :
+				m_slot(p_slot),
+				m_end(p_end)
+			{
+				SkipEmpty();
+			}
+
+			SlotType& operator*() const { return *m_slot; }
+			SlotType* operator->() const { return m_slot; }
+
+			Iterator& operator++()
+			{
+				m_slot++;
+				SkipEmpty();
+				return *this;
+			}
+
+			bool operator==(const Iterator& p_other) const { return m_slot == p_other.m_slot; }
+			bool operator!=(const Iterator& p_other) const { return m_slot != p_other.m_slot; }
+
+		private:
+			void SkipEmpty()
+			{
+				while (m_slot != m_end && m_slot->key == 0)
+					m_slot++;
+			}
+
+			SlotType* m_slot;
+			SlotType* m_end;
+		};
+
+		FlatHashMap() = default;
+
+		Value* Find(Key p_key)
+		{
+			if (m_size == 0)
+				return nullptr;
+
+			for (size_t index = HomeIndex(p_key);; index = (index + 1) & m_mask)
+			{
+				auto& slot = m_slots[index];
+				if (slot.key == p_key)
+					return &slot.value;
+				if (slot.key == 0)
+					return nullptr;
+			}
+		}
+
+		const Value* Find(Key p_key) const
+		{
+			return const_cast<FlatHashMap*>(this)->Find(p_key);
+		}
+
+		bool Contains(Key p_key) const
+		{
+			return Find(p_key) != nullptr;
+		}
+
+		// Keeps the existing value, returns it and whether the value was inserted
+		template<typename... Args>
+		std::pair<Value*, bool> TryEmplace(Key p_key, Args&&... p_args)
+		{
+			PR_ASSERT(p_key != 0, "FlatHashMap key 0 is reserved for empty slots");
+
+			if ((m_size + 1) * 4 > m_slots.size() * 3)
+				Rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+
+			for (size_t index = HomeIndex(p_key);; index = (index + 1) & m_mask)
+			{
+				auto& slot = m_slots[index];
+				if (slot.key == p_key)
+					return { &slot.value, false };
+
+				if (slot.key == 0)
+				{
+					slot.key = p_key;
+					slot.value = Value(std::forward<Args>(p_args)...);
+					m_size++;
+					return { &slot.value, true };
+				}
+			}
+		}
+
+		template<typename V>
+		Value& InsertOrAssign(Key p_key, V&& p_value)
+		{
+			auto [value, inserted] = TryEmplace(p_key);
+			*value = std::forward<V>(p_value);
+			return *value;
+		}
+
+		Value& operator[](Key p_key)
+		{
+			return *TryEmplace(p_key).first;
+		}
+
+		bool Erase(Key p_key)
+		{
+			if (m_size == 0)
+				return false;
+
+			size_t hole = HomeIndex(p_key);
+			while (m_slots[hole].key != p_key)
+			{
+				if (m_slots[hole].key == 0)
+					return false;
+				hole = (hole + 1) & m_mask;
+			}
+
+			// Move back every following entry that can reach the hole from its home slot
+			for (size_t index = (hole + 1) & m_mask; m_slots[index].key != 0; index = (index + 1) & m_mask)
+			{
+				size_t home = HomeIndex(m_slots[index].key);
+				if (((index - home) & m_mask) >= ((index - hole) & m_mask))
+				{
+					m_slots[hole] = std::move(m_slots[index]);
+					hole = index;
+				}
+			}
+
+			m_slots[hole] = Slot();
+			m_size--;
+			return true;
+		}
+
+		void Clear()
+		{
+			for (auto& slot : m_slots)
+				slot = Slot();
+			m_size = 0;
+		}
+
+		void Reserve(size_t p_size)
+		{
+			size_t capacity = m_slots.empty() ? 16 : m_slots.size();
+			while (p_size * 4 > capacity * 3)
+				capacity *= 2;
+
+			if (capacity != m_slots.size())
+				Rehash(capacity);
+		}
+
+		size_t Size() const { return m_size; }
+		bool   Empty() const { return m_size == 0; }
+
+		Iterator<Slot>       begin() { return { m_slots.data(), m_slots.data() + m_slots.size() }; }
+		Iterator<Slot>       end() { return { m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size() }; }
+		Iterator<const Slot> begin() const { return { m_slots.data(), m_slots.data() + m_slots.size() }; }
+		Iterator<const Slot> end() const { return { m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size() }; }
+
+	private:
+		size_t HomeIndex(Key p_key) const
+		{
+			// Fibonacci hashing spreads sequential keys
+			return static_cast<size_t>((p_key * 0x9E3779B97F4A7C15ull) >> 32) & m_mask;
+		}
+
+		void Rehash(size_t p_capacity)
+		{
+			std::vector<Slot> oldSlots(p_capacity);
+			oldSlots.swap(m_slots);
+			m_mask = p_capacity - 1;
+
+			for (auto& oldSlot : oldSlots)
+			{
+				if (oldSlot.key == 0)
+					continue;
+
+				size_t index = HomeIndex(oldSlot.key);
+				while (m_slots[index].key != 0)
+					index = (index + 1) & m_mask;
+				m_slots[index] = std::move(oldSlot);
+			}
+		}
+
+		std::vector<Slot> m_slots;
+		size_t            m_size = 0;
+		size_t            m_mask = 0;
+	};
+}
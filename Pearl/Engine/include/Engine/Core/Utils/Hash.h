@@ -0,0 +1,9 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace PrCore::Utils {
+
+	// XXH64 of the bytes, the value is the same on every platform and run so it can be stored in files
+	uint64_t Hash64(const void* p_data, size_t p_size, uint64_t p_seed = 0);
+}
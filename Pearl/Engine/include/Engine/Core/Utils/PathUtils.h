@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 
 namespace PrCore::PathUtils
@@ -6,6 +7,9 @@ namespace PrCore::PathUtils
 	void             Sanitize(char* p_path);
 	std::string      Sanitize(std::string_view p_path);
 
+	// 64-bit hash of the sanitized path computed in place, never returns 0
+	uint64_t         HashPath(std::string_view p_path);
+
 	bool             IsAbsolute(const char* p_path);
 	bool             IsRelative(const char* p_path);
 
@@ -12,6 +12,8 @@ namespace PrRenderer::OpenGL {
 		void RecalculateNormals() override;
 		void RecalculateTangents() override;
 
+		PrCore::Resources::IResourceDataPtr Clone() const override;
+
 	private:
 		void UpdateBuffers() override;
 	};
@@ -3,6 +3,7 @@
 #include"Renderer/Resources/Shader.h"
 #include"Renderer/Resources/Cubemap.h"
 
+#include"Core/Utils/CopyOnWrite.h"
 #include"Core/Utils/JSONParser.h"
 #include"Core/Utils/Logger.h"
 
@@ -17,6 +18,7 @@ namespace PrRenderer::Resources {
 		Transparent
 	};
 
+	// Copies share the uniforms and the texture bindings, each of them is detached on the first change of the copy
 	class Material : public PrCore::Resources::IResourceData {
 	public:
 		Material() = delete;
@@ -70,13 +72,20 @@ namespace PrRenderer::Resources {
 
 
 		size_t GetByteSize() const override;
+		void   ForEachBlock(const BlockVisitor& p_visitor) const override;
 
 	protected:
 		bool PopulateBasedOnShader(PrCore::Utils::JSON::json& p_json);
 
+		// Returns nullptr if the material does not have the uniform
+		Uniform* WriteUniform(const std::string& p_name);
+
+		size_t UniformsByteSize() const;
+		size_t TexturesByteSize() const;
+
 		ShaderPtr m_shader;
-		std::map<std::string, TexturePtr> m_textures;
-		std::map<std::string, Uniform> m_uniforms;
+		PrCore::Utils::CopyOnWrite<std::map<std::string, TexturePtr>> m_textures;
+		PrCore::Utils::CopyOnWrite<std::map<std::string, Uniform>> m_uniforms;
 		RenderType m_renderType;
 		size_t m_renderOrder;
 
@@ -92,8 +101,8 @@ namespace PrRenderer::Resources {
 	template<typename T>
 	inline void Material::SetProperty(const std::string& p_name, const T& p_value)
 	{
-		auto find = m_uniforms.find(p_name);
-		if (find != m_uniforms.end())
+		auto find = m_uniforms->find(p_name);
+		if (find != m_uniforms->end())
 		{
 			if (find->second.size != 1)
 			{
@@ -101,7 +110,7 @@ namespace PrRenderer::Resources {
 				return;
 			}
 
-			find->second.value = std::make_any<T>(p_value);
+			WriteUniform(p_name)->value = std::make_any<T>(p_value);
 		}
 		else
 		{
@@ -112,8 +121,8 @@ namespace PrRenderer::Resources {
 	template<typename T>
 	inline void Material::SetPropertyArray(const std::string& p_name, const T const* p_value, unsigned int p_count)
 	{
-		auto find = m_uniforms.find(p_name);
-		if (find != m_uniforms.end())
+		auto find = m_uniforms->find(p_name);
+		if (find != m_uniforms->end())
 		{
 			if (find->second.size == 1)
 			{
@@ -124,7 +133,7 @@ namespace PrRenderer::Resources {
 			std::vector<T> tempVector(find->second.size);
 			for (int i = 0; i < p_count; i++)
 				tempVector[i] = p_value[i];
-			find->second.value = std::make_any<std::vector<T>>(tempVector);
+			WriteUniform(p_name)->value = std::make_any<std::vector<T>>(tempVector);
 		}
 		else
 		{
@@ -136,12 +145,12 @@ namespace PrRenderer::Resources {
 	inline const T& Material::GetProperty(const std::string& p_name)
 	{
 
-		auto find = m_uniforms.find(p_name);
-		if (find != m_uniforms.end())
+		auto find = m_uniforms->find(p_name);
+		if (find != m_uniforms->end())
 		{
 			try
 			{
-				T& returnValue = std::any_cast<T&>(find->second.value);
+				const T& returnValue = std::any_cast<const T&>(find->second.value);
 				return returnValue;
 			}
 			catch (const std::bad_any_cast& e)
@@ -11,5 +11,14 @@ namespace PrRenderer::Resources {
 		void UnloadResource(PrCore::Resources::IResourceDataPtr p_resourceData) override;
 
 		bool SaveResourceOnDisc(PrCore::Resources::IResourceDataPtr p_resourceData, const std::string& p_path) override;
+
+		// Shader, textures and cubemaps referenced by the material file
+		std::vector<PrCore::Resources::ResourceDependency> GetDependencies(const std::string& p_path) override;
+
+		bool CookResource(const std::string& p_path) override;
+
+		// Cooked material kept by the compressed residency tier
+		bool ReadCookedPayload(const std::string& p_path, std::vector<uint8_t>& p_payload) override;
+		PrCore::Resources::IResourceDataPtr LoadCookedResource(const std::string& p_path, const std::vector<uint8_t>& p_payload) override;
 	};
 }
\ No newline at end of file
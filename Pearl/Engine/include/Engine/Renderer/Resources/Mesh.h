@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core/Resources/IResource.h"
+#include "Core/Utils/CopyOnWrite.h"
 
 #include "Renderer/Core/Defines.h"
 #include "Renderer/Core/Color.h"
@@ -41,14 +42,18 @@ namespace PrRenderer::Resources {
 		Line
 	};
 
+	// Copies share the vertex streams and the buffers, setting a stream of the copy replaces it for the copy only
 	class Mesh : public PrCore::Resources::IResourceData {
 	public:
-		using UVArray = std::array<std::vector<PrCore::Math::vec2>, 8>;
+		template<typename T>
+		using Stream = PrCore::Utils::CopyOnWrite<std::vector<T>>;
+		using UVArray = std::array<Stream<PrCore::Math::vec2>, 8>;
 
 		Mesh() :
 			m_indicesCount(0),
 			m_verticesCount(0),
-			m_stateChanged(false)
+			m_stateChanged(false),
+			m_hasBoxVolume(false)
 		{}
 
 		virtual void Bind() = 0;
@@ -56,18 +61,21 @@ namespace PrRenderer::Resources {
 
 		inline const std::shared_ptr<Buffers::VertexArray>& GetVertexArray() const { return m_VA; }
 
-		inline const std::vector<PrCore::Math::vec3>& GetVertices() const { return m_vertices; }
+		inline const std::vector<PrCore::Math::vec3>& GetVertices() const { return *m_vertices; }
 		inline size_t                                 GetVerticesCount() const { return m_verticesCount; }
 
-		inline const std::vector<unsigned int>& GetIndices() const { return m_indices; }
+		inline const std::vector<unsigned int>& GetIndices() const { return *m_indices; }
 		inline size_t                           GetIndicesCount() const { return m_indicesCount; }
 
-		inline const std::vector<Core::Color>&        GetColors() const { return m_colors; }
-		inline const std::vector<PrCore::Math::vec3>& GetNormals() const { return m_normals; }
-		inline const std::vector<PrCore::Math::vec4>& GetTangents() const { return m_tangents; }
+		inline const std::vector<Core::Color>&        GetColors() const { return *m_colors; }
+		inline const std::vector<PrCore::Math::vec3>& GetNormals() const { return *m_normals; }
+		inline const std::vector<PrCore::Math::vec4>& GetTangents() const { return *m_tangents; }
 
 		inline const Core::BoxVolume& GetBoxVolume() { return m_boxVolume; }
 
+		// Precomputed bounds, kept until the vertices are set again
+		void SetBoxVolume(const Core::BoxVolume& p_boxVolume);
+
 		// Submesh is always al least 1 in size, it contains a submesh covering whole vertexArray in that case
 		size_t                        GetSubmeshCount() { return m_submeshes.size(); }
 		const SubMesh&                GetSubmesh(size_t p_index);
@@ -99,20 +107,21 @@ namespace PrRenderer::Resources {
 		static MeshPtr CreatePrimitive(PrimitiveType p_primitiveType);
 
 		size_t GetByteSize() const override;
+		void   ForEachBlock(const BlockVisitor& p_visitor) const override;
 
 	protected:
 		std::vector<PrCore::Math::vec4> CalculateTangents();
 		std::vector<PrCore::Math::vec3> CalculateNormals();
 		PrCore::Math::vec4 GenerateTangent(int a, int b, int c);
 
-		std::vector<unsigned int>             m_indices;
+		Stream<unsigned int>                  m_indices;
 		size_t                                m_indicesCount;
 
-		std::vector<PrCore::Math::vec3>       m_vertices;
+		Stream<PrCore::Math::vec3>            m_vertices;
 		size_t                                m_verticesCount;
-		std::vector<Core::Color>              m_colors;
-		std::vector<PrCore::Math::vec3>       m_normals;
-		std::vector<PrCore::Math::vec4>       m_tangents;
+		Stream<Core::Color>                   m_colors;
+		Stream<PrCore::Math::vec3>            m_normals;
+		Stream<PrCore::Math::vec4>            m_tangents;
 
 		std::vector<SubMesh>                  m_submeshes;
 
@@ -124,6 +133,7 @@ namespace PrRenderer::Resources {
 		std::shared_ptr<Buffers::VertexArray> m_VA;
 
 		Core::BoxVolume                       m_boxVolume;
+		bool                                  m_hasBoxVolume;
 
 	private:
 		// Add later
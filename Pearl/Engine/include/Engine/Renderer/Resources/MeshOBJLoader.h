@@ -9,6 +9,17 @@ namespace PrRenderer::Resources {
 	public:
 		PrCore::Resources::IResourceDataPtr LoadResource(const std::string& p_path) override;
 
+		// Cooked mesh or OBJ is decoded on a worker, mesh buffers are created in FinalizeResource
+		bool SupportsAsyncLoad() const override { return true; }
+		PrCore::Resources::IResourceStagingDataPtr LoadResourceAsync(const std::string& p_path) override;
+		PrCore::Resources::IResourceDataPtr FinalizeResource(PrCore::Resources::IResourceStagingDataPtr p_stagingData, const std::string& p_path) override;
+
+		bool CookResource(const std::string& p_path) override;
+
+		// Cooked mesh kept by the compressed residency tier
+		bool ReadCookedPayload(const std::string& p_path, std::vector<uint8_t>& p_payload) override;
+		PrCore::Resources::IResourceStagingDataPtr LoadCookedResourceAsync(const std::string& p_path, const std::vector<uint8_t>& p_payload) override;
+
 		void UnloadResource(PrCore::Resources::IResourceDataPtr p_resourceData) override;
 
 		bool SaveResourceOnDisc(PrCore::Resources::IResourceDataPtr p_resourceData, const std::string& p_path) override;
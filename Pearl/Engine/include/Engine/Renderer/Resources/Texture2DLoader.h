@@ -20,6 +20,17 @@ namespace PrRenderer::Resources {
 
 		IResourceDataPtr LoadResource(const std::string& p_path) override;
 
+		// File read and decode run on a worker, texture is created and uploaded in FinalizeResource
+		bool SupportsAsyncLoad() const override { return true; }
+		IResourceStagingDataPtr LoadResourceAsync(const std::string& p_path) override;
+		IResourceDataPtr FinalizeResource(IResourceStagingDataPtr p_stagingData, const std::string& p_path) override;
+
+		bool CookResource(const std::string& p_path) override;
+
+		// Cooked texture kept by the compressed residency tier
+		bool ReadCookedPayload(const std::string& p_path, std::vector<uint8_t>& p_payload) override;
+		IResourceStagingDataPtr LoadCookedResourceAsync(const std::string& p_path, const std::vector<uint8_t>& p_payload) override;
+
 		IResourceDataPtr LoadFromMemoryResource(const void* p_buffer, size_t p_size, int p_flags = 0);
 
 		void UnloadResource(IResourceDataPtr p_resourceData) override;
@@ -226,15 +226,27 @@ void EntityManager::OnDeserialize(const Utils::JSON::json& p_serialized)
 	}
 }
 
+void EntityManager::GatherResources(const Utils::JSON::json& p_serialized, std::vector<Resources::ResourceDependency>& p_resources)
+{
+	for (auto& entityJSON : p_serialized)
+	{
+		for (auto& componentJSON : entityJSON["components"])
+		{
+			std::string componentType = componentJSON["componentType"];
+			GatherComponentResources(componentType, componentJSON, p_resources);
+		}
+	}
+}
+
 void EntityManager::FireEntityCreated(Entity p_entity)
 {
-	Events::EventPtr event = std::make_shared<Events::EntityCreatedEvent>(p_entity);
+	Events::EntityCreatedEvent event(p_entity);
 	Events::EventManager::GetInstance().FireEvent(event);
 }
 
 void EntityManager::FireEntityDestoryed(Entity p_entity)
 {
-	Events::EventPtr event = std::make_shared<Events::EntityDestroyedEvent>(p_entity);
+	Events::EntityDestroyedEvent event(p_entity);
 	Events::EventManager::GetInstance().FireEvent(event);
 }
 
@@ -3,6 +3,8 @@
 #include"Core/ECS/SceneManager.h"
 #include"Core/File/FileSystem.h"
 #include"Core/ECS/Scene.h"
+#include"Core/ECS/EntityManager.h"
+#include"Core/Resources/ResourceSystem.h"
 
 using namespace PrCore::ECS;
 
@@ -56,9 +58,17 @@ Scene* SceneManager::LoadScene(const std::string& p_path)
 
 	auto sceneJSON = Utils::JSON::json::parse(dataVector);
 
+	// Start loading every referenced resource in one batch, the entities are built while the loads run
+	std::vector<PrCore::Resources::ResourceDependency> sceneResources;
+	EntityManager::GatherResources(sceneJSON["entities"], sceneResources);
+	auto preload = PrCore::Resources::ResourceSystem::GetInstance().Preload(sceneResources);
+
 	auto scene = CreateScene("");
 	scene->OnDeserialize(sceneJSON);
 
+	// Component handles joined the preloaded loads
+	PrCore::Resources::ResourceSystem::GetInstance().WaitForPreload(preload);
+
 	m_activeScene = scene;
 
 	return scene;
@@ -5,18 +5,22 @@
 #include"Core/Utils/Logger.h"
 #include"Core/Utils/Clock.h"
 #include"Core/Utils/PathUtils.h"
+#include "Core/Memory/FrameAllocator.h"
 #include "Core/File/ConfigFile.h"
 #include "Core/File/FileSystem.h"
 #include "Core/ECS/SceneManager.h"
 #include "Core/Threading/ThreadSystem.h"
 #include "Core/Threading/JobSystem.h"
 
+#include <filesystem>
+
 #include"Renderer/Core/DeferRenderFrontend.h"
 #include"Renderer/Core/RenderSystem.h"
 #include"Renderer/OpenGL/GLContext.h"
 
 #include "Core/Resources/ResourceDatabase.h"
 
+#include "Core/Resources/CookedAsset.h"
 #include "Core/Resources/ResourceSystem.h"
 #include "Renderer/Resources/Shader.h"
 #include "Renderer/Resources/Cubemap.h"
@@ -34,6 +38,8 @@
 
 const std::string_view GraphicConfig{ "config/graphic.cfg" };
 const std::string_view RendererConfig{ "config/renderer.cfg" };
+const std::string_view EngineConfig{ "config/engine.cfg" };
+const std::string_view AssetRegistryFile{ "config/assetRegistry.json" };
 
 PrCore::Entry::AppContext::AppContext()
 {
@@ -42,17 +48,13 @@ PrCore::Entry::AppContext::AppContext()
 
 	Utils::Logger::Init();
 	Utils::Clock::Init();
+	Memory::FrameAllocator::Init();
 	PRLOG_INFO("Building AppContext");
 
 
 
 	//Init Engine Subsystems
 
-	//-----------------------
-	// Init threading
-	Threading::ThreadSystem::Init();
-	Threading::JobSystem::Init(10);
-
 	//-----------------------
 	// Init File System
 	std::string_view engineAssetsPath = "EngineAssets";
@@ -76,8 +78,55 @@ PrCore::Entry::AppContext::AppContext()
 	filePtr->MountDir(gameAssets);
 	filePtr->SetWriteDir(gameAssets);
 
+	// Packs built from the asset directories, loose files in the directories override the packed ones
+	for (auto& assetsPath : { engineAssets, gameAssets })
+	{
+		auto packPath = assetsPath + ".prpak";
+		std::error_code error;
+		if (std::filesystem::is_regular_file(packPath, error))
+			filePtr->OpenArchive(packPath);
+	}
+
+	File::ConfigFile engineConfig;
+	bool engineConfigOpened = engineConfig.OpenFromFile(EngineConfig);
+
+	//-----------------------
+	// Init threading, worker numbers left as zero are derived from the CPU topology
+	Threading::ThreadSystem::Init();
+	{
+		Threading::JobSystemSettings jobSystemSettings;
+		if (engineConfigOpened)
+		{
+			engineConfig.GET_CONFIG_SETTING_NAME(jobSystemSettings, workerNumber);
+			engineConfig.GET_CONFIG_SETTING_NAME(jobSystemSettings, backgroundWorkerNumber);
+			engineConfig.GET_CONFIG_SETTING_NAME(jobSystemSettings, reservedThreads);
+			engineConfig.GET_CONFIG_SETTING_NAME(jobSystemSettings, pinWorkers);
+		}
+
+		Threading::JobSystem::Init(jobSystemSettings);
+	}
+
 	Events::EventManager::Init();
 	Resources::ResourceSystem::Init();
+	Resources::ResourceSystem::GetInstance().GetAssetRegistry().OpenFromFile(AssetRegistryFile);
+
+	// Assets written on disk are reloaded while the engine runs, without the setting it is off in builds without asserts
+#ifdef PR_ASSERTENABLE
+	bool watchAssets = true;
+#else
+	bool watchAssets = false;
+#endif
+	{
+		// Loaders write the cooked files of the sources they parse, shipped builds load the cooked files only
+		bool cookOnLoad = true;
+		if (engineConfigOpened)
+		{
+			engineConfig.GetSetting("cookOnLoad", cookOnLoad);
+			engineConfig.GetSetting("watchAssets", watchAssets);
+		}
+
+		Resources::CookedAsset::SetCookOnLoad(cookOnLoad);
+	}
 
 	//-----------------------
 	// Init Resource System
@@ -106,6 +155,12 @@ PrCore::Entry::AppContext::AppContext()
 		cubemapDatabase->RegisterLoader(".cubemap", std::make_unique<BasicCubemapLoader>());
 		cubemapDatabase->RegisterLoader(".hdr", std::make_unique<HdrCubemapLoader>());
 		ResourceSystem::GetInstance().RegisterDatabase<Cubemap>(std::move(cubemapDatabase));
+
+		if (watchAssets)
+		{
+			ResourceSystem::GetInstance().WatchDirectory(engineAssets);
+			ResourceSystem::GetInstance().WatchDirectory(gameAssets);
+		}
 	}
 	//-----------------------
 
@@ -214,10 +269,15 @@ PrCore::Entry::AppContext::~AppContext()
 	delete m_rendererContext;
 	delete m_window;
 	Windowing::GLWindow::TerminateDevice();
+
+	auto& assetRegistry = Resources::ResourceSystem::GetInstance().GetAssetRegistry();
+	if (assetRegistry.IsDirty())
+		assetRegistry.SaveToFile(AssetRegistryFile);
 	Resources::ResourceSystem::Terminate();
 	Events::EventManager::Terminate();
 	File::FileSystem::Terminate();
 	Threading::JobSystem::Terminate();
 	Threading::ThreadSystem::Terminate();
+	Memory::FrameAllocator::Terminate();
 	Utils::Clock::Terminate();
 }
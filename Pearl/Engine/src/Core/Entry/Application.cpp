@@ -5,6 +5,8 @@
 #include"Core/Events/WindowEvents.h"
 #include"Core/Events/EventManager.h"
 #include"Core/Utils/Clock.h"
+#include"Core/Memory/FrameAllocator.h"
+#include"Core/Resources/ResourceSystem.h"
 
 using namespace PrCore::Entry;
 
@@ -19,6 +21,9 @@ void Application::Run()
 {
 	while (!m_shouldClose)
 	{
+		// Resources finished by the loading jobs are available for the whole frame
+		Resources::ResourceSystem::GetInstance().Update();
+
 		PreFrame();
 		if (!m_minimalized)
 			OnFrame(Utils::Clock::GetInstance().GetUnscaledDeltaTime());
@@ -26,6 +31,7 @@ void Application::Run()
 
 		//PRLOG_INFO("{0}", gameClock.GetRealTime());
 		Utils::Clock::GetInstance().Tick();
+		Memory::FrameAllocator::GetInstance().NewFrame();
 	}
 }
 
@@ -47,6 +53,6 @@ void Application::OnWindowClose(Events::EventPtr p_event)
 
 void Application::OnWindowMinimalized(Events::EventPtr p_event)
 {
-	auto minimalizeEvent = std::static_pointer_cast<Events::WindowMinimalizeEvent>(p_event);
+	auto minimalizeEvent = static_cast<Events::WindowMinimalizeEvent*>(p_event);
 	m_minimalized = minimalizeEvent->m_minimalized;
 }
@@ -0,0 +1,19 @@
+#include"Core/Common/pearl_pch.h"
+
+#include"Core/Events/Event.h"
+
+#include<mutex>
+
+namespace PrCore::Events {
+
+	EventTypeIndex RegisterEventType(EventType p_type)
+	{
+		// Called once per event type, types register from any thread on their first use
+		static std::mutex s_typesLock;
+		static std::unordered_map<EventType, EventTypeIndex> s_types;
+
+		std::lock_guard lock{ s_typesLock };
+		auto [it, inserted] = s_types.try_emplace(p_type, static_cast<EventTypeIndex>(s_types.size()));
+		return it->second;
+	}
+}
@@ -6,12 +6,18 @@
 using namespace PrCore::Events;
 
 EventManager::EventManager() :
-	m_activeQueue(0)
+	m_mainThreadId(std::this_thread::get_id())
 {}
 
 bool EventManager::AddListener(const EventListener& p_listener, EventType p_type)
 {
-	auto& eventListenerList = m_eventMap[p_type];
+	PR_ASSERT(std::this_thread::get_id() == m_mainThreadId, "AddListener is main thread only");
+
+	auto typeIndex = RegisterEventType(p_type);
+	if (typeIndex >= m_listeners.size())
+		m_listeners.resize(typeIndex + 1);
+
+	auto& eventListenerList = m_listeners[typeIndex];
 
 	for (auto& eventListener : eventListenerList)
 	{
@@ -29,75 +35,51 @@ bool EventManager::AddListener(const EventListener& p_listener, EventType p_type
 
 bool EventManager::RemoveListener(const EventListener& p_listener, EventType p_type)
 {
-	auto findListener = m_eventMap.find(p_type);
-	if (findListener != m_eventMap.end())
+	PR_ASSERT(std::this_thread::get_id() == m_mainThreadId, "RemoveListener is main thread only");
+
+	auto typeIndex = RegisterEventType(p_type);
+	if (typeIndex >= m_listeners.size())
+		return false;
+
+	auto& eventListeners = m_listeners[typeIndex];
+	for (auto it = eventListeners.cbegin(); it != eventListeners.cend(); ++it)
 	{
-		auto& eventListeners = findListener->second;
-		for (auto it = eventListeners.cbegin(); it!= eventListeners.cend(); ++it)
+		if (p_listener == *it)
 		{
-			if (p_listener == *it)
-			{
-				eventListeners.erase(it);
-				if (eventListeners.empty())
-					m_eventMap.erase(p_type);
-				return true;
-			}
+			eventListeners.erase(it);
+			return true;
 		}
 	}
 
 	return false;
 }
 
-bool EventManager::FireEvent(EventPtr& p_event)
+bool EventManager::FireEvent(Event& p_event)
 {
-	bool sucess = false;
+	PR_ASSERT(std::this_thread::get_id() == m_mainThreadId, "FireEvent is main thread only, use QueueEvent");
 
-	auto findListener = m_eventMap.find(p_event->GetType());
-	if (findListener != m_eventMap.end())
-	{
-		const auto& eventListenerList = findListener->second;
-		for (EventListener listener : eventListenerList)
-		{
-			listener(p_event);
-			sucess = true;
-		}
-
-	}
-
-	return sucess;
+	return Dispatch(&p_event);
 }
 
-bool EventManager::QueueEvent(EventPtr& p_event)
+void EventManager::Update()
 {
-	auto findListener = m_eventMap.find(p_event->GetType());
-	if (findListener != m_eventMap.end())
-	{
-		m_eventQueue[m_activeQueue].push_back(p_event);
-		return true;
-	}
+	PR_ASSERT(std::this_thread::get_id() == m_mainThreadId, "Update is main thread only");
 
-	return false;
+	m_eventQueue.Drain([this](EventPtr p_event) {
+		Dispatch(p_event);
+		});
 }
 
-void EventManager::Update()
+bool EventManager::Dispatch(EventPtr p_event)
 {
-	auto queueToProcess = m_activeQueue;
-	m_activeQueue = (++m_activeQueue) % EVENTQUEUE_NUM;
-	m_eventQueue[m_activeQueue].clear();
-
-	while (!m_eventQueue[queueToProcess].empty())
-	{
-		auto eventToProcess = m_eventQueue[queueToProcess].front();
-		m_eventQueue[queueToProcess].pop_front();
+	auto typeIndex = p_event->GetTypeIndex();
+	if (typeIndex >= m_listeners.size())
+		return false;
 
-		auto eventType = eventToProcess->GetType();
+	// Listeners may register while dispatching and reallocate the table, so it is indexed every iteration
+	size_t listenerIndex = 0;
+	for (; listenerIndex < m_listeners[typeIndex].size(); listenerIndex++)
+		m_listeners[typeIndex][listenerIndex](p_event);
 
-		auto findListener = m_eventMap.find(eventType);
-		if (findListener != m_eventMap.end())
-		{
-			auto& eventListeners = findListener->second;
-			for (auto& listener : eventListeners)
-				listener(eventToProcess);
-		}
-	}
-}
\ No newline at end of file
+	return listenerIndex > 0;
+}
@@ -0,0 +1,131 @@
+#include"Core/Common/pearl_pch.h"
+
+#include"Core/Events/EventQueue.h"
+
+using namespace PrCore::Events;
+
+namespace {
+	std::atomic<uint64_t> g_nextInstanceId = 1;
+
+	size_t RoundUpToPowerOfTwo(size_t p_value)
+	{
+		size_t result = 1;
+		while (result < p_value)
+			result <<= 1;
+
+		return result;
+	}
+}
+
+thread_local EventQueue::ThreadCache EventQueue::s_threadCache;
+thread_local PrCore::Memory::LinearAllocator* EventQueue::s_eventArena = nullptr;
+
+EventQueue::Producer::Producer(size_t p_capacity, std::thread::id p_threadId) :
+	ring(RoundUpToPowerOfTwo(p_capacity)),
+	mask(RoundUpToPowerOfTwo(p_capacity) - 1),
+	threadId(p_threadId),
+	head(0),
+	tail(0),
+	hasOverflow(false),
+	emplaceEpoch(0),
+	activeArena(0)
+{
+	for (auto& arena : arenas)
+		arena = std::make_unique<Memory::LinearAllocator>(g_eventArenaCapacity);
+}
+
+bool EventQueue::Producer::TryPush(const QueuedEvent& p_event)
+{
+	size_t currentTail = tail.load(std::memory_order_relaxed);
+	if (currentTail - head.load(std::memory_order_acquire) >= ring.size())
+		return false;
+
+	ring[currentTail & mask] = p_event;
+	tail.store(currentTail + 1, std::memory_order_release);
+	return true;
+}
+
+void EventQueue::Producer::WaitForEmplace() const
+{
+	auto epoch = emplaceEpoch.load(std::memory_order_seq_cst);
+	if ((epoch & 1) == 0)
+		return;
+
+	while (emplaceEpoch.load(std::memory_order_acquire) == epoch)
+		std::this_thread::yield();
+}
+
+EventQueue::EventQueue(size_t p_producerCapacity) :
+	m_producerCount(0),
+	m_sharedActiveArena(0),
+	m_producerCapacity(p_producerCapacity),
+	m_instanceId(g_nextInstanceId++)
+{
+	PR_ASSERT(p_producerCapacity > 0, "EventQueue producer capacity is 0");
+
+	for (auto& arena : m_sharedArenas)
+		arena = std::make_unique<Memory::LinearAllocator>(g_eventArenaCapacity);
+}
+
+std::string_view EventQueue::CopyString(std::string_view p_string)
+{
+	return s_eventArena ? s_eventArena->CopyString(p_string) : p_string;
+}
+
+void EventQueue::PushToProducer(Producer* p_producer, const QueuedEvent& p_event)
+{
+	if (p_producer == nullptr)
+	{
+		// Threads above the limit share the overflow of the first producer
+		p_producer = m_producers[0].get();
+	}
+	else if (!p_producer->hasOverflow.load(std::memory_order_acquire) && p_producer->TryPush(p_event))
+	{
+		return;
+	}
+
+	std::lock_guard lock{ p_producer->overflowLock };
+	p_producer->overflow.push_back(p_event);
+	p_producer->hasOverflow.store(true, std::memory_order_release);
+}
+
+void EventQueue::Clear()
+{
+	Drain([](EventPtr) {});
+}
+
+EventQueue::Producer* EventQueue::GetThreadProducer()
+{
+	if (s_threadCache.instanceId == m_instanceId)
+		return s_threadCache.producer;
+
+	std::lock_guard lock{ m_producersLock };
+
+	// Thread may have been registered before it pushed to another queue
+	auto threadId = std::this_thread::get_id();
+	size_t producerCount = m_producerCount.load(std::memory_order_relaxed);
+	Producer* producer = nullptr;
+	for (size_t i = 0; i < producerCount; i++)
+	{
+		if (m_producers[i]->threadId == threadId)
+		{
+			producer = m_producers[i].get();
+			break;
+		}
+	}
+
+	if (producer == nullptr && producerCount == g_maxEventProducers)
+	{
+		PRLOG_WARN("EventQueue reached {} producer threads, further threads use the locked overflow", g_maxEventProducers);
+	}
+	else if (producer == nullptr)
+	{
+		m_producers[producerCount] = std::make_unique<Producer>(m_producerCapacity, threadId);
+		producer = m_producers[producerCount].get();
+		m_producerCount.store(producerCount + 1, std::memory_order_release);
+	}
+
+	s_threadCache.instanceId = m_instanceId;
+	s_threadCache.producer = producer;
+	return producer;
+}
@@ -1,6 +1,7 @@
 #include "Core/Common/pearl_pch.h"
 
 #include "Core/File/FileSystem.h"
+#include "Core/File/PackFile.h"
 #include "physfs/physfs.h"
 
 using namespace PrCore::File;
@@ -13,6 +14,7 @@ PHYSFS_File* ToPhys(FileHandle p_handle)
 FileSystem::FileSystem()
 {
 	PHYSFS_init(NULL);
+	RegisterPackArchiver();
 }
 
 FileSystem::~FileSystem()
@@ -30,9 +32,9 @@ void PrCore::File::FileSystem::PrintError()
 	}
 }
 
-void FileSystem::MountDir(std::string_view p_path, std::string_view p_mountPoint)
+void FileSystem::MountDir(std::string_view p_path, std::string_view p_mountPoint, bool p_highestPriority)
 {
-	if(!PHYSFS_mount(p_path.data(), p_mountPoint.data(), 1))
+	if(!PHYSFS_mount(p_path.data(), p_mountPoint.data(), !p_highestPriority))
 		PrintError();
 }
 
@@ -42,9 +44,9 @@ void FileSystem::UnmountDir(std::string_view p_path)
 		PrintError();
 }
 
-void FileSystem::OpenArchive(std::string_view p_path, std::string_view p_mountPoint)
+void FileSystem::OpenArchive(std::string_view p_path, std::string_view p_mountPoint, bool p_highestPriority)
 {
-	if(!PHYSFS_mount(p_path.data(), p_mountPoint.data(), 1))
+	if(!PHYSFS_mount(p_path.data(), p_mountPoint.data(), !p_highestPriority))
 		PrintError();
 }
 
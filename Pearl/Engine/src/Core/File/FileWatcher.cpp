@@ -0,0 +1,291 @@
+#include "Core/Common/pearl_pch.h"
+
+#include "Core/File/FileWatcher.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+using namespace PrCore::File;
+
+namespace {
+	std::string RootKey(const std::filesystem::path& p_dirPath)
+	{
+		std::error_code error;
+		auto rootPath = std::filesystem::absolute(p_dirPath, error).lexically_normal().generic_string();
+		while (rootPath.size() > 1 && rootPath.back() == '/')
+			rootPath.pop_back();
+
+		return rootPath;
+	}
+
+#ifdef __linux__
+	// Written files are reported when closed, so a reload never reads a half written file
+	constexpr uint32_t g_notifyMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+#endif
+}
+
+FileWatcher::FileWatcher(bool p_forcePolling /*= false*/) :
+	m_notifyHandle(-1),
+	m_pollInterval(std::chrono::milliseconds(500)),
+	m_lastPoll()
+{
+#ifdef __linux__
+	if (!p_forcePolling)
+	{
+		m_notifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_notifyHandle < 0)
+			PRLOG_WARN("FileWatcher cannot initialize inotify, errno {0}. Falling back to polling.", errno);
+	}
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+	if (m_notifyHandle >= 0)
+		close(m_notifyHandle);
+#endif
+}
+
+void FileWatcher::Watch(std::string_view p_dirPath, std::string_view p_mountPoint /*= "/"*/)
+{
+	std::filesystem::path dirPath{ p_dirPath };
+	std::error_code error;
+	if (!std::filesystem::is_directory(dirPath, error))
+	{
+		PRLOG_WARN("FileWatcher cannot watch \"{0}\". Directory does not exist.", p_dirPath);
+		return;
+	}
+
+	auto rootKey = RootKey(dirPath);
+	if (m_dirs.find(rootKey) != m_dirs.end())
+	{
+		PRLOG_WARN("FileWatcher already watches \"{0}\".", p_dirPath);
+		return;
+	}
+
+	WatchedDir& watchedDir = m_dirs[rootKey];
+	watchedDir.root = rootKey;
+
+	// Mount point "/" maps the directory to the root paths
+	auto mountPoint = p_mountPoint;
+	while (!mountPoint.empty() && mountPoint.front() == '/')
+		mountPoint.remove_prefix(1);
+	while (!mountPoint.empty() && mountPoint.back() == '/')
+		mountPoint.remove_suffix(1);
+	if (!mountPoint.empty())
+		watchedDir.mountPrefix = std::string(mountPoint) + '/';
+
+	if (IsPolling())
+		ScanDir(watchedDir, nullptr);
+	else
+		AddNotifyWatches(rootKey, watchedDir.root, nullptr);
+}
+
+void FileWatcher::Unwatch(std::string_view p_dirPath)
+{
+	auto rootKey = RootKey(std::filesystem::path{ p_dirPath });
+	auto dirIt = m_dirs.find(rootKey);
+	if (dirIt == m_dirs.end())
+	{
+		PRLOG_WARN("FileWatcher does not watch \"{0}\". Cannot unwatch the directory.", p_dirPath);
+		return;
+	}
+
+	if (!IsPolling())
+		RemoveNotifyWatches(rootKey);
+
+	m_dirs.erase(dirIt);
+}
+
+std::vector<FileChange> FileWatcher::PollChanges()
+{
+	std::vector<FileChange> changes;
+	if (IsPolling())
+	{
+		auto now = std::chrono::steady_clock::now();
+		if (now - m_lastPoll < m_pollInterval)
+			return changes;
+
+		m_lastPoll = now;
+		for (auto& [_, watchedDir] : m_dirs)
+			ScanDir(watchedDir, &changes);
+	}
+	else
+	{
+		PollNotifications(changes);
+	}
+
+	// Editors write a file in many steps, report it once
+	std::sort(changes.begin(), changes.end());
+	changes.erase(std::unique(changes.begin(), changes.end()), changes.end());
+
+	return changes;
+}
+
+FileChange FileWatcher::MakeChange(const WatchedDir& p_dir, const std::filesystem::path& p_filePath) const
+{
+	return { p_dir.mountPrefix + p_filePath.lexically_relative(p_dir.root).generic_string(), p_filePath.generic_string() };
+}
+
+void FileWatcher::ScanDir(WatchedDir& p_dir, std::vector<FileChange>* p_changes)
+{
+	std::map<std::string, FileStamp> files;
+
+	std::error_code error;
+	auto options = std::filesystem::directory_options::skip_permission_denied;
+	for (auto it = std::filesystem::recursive_directory_iterator(p_dir.root, options, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+	{
+		std::error_code entryError;
+		if (!it->is_regular_file(entryError))
+			continue;
+
+		FileStamp stamp;
+		stamp.writeTime = it->last_write_time(entryError);
+		stamp.size = it->file_size(entryError);
+		if (entryError)
+			continue;
+
+		auto filePath = it->path().generic_string();
+		if (p_changes)
+		{
+			auto previousIt = p_dir.files.find(filePath);
+			if (previousIt == p_dir.files.end() || !(previousIt->second == stamp))
+				p_changes->push_back(MakeChange(p_dir, it->path()));
+		}
+
+		files.emplace(std::move(filePath), stamp);
+	}
+
+	// Deleted files are dropped, the resources keep their data until they are unloaded
+	p_dir.files = std::move(files);
+}
+
+void FileWatcher::PollNotifications(std::vector<FileChange>& p_changes)
+{
+#ifdef __linux__
+	alignas(inotify_event) char buffer[4096];
+	bool overflowed = false;
+	while (true)
+	{
+		auto length = read(m_notifyHandle, buffer, sizeof(buffer));
+		if (length <= 0)
+		{
+			if (length < 0 && errno != EAGAIN && errno != EINTR)
+				PRLOG_WARN("FileWatcher cannot read inotify events, errno {0}.", errno);
+			break;
+		}
+
+		for (char* eventPtr = buffer; eventPtr < buffer + length;)
+		{
+			auto event = reinterpret_cast<const inotify_event*>(eventPtr);
+			eventPtr += sizeof(inotify_event) + event->len;
+
+			// Kernel queue overflowed and dropped events, the watched roots are rescanned below
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				overflowed = true;
+				continue;
+			}
+
+			auto watchIt = m_notifyWatches.find(event->wd);
+			if (watchIt == m_notifyWatches.end())
+				continue;
+
+			// Watch removed with its directory
+			if (event->mask & IN_IGNORED)
+			{
+				m_notifyWatches.erase(watchIt);
+				continue;
+			}
+
+			if (event->len == 0)
+				continue;
+
+			auto& [rootKey, dirPath] = watchIt->second;
+			auto dirIt = m_dirs.find(rootKey);
+			if (dirIt == m_dirs.end())
+				continue;
+
+			auto filePath = dirPath / event->name;
+			if (event->mask & IN_ISDIR)
+			{
+				// inotify is not recursive, new directories get their own watches
+				if (event->mask & (IN_CREATE | IN_MOVED_TO))
+					AddNotifyWatches(std::string(rootKey), filePath, &p_changes);
+				continue;
+			}
+
+			// Created files are reported with IN_CLOSE_WRITE once written
+			if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+				p_changes.push_back(MakeChange(dirIt->second, filePath));
+		}
+	}
+
+	if (overflowed)
+	{
+		PRLOG_WARN("FileWatcher inotify queue overflowed. Rescanning the watched directories.");
+
+		// Every file is reported since the dropped events are unknown, existing watches are kept by inotify_add_watch
+		for (auto& [rootKey, watchedDir] : m_dirs)
+			AddNotifyWatches(rootKey, watchedDir.root, &p_changes);
+	}
+#endif
+}
+
+void FileWatcher::AddNotifyWatches(const std::string& p_rootKey, const std::filesystem::path& p_dirPath, std::vector<FileChange>* p_changes)
+{
+#ifdef __linux__
+	auto addWatch = [this, &p_rootKey](const std::filesystem::path& p_path) {
+		int watchDescriptor = inotify_add_watch(m_notifyHandle, p_path.c_str(), g_notifyMask);
+		if (watchDescriptor < 0)
+		{
+			PRLOG_WARN("FileWatcher cannot watch \"{0}\", errno {1}.", p_path.generic_string(), errno);
+			return;
+		}
+
+		m_notifyWatches[watchDescriptor] = { p_rootKey, p_path };
+	};
+
+	addWatch(p_dirPath);
+
+	std::error_code error;
+	auto options = std::filesystem::directory_options::skip_permission_denied;
+	for (auto it = std::filesystem::recursive_directory_iterator(p_dirPath, options, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+	{
+		std::error_code entryError;
+		if (it->is_directory(entryError))
+		{
+			addWatch(it->path());
+		}
+		else if (p_changes && it->is_regular_file(entryError))
+		{
+			// Files written into a new directory before its watch was added
+			p_changes->push_back(MakeChange(m_dirs.at(p_rootKey), it->path()));
+		}
+	}
+#endif
+}
+
+void FileWatcher::RemoveNotifyWatches(const std::string& p_rootKey)
+{
+#ifdef __linux__
+	for (auto it = m_notifyWatches.begin(); it != m_notifyWatches.end();)
+	{
+		if (it->second.first == p_rootKey)
+		{
+			inotify_rm_watch(m_notifyHandle, it->first);
+			it = m_notifyWatches.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+#endif
+}
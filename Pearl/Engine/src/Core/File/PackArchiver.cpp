@@ -0,0 +1,261 @@
+#include "Core/Common/pearl_pch.h"
+
+#include "Core/File/PackFile.h"
+#include "physfs/physfs.h"
+
+using namespace PrCore::File;
+
+namespace {
+	// Open file of a pack, entries point into the mapping and compressed ones into their decompressed copy
+	struct PackStream
+	{
+		const uint8_t*                        data = nullptr;
+		uint64_t                              size = 0;
+		uint64_t                              position = 0;
+		std::shared_ptr<std::vector<uint8_t>> decompressed;
+	};
+
+	struct PackArchive
+	{
+		std::unique_ptr<PackFile> packFile;
+		PHYSFS_Io*                io = nullptr;
+	};
+
+	PackStream* GetStream(PHYSFS_Io* p_io)
+	{
+		return static_cast<PackStream*>(p_io->opaque);
+	}
+
+	PHYSFS_sint64 StreamRead(PHYSFS_Io* p_io, void* p_buffer, PHYSFS_uint64 p_length)
+	{
+		auto stream = GetStream(p_io);
+		auto length = std::min<uint64_t>(p_length, stream->size - stream->position);
+		if (length > 0)
+			std::memcpy(p_buffer, stream->data + stream->position, length);
+		stream->position += length;
+
+		return static_cast<PHYSFS_sint64>(length);
+	}
+
+	PHYSFS_sint64 StreamWrite(PHYSFS_Io*, const void*, PHYSFS_uint64)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+		return -1;
+	}
+
+	int StreamSeek(PHYSFS_Io* p_io, PHYSFS_uint64 p_offset)
+	{
+		auto stream = GetStream(p_io);
+		if (p_offset > stream->size)
+		{
+			PHYSFS_setErrorCode(PHYSFS_ERR_PAST_EOF);
+			return 0;
+		}
+
+		stream->position = p_offset;
+		return 1;
+	}
+
+	PHYSFS_sint64 StreamTell(PHYSFS_Io* p_io)
+	{
+		return static_cast<PHYSFS_sint64>(GetStream(p_io)->position);
+	}
+
+	PHYSFS_sint64 StreamLength(PHYSFS_Io* p_io)
+	{
+		return static_cast<PHYSFS_sint64>(GetStream(p_io)->size);
+	}
+
+	PHYSFS_Io* StreamDuplicate(PHYSFS_Io* p_io);
+
+	void StreamDestroy(PHYSFS_Io* p_io)
+	{
+		delete GetStream(p_io);
+		delete p_io;
+	}
+
+	PHYSFS_Io* CreateStream(PackStream p_stream)
+	{
+		auto io = new PHYSFS_Io();
+		io->version = 0;
+		io->opaque = new PackStream(std::move(p_stream));
+		io->read = StreamRead;
+		io->write = StreamWrite;
+		io->seek = StreamSeek;
+		io->tell = StreamTell;
+		io->length = StreamLength;
+		io->duplicate = StreamDuplicate;
+		io->flush = nullptr;
+		io->destroy = StreamDestroy;
+
+		return io;
+	}
+
+	PHYSFS_Io* StreamDuplicate(PHYSFS_Io* p_io)
+	{
+		// Copies share the bytes and have their own position
+		auto stream = *GetStream(p_io);
+		stream.position = 0;
+
+		return CreateStream(std::move(stream));
+	}
+
+	PackArchive* GetArchive(void* p_opaque)
+	{
+		return static_cast<PackArchive*>(p_opaque);
+	}
+
+	void* OpenArchive(PHYSFS_Io* p_io, const char* p_name, int p_forWrite, int* p_claimed)
+	{
+		PackHeader header;
+		if (p_io == nullptr || !p_io->seek(p_io, 0) || p_io->read(p_io, &header, sizeof(PackHeader)) != sizeof(PackHeader) ||
+			header.magic != PackFile::Magic)
+		{
+			return nullptr;
+		}
+
+		*p_claimed = 1;
+		if (p_forWrite)
+		{
+			PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+			return nullptr;
+		}
+
+		// Native files are mapped, packs from other sources are read to memory
+		auto packFile = PackFile::Open(p_name);
+		if (packFile == nullptr)
+		{
+			auto length = p_io->length(p_io);
+			std::vector<uint8_t> data(length > 0 ? static_cast<size_t>(length) : 0);
+			if (length > 0 && p_io->seek(p_io, 0) && p_io->read(p_io, data.data(), data.size()) == length)
+				packFile = PackFile::OpenFromMemory(std::move(data));
+		}
+
+		if (packFile == nullptr)
+		{
+			PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+			return nullptr;
+		}
+
+		// Archive owns the io once opened
+		return new PackArchive{ std::move(packFile), p_io };
+	}
+
+	PHYSFS_EnumerateCallbackResult Enumerate(void* p_opaque, const char* p_dirName, PHYSFS_EnumerateCallback p_callback, const char* p_origDir, void* p_callbackData)
+	{
+		auto& packFile = *GetArchive(p_opaque)->packFile;
+		for (auto& name : packFile.EnumerateDirectory(p_dirName))
+		{
+			auto result = p_callback(p_callbackData, p_origDir, name.c_str());
+			if (result == PHYSFS_ENUM_ERROR)
+				PHYSFS_setErrorCode(PHYSFS_ERR_APP_CALLBACK);
+			if (result != PHYSFS_ENUM_OK)
+				return result;
+		}
+
+		return PHYSFS_ENUM_OK;
+	}
+
+	PHYSFS_Io* OpenRead(void* p_opaque, const char* p_fileName)
+	{
+		auto& packFile = *GetArchive(p_opaque)->packFile;
+		auto entry = packFile.Find(p_fileName);
+		if (entry == nullptr)
+		{
+			PHYSFS_setErrorCode(packFile.IsDirectory(p_fileName) ? PHYSFS_ERR_NOT_A_FILE : PHYSFS_ERR_NOT_FOUND);
+			return nullptr;
+		}
+
+		PackStream stream;
+		stream.size = entry->size;
+		if (entry->flags & PackEntryCompressed)
+		{
+			stream.decompressed = std::make_shared<std::vector<uint8_t>>();
+			if (!packFile.Read(*entry, *stream.decompressed))
+			{
+				PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+				return nullptr;
+			}
+
+			stream.data = stream.decompressed->data();
+		}
+		else
+		{
+			stream.data = packFile.GetData(*entry);
+		}
+
+		return CreateStream(std::move(stream));
+	}
+
+	PHYSFS_Io* OpenWrite(void*, const char*)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+		return nullptr;
+	}
+
+	int Remove(void*, const char*)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+		return 0;
+	}
+
+	int Stat(void* p_opaque, const char* p_fileName, PHYSFS_Stat* p_stat)
+	{
+		auto& packFile = *GetArchive(p_opaque)->packFile;
+
+		*p_stat = PHYSFS_Stat{};
+		p_stat->modtime = -1;
+		p_stat->createtime = -1;
+		p_stat->accesstime = -1;
+		p_stat->readonly = 1;
+
+		if (auto entry = packFile.Find(p_fileName))
+		{
+			p_stat->filesize = static_cast<PHYSFS_sint64>(entry->size);
+			p_stat->filetype = PHYSFS_FILETYPE_REGULAR;
+			return 1;
+		}
+
+		if (packFile.IsDirectory(p_fileName))
+		{
+			p_stat->filesize = 0;
+			p_stat->filetype = PHYSFS_FILETYPE_DIRECTORY;
+			return 1;
+		}
+
+		PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+		return 0;
+	}
+
+	void CloseArchive(void* p_opaque)
+	{
+		auto archive = GetArchive(p_opaque);
+		archive->io->destroy(archive->io);
+		delete archive;
+	}
+
+	const PHYSFS_Archiver g_packArchiver = {
+		0,
+		{ "PRPAK", "Pearl Engine asset pack", "Pearl Engine", "", 0 },
+		OpenArchive,
+		Enumerate,
+		OpenRead,
+		OpenWrite,
+		OpenWrite,
+		Remove,
+		Remove,
+		Stat,
+		CloseArchive
+	};
+}
+
+bool PrCore::File::RegisterPackArchiver()
+{
+	if (!PHYSFS_registerArchiver(&g_packArchiver))
+	{
+		PRLOG_ERROR("Cannot register pack archiver: {}", PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()));
+		return false;
+	}
+
+	return true;
+}
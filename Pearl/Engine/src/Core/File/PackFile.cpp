@@ -0,0 +1,521 @@
+#include "Core/Common/pearl_pch.h"
+
+#include "Core/File/PackFile.h"
+#include "Core/Utils/Compression.h"
+#include "Core/Utils/PathUtils.h"
+
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+using namespace PrCore::File;
+
+namespace {
+	inline char NormalizeChar(char p_char)
+	{
+		return p_char == '\\' ? '/' : static_cast<char>(std::tolower(static_cast<unsigned int>(p_char)));
+	}
+
+	// Pack paths are relative, PhysFS paths are too but the engine paths may start with a slash
+	std::string_view TrimPath(std::string_view p_path)
+	{
+		while (!p_path.empty() && (p_path.front() == '/' || p_path.front() == '\\'))
+			p_path.remove_prefix(1);
+		while (!p_path.empty() && (p_path.back() == '/' || p_path.back() == '\\'))
+			p_path.remove_suffix(1);
+
+		return p_path;
+	}
+
+	bool StartsWithPath(std::string_view p_path, std::string_view p_prefix)
+	{
+		if (p_path.size() < p_prefix.size())
+			return false;
+
+		for (size_t i = 0; i < p_prefix.size(); i++)
+		{
+			if (NormalizeChar(p_path[i]) != NormalizeChar(p_prefix[i]))
+				return false;
+		}
+
+		return true;
+	}
+
+	bool IsSamePath(std::string_view p_path, std::string_view p_otherPath)
+	{
+		return p_path.size() == p_otherPath.size() && StartsWithPath(p_path, p_otherPath);
+	}
+
+	uint64_t AlignUp(uint64_t p_value, uint64_t p_alignment)
+	{
+		return (p_value + p_alignment - 1) & ~(p_alignment - 1);
+	}
+}
+
+PackFile::~PackFile()
+{
+	if (m_mapping == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_mapping);
+	CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+#else
+	munmap(m_mapping, m_size);
+#endif
+}
+
+std::unique_ptr<PackFile> PackFile::Open(std::string_view p_nativePath)
+{
+	std::string nativePath{ p_nativePath };
+	std::unique_ptr<PackFile> packFile{ new PackFile() };
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(nativePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		PRLOG_ERROR("Cannot open pack \"{0}\"", p_nativePath);
+		return nullptr;
+	}
+
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = nullptr;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	// Mapping keeps the file open
+	CloseHandle(file);
+	if (mapping == nullptr)
+	{
+		PRLOG_ERROR("Cannot map pack \"{0}\"", p_nativePath);
+		return nullptr;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		PRLOG_ERROR("Cannot map pack \"{0}\"", p_nativePath);
+		return nullptr;
+	}
+
+	packFile->m_mapping = view;
+	packFile->m_mappingHandle = mapping;
+	packFile->m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int file = open(nativePath.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+	{
+		PRLOG_ERROR("Cannot open pack \"{0}\"", p_nativePath);
+		return nullptr;
+	}
+
+	struct stat fileStat;
+	void* view = MAP_FAILED;
+	if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+		view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+	// Mapping keeps the file open
+	close(file);
+	if (view == MAP_FAILED)
+	{
+		PRLOG_ERROR("Cannot map pack \"{0}\"", p_nativePath);
+		return nullptr;
+	}
+
+	packFile->m_mapping = view;
+	packFile->m_size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+	packFile->m_data = static_cast<const uint8_t*>(packFile->m_mapping);
+	if (!packFile->Validate())
+	{
+		PRLOG_ERROR("Pack \"{0}\" is corrupted", p_nativePath);
+		return nullptr;
+	}
+
+	packFile->BuildDirectories();
+	return packFile;
+}
+
+std::unique_ptr<PackFile> PackFile::OpenFromMemory(std::vector<uint8_t> p_data)
+{
+	std::unique_ptr<PackFile> packFile{ new PackFile() };
+	packFile->m_memory = std::move(p_data);
+	packFile->m_data = packFile->m_memory.data();
+	packFile->m_size = packFile->m_memory.size();
+
+	if (!packFile->Validate())
+		return nullptr;
+
+	packFile->BuildDirectories();
+	return packFile;
+}
+
+bool PackFile::Validate()
+{
+	PackHeader header;
+	if (m_size < sizeof(PackHeader))
+		return false;
+
+	std::memcpy(&header, m_data, sizeof(PackHeader));
+	if (header.magic != Magic || header.version != Version)
+		return false;
+
+	// Entries are read in place from the mapping
+	if (header.tocOffset % alignof(PackEntry) != 0 || header.tocOffset > m_size || header.entryCount > (m_size - header.tocOffset) / sizeof(PackEntry))
+		return false;
+
+	if (header.namesOffset > m_size || header.namesSize > m_size - header.namesOffset)
+		return false;
+
+	m_entries = reinterpret_cast<const PackEntry*>(m_data + header.tocOffset);
+	m_entryCount = header.entryCount;
+	m_names = reinterpret_cast<const char*>(m_data + header.namesOffset);
+
+	for (size_t i = 0; i < m_entryCount; i++)
+	{
+		auto& entry = m_entries[i];
+		if (entry.dataOffset > m_size || entry.storedSize > m_size - entry.dataOffset)
+			return false;
+
+		if (entry.nameOffset > header.namesSize || entry.nameLength > header.namesSize - entry.nameOffset)
+			return false;
+
+		if (!(entry.flags & PackEntryCompressed) && entry.storedSize != entry.size)
+			return false;
+
+		if (i > 0 && m_entries[i - 1].pathHash > entry.pathHash)
+			return false;
+	}
+
+	return true;
+}
+
+void PackFile::BuildDirectories()
+{
+	// Root exists even in an empty pack
+	GetOrAddDirectory("");
+
+	for (size_t i = 0; i < m_entryCount; i++)
+	{
+		auto entryPath = GetEntryPath(m_entries[i]);
+
+		// Each path segment is a child of the directory before it
+		size_t nameStart = 0;
+		while (true)
+		{
+			auto separator = entryPath.find('/', nameStart);
+			auto& directory = GetOrAddDirectory(entryPath.substr(0, nameStart > 0 ? nameStart - 1 : 0));
+			directory.children.emplace_back(entryPath.substr(nameStart, separator - nameStart));
+
+			if (separator == std::string_view::npos)
+				break;
+			nameStart = separator + 1;
+		}
+	}
+
+	for (auto& directory : m_directories)
+	{
+		auto& children = directory.children;
+		std::sort(children.begin(), children.end());
+		children.erase(std::unique(children.begin(), children.end()), children.end());
+		children.shrink_to_fit();
+	}
+}
+
+const PackFile::PackDirectory* PackFile::FindDirectory(std::string_view p_path) const
+{
+	auto index = m_directoryIndices.Find(PathUtils::HashPath(p_path));
+	if (index == nullptr)
+		return nullptr;
+
+	for (size_t dirIndex = *index; dirIndex != SIZE_MAX; dirIndex = m_directories[dirIndex].nextSameHash)
+	{
+		if (IsSamePath(m_directories[dirIndex].path, p_path))
+			return &m_directories[dirIndex];
+	}
+
+	return nullptr;
+}
+
+PackFile::PackDirectory& PackFile::GetOrAddDirectory(std::string_view p_path)
+{
+	auto [index, inserted] = m_directoryIndices.TryEmplace(PathUtils::HashPath(p_path), m_directories.size());
+	if (!inserted)
+	{
+		// Paths of the same hash are chained
+		size_t dirIndex = *index;
+		while (true)
+		{
+			auto& directory = m_directories[dirIndex];
+			if (IsSamePath(directory.path, p_path))
+				return directory;
+			if (directory.nextSameHash == SIZE_MAX)
+				break;
+			dirIndex = directory.nextSameHash;
+		}
+
+		m_directories[dirIndex].nextSameHash = m_directories.size();
+	}
+
+	auto& directory = m_directories.emplace_back();
+	directory.path = p_path;
+	return directory;
+}
+
+const PackEntry* PackFile::Find(std::string_view p_path) const
+{
+	auto path = TrimPath(p_path);
+	auto pathHash = PathUtils::HashPath(path);
+
+	auto entriesEnd = m_entries + m_entryCount;
+	auto entryIt = std::lower_bound(m_entries, entriesEnd, pathHash, [](const PackEntry& p_entry, uint64_t p_hash) {
+		return p_entry.pathHash < p_hash;
+	});
+
+	// Paths of the same hash are next to each other
+	for (; entryIt != entriesEnd && entryIt->pathHash == pathHash; ++entryIt)
+	{
+		if (IsSamePath(GetEntryPath(*entryIt), path))
+			return entryIt;
+	}
+
+	return nullptr;
+}
+
+bool PackFile::IsDirectory(std::string_view p_path) const
+{
+	return FindDirectory(TrimPath(p_path)) != nullptr;
+}
+
+const std::vector<std::string>& PackFile::EnumerateDirectory(std::string_view p_path) const
+{
+	static const std::vector<std::string> s_noChildren;
+
+	auto directory = FindDirectory(TrimPath(p_path));
+	return directory ? directory->children : s_noChildren;
+}
+
+std::string_view PackFile::GetEntryPath(const PackEntry& p_entry) const
+{
+	return { m_names + p_entry.nameOffset, p_entry.nameLength };
+}
+
+bool PackFile::Read(const PackEntry& p_entry, std::vector<uint8_t>& p_data) const
+{
+	p_data.resize(p_entry.size);
+	if (p_entry.flags & PackEntryCompressed)
+	{
+		if (!Utils::Decompress(GetData(p_entry), p_entry.storedSize, p_data.data(), p_data.size()))
+		{
+			PRLOG_ERROR("Pack entry \"{0}\" is corrupted", GetEntryPath(p_entry));
+			p_data.clear();
+			return false;
+		}
+	}
+	else if (p_entry.size > 0)
+	{
+		std::memcpy(p_data.data(), GetData(p_entry), p_entry.size);
+	}
+
+	return true;
+}
+
+PackWriter::PackWriter(uint32_t p_alignment /*= 64*/) :
+	m_alignment(p_alignment)
+{
+	// Table of contents follows the data and is read in place
+	PR_ASSERT(p_alignment >= alignof(PackEntry) && (p_alignment & (p_alignment - 1)) == 0, "Pack alignment has to be a power of two of at least 8");
+}
+
+void PackWriter::AddFile(std::string_view p_path, std::vector<uint8_t> p_data, bool p_compress /*= true*/)
+{
+	PackedFile packedFile;
+	packedFile.path = TrimPath(p_path);
+	std::replace(packedFile.path.begin(), packedFile.path.end(), '\\', '/');
+	packedFile.size = p_data.size();
+
+	if (p_compress && !p_data.empty())
+	{
+		std::vector<uint8_t> compressed(Utils::CompressBound(p_data.size()));
+		auto compressedSize = Utils::Compress(p_data.data(), p_data.size(), compressed.data(), compressed.size());
+		if (compressedSize > 0 && compressedSize < p_data.size())
+		{
+			compressed.resize(compressedSize);
+			compressed.shrink_to_fit();
+			p_data = std::move(compressed);
+			packedFile.compressed = true;
+		}
+	}
+	packedFile.data = std::move(p_data);
+
+	auto [index, inserted] = m_fileIndices.TryEmplace(PathUtils::HashPath(packedFile.path), m_files.size());
+	if (!inserted)
+	{
+		// Paths of the same hash are chained
+		size_t fileIndex = *index;
+		while (true)
+		{
+			auto& file = m_files[fileIndex];
+			if (IsSamePath(file.path, packedFile.path))
+			{
+				packedFile.nextSameHash = file.nextSameHash;
+				file = std::move(packedFile);
+				return;
+			}
+			if (file.nextSameHash == SIZE_MAX)
+				break;
+			fileIndex = file.nextSameHash;
+		}
+
+		m_files[fileIndex].nextSameHash = m_files.size();
+	}
+
+	m_files.push_back(std::move(packedFile));
+}
+
+size_t PackWriter::AddDirectory(std::string_view p_nativeDir, bool p_compress /*= true*/)
+{
+	std::filesystem::path dirPath{ p_nativeDir };
+	std::error_code error;
+	if (!std::filesystem::is_directory(dirPath, error))
+	{
+		PRLOG_WARN("Cannot pack \"{0}\". Directory does not exist.", p_nativeDir);
+		return 0;
+	}
+
+	size_t fileCount = 0;
+	auto options = std::filesystem::directory_options::skip_permission_denied;
+	for (auto it = std::filesystem::recursive_directory_iterator(dirPath, options, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+	{
+		std::error_code entryError;
+		if (!it->is_regular_file(entryError))
+			continue;
+
+		std::ifstream file(it->path(), std::ios::binary);
+		std::vector<uint8_t> data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+		if (file.bad())
+		{
+			PRLOG_WARN("Cannot pack \"{0}\". Reading the file failed.", it->path().generic_string());
+			continue;
+		}
+
+		AddFile(it->path().lexically_relative(dirPath).generic_string(), std::move(data), p_compress);
+		fileCount++;
+	}
+
+	return fileCount;
+}
+
+bool PackWriter::Write(std::string_view p_nativePath) const
+{
+	std::vector<const PackedFile*> files;
+	files.reserve(m_files.size());
+	for (auto& file : m_files)
+		files.push_back(&file);
+
+	std::vector<uint64_t> pathHashes(m_files.size());
+	for (size_t i = 0; i < m_files.size(); i++)
+		pathHashes[i] = PathUtils::HashPath(m_files[i].path);
+
+	auto hashOf = [&](const PackedFile* p_file) { return pathHashes[p_file - m_files.data()]; };
+	std::sort(files.begin(), files.end(), [&](const PackedFile* p_first, const PackedFile* p_second) {
+		return hashOf(p_first) != hashOf(p_second) ? hashOf(p_first) < hashOf(p_second) : p_first->path < p_second->path;
+	});
+
+	PackHeader header;
+	header.magic = PackFile::Magic;
+	header.version = PackFile::Version;
+	header.entryCount = static_cast<uint32_t>(files.size());
+	header.alignment = m_alignment;
+
+	std::vector<PackEntry> entries(files.size());
+	std::string names;
+	uint64_t offset = AlignUp(sizeof(PackHeader), m_alignment);
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		auto& file = *files[i];
+		auto& entry = entries[i];
+		entry.pathHash = hashOf(&file);
+		entry.dataOffset = offset;
+		entry.storedSize = file.data.size();
+		entry.size = file.size;
+		entry.nameOffset = static_cast<uint32_t>(names.size());
+		entry.nameLength = static_cast<uint32_t>(file.path.size());
+		entry.flags = file.compressed ? static_cast<uint32_t>(PackEntryCompressed) : 0u;
+
+		names += file.path;
+		offset = AlignUp(offset + entry.storedSize, m_alignment);
+	}
+
+	if (names.size() > UINT32_MAX)
+	{
+		PRLOG_ERROR("Cannot write pack \"{0}\". Paths are too long.", p_nativePath);
+		return false;
+	}
+
+	header.tocOffset = offset;
+	header.namesOffset = header.tocOffset + entries.size() * sizeof(PackEntry);
+	header.namesSize = names.size();
+
+	// Mounted pack keeps its old mapping, the new one replaces it when written completely
+	std::filesystem::path packPath{ p_nativePath };
+	auto tempPath = packPath;
+	tempPath += ".tmp";
+	{
+		std::ofstream packStream(tempPath, std::ios::binary | std::ios::trunc);
+		if (!packStream)
+		{
+			PRLOG_ERROR("Cannot write pack \"{0}\"", p_nativePath);
+			return false;
+		}
+
+		const char padding[256] = {};
+		auto writePadding = [&](uint64_t p_offset) {
+			auto position = static_cast<uint64_t>(packStream.tellp());
+			for (; position < p_offset; position += sizeof(padding))
+				packStream.write(padding, std::min<uint64_t>(sizeof(padding), p_offset - position));
+		};
+
+		packStream.write(reinterpret_cast<const char*>(&header), sizeof(PackHeader));
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			writePadding(entries[i].dataOffset);
+			packStream.write(reinterpret_cast<const char*>(files[i]->data.data()), files[i]->data.size());
+		}
+
+		writePadding(header.tocOffset);
+		packStream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(PackEntry));
+		packStream.write(names.data(), names.size());
+
+		if (!packStream.flush())
+		{
+			PRLOG_ERROR("Cannot write pack \"{0}\"", p_nativePath);
+			packStream.close();
+
+			std::error_code error;
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, packPath, error);
+	if (error)
+	{
+		PRLOG_ERROR("Cannot replace pack \"{0}\", {1}", p_nativePath, error.message());
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+
+	return true;
+}
@@ -10,8 +10,9 @@ InputManager::InputManager() :
 	s_mouseXPos(0.0f),
 	s_mouseYPos(0.0f),
 	s_mouseScroll(0.0f),
-	s_anyPressed(false),
-	s_anyHold(false)
+	m_charInput{},
+	m_charInputHead(0),
+	m_charInputCount(0)
 {
 	Events::EventListener keyPressedListener;
 	keyPressedListener.connect<&InputManager::OnKeyPressed>(this);
@@ -36,6 +37,10 @@ InputManager::InputManager() :
 	Events::EventListener mouseScrollListener;
 	mouseScrollListener.connect<&InputManager::OnMouseScroll>(this);
 	Events::EventManager::GetInstance().AddListener(mouseScrollListener, Events::MouseScrollEvent::s_type);
+
+	Events::EventListener charInputListener;
+	charInputListener.connect<&InputManager::OnCharInput>(this);
+	Events::EventManager::GetInstance().AddListener(charInputListener, Events::CharInputEvent::s_type);
 }
 
 InputManager::~InputManager()
@@ -63,64 +68,50 @@ InputManager::~InputManager()
 	Events::EventListener mouseScrollListener;
 	mouseScrollListener.connect<&InputManager::OnMouseScroll>(this);
 	Events::EventManager::GetInstance().RemoveListener(mouseScrollListener, Events::MouseScrollEvent::s_type);
+
+	Events::EventListener charInputListener;
+	charInputListener.connect<&InputManager::OnCharInput>(this);
+	Events::EventManager::GetInstance().RemoveListener(charInputListener, Events::CharInputEvent::s_type);
 }
 
 bool InputManager::IsKeyPressed(PrKey p_key) const
 {
-	auto keyIterator = s_keyState.find(p_key);
-	if (keyIterator == s_keyState.end())
-		return false;
-	return keyIterator->second  == PrInputState::PRESS;
+	return m_keyState.IsPressed(KeyStateTable::ToIndex((int)p_key));
 }
 
 bool InputManager::IsKeyReleased(PrKey p_key) const
 {
-	auto keyIterator = s_keyState.find(p_key);
-	if (keyIterator == s_keyState.end())
-		return false;
-	return keyIterator->second == PrInputState::RELEASE;
+	return m_keyState.IsReleased(KeyStateTable::ToIndex((int)p_key));
 }
 
 bool InputManager::IsKeyHold(PrKey p_key) const
 {
-	auto keyHoldIterator = s_keyHold.find(p_key);
-	if (keyHoldIterator == s_keyHold.end())
-		return false;
-	return keyHoldIterator->second;
+	return m_keyState.IsDown(KeyStateTable::ToIndex((int)p_key));
 }
 
 bool InputManager::IsButtonPressed(PrMouseButton p_key) const
 {
-	auto buttonIterator = s_buttonState.find(p_key);
-	if (buttonIterator == s_buttonState.end())
-		return false;
-	return buttonIterator->second == PrInputState::PRESS;
+	return m_buttonState.IsPressed(ButtonStateTable::ToIndex((int)p_key));
 }
 
 bool InputManager::IsButtonReleased(PrMouseButton p_key) const
 {
-	auto buttonIterator = s_buttonState.find(p_key);
-	if (buttonIterator == s_buttonState.end())
-		return false;
-	return buttonIterator->second == PrInputState::RELEASE;
+	return m_buttonState.IsReleased(ButtonStateTable::ToIndex((int)p_key));
 }
 
 bool InputManager::IsButtonHold(PrMouseButton p_key) const
 {
-	auto buttonHoldIterator = s_buttonHold.find(p_key);
-	if (buttonHoldIterator == s_buttonHold.end())
-		return false;
-	return buttonHoldIterator->second;
+	return m_buttonState.IsDown(ButtonStateTable::ToIndex((int)p_key));
 }
 
 bool InputManager::IsAnyKeyPressed() const
 {
-	return s_anyPressed;
+	return m_keyState.IsAnyPressed();
 }
 
 bool InputManager::IsAnyKeyHold() const
 {
-	return s_anyHold;
+	return m_keyState.IsAnyDown();
 }
 
 double InputManager::GetMouseScroll() const
@@ -143,57 +134,73 @@ PrCore::Math::vec2 InputManager::GetMousePosition() const
 	return Math::vec2(GetMouseX(), GetMouseY());
 }
 
+size_t InputManager::GetCharInputCount() const
+{
+	return m_charInputCount;
+}
+
+uint32_t InputManager::GetCharInput(size_t p_index) const
+{
+	PR_ASSERT(p_index < m_charInputCount, "Char input index out of range");
+	return m_charInput[(m_charInputHead + p_index) & (g_charInputCapacity - 1)];
+}
+
 void InputManager::ResetFlags()
 {
-	s_anyPressed = false;
-	for (auto it = s_keyState.begin(); it != s_keyState.end(); ++it)
- 		s_anyPressed |= (it->second == PrInputState::PRESS);
+	m_keyState.NewFrame();
+	m_buttonState.NewFrame();
+
+	// Scroll events are accumulated per frame
+	s_mouseScroll = 0.0;
 
-	s_anyHold = false;
-	for (auto it = s_keyHold.begin(); it != s_keyHold.end(); ++it)
-		s_anyHold |= it->second;
-	
-	s_keyState.clear();
-	s_buttonState.clear();
+	m_charInputHead = 0;
+	m_charInputCount = 0;
 }
 
 void InputManager::OnKeyPressed(Events::EventPtr p_event)
 {
-	auto keyPresedEvent = std::static_pointer_cast<Events::KeyPressedEvent>(p_event);
-	s_keyState[keyPresedEvent->m_key] = PrInputState::PRESS;
-	s_keyHold[keyPresedEvent->m_key] = true;
+	auto keyPresedEvent = static_cast<Events::KeyPressedEvent*>(p_event);
+	m_keyState.Press(KeyStateTable::ToIndex((int)keyPresedEvent->m_key));
 }
 
 void InputManager::OnKeyReleased(Events::EventPtr p_event)
 {
-	auto keyReleasedEvent = std::static_pointer_cast<Events::KeyReleasedEvent>(p_event);
-	s_keyState[keyReleasedEvent->m_key] = PrInputState::RELEASE;
-	s_keyHold[keyReleasedEvent->m_key] = false;
+	auto keyReleasedEvent = static_cast<Events::KeyReleasedEvent*>(p_event);
+	m_keyState.Release(KeyStateTable::ToIndex((int)keyReleasedEvent->m_key));
 }
 
 void InputManager::OnMouseButtonPressed(Events::EventPtr p_event)
 {
-	auto buttonPresedEvent = std::static_pointer_cast<Events::MouseButtonPressedEvent>(p_event);
-	s_buttonState[buttonPresedEvent->m_button] = PrInputState::PRESS;
-	s_buttonHold[buttonPresedEvent->m_button] = true;
+	auto buttonPresedEvent = static_cast<Events::MouseButtonPressedEvent*>(p_event);
+	m_buttonState.Press(ButtonStateTable::ToIndex((int)buttonPresedEvent->m_button));
 }
 
 void InputManager::OnMouseButtonReleased(Events::EventPtr p_event)
 {
-	auto buttonReleasedEvent = std::static_pointer_cast<Events::MouseButtonReleasedEvent>(p_event);
-	s_buttonState[buttonReleasedEvent->m_button] = PrInputState::RELEASE;
-	s_buttonHold[buttonReleasedEvent->m_button] = false;
+	auto buttonReleasedEvent = static_cast<Events::MouseButtonReleasedEvent*>(p_event);
+	m_buttonState.Release(ButtonStateTable::ToIndex((int)buttonReleasedEvent->m_button));
 }
 
 void InputManager::OnMouseMoved(Events::EventPtr p_event)
 {
-	auto mouseMovedEvent = std::static_pointer_cast<Events::MouseMovedEvent>(p_event);
+	auto mouseMovedEvent = static_cast<Events::MouseMovedEvent*>(p_event);
 	s_mouseXPos = mouseMovedEvent->m_xPos;
 	s_mouseYPos = mouseMovedEvent->m_yPos;
 }
 
 void InputManager::OnMouseScroll(Events::EventPtr p_event)
 {
-	auto mouseScrollEvent = std::static_pointer_cast<Events::MouseScrollEvent>(p_event);
-	s_mouseScroll = mouseScrollEvent->m_yOffset;
+	auto mouseScrollEvent = static_cast<Events::MouseScrollEvent*>(p_event);
+	s_mouseScroll += mouseScrollEvent->m_yOffset;
 }
+
+void InputManager::OnCharInput(Events::EventPtr p_event)
+{
+	auto charInputEvent = static_cast<Events::CharInputEvent*>(p_event);
+
+	m_charInput[(m_charInputHead + m_charInputCount) & (g_charInputCapacity - 1)] = charInputEvent->m_codepoint;
+	if (m_charInputCount < g_charInputCapacity)
+		m_charInputCount++;
+	else
+		m_charInputHead = (m_charInputHead + 1) & (g_charInputCapacity - 1);
+}
\ No newline at end of file
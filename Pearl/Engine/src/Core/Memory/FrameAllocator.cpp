@@ -0,0 +1,57 @@
+#include "Core/Common/pearl_pch.h"
+
+#include "Core/Memory/FrameAllocator.h"
+
+using namespace PrCore::Memory;
+
+namespace {
+	std::atomic<uint64_t> g_nextInstanceId = 1;
+}
+
+thread_local FrameAllocator::ThreadCache FrameAllocator::s_threadCache;
+
+FrameAllocator::FrameAllocator(size_t p_threadCapacity, size_t p_frameCount) :
+	m_threadCapacity(p_threadCapacity),
+	m_frameCount(p_frameCount),
+	m_instanceId(g_nextInstanceId++)
+{
+	PR_ASSERT(p_threadCapacity > 0, "FrameAllocator capacity is 0");
+	PR_ASSERT(p_frameCount > 0, "FrameAllocator frame count is 0");
+
+	m_frameIndex.store(0);
+}
+
+FrameAllocator::~FrameAllocator()
+{
+	std::lock_guard lock{ m_threadFramesLock };
+	m_threadFrames.clear();
+}
+
+LinearAllocator& FrameAllocator::GetThreadAllocator()
+{
+	if (s_threadCache.instanceId != m_instanceId)
+	{
+		auto threadFrames = std::make_unique<ThreadFrames>();
+		for (size_t i = 0; i < m_frameCount; i++)
+			threadFrames->frames.push_back(std::make_unique<LinearAllocator>(m_threadCapacity));
+
+		s_threadCache.instanceId = m_instanceId;
+		s_threadCache.threadFrames = threadFrames.get();
+
+		std::lock_guard lock{ m_threadFramesLock };
+		m_threadFrames.push_back(std::move(threadFrames));
+	}
+
+	return *s_threadCache.threadFrames->frames[m_frameIndex.load()];
+}
+
+void FrameAllocator::NewFrame()
+{
+	size_t frameIndex = (m_frameIndex.load() + 1) % m_frameCount;
+
+	std::lock_guard lock{ m_threadFramesLock };
+	for (auto& threadFrames : m_threadFrames)
+		threadFrames->frames[frameIndex]->Reset();
+
+	m_frameIndex.store(frameIndex);
+}
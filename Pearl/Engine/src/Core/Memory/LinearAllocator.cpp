@@ -0,0 +1,163 @@
+#include "Core/Common/pearl_pch.h"
+
+#include "Core/Memory/LinearAllocator.h"
+
+using namespace PrCore::Memory;
+
+namespace {
+#if PR_SCRATCH_DEBUG
+	// Guard after every allocation, a broken guard means the allocation was overrun
+	// The pattern is followed by the address of the previous guard, so the guards are walked in place
+	constexpr size_t  g_guardPatternSize = 16;
+	constexpr size_t  g_guardSize = g_guardPatternSize + sizeof(uint8_t*);
+	constexpr uint8_t g_guardPattern = 0xFD;
+	// Fresh memory is filled to expose reads of uninitialised data
+	constexpr uint8_t g_allocatedPattern = 0xCD;
+	// Released memory is filled to expose use after Reset
+	constexpr uint8_t g_releasedPattern = 0xDD;
+#else
+	constexpr size_t  g_guardSize = 0;
+#endif
+
+	size_t AlignOffset(const uint8_t* p_base, size_t p_offset, size_t p_alignment)
+	{
+		auto address = reinterpret_cast<uintptr_t>(p_base) + p_offset;
+		auto alignedAddress = (address + p_alignment - 1) & ~(static_cast<uintptr_t>(p_alignment) - 1);
+		return p_offset + (alignedAddress - address);
+	}
+}
+
+LinearAllocator::LinearAllocator(size_t p_capacity) :
+	m_buffer(std::make_unique<uint8_t[]>(p_capacity)),
+	m_capacity(p_capacity),
+	m_offset(0),
+	m_overflowSize(0)
+{
+	PR_ASSERT(p_capacity > 0, "LinearAllocator capacity is 0");
+}
+
+LinearAllocator::~LinearAllocator()
+{
+	Validate();
+}
+
+void* LinearAllocator::Allocate(size_t p_size, size_t p_alignment)
+{
+	PR_ASSERT(p_alignment > 0 && (p_alignment & (p_alignment - 1)) == 0, "Alignment must be a power of two");
+
+	size_t requiredSize = p_size + g_guardSize;
+	size_t alignedOffset = AlignOffset(m_buffer.get(), m_offset, p_alignment);
+
+	uint8_t* ptr = nullptr;
+	if (alignedOffset + requiredSize <= m_capacity)
+	{
+		ptr = m_buffer.get() + alignedOffset;
+		m_offset = alignedOffset + requiredSize;
+	}
+	else
+	{
+		ptr = AllocateOverflow(requiredSize, p_alignment);
+	}
+
+#if PR_SCRATCH_DEBUG
+	std::memset(ptr, g_allocatedPattern, p_size);
+	auto guard = ptr + p_size;
+	std::memset(guard, g_guardPattern, g_guardPatternSize);
+	std::memcpy(guard + g_guardPatternSize, &m_lastGuard, sizeof(m_lastGuard));
+	m_lastGuard = guard;
+#endif
+
+	return ptr;
+}
+
+uint8_t* LinearAllocator::AllocateOverflow(size_t p_size, size_t p_alignment)
+{
+	if (!m_overflowBlocks.empty())
+	{
+		auto& block = m_overflowBlocks.back();
+		size_t alignedOffset = AlignOffset(block.data.get(), block.offset, p_alignment);
+		if (alignedOffset + p_size <= block.capacity)
+		{
+			m_overflowSize += alignedOffset + p_size - block.offset;
+			block.offset = alignedOffset + p_size;
+			return block.data.get() + alignedOffset;
+		}
+	}
+
+	// Overflow blocks live only until the next Reset
+	OverflowBlock block;
+	block.capacity = std::max(m_capacity, p_size + p_alignment);
+	block.data = std::make_unique<uint8_t[]>(block.capacity);
+
+	size_t alignedOffset = AlignOffset(block.data.get(), 0, p_alignment);
+	block.offset = alignedOffset + p_size;
+	m_overflowSize += block.offset;
+
+	auto ptr = block.data.get() + alignedOffset;
+	m_overflowBlocks.push_back(std::move(block));
+	return ptr;
+}
+
+void LinearAllocator::Reset()
+{
+	Validate();
+
+#if PR_SCRATCH_DEBUG
+	std::memset(m_buffer.get(), g_releasedPattern, m_offset);
+	m_lastGuard = nullptr;
+#endif
+
+	// Grow once so the next frames with the same usage fit in the main buffer
+	if (!m_overflowBlocks.empty())
+	{
+		size_t usedSize = GetUsedSize();
+		size_t newCapacity = m_capacity;
+		while (newCapacity < usedSize)
+			newCapacity *= 2;
+
+		PRLOG_WARN("LinearAllocator overflowed by {} bytes, capacity grows from {} to {}", m_overflowSize, m_capacity, newCapacity);
+
+		m_buffer = std::make_unique<uint8_t[]>(newCapacity);
+		m_capacity = newCapacity;
+		m_overflowBlocks.clear();
+		m_overflowSize = 0;
+	}
+
+	m_offset = 0;
+}
+
+void LinearAllocator::Validate() const
+{
+#if PR_SCRATCH_DEBUG
+	// Pattern is checked before the link is followed, an overrun breaks the pattern first
+	const uint8_t* guard = m_lastGuard;
+	while (guard != nullptr)
+	{
+		for (size_t i = 0; i < g_guardPatternSize; i++)
+		{
+			if (guard[i] != g_guardPattern)
+			{
+				PR_ASSERT(false, "LinearAllocator allocation was overrun");
+				return;
+			}
+		}
+
+		std::memcpy(&guard, guard + g_guardPatternSize, sizeof(guard));
+	}
+#endif
+}
+
+bool LinearAllocator::Owns(const void* p_ptr) const
+{
+	auto ptr = static_cast<const uint8_t*>(p_ptr);
+	if (ptr >= m_buffer.get() && ptr < m_buffer.get() + m_capacity)
+		return true;
+
+	for (auto& block : m_overflowBlocks)
+	{
+		if (ptr >= block.data.get() && ptr < block.data.get() + block.capacity)
+			return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,299 @@
+#include "Core/Common/pearl_pch.h"
+
+#include "Core/Resources/AssetRegistry.h"
+#include "Core/File/FileSystem.h"
+#include "Core/Utils/Hash.h"
+
+#include <algorithm>
+#include <fstream>
+
+using namespace PrCore::Resources;
+
+uint64_t AssetRegistry::HashContent(const void* p_data, size_t p_size)
+{
+	// 0 marks a file that is not hashed yet
+	auto hash = Utils::Hash64(p_data, p_size);
+	return hash != 0 ? hash : 1;
+}
+
+bool AssetRegistry::OpenFromFile(std::string_view p_filePath)
+{
+	auto& fileSystem = File::FileSystem::GetInstance();
+	if (!fileSystem.FileExist(p_filePath))
+	{
+		PRLOG_INFO("Asset registry \"{0}\" does not exist. Starting with an empty registry.", p_filePath);
+		Deserialize(nlohmann::json::object());
+		return true;
+	}
+
+	auto file = fileSystem.OpenFileWrapper(p_filePath);
+	if (file == nullptr)
+		return false;
+
+	std::vector<char> data(file->GetSize());
+	if (!data.empty())
+		file->Read(data.data(), data.size());
+
+	auto serialized = nlohmann::json::parse(data.begin(), data.end(), nullptr, false);
+	if (serialized.is_discarded())
+	{
+		PRLOG_WARN("Cannot parse asset registry \"{0}\". Starting with an empty registry.", p_filePath);
+		Deserialize(nlohmann::json::object());
+		return false;
+	}
+
+	Deserialize(serialized);
+	return true;
+}
+
+bool AssetRegistry::SaveToFile(std::string_view p_filePath)
+{
+	nlohmann::json serialized;
+	Serialize(serialized);
+
+	auto& fileSystem = File::FileSystem::GetInstance();
+	auto file = fileSystem.FileOpen(p_filePath, File::OpenMode::Write);
+	if (file == nullptr)
+	{
+		PRLOG_WARN("Cannot save asset registry \"{0}\".", p_filePath);
+		return false;
+	}
+
+	std::string dumpJson = serialized.dump(4);
+	fileSystem.FileWrite(file, dumpJson.c_str(), dumpJson.length());
+	fileSystem.FileClose(file);
+
+	std::unique_lock lock(m_lock);
+	m_dirty = false;
+	return true;
+}
+
+void AssetRegistry::Serialize(nlohmann::json& p_serialized) const
+{
+	std::vector<const AssetRecord*> records;
+	std::shared_lock lock(m_lock);
+	records.reserve(m_records.Size());
+	for (auto& [_, record] : m_records)
+		records.push_back(&record);
+
+	// Sorted so the saved file does not change with the hash map layout
+	std::sort(records.begin(), records.end(), [](const AssetRecord* p_lhs, const AssetRecord* p_rhs) {
+		return p_lhs->path < p_rhs->path;
+		});
+
+	auto assets = nlohmann::json::array();
+	for (auto record : records)
+	{
+		nlohmann::json asset;
+		asset["path"] = record->path;
+		asset["id"] = record->id;
+		asset["contentHash"] = record->contentHash;
+		asset["fileSize"] = record->fileSize;
+		asset["modTime"] = record->modTime;
+		asset["importHash"] = record->importHash;
+		if (!record->importSettings.is_null())
+			asset["importSettings"] = record->importSettings;
+
+		assets.push_back(std::move(asset));
+	}
+
+	p_serialized["version"] = s_version;
+	p_serialized["assets"] = std::move(assets);
+}
+
+void AssetRegistry::Deserialize(const nlohmann::json& p_serialized)
+{
+	std::unique_lock lock(m_lock);
+	m_records.Clear();
+	m_dirty = false;
+
+	if (!p_serialized.contains("assets"))
+		return;
+
+	if (p_serialized.value("version", 0) != s_version)
+	{
+		PRLOG_WARN("Asset registry version {0} is not supported. Assets are hashed and imported again.", p_serialized.value("version", 0));
+		m_dirty = true;
+		return;
+	}
+
+	for (auto& asset : p_serialized["assets"])
+	{
+		AssetRecord record;
+		record.path = PathUtils::Sanitize(asset.value("path", std::string{}));
+		if (record.path.empty())
+			continue;
+
+		record.id = MakeID(record.path);
+		if (asset.value("id", InvalidID) != record.id)
+		{
+			// Written with another path hash, the derived data of the old ID is stale
+			PRLOG_WARN("Asset registry ID of \"{0}\" does not match the path. The asset is imported again.", record.path);
+			m_dirty = true;
+			m_records.InsertOrAssign(record.id, std::move(record));
+			continue;
+		}
+
+		record.contentHash = asset.value("contentHash", uint64_t{ 0 });
+		record.fileSize = asset.value("fileSize", int64_t{ -1 });
+		record.modTime = asset.value("modTime", int64_t{ -1 });
+		record.importHash = asset.value("importHash", uint64_t{ 0 });
+		if (asset.contains("importSettings"))
+			record.importSettings = asset["importSettings"];
+
+		m_records.InsertOrAssign(record.id, std::move(record));
+	}
+}
+
+bool AssetRegistry::IsDirty() const
+{
+	std::shared_lock lock(m_lock);
+	return m_dirty;
+}
+
+bool AssetRegistry::FindRecord(std::string_view p_path, AssetRecord& p_record) const
+{
+	std::shared_lock lock(m_lock);
+	auto record = m_records.Find(MakeID(p_path));
+	if (record == nullptr)
+		return false;
+
+	p_record = *record;
+	return true;
+}
+
+void AssetRegistry::RemoveRecord(std::string_view p_path)
+{
+	std::unique_lock lock(m_lock);
+	if (m_records.Erase(MakeID(p_path)))
+		m_dirty = true;
+}
+
+size_t AssetRegistry::GetRecordCount() const
+{
+	std::shared_lock lock(m_lock);
+	return m_records.Size();
+}
+
+bool AssetRegistry::UpdateContentHash(std::string_view p_path, uint64_t p_contentHash, int64_t p_fileSize /*= -1*/, int64_t p_modTime /*= -1*/)
+{
+	std::unique_lock lock(m_lock);
+	auto& record = GetOrAddRecord(p_path);
+
+	// Stamp of an older file must not vouch for the new hash
+	if (record.fileSize != p_fileSize || record.modTime != p_modTime)
+	{
+		record.fileSize = p_fileSize;
+		record.modTime = p_modTime;
+		m_dirty = true;
+	}
+
+	if (record.contentHash == p_contentHash && record.hashVerified)
+		return false;
+
+	// The file may have been changed and changed back while the engine was closed
+	record.hashVerified = true;
+	if (record.contentHash != p_contentHash)
+	{
+		record.contentHash = p_contentHash;
+		m_dirty = true;
+	}
+
+	return true;
+}
+
+bool AssetRegistry::UpdateFromFile(std::string_view p_path)
+{
+	auto file = File::FileSystem::GetInstance().OpenFileWrapper(p_path);
+	if (file == nullptr)
+		return false;
+
+	auto stat = file->GetStat();
+	std::vector<char> data(file->GetSize());
+	if (!data.empty())
+		file->Read(data.data(), data.size());
+
+	return UpdateContentHash(p_path, HashContent(data.data(), data.size()), stat.fileSize, stat.modTime);
+}
+
+bool AssetRegistry::VerifyFromFile(std::string_view p_path)
+{
+	auto stat = File::FileSystem::GetInstance().GetStat(p_path);
+	{
+		std::unique_lock lock(m_lock);
+		auto record = m_records.Find(MakeID(p_path));
+		if (record && record->hashVerified)
+			return true;
+
+		// Unknown stamps never match, archives without modification times are always hashed
+		if (record && record->contentHash != 0 && record->modTime > 0 && record->modTime == stat.modTime && record->fileSize == stat.fileSize)
+		{
+			record->hashVerified = true;
+			return true;
+		}
+	}
+
+	UpdateFromFile(p_path);
+
+	AssetRecord record;
+	return FindRecord(p_path, record) && record.hashVerified;
+}
+
+bool AssetRegistry::UpdateFromNativeFile(std::string_view p_path, const std::string& p_nativePath)
+{
+	std::ifstream file(p_nativePath, std::ios::binary);
+	if (!file)
+		return false;
+
+	std::vector<char> data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	if (file.bad())
+		return false;
+
+	return UpdateContentHash(p_path, HashContent(data.data(), data.size()));
+}
+
+void AssetRegistry::InvalidateHash(std::string_view p_path)
+{
+	std::unique_lock lock(m_lock);
+	auto record = m_records.Find(MakeID(p_path));
+	if (record == nullptr)
+		return;
+
+	record->hashVerified = false;
+	record->fileSize = -1;
+	record->modTime = -1;
+	m_dirty = true;
+}
+
+bool AssetRegistry::NeedsImport(std::string_view p_path, uint64_t p_contentHash, const nlohmann::json& p_importSettings /*= {}*/) const
+{
+	std::shared_lock lock(m_lock);
+	auto record = m_records.Find(MakeID(p_path));
+	if (record == nullptr)
+		return true;
+
+	return record->importHash != p_contentHash || record->importSettings != p_importSettings;
+}
+
+void AssetRegistry::RecordImport(std::string_view p_path, uint64_t p_contentHash, const nlohmann::json& p_importSettings /*= {}*/)
+{
+	std::unique_lock lock(m_lock);
+	auto& record = GetOrAddRecord(p_path);
+	record.contentHash = p_contentHash;
+	record.hashVerified = true;
+	record.importHash = p_contentHash;
+	record.importSettings = p_importSettings;
+	m_dirty = true;
+}
+
+AssetRecord& AssetRegistry::GetOrAddRecord(std::string_view p_path)
+{
+	auto [record, added] = m_records.TryEmplace(MakeID(p_path));
+	if (added)
+	{
+		record->path = PathUtils::Sanitize(p_path);
+		record->id = MakeID(p_path);
+	}
+
+	return *record;
+}
@@ -0,0 +1,150 @@
+#include "Core/Common/pearl_pch.h"
+
+#include "Core/Resources/CookedAsset.h"
+#include "Core/Resources/ResourceSystem.h"
+#include "Core/File/FileSystem.h"
+#include "Core/Utils/PathUtils.h"
+
+using namespace PrCore::Resources;
+
+namespace {
+	constexpr uint32_t g_cookedMagic = CookedAsset::MakeFourCC('P', 'R', 'C', 'K');
+}
+
+std::string CookedAsset::GetCookedPath(std::string_view p_sourcePath)
+{
+	auto sourcePath = PathUtils::Sanitize(p_sourcePath);
+	auto firstChar = sourcePath.find_first_not_of('/');
+	if (firstChar == std::string::npos)
+		firstChar = sourcePath.size();
+
+	return "cooked/" + sourcePath.substr(firstChar) + ".prc";
+}
+
+bool CookedAsset::IsCookedPath(std::string_view p_path)
+{
+	auto path = PathUtils::Sanitize(p_path);
+	auto firstChar = path.find_first_not_of('/');
+	return firstChar != std::string::npos && path.compare(firstChar, 7, "cooked/") == 0;
+}
+
+bool CookedAsset::Read(std::string_view p_sourcePath, uint32_t p_assetType, uint32_t p_formatVersion, std::vector<uint8_t>& p_payload)
+{
+	CookedAssetHeader header;
+	std::vector<uint8_t> payload;
+	if (!ReadHeader(GetCookedPath(p_sourcePath), header, &payload) || !IsHeaderValid(header, p_assetType, p_formatVersion))
+		return false;
+
+	// Without the source the cooked file is the asset
+	auto& fileSystem = File::FileSystem::GetInstance();
+	auto sourcePath = PathUtils::Sanitize(p_sourcePath);
+	if (fileSystem.FileExist(sourcePath))
+	{
+		// Hash recorded in another run is trusted while the source keeps its size and modification time
+		auto& assetRegistry = ResourceSystem::GetInstance().GetAssetRegistry();
+		AssetRecord record;
+		if (!assetRegistry.VerifyFromFile(sourcePath) || !assetRegistry.FindRecord(sourcePath, record) || record.contentHash != header.sourceHash)
+			return false;
+	}
+
+	p_payload = std::move(payload);
+	return true;
+}
+
+bool CookedAsset::Write(std::string_view p_sourcePath, uint32_t p_assetType, uint32_t p_formatVersion, uint64_t p_sourceHash, const std::vector<uint8_t>& p_payload, const nlohmann::json& p_importSettings /*= {}*/)
+{
+	CookedAssetHeader header;
+	header.magic = g_cookedMagic;
+	header.assetType = p_assetType;
+	header.formatVersion = p_formatVersion;
+	header.headerSize = sizeof(CookedAssetHeader);
+	header.sourceHash = p_sourceHash;
+	header.payloadSize = p_payload.size();
+
+	auto& fileSystem = File::FileSystem::GetInstance();
+	auto cookedPath = GetCookedPath(p_sourcePath);
+	fileSystem.CreateDir(PathUtils::RemoveFile(cookedPath));
+
+	auto file = fileSystem.FileOpen(cookedPath, File::OpenMode::Write);
+	if (file == nullptr)
+	{
+		PRLOG_WARN("Cannot write cooked file \"{0}\".", cookedPath);
+		return false;
+	}
+
+	bool written = fileSystem.FileWrite(file, &header, sizeof(header)) == sizeof(header) &&
+		(p_payload.empty() || fileSystem.FileWrite(file, p_payload.data(), p_payload.size()) == p_payload.size());
+	fileSystem.FileClose(file);
+
+	if (!written)
+	{
+		// Truncated file fails the header check, it is removed to not be read again
+		PRLOG_WARN("Cannot write cooked file \"{0}\".", cookedPath);
+		fileSystem.FileDelete(cookedPath);
+		return false;
+	}
+
+	ResourceSystem::GetInstance().GetAssetRegistry().RecordImport(p_sourcePath, p_sourceHash, p_importSettings);
+	return true;
+}
+
+bool CookedAsset::ReadSource(std::string_view p_sourcePath, std::vector<uint8_t>& p_source, uint64_t& p_sourceHash)
+{
+	auto file = File::FileSystem::GetInstance().OpenFileWrapper(p_sourcePath);
+	if (file == nullptr)
+		return false;
+
+	auto stat = file->GetStat();
+	p_source.resize(file->GetSize());
+	if (!p_source.empty())
+		file->Read(p_source.data(), p_source.size());
+
+	p_sourceHash = AssetRegistry::HashContent(p_source.data(), p_source.size());
+	ResourceSystem::GetInstance().GetAssetRegistry().UpdateContentHash(p_sourcePath, p_sourceHash, stat.fileSize, stat.modTime);
+	return true;
+}
+
+bool CookedAsset::IsUpToDate(std::string_view p_sourcePath, uint32_t p_assetType, uint32_t p_formatVersion, uint64_t p_sourceHash, const nlohmann::json& p_importSettings /*= {}*/)
+{
+	if (ResourceSystem::GetInstance().GetAssetRegistry().NeedsImport(p_sourcePath, p_sourceHash, p_importSettings))
+		return false;
+
+	CookedAssetHeader header;
+	return ReadHeader(GetCookedPath(p_sourcePath), header, nullptr) && IsHeaderValid(header, p_assetType, p_formatVersion) && header.sourceHash == p_sourceHash;
+}
+
+bool CookedAsset::ReadHeader(std::string_view p_cookedPath, CookedAssetHeader& p_header, std::vector<uint8_t>* p_payload)
+{
+	auto& fileSystem = File::FileSystem::GetInstance();
+	if (!fileSystem.FileExist(p_cookedPath))
+		return false;
+
+	auto file = fileSystem.OpenFileWrapper(p_cookedPath);
+	if (file == nullptr)
+		return false;
+
+	size_t fileSize = file->GetSize();
+	if (fileSize < sizeof(CookedAssetHeader) || file->Read(&p_header, sizeof(CookedAssetHeader)) != sizeof(CookedAssetHeader))
+		return false;
+
+	// Truncated or padded files are not trusted
+	if (p_header.magic != g_cookedMagic || p_header.headerSize != sizeof(CookedAssetHeader) || p_header.payloadSize != fileSize - sizeof(CookedAssetHeader))
+	{
+		PRLOG_WARN("Cooked file \"{0}\" is corrupted. The asset is loaded from the source.", p_cookedPath);
+		return false;
+	}
+
+	if (p_payload)
+	{
+		p_payload->resize(static_cast<size_t>(p_header.payloadSize));
+		if (!p_payload->empty() && file->Read(p_payload->data(), p_payload->size()) != p_payload->size())
+			return false;
+	}
+
+	return true;
+}
+
+bool CookedAsset::IsHeaderValid(const CookedAssetHeader& p_header, uint32_t p_assetType, uint32_t p_formatVersion)
+{
+	return p_header.assetType == p_assetType && p_header.formatVersion == p_formatVersion;
+}
@@ -1,13 +1,16 @@
 #include "Core/Common/pearl_pch.h"
 
 #include "Core/Resources/ResourceDatabase.h"
+#include "Core/Resources/AssetRegistry.h"
 #include "Core/Resources/IResourceDataLoader.h"
+#include "Core/Utils/Compression.h"
 #include "Core/Utils/PathUtils.h"
-#include "Core/Utils/StringUtils.h"
 
 #include "Core/Events/EventManager.h"
 #include "Core/Events/ResourceEvents.h"
 
+#include "Core/Threading/JobSystem.h"
+
 #include <algorithm>
 
 using namespace PrCore::Resources;
@@ -15,21 +18,21 @@ using namespace PrCore::Resources;
 ResourceDatabase::~ResourceDatabase()
 {
 	RemoveAll();
+	WaitForAllLoadsPrivate();
 	UnregisterAllLoaders();
 }
 
-ResourceDescPtr ResourceDatabase::Load(const std::string& p_path, std::shared_ptr<IResourceDataLoader> p_loader /*= nullptr*/)
+ResourceDescPtr ResourceDatabase::Load(std::string_view p_path, std::shared_ptr<IResourceDataLoader> p_loader /*= nullptr*/)
 {
 	PR_ASSERT(!p_path.empty(), "Resource path is empty");
-	auto lowerPath = PrCore::StringUtils::ToLower(p_path);
 
-	auto resourceDesc = ResourceByPath(lowerPath);
+	auto resourceDesc = ResourceByPath(p_path);
 	if (resourceDesc == nullptr)
-		resourceDesc = RegisterFileResourcePrivate(lowerPath);
-	
-	if (resourceDesc->state == ResourceState::Unloaded || resourceDesc->state == ResourceState::Registered)
-		LoadResourcePrivate(resourceDesc, p_loader);
-	
+		resourceDesc = RegisterFileResourcePrivate(p_path);
+
+	LoadResourcePrivate(resourceDesc, p_loader);
+
+	MarkAccessed(resourceDesc);
 	return resourceDesc;
 }
 
@@ -53,21 +56,123 @@ ResourceDescPtr ResourceDatabase::Load(ResourceID p_id, std::shared_ptr<IResourc
 	if (resourceDesc->state == ResourceState::Corrupted)
 		PRLOG_WARN("Cannot load resource with ID {0} and path \"{1}\".Resource is corrupted.", p_id, resourceDesc->filePath);
 
-	if (resourceDesc->state == ResourceState::Unloaded || resourceDesc->state == ResourceState::Registered)
-		LoadResourcePrivate(resourceDesc, p_loader);
-	
+	LoadResourcePrivate(resourceDesc, p_loader);
+
+	MarkAccessed(resourceDesc);
+	return resourceDesc;
+}
+
+ResourceDescPtr ResourceDatabase::LoadAsync(std::string_view p_path, ResourceLoadCallback p_callback /*= nullptr*/, std::shared_ptr<IResourceDataLoader> p_loader /*= nullptr*/)
+{
+	PR_ASSERT(!p_path.empty(), "Resource path is empty");
+
+	auto resourceDesc = ResourceByPath(p_path);
+	if (resourceDesc == nullptr)
+		resourceDesc = RegisterFileResourcePrivate(p_path);
+
+	return LoadAsyncPrivate(resourceDesc, std::move(p_callback), std::move(p_loader));
+}
+
+ResourceDescPtr ResourceDatabase::LoadAsync(ResourceID p_id, ResourceLoadCallback p_callback /*= nullptr*/, std::shared_ptr<IResourceDataLoader> p_loader /*= nullptr*/)
+{
+	PR_ASSERT(p_id != InvalidID, "ResourceID is invalid.");
+
+	auto resourceDesc = ResourceByID(p_id);
+	if (resourceDesc == nullptr)
+	{
+		PRLOG_WARN("Cannot load resource with ID {0}. ID does not exist.", p_id);
+		return nullptr;
+	}
+
+	if (resourceDesc->origin != ResourceOrigin::File)
+	{
+		PRLOG_WARN("Cannot load resource with ID {0}. Only file resources can be loaded. Returning memory resource directly.", p_id);
+		if (p_callback)
+			p_callback(resourceDesc);
+		return resourceDesc;
+	}
+
+	if (resourceDesc->state == ResourceState::Corrupted)
+		PRLOG_WARN("Cannot load resource with ID {0} and path \"{1}\".Resource is corrupted.", p_id, resourceDesc->filePath);
+
+	return LoadAsyncPrivate(resourceDesc, std::move(p_callback), std::move(p_loader));
+}
+
+ResourceDescPtr ResourceDatabase::Reload(std::string_view p_path, ResourceLoadCallback p_callback /*= nullptr*/, ResourceReloadCheck p_check /*= nullptr*/)
+{
+	PR_ASSERT(!p_path.empty(), "Resource path is empty");
+
+	auto resourceDesc = ResourceByPath(p_path);
+	if (resourceDesc == nullptr)
+	{
+		PRLOG_WARN("Cannot reload resource with path \"{0}\". Resource is not registered.", p_path);
+		return nullptr;
+	}
+
+	ReloadPrivate(resourceDesc, std::move(p_callback), std::move(p_check));
 	return resourceDesc;
 }
 
-void ResourceDatabase::Unload(const std::string& p_path)
+void ResourceDatabase::WaitForLoad(ResourceID p_id)
+{
+	auto resourceDesc = ResourceByID(p_id);
+	if (resourceDesc == nullptr)
+		return;
+
+	StateLock lock(m_stateLock);
+	WaitWhileLoading(lock, resourceDesc);
+}
+
+void ResourceDatabase::FinalizeLoads(std::chrono::steady_clock::time_point p_deadline)
+{
+	while (true)
+	{
+		PendingLoadPtr pendingLoad;
+		{
+			std::lock_guard lock(m_finalizeQueueLock);
+			if (m_finalizeQueue.empty())
+				break;
+
+			pendingLoad = std::move(m_finalizeQueue.front());
+			m_finalizeQueue.pop_front();
+		}
+
+		if (pendingLoad->cancelled)
+			continue;
+
+		FinalizeLoadPrivate(pendingLoad);
+		if (std::chrono::steady_clock::now() >= p_deadline)
+			break;
+	}
+
+	std::vector<DeferredUnload> deferredUnloads;
+	{
+		std::lock_guard lock(m_stateLock);
+		std::erase_if(m_loadJobs, [](const Threading::JobStatePtr& p_jobState) {
+			return p_jobState->IsDone();
+			});
+		deferredUnloads.swap(m_deferredUnloads);
+	}
+
+	// Data unloaded or evicted on the other threads
+	for (auto& deferredUnload : deferredUnloads)
+		deferredUnload.loader->UnloadResource(std::move(deferredUnload.data));
+}
+
+bool ResourceDatabase::HasQueuedFinalizes() const
+{
+	std::lock_guard lock(m_finalizeQueueLock);
+	return !m_finalizeQueue.empty();
+}
+
+void ResourceDatabase::Unload(std::string_view p_path)
 {
 	PR_ASSERT(!p_path.empty(), "Resource path is empty");
-	auto lowerPath = PrCore::StringUtils::ToLower(p_path);
 
-	auto resourceDesc = ResourceByPath(lowerPath);
+	auto resourceDesc = ResourceByPath(p_path);
 	if (resourceDesc == nullptr)
 	{
-		PRLOG_WARN("Cannot unload resource with path \"{0}\". Resource does not exist.", lowerPath);
+		PRLOG_WARN("Cannot unload resource with path \"{0}\". Resource does not exist.", p_path);
 		return;
 	}
 
@@ -80,8 +185,17 @@ void ResourceDatabase::Unload(const std::string& p_path)
 	if (resourceDesc->state == ResourceState::Corrupted)
 		PRLOG_WARN("Cannot unload resource with ID {0} path \"{1}\". Resource is corrupted.", resourceDesc->id, resourceDesc->filePath);
 
-	if (resourceDesc->state == ResourceState::Loaded)
-		UnloadResourcePrivate(resourceDesc);
+	PendingLoadPtr cancelledLoad;
+	{
+		StateLock lock(m_stateLock);
+		cancelledLoad = CancelLoadPrivate(lock, resourceDesc);
+
+		DropCompressedPrivate(resourceDesc);
+		if (resourceDesc->state == ResourceState::Loaded)
+			UnloadResourcePrivate(resourceDesc);
+	}
+
+	CallLoadCallbacks(cancelledLoad);
 }
 
 void ResourceDatabase::Unload(ResourceID p_id)
@@ -104,8 +218,17 @@ void ResourceDatabase::Unload(ResourceID p_id)
 	if (resourceDesc->state == ResourceState::Corrupted)
 		PRLOG_WARN("Cannot unload resource with ID {0} path \"{1}\". Resource is corrupted.", p_id, resourceDesc->filePath);
 
-	if (resourceDesc->state == ResourceState::Loaded)
-		UnloadResourcePrivate(resourceDesc);
+	PendingLoadPtr cancelledLoad;
+	{
+		StateLock lock(m_stateLock);
+		cancelledLoad = CancelLoadPrivate(lock, resourceDesc);
+
+		DropCompressedPrivate(resourceDesc);
+		if (resourceDesc->state == ResourceState::Loaded)
+			UnloadResourcePrivate(resourceDesc);
+	}
+
+	CallLoadCallbacks(cancelledLoad);
 }
 
 PrCore::Resources::ResourceDescPtr ResourceDatabase::Get(ResourceID p_id)
@@ -119,33 +242,28 @@ PrCore::Resources::ResourceDescPtr ResourceDatabase::Get(ResourceID p_id)
 		return nullptr;
 	}
 
-	if (resourceDesc->origin == ResourceOrigin::File && (resourceDesc->state == ResourceState::Unloaded || resourceDesc->state == ResourceState::Registered))
-	{
-		LoadResourcePrivate(resourceDesc);
+	if (resourceDesc->origin == ResourceOrigin::File && LoadResourcePrivate(resourceDesc))
 		FireCacheMiss(resourceDesc->id, resourceDesc->filePath);
-	}
 
+	MarkAccessed(resourceDesc);
 	return resourceDesc;
 }
 
-PrCore::Resources::ResourceDescPtr ResourceDatabase::Get(const std::string& p_path)
+PrCore::Resources::ResourceDescPtr ResourceDatabase::Get(std::string_view p_path)
 {
 	PR_ASSERT(!p_path.empty(), "Resource path is empty");
-	auto lowerPath = PrCore::StringUtils::ToLower(p_path);
 
-	auto resourceDesc = ResourceByPath(lowerPath);
+	auto resourceDesc = ResourceByPath(p_path);
 	if (resourceDesc == nullptr)
 	{
-		PRLOG_WARN("Cannot load resource with path \"{0}\". Resource is not registered.", lowerPath);
+		PRLOG_WARN("Cannot load resource with path \"{0}\". Resource is not registered.", p_path);
 		return nullptr;
 	}
 
-	if (resourceDesc->origin == ResourceOrigin::File && (resourceDesc->state == ResourceState::Unloaded || resourceDesc->state == ResourceState::Registered))
-	{
-		LoadResourcePrivate(resourceDesc);
+	if (resourceDesc->origin == ResourceOrigin::File && LoadResourcePrivate(resourceDesc))
 		FireCacheMiss(resourceDesc->id, resourceDesc->filePath);
-	}
 
+	MarkAccessed(resourceDesc);
 	return resourceDesc;
 }
 
@@ -154,19 +272,18 @@ PrCore::Resources::ResourceDescPtr ResourceDatabase::Register(IResourceDataPtr p
 	return RegisterMemoryResourcePrivate(p_resourceData);
 }
 
-PrCore::Resources::ResourceDescPtr ResourceDatabase::Register(const std::string& p_path)
+PrCore::Resources::ResourceDescPtr ResourceDatabase::Register(std::string_view p_path)
 {
 	PR_ASSERT(!p_path.empty(), "Resource path is empty");
-	auto lowerPath = PrCore::StringUtils::ToLower(p_path);
 
-	auto resourceDesc = ResourceByPath(lowerPath);
+	auto resourceDesc = ResourceByPath(p_path);
 	if (resourceDesc)
 	{
-		PRLOG_WARN("Resource with path \"{0}\" already registered. Returning already registered", lowerPath);
+		PRLOG_WARN("Resource with path \"{0}\" already registered. Returning already registered", p_path);
 		return resourceDesc;
 	}
 
-	return RegisterFileResourcePrivate(lowerPath);
+	return RegisterFileResourcePrivate(p_path);
 }
 
 
@@ -181,45 +298,86 @@ bool ResourceDatabase::Remove(ResourceID p_id)
 		return false;
 	}
 
-	if (resourceDesc->origin == ResourceOrigin::File && resourceDesc->state == ResourceState::Loaded)
+	PendingLoadPtr cancelledLoad;
+	PendingLoadPtr cancelledReload;
 	{
-		UnloadResourcePrivate(resourceDesc);
-		FireUnloadedEvent(resourceDesc->id, resourceDesc->filePath);
-	}
+		StateLock lock(m_stateLock);
 
-	if (resourceDesc->origin == ResourceOrigin::Memory)
-		m_memoryUsage -= resourceDesc->size;
+		// Removed by another thread meanwhile
+		if (resourceDesc->id != p_id)
+			return false;
 
-	m_resourcesID.erase(resourceDesc->id);
-	if(resourceDesc->origin == ResourceOrigin::File && !resourceDesc->filePath.empty())
-		m_resourcesPaths.erase(resourceDesc->filePath);
+		cancelledLoad = CancelLoadPrivate(lock, resourceDesc);
+		cancelledReload = CancelReloadPrivate(resourceDesc);
 
-	// Remove custom loader for the removed resource
-	if(auto customLoaderIt = m_customLoaders.find(resourceDesc->id); customLoaderIt != m_customLoaders.end())
-		m_customLoaders.erase(customLoaderIt);
+		if (resourceDesc->origin == ResourceOrigin::File && resourceDesc->state == ResourceState::Loaded)
+		{
+			UnloadResourcePrivate(resourceDesc);
+			FireUnloadedEvent(resourceDesc->id, resourceDesc->filePath);
+		}
 
-	resourceDesc->id = InvalidID;
-	resourceDesc->data = nullptr;
-	resourceDesc->size = 0;
-	resourceDesc->state = ResourceState::Unmanaged;
+		if (resourceDesc->origin == ResourceOrigin::Memory)
+			ReleaseMemoryPrivate(resourceDesc);
 
+		{
+			auto& shard = ShardFor(m_resourcesID, resourceDesc->id);
+			std::unique_lock shardLock(shard.lock);
+			shard.resources.Erase(resourceDesc->id);
+		}
+
+		if (resourceDesc->origin == ResourceOrigin::File && !resourceDesc->filePath.empty())
+		{
+			auto pathHash = PathUtils::HashPath(resourceDesc->filePath);
+			auto& shard = ShardFor(m_resourcesPaths, pathHash);
+			std::unique_lock shardLock(shard.lock);
+			shard.resources.Erase(pathHash);
+		}
+
+		// Remove custom loader for the removed resource
+		m_customLoaders.Erase(resourceDesc->id);
+		TakeCompressedPrivate(resourceDesc->id);
+
+		resourceDesc->id = InvalidID;
+		resourceDesc->ReleaseSlot();
+		resourceDesc->size = 0;
+		resourceDesc->state = ResourceState::Unmanaged;
+	}
+
+	CallLoadCallbacks(cancelledLoad);
+	CallLoadCallbacks(cancelledReload);
 	return true;
 }
 
-PrCore::Resources::ResourceDescPtr ResourceDatabase::RegisterFileResourcePrivate(const std::string& p_path)
+PrCore::Resources::ResourceDescPtr ResourceDatabase::RegisterFileResourcePrivate(std::string_view p_path)
 {
 	PR_ASSERT(!p_path.empty(), "Resource path is empty");
 
+	// Path is normalized once, lookups hash the path as passed
+	auto filePath = PathUtils::Sanitize(p_path);
+	auto pathHash = PathUtils::HashPath(filePath);
+
+	auto& pathShard = ShardFor(m_resourcesPaths, pathHash);
+	std::unique_lock pathLock(pathShard.lock);
+
+	// Another thread registered the path meanwhile
+	if (auto registeredDesc = pathShard.resources.Find(pathHash))
+		return *registeredDesc;
+
+	// File resources keep the ID between the runs, memory resources are new every run
 	auto resourceDesc = std::make_shared<ResourceDesc>();
-	resourceDesc->id = Utils::UUIDGenerator().Generate();
-	resourceDesc->filePath = p_path;
+	resourceDesc->id = AssetRegistry::MakeID(filePath);
+	resourceDesc->filePath = std::move(filePath);
 	resourceDesc->state = ResourceState::Registered;
 	resourceDesc->origin = ResourceOrigin::File;
-	resourceDesc->data = nullptr;
+	resourceDesc->SetData(nullptr);
 	resourceDesc->size = 0;
 
-	m_resourcesID.emplace(resourceDesc->id, resourceDesc);
-	m_resourcesPaths.emplace(resourceDesc->filePath, resourceDesc);
+	{
+		auto& idShard = ShardFor(m_resourcesID, resourceDesc->id);
+		std::unique_lock idLock(idShard.lock);
+		idShard.resources.InsertOrAssign(resourceDesc->id, resourceDesc);
+	}
+	pathShard.resources.InsertOrAssign(pathHash, resourceDesc);
 
 	return resourceDesc;
 }
@@ -233,13 +391,18 @@ PrCore::Resources::ResourceDescPtr PrCore::Resources::ResourceDatabase::Register
 	resourceDesc->filePath = "";
 	resourceDesc->state = ResourceState::Registered;
 	resourceDesc->origin = ResourceOrigin::Memory;
-	resourceDesc->data = p_resourceData;
-	resourceDesc->size = p_resourceData->GetByteSize();
+	resourceDesc->SetData(p_resourceData);
+	resourceDesc->size = 0;
 
-	m_memoryUsage += resourceDesc->size;
-	CheckMemoryBudget(resourceDesc);
+	{
+		std::lock_guard lock(m_stateLock);
+		AddMemoryPrivate(resourceDesc);
+		CheckMemoryBudget(resourceDesc);
+	}
 
-	m_resourcesID.emplace(resourceDesc->id, resourceDesc);
+	auto& shard = ShardFor(m_resourcesID, resourceDesc->id);
+	std::unique_lock shardLock(shard.lock);
+	shard.resources.InsertOrAssign(resourceDesc->id, resourceDesc);
 
 	return resourceDesc;
 }
@@ -249,85 +412,544 @@ bool PrCore::Resources::ResourceDatabase::LoadResourcePrivate(const ResourceDesc
 	PR_ASSERT(p_resourceDesc, "Resource is nullptr");
 	PR_ASSERT(!p_resourceDesc->filePath.empty(), "Resource path is empty");
 
-	const std::string& path = p_resourceDesc->filePath;
+	// Loaded resources are returned without the state lock
+	auto state = p_resourceDesc->state.load();
+	if (state == ResourceState::Loaded || state == ResourceState::Corrupted)
+		return false;
+
+	StateLock lock(m_stateLock);
+	WaitWhileLoading(lock, p_resourceDesc);
+
+	state = p_resourceDesc->state;
+	if (state != ResourceState::Unloaded && state != ResourceState::Registered)
+		return false;
+
+	auto pendingLoad = std::make_shared<PendingLoad>();
+	pendingLoad->resourceDesc = p_resourceDesc;
+	pendingLoad->path = p_resourceDesc->filePath;
+	pendingLoad->loader = ResolveLoader(p_resourceDesc, p_loader);
+	if (auto customLoader = m_customLoaders.Find(p_resourceDesc->id))
+		pendingLoad->customLoader = *customLoader;
+	pendingLoad->compressed = TakeCompressedPrivate(p_resourceDesc->id);
+	pendingLoad->startTime = std::chrono::steady_clock::now();
+
+	// Loader needs the finalize thread, the resource is returned in Loading state and the load finishes there
+	if (!CanUseLoader(pendingLoad->loader))
+	{
+		p_resourceDesc->state = ResourceState::Loading;
+		m_pendingLoads.InsertOrAssign(p_resourceDesc->id, pendingLoad);
+		ScheduleLoadPrivate(pendingLoad);
+		return true;
+	}
+
+	// Threads requesting the resource meanwhile wait for this load
+	pendingLoad->synchronous = true;
+	p_resourceDesc->state = ResourceState::Loading;
+	m_pendingLoads.InsertOrAssign(p_resourceDesc->id, pendingLoad);
+	m_syncLoadCount++;
+	lock.unlock();
+
 	IResourceDataPtr resourceData = nullptr;
-	
-	// Check if custom loader was passed to use
-	if (p_loader)
+	if (pendingLoad->loader)
+	{
+		if (pendingLoad->compressed)
+			resourceData = PromoteResourcePrivate(pendingLoad);
+		if (resourceData == nullptr)
+			resourceData = pendingLoad->loader->LoadResource(pendingLoad->path);
+	}
+
+	lock.lock();
+	m_pendingLoads.Erase(p_resourceDesc->id);
+	m_syncLoadCount--;
+	if (CommitLoadedData(p_resourceDesc, resourceData))
+		RecordLoadTime(pendingLoad);
+	m_stateChanged.notify_all();
+	lock.unlock();
+
+	CallLoadCallbacks(pendingLoad);
+	return true;
+}
+
+ResourceDescPtr ResourceDatabase::LoadAsyncPrivate(const ResourceDescPtr& p_resourceDesc, ResourceLoadCallback p_callback, std::shared_ptr<IResourceDataLoader> p_loader)
+{
+	PR_ASSERT(p_resourceDesc, "Resource is nullptr");
+	MarkAccessed(p_resourceDesc);
+
+	StateLock lock(m_stateLock);
+	if (p_resourceDesc->state == ResourceState::Loading)
+	{
+		// Join the load in progress, its loader is kept
+		if (p_callback)
+			(*m_pendingLoads.Find(p_resourceDesc->id))->callbacks.push_back(std::move(p_callback));
+		return p_resourceDesc;
+	}
+
+	if (p_resourceDesc->state != ResourceState::Unloaded && p_resourceDesc->state != ResourceState::Registered)
+	{
+		lock.unlock();
+		if (p_callback)
+			p_callback(p_resourceDesc);
+		return p_resourceDesc;
+	}
+
+	auto pendingLoad = std::make_shared<PendingLoad>();
+	pendingLoad->resourceDesc = p_resourceDesc;
+	pendingLoad->path = p_resourceDesc->filePath;
+	pendingLoad->loader = ResolveLoader(p_resourceDesc, p_loader);
+	if (auto customLoader = m_customLoaders.Find(p_resourceDesc->id))
+		pendingLoad->customLoader = *customLoader;
+	if (p_callback)
+		pendingLoad->callbacks.push_back(std::move(p_callback));
+	pendingLoad->compressed = TakeCompressedPrivate(p_resourceDesc->id);
+	pendingLoad->startTime = std::chrono::steady_clock::now();
+
+	p_resourceDesc->state = ResourceState::Loading;
+	m_pendingLoads.InsertOrAssign(p_resourceDesc->id, pendingLoad);
+	ScheduleLoadPrivate(pendingLoad);
+
+	return p_resourceDesc;
+}
+
+void ResourceDatabase::ReloadPrivate(const ResourceDescPtr& p_resourceDesc, ResourceLoadCallback p_callback, ResourceReloadCheck p_check)
+{
+	PR_ASSERT(p_resourceDesc, "Resource is nullptr");
+
+	StateLock lock(m_stateLock);
+	if (p_resourceDesc->state == ResourceState::Loading)
+	{
+		// The load in progress may have read the file before the change, reload once it finishes
+		(*m_pendingLoads.Find(p_resourceDesc->id))->callbacks.push_back([this, callback = std::move(p_callback), check = std::move(p_check)](ResourceDescPtr p_loadedDesc) {
+			ReloadPrivate(p_loadedDesc, callback, check);
+			});
+		return;
+	}
+
+	if (p_resourceDesc->origin != ResourceOrigin::File || p_resourceDesc->state != ResourceState::Loaded)
+	{
+		// Compressed copy holds the previous file
+		DropCompressedPrivate(p_resourceDesc);
+		lock.unlock();
+		if (p_callback)
+			p_callback(p_resourceDesc);
+		return;
+	}
+
+	auto pendingLoad = std::make_shared<PendingLoad>();
+	pendingLoad->resourceDesc = p_resourceDesc;
+	pendingLoad->path = p_resourceDesc->filePath;
+	pendingLoad->loader = ResolveLoader(p_resourceDesc, nullptr);
+	if (auto customLoader = m_customLoaders.Find(p_resourceDesc->id))
+		pendingLoad->customLoader = *customLoader;
+	pendingLoad->reload = true;
+
+	// A newer change replaces the reload in progress, its callbacks wait for this one
+	// The replaced reload may have passed its check already, the check runs for what it records and the file is read anyway
+	pendingLoad->reloadCheck = std::move(p_check);
+	if (auto previousReload = m_pendingReloads.Find(p_resourceDesc->id))
 	{
-		//Use custom loader and insert it into the map, replace if another custom loader was used previously. 
-		resourceData = p_loader->LoadResource(path);
-		m_customLoaders.insert_or_assign(p_resourceDesc->id, p_loader);
+		(*previousReload)->cancelled = true;
+		pendingLoad->callbacks = std::move((*previousReload)->callbacks);
+
+		if (pendingLoad->reloadCheck)
+		{
+			pendingLoad->reloadCheck = [check = std::move(pendingLoad->reloadCheck)]() {
+				check();
+				return true;
+			};
+		}
+	}
+
+	if (p_callback)
+		pendingLoad->callbacks.push_back(std::move(p_callback));
+
+	m_pendingReloads.InsertOrAssign(p_resourceDesc->id, pendingLoad);
+	ScheduleLoadPrivate(pendingLoad);
+}
+
+void ResourceDatabase::ScheduleLoadPrivate(const PendingLoadPtr& p_pendingLoad)
+{
+	if (p_pendingLoad->loader && p_pendingLoad->loader->SupportsAsyncLoad())
+	{
+		p_pendingLoad->jobState = Threading::JobSystem::GetInstance().Schedule(Threading::JobPriority::Background, "LoadResourceAsync", [this, p_pendingLoad]() {
+			p_pendingLoad->unchanged = p_pendingLoad->reloadCheck && !p_pendingLoad->reloadCheck();
+			if (p_pendingLoad->compressed && !p_pendingLoad->unchanged)
+				p_pendingLoad->stagingData = PromoteResourceAsyncPrivate(p_pendingLoad);
+			if (p_pendingLoad->stagingData == nullptr && !p_pendingLoad->unchanged)
+				p_pendingLoad->stagingData = p_pendingLoad->loader->LoadResourceAsync(p_pendingLoad->path);
+
+			QueueFinalizePrivate(p_pendingLoad);
+			});
+		m_loadJobs.push_back(p_pendingLoad->jobState);
 	}
 	else
 	{
-		auto customLoader = m_customLoaders.find(p_resourceDesc->id);
-		if (customLoader != m_customLoaders.end())
+		// Loader without async support loads the whole resource in the finalize step
+		QueueFinalizePrivate(p_pendingLoad);
+	}
+}
+
+void ResourceDatabase::QueueFinalizePrivate(const PendingLoadPtr& p_pendingLoad)
+{
+	{
+		std::lock_guard lock(m_finalizeQueueLock);
+		m_finalizeQueue.push_back(p_pendingLoad);
+	}
+
+	if (m_finalizeQueuedCallback)
+		m_finalizeQueuedCallback();
+}
+
+void ResourceDatabase::FinalizeLoadPrivate(const PendingLoadPtr& p_pendingLoad)
+{
+	PR_ASSERT(!p_pendingLoad->synchronous, "Finalizing synchronous load");
+
+	// Finalize step runs without the state lock, the load can be cancelled meanwhile
+	IResourceDataPtr resourceData = nullptr;
+	auto loader = p_pendingLoad->loader;
+
+	// Loaders without async support check the file here, the others in the load job
+	if (loader && !loader->SupportsAsyncLoad() && p_pendingLoad->reloadCheck)
+		p_pendingLoad->unchanged = !p_pendingLoad->reloadCheck();
+
+	if (loader && !p_pendingLoad->unchanged)
+	{
+		if (loader->SupportsAsyncLoad())
 		{
-			// Use a custom loader if assigned
-			resourceData = customLoader->second->LoadResource(path);
+			resourceData = loader->FinalizeResource(std::move(p_pendingLoad->stagingData), p_pendingLoad->path);
 		}
 		else
 		{
-			// Use default loader for extension
-			auto loaderIt = m_loaders.find(PathUtils::GetExtension(path));
-			PR_ASSERT(loaderIt != m_loaders.end(), "Cannot load resource. Resource loader not registered.");
+			if (p_pendingLoad->compressed)
+				resourceData = PromoteResourcePrivate(p_pendingLoad);
+			if (resourceData == nullptr)
+				resourceData = loader->LoadResource(p_pendingLoad->path);
+		}
+	}
+
+	auto& resourceDesc = p_pendingLoad->resourceDesc;
+	StateLock lock(m_stateLock);
+	if (p_pendingLoad->cancelled)
+	{
+		if (resourceData)
+			p_pendingLoad->loader->UnloadResource(resourceData);
+		return;
+	}
+
+	if (p_pendingLoad->reload)
+	{
+		CommitReloadedData(p_pendingLoad, std::move(resourceData));
+	}
+	else
+	{
+		m_pendingLoads.Erase(resourceDesc->id);
+		if (CommitLoadedData(resourceDesc, resourceData))
+			RecordLoadTime(p_pendingLoad);
+		m_stateChanged.notify_all();
+	}
+	lock.unlock();
+
+	CallLoadCallbacks(p_pendingLoad);
+}
+
+void ResourceDatabase::WaitWhileLoading(StateLock& p_lock, const ResourceDescPtr& p_resourceDesc)
+{
+	while (p_resourceDesc->state == ResourceState::Loading)
+	{
+		auto pendingLoad = *m_pendingLoads.Find(p_resourceDesc->id);
+
+		// The finalize thread may be waiting for this thread, the load is not waited for
+		if (!CanUseLoader(pendingLoad->loader))
+			return;
+
+		if (pendingLoad->synchronous)
+		{
+			m_stateChanged.wait(p_lock);
+			continue;
+		}
 
-			if (loaderIt != m_loaders.end())
-				resourceData = loaderIt->second->LoadResource(path);
+		p_lock.unlock();
+		if (pendingLoad->jobState)
+			pendingLoad->jobState->Wait();
+
+		// Finalize out of order, the load is already in the queue
+		bool queued = false;
+		{
+			std::lock_guard queueLock(m_finalizeQueueLock);
+			auto queueIt = std::find(m_finalizeQueue.begin(), m_finalizeQueue.end(), pendingLoad);
+			if (queueIt != m_finalizeQueue.end())
+			{
+				m_finalizeQueue.erase(queueIt);
+				queued = true;
+			}
 		}
+
+		if (queued)
+			FinalizeLoadPrivate(pendingLoad);
+		p_lock.lock();
+
+		// Another thread took the load from the queue, it commits the data under the lock
+		auto currentLoad = m_pendingLoads.Find(p_resourceDesc->id);
+		if (!queued && p_resourceDesc->state == ResourceState::Loading && currentLoad && *currentLoad == pendingLoad)
+			m_stateChanged.wait(p_lock);
+	}
+}
+
+ResourceDatabase::PendingLoadPtr ResourceDatabase::CancelLoadPrivate(StateLock& p_lock, const ResourceDescPtr& p_resourceDesc)
+{
+	if (p_resourceDesc->state != ResourceState::Loading)
+		return nullptr;
+
+	auto pendingLoad = *m_pendingLoads.Find(p_resourceDesc->id);
+	if (pendingLoad->synchronous)
+	{
+		// Synchronous loads finish without the other threads
+		m_stateChanged.wait(p_lock, [&]() {
+			auto currentLoad = m_pendingLoads.Find(p_resourceDesc->id);
+			return currentLoad == nullptr || *currentLoad != pendingLoad;
+			});
+		return nullptr;
+	}
+
+	// Worker result is dropped when the load reaches the finalize queue
+	pendingLoad->cancelled = true;
+	m_pendingLoads.Erase(p_resourceDesc->id);
+
+	p_resourceDesc->state = ResourceState::Unloaded;
+	m_stateChanged.notify_all();
+	PRLOG_INFO("Cancelled loading resource path \"{0}\" with UUID {1}", p_resourceDesc->filePath, p_resourceDesc->id);
+
+	return pendingLoad;
+}
+
+void ResourceDatabase::CallLoadCallbacks(const PendingLoadPtr& p_pendingLoad)
+{
+	// The load is no longer pending, no callbacks are added
+	if (p_pendingLoad == nullptr)
+		return;
+
+	for (auto& callback : p_pendingLoad->callbacks)
+		callback(p_pendingLoad->resourceDesc);
+}
+
+void ResourceDatabase::CommitReloadedData(const PendingLoadPtr& p_pendingLoad, IResourceDataPtr p_resourceData)
+{
+	auto& resourceDesc = p_pendingLoad->resourceDesc;
+	m_pendingReloads.Erase(resourceDesc->id);
+
+	// Unloaded meanwhile, the next load reads the new file
+	if (resourceDesc->state != ResourceState::Loaded)
+	{
+		if (p_resourceData)
+			p_pendingLoad->loader->UnloadResource(p_resourceData);
+		return;
 	}
 
-	if (resourceData == nullptr)
+	if (p_pendingLoad->unchanged)
+		return;
+
+	// The file may be written again soon, keep the working data
+	if (p_resourceData == nullptr)
+	{
+		PRLOG_WARN("Cannot reload resource path \"{0}\" with ID {1}. Keeping the previous data.", resourceDesc->filePath, resourceDesc->id);
+		return;
+	}
+
+	// New data replaces the previous one in a single atomic store, readers without the lock never see nullptr, see ResourceDesc::SetData
+	auto previousData = resourceDesc->GetData();
+	ReleaseMemoryPrivate(resourceDesc);
+
+	PRLOG_INFO("Reloading resource path \"{0}\" with UUID {1}", resourceDesc->filePath, resourceDesc->id);
+	CommitLoadedData(resourceDesc, p_resourceData);
+
+	p_pendingLoad->loader->UnloadResource(previousData);
+}
+
+ResourceDatabase::PendingLoadPtr ResourceDatabase::CancelReloadPrivate(const ResourceDescPtr& p_resourceDesc)
+{
+	auto pendingReload = m_pendingReloads.Find(p_resourceDesc->id);
+	if (pendingReload == nullptr)
+		return nullptr;
+
+	// Worker result is dropped like for a cancelled load
+	auto cancelledReload = std::move(*pendingReload);
+	cancelledReload->cancelled = true;
+	m_pendingReloads.Erase(p_resourceDesc->id);
+
+	return cancelledReload;
+}
+
+void ResourceDatabase::WaitForAllLoadsPrivate()
+{
+	std::vector<Threading::JobStatePtr> loadJobs;
+	{
+		// Synchronous loads use the loaders outside of the lock
+		StateLock lock(m_stateLock);
+		m_stateChanged.wait(lock, [this]() { return m_syncLoadCount == 0; });
+		loadJobs.swap(m_loadJobs);
+	}
+
+	for (auto& jobState : loadJobs)
+		jobState->Wait();
+
+	FinalizeLoads(std::chrono::steady_clock::time_point::max());
+}
+
+IResourceDataLoader* ResourceDatabase::ResolveLoader(const ResourceDescPtr& p_resourceDesc, const std::shared_ptr<IResourceDataLoader>& p_loader)
+{
+	// Check if custom loader was passed to use
+	if (p_loader)
+	{
+		// Bind custom loader to the resource, replace if another custom loader was used previously
+		m_customLoaders.InsertOrAssign(p_resourceDesc->id, p_loader);
+		return p_loader.get();
+	}
+
+	// Use a custom loader if assigned
+	if (auto customLoader = m_customLoaders.Find(p_resourceDesc->id))
+		return customLoader->get();
+
+	// Use default loader for extension
+	auto loader = LoaderByExtension(p_resourceDesc->filePath);
+	PR_ASSERT(loader != nullptr, "Cannot load resource. Resource loader not registered.");
+
+	return loader;
+}
+
+bool ResourceDatabase::CommitLoadedData(const ResourceDescPtr& p_resourceDesc, IResourceDataPtr p_resourceData)
+{
+	const std::string& path = p_resourceDesc->filePath;
+	if (p_resourceData == nullptr)
 	{
 		PRLOG_WARN("Cannot load resource path \"{0}\" with ID {1}", path, p_resourceDesc->id);
 		FireCorruptedEvent(p_resourceDesc->id, path);
 
-		p_resourceDesc->data = nullptr;
+		p_resourceDesc->SetData(nullptr);
 		p_resourceDesc->size = 0;
 		p_resourceDesc->state = ResourceState::Corrupted;
-		p_resourceDesc->origin = ResourceOrigin::File;
 
 		return false;
 	}
 
 	// Set resource data name for logging purpose
-	resourceData->SetName(path);
+	p_resourceData->SetName(path);
 
-	p_resourceDesc->data = resourceData;
-	p_resourceDesc->size = resourceData->GetByteSize();
+	p_resourceDesc->SetData(p_resourceData);
+	AddMemoryPrivate(p_resourceDesc);
 	p_resourceDesc->state = ResourceState::Loaded;
-	p_resourceDesc->origin = ResourceOrigin::File;
 
 	PRLOG_INFO("Loaded resource path \"{0}\" with UUID {1}", path, p_resourceDesc->id);
 	FireLoadedEvent(p_resourceDesc->id, p_resourceDesc->filePath);
-	
-	m_memoryUsage += p_resourceDesc->size;
+
 	CheckMemoryBudget(p_resourceDesc);
 
 	return true;
 }
 
+void ResourceDatabase::AddMemoryPrivate(const ResourceDescPtr& p_resourceDesc)
+{
+	auto resourceData = p_resourceDesc->GetData();
+	auto dataSize = resourceData->GetByteSize();
+
+	ResourceBlocks resourceBlocks;
+	size_t blocksSize = 0;
+	size_t countedSize = 0;
+	resourceData->ForEachBlock([&](const std::shared_ptr<const void>& p_block, size_t p_size) {
+		auto blockKey = reinterpret_cast<uint64_t>(p_block.get());
+		auto [sharedBlock, inserted] = m_sharedBlocks.TryEmplace(blockKey);
+		if (inserted)
+		{
+			sharedBlock->block = p_block;
+			sharedBlock->size = p_size;
+			countedSize += p_size;
+		}
+
+		sharedBlock->holders++;
+		resourceBlocks.blocks.push_back(blockKey);
+		blocksSize += p_size;
+	});
+
+	if (resourceBlocks.blocks.empty())
+	{
+		p_resourceDesc->size = dataSize;
+	}
+	else
+	{
+		resourceBlocks.exclusiveSize = dataSize > blocksSize ? dataSize - blocksSize : 0;
+		p_resourceDesc->size = resourceBlocks.exclusiveSize + countedSize;
+		m_resourceBlocks.InsertOrAssign(p_resourceDesc->id, std::move(resourceBlocks));
+	}
+
+	m_memoryUsage += p_resourceDesc->size;
+}
+
+void ResourceDatabase::ReleaseMemoryPrivate(const ResourceDescPtr& p_resourceDesc)
+{
+	auto resourceBlocks = m_resourceBlocks.Find(p_resourceDesc->id);
+	if (resourceBlocks == nullptr)
+	{
+		m_memoryUsage -= p_resourceDesc->size;
+		return;
+	}
+
+	// Blocks still held by other resources stay counted
+	size_t releasedSize = resourceBlocks->exclusiveSize;
+	for (auto blockKey : resourceBlocks->blocks)
+	{
+		auto sharedBlock = m_sharedBlocks.Find(blockKey);
+		PR_ASSERT(sharedBlock != nullptr && sharedBlock->holders > 0, "Shared block is not counted");
+
+		if (--sharedBlock->holders == 0)
+		{
+			releasedSize += sharedBlock->size;
+			m_sharedBlocks.Erase(blockKey);
+		}
+	}
+
+	m_resourceBlocks.Erase(p_resourceDesc->id);
+	m_memoryUsage -= releasedSize;
+}
+
+void ResourceDatabase::NotifyChanged(ResourceID p_id)
+{
+	PR_ASSERT(p_id != InvalidID, "ResourceID is invalid.");
+
+	auto resourceDesc = ResourceByID(p_id);
+	if (resourceDesc == nullptr)
+	{
+		PRLOG_WARN("Cannot count resource with ID {0}. Resource is not registered.", p_id);
+		return;
+	}
+
+	// Removed meanwhile, resources without data are counted when it is committed
+	std::lock_guard lock(m_stateLock);
+	if (resourceDesc->id != p_id || resourceDesc->GetRawData() == nullptr)
+		return;
+
+	ReleaseMemoryPrivate(resourceDesc);
+	AddMemoryPrivate(resourceDesc);
+	CheckMemoryBudget(resourceDesc);
+}
+
 PrCore::Resources::IResourceDataLoader* PrCore::Resources::ResourceDatabase::GetLoader(const std::string& p_fileExtension)
 {
 	PR_ASSERT(!p_fileExtension.empty(), "File extension is empty");
-	auto lowerExt = PrCore::StringUtils::ToLower(p_fileExtension);
 
-	auto it = m_loaders.find(lowerExt);
-	if (it == m_loaders.end())
+	std::shared_lock lock(m_loadersLock);
+	auto loader = m_loaders.Find(PathUtils::HashPath(p_fileExtension));
+	if (loader == nullptr)
 		return nullptr;
 
 	// Return raw ptr, possible risk of deleting the ptr by the client.
-	return it->second.get();
+	return loader->get();
 }
 
 PrCore::Resources::ResourceDescPtr ResourceDatabase::SaveToFileAndLoad(ResourceID p_sourceId, const std::string& p_path)
 {
 	PR_ASSERT(!p_path.empty(), "File path is empty");
-	auto lowerPath = PrCore::StringUtils::ToLower(p_path);
+	auto filePath = PathUtils::Sanitize(p_path);
 
 	// Save to File
-	bool success = SaveToFile(p_sourceId, lowerPath);
+	bool success = SaveToFilePrivate(p_sourceId, filePath);
 
 	if (!success)
 	{
@@ -335,16 +957,17 @@ PrCore::Resources::ResourceDescPtr ResourceDatabase::SaveToFileAndLoad(ResourceI
 		return nullptr;
 	}
 
-	auto customLoaderIt = m_customLoaders.find(p_sourceId);
-	auto customLoader = customLoaderIt != m_customLoaders.end() ? customLoaderIt->second : nullptr;
-	return Load(lowerPath, customLoader);
+	return Load(filePath, FindCustomLoader(p_sourceId));
 }
 
 bool ResourceDatabase::SaveToFile(ResourceID p_sourceId, const std::string& p_path)
 {
 	PR_ASSERT(!p_path.empty(), "File path is empty");
-	auto lowerPath = PrCore::StringUtils::ToLower(p_path);
+	return SaveToFilePrivate(p_sourceId, PathUtils::Sanitize(p_path));
+}
 
+bool ResourceDatabase::SaveToFilePrivate(ResourceID p_sourceId, const std::string& p_filePath)
+{
 	// Get Load if necessary
 	auto resourceDesc = Get(p_sourceId);
 	if (resourceDesc == nullptr)
@@ -352,18 +975,17 @@ bool ResourceDatabase::SaveToFile(ResourceID p_sourceId, const std::string& p_pa
 
 	// Get loader
 	bool success = false;
-	auto customLoaderIt = m_customLoaders.find(resourceDesc->id);
-	if (customLoaderIt != m_customLoaders.end())
+	if (auto customLoader = FindCustomLoader(p_sourceId))
 	{
-		success = customLoaderIt->second->SaveResourceOnDisc(resourceDesc->data, lowerPath);
+		success = customLoader->SaveResourceOnDisc(resourceDesc->GetData(), p_filePath);
 	}
 	else
 	{
-		auto loaderIt = m_loaders.find(PathUtils::GetExtension(lowerPath));
-		PR_ASSERT(loaderIt != m_loaders.end(), "Cannot unload resource. Resource loader not registered.");
+		auto loader = LoaderByExtension(p_filePath);
+		PR_ASSERT(loader != nullptr, "Cannot unload resource. Resource loader not registered.");
 
-		if (loaderIt != m_loaders.end())
-			success = loaderIt->second->SaveResourceOnDisc(resourceDesc->data, lowerPath);
+		if (loader != nullptr)
+			success = loader->SaveResourceOnDisc(resourceDesc->GetData(), p_filePath);
 	}
 	
 	return success;
@@ -371,31 +993,32 @@ bool ResourceDatabase::SaveToFile(ResourceID p_sourceId, const std::string& p_pa
 
 void ResourceDatabase::ForEachResource(ResourceVisitor p_visitor)
 {
-	for (auto [_, resourceDesc] : m_resourcesID)
+	for (auto& resourceDesc : SnapshotResources(m_resourcesID))
 		p_visitor(resourceDesc);
 }
 
 void ResourceDatabase::RemoveAll()
 {
 	std::vector<ResourceID> tempIDs;
-	tempIDs.reserve(m_resourcesID.size());
-
-	for (auto& [id, _] : m_resourcesID)
-		tempIDs.push_back(id);
+	for (auto& shard : m_resourcesID)
+	{
+		std::shared_lock lock(shard.lock);
+		for (auto& [id, _] : shard.resources)
+			tempIDs.push_back(id);
+	}
 	
 	for (auto id : tempIDs)
 		Remove(id);
 }
 
-PrCore::Resources::ResourceDescPtr ResourceDatabase::GetMetadata(const std::string& p_path)
+PrCore::Resources::ResourceDescPtr ResourceDatabase::GetMetadata(std::string_view p_path)
 {
 	PR_ASSERT(!p_path.empty(), "Resource path is empty");
-	auto lowerPath = PrCore::StringUtils::ToLower(p_path);
 
-	auto resourceDesc = ResourceByPath(lowerPath);
+	auto resourceDesc = ResourceByPath(p_path);
 	if (resourceDesc == nullptr)
 	{
-		PRLOG_WARN("Cannot unload resource with path \"{0}\". Resource is not registered.", lowerPath);
+		PRLOG_WARN("Cannot unload resource with path \"{0}\". Resource is not registered.", p_path);
 		return nullptr;
 	}
 
@@ -416,35 +1039,348 @@ PrCore::Resources::ResourceDescPtr ResourceDatabase::GetMetadata(ResourceID p_id
 	return resourceDesc;
 }
 
+std::vector<ResourceDependency> ResourceDatabase::GetDependencies(std::string_view p_path)
+{
+	PR_ASSERT(!p_path.empty(), "Resource path is empty");
+
+	// Loaders get the normalized path like in the load
+	auto filePath = PathUtils::Sanitize(p_path);
+	if (auto resourceDesc = ResourceByPath(p_path))
+	{
+		if (auto customLoader = FindCustomLoader(resourceDesc->id))
+			return customLoader->GetDependencies(filePath);
+	}
+
+	if (auto loader = LoaderByExtension(filePath))
+		return loader->GetDependencies(filePath);
+
+	return {};
+}
+
+bool ResourceDatabase::Cook(std::string_view p_path)
+{
+	PR_ASSERT(!p_path.empty(), "Resource path is empty");
+
+	auto filePath = PathUtils::Sanitize(p_path);
+	if (auto loader = LoaderByExtension(filePath))
+		return loader->CookResource(filePath);
+
+	PRLOG_WARN("Cannot cook resource \"{0}\". Loader is not registered.", p_path);
+	return false;
+}
+
 void ResourceDatabase::CheckMemoryBudget(ResourceDescPtr p_resource)
 {
+	// Hysteresis, evict below the high watermark so the next loads do not evict again
+	if (m_evictionPolicy.enabled && m_memoryUsage > static_cast<size_t>(m_memoryBudget * m_evictionPolicy.highWatermark))
+		EvictResources(static_cast<size_t>(m_memoryBudget * m_evictionPolicy.lowWatermark));
+
 	if (m_memoryUsage > m_memoryBudget)
 		FireBudgetExceeded(p_resource->id, p_resource->filePath, m_memoryUsage, m_memoryBudget);
 }
 
+void ResourceDatabase::EvictResources(size_t p_targetUsage)
+{
+	// Only file resources can be loaded back
+	std::vector<ResourceDescPtr> candidates;
+	for (auto& shard : m_resourcesPaths)
+	{
+		std::shared_lock lock(shard.lock);
+		for (auto& [_, resourceDesc] : shard.resources)
+		{
+			if (resourceDesc->state == ResourceState::Loaded && resourceDesc->pinCount == 0 && !IsReferenced(resourceDesc, 2))
+				candidates.push_back(resourceDesc);
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const ResourceDescPtr& p_lhs, const ResourceDescPtr& p_rhs) {
+		return p_lhs->lastAccess < p_rhs->lastAccess;
+		});
+
+	for (auto& resourceDesc : candidates)
+	{
+		if (m_memoryUsage <= p_targetUsage)
+			break;
+
+		// Another thread may have taken the resource since it was collected
+		// Lookups wait for the shard locks, the resource is checked and detached before any new reference is taken
+		IResourceDataPtr resourceData;
+		{
+			auto pathHash = PathUtils::HashPath(resourceDesc->filePath);
+			std::unique_lock pathLock(ShardFor(m_resourcesPaths, pathHash).lock);
+			std::unique_lock idLock(ShardFor(m_resourcesID, resourceDesc->id).lock);
+
+			// Candidate list holds one more reference
+			if (resourceDesc->state != ResourceState::Loaded || resourceDesc->pinCount > 0 || IsReferenced(resourceDesc, 3))
+				continue;
+
+			PRLOG_INFO("Evicting resource path \"{0}\" with UUID {1}", resourceDesc->filePath, resourceDesc->id);
+			resourceData = DetachDataPrivate(resourceDesc);
+		}
+
+		ReleaseDataPrivate(resourceDesc, std::move(resourceData));
+
+		if (IsCompressionEnabled())
+			DemoteResourcePrivate(resourceDesc);
+	}
+}
+
+bool ResourceDatabase::IsReferenced(const ResourceDescPtr& p_resourceDesc, long p_ownedReferences) const
+{
+	// ID and path maps own two references to the descriptor, the data is owned by the descriptor and the copy taken here
+	auto resourceData = p_resourceDesc->GetData();
+	return p_resourceDesc.use_count() > p_ownedReferences || (resourceData && resourceData.use_count() > 2);
+}
+
+void ResourceDatabase::SetEvictionPolicy(const ResourceEvictionPolicy& p_policy)
+{
+	PR_ASSERT(p_policy.lowWatermark <= p_policy.highWatermark, "Eviction low watermark is above the high watermark");
+
+	std::lock_guard lock(m_stateLock);
+	m_evictionPolicy = p_policy;
+
+	if (!IsCompressionEnabled())
+		TrimCompressedResources(0);
+}
+
+void ResourceDatabase::SetCompressedMemoryBudget(size_t p_budget)
+{
+	std::lock_guard lock(m_stateLock);
+	m_compressedMemoryBudget = p_budget;
+
+	TrimCompressedResources(IsCompressionEnabled() ? p_budget : 0);
+}
+
+ResourceResidencyStats ResourceDatabase::GetResidencyStats()
+{
+	ResourceResidencyStats stats;
+	for (auto& resourceDesc : SnapshotResources(m_resourcesID))
+	{
+		if (resourceDesc->GetRawData())
+			stats.residentCount++;
+	}
+
+	std::lock_guard lock(m_stateLock);
+	stats.residentBytes = m_memoryUsage;
+	stats.compressedCount = m_compressedResources.Size();
+	stats.compressedBytes = m_compressedMemoryUsage;
+	stats.payloadBytes = m_compressedPayloadSize;
+	stats.demotions = m_demotions;
+	stats.promotions = m_promotions;
+	stats.fileLoads = m_fileLoads;
+	stats.promotionTime = m_promotionTime;
+	stats.fileLoadTime = m_fileLoadTime;
+
+	return stats;
+}
+
+void ResourceDatabase::DemoteResourcePrivate(const ResourceDescPtr& p_resourceDesc)
+{
+	// Custom loader is kept alive by the job, extension loaders are released after the load jobs finished
+	std::shared_ptr<IResourceDataLoader> customLoader;
+	IResourceDataLoader* loader = nullptr;
+	if (auto foundLoader = m_customLoaders.Find(p_resourceDesc->id))
+	{
+		customLoader = *foundLoader;
+		loader = customLoader.get();
+	}
+	else
+	{
+		loader = LoaderByExtension(p_resourceDesc->filePath);
+	}
+
+	if (loader == nullptr)
+		return;
+
+	auto demoteJob = Threading::JobSystem::GetInstance().Schedule(Threading::JobPriority::Background, "DemoteResource",
+		[this, resourceDesc = p_resourceDesc, path = p_resourceDesc->filePath, generation = p_resourceDesc->GetGeneration(), loader, customLoader]() {
+			std::vector<uint8_t> payload;
+			if (!loader->ReadCookedPayload(path, payload) || payload.empty())
+				return;
+
+			auto compressed = std::make_shared<CompressedResource>();
+			compressed->data.resize(Utils::CompressBound(payload.size()));
+			auto compressedSize = Utils::Compress(payload.data(), payload.size(), compressed->data.data(), compressed->data.size());
+			if (compressedSize == 0)
+				return;
+
+			compressed->data.resize(compressedSize);
+			compressed->data.shrink_to_fit();
+			compressed->payloadSize = payload.size();
+			compressed->lastAccess = resourceDesc->lastAccess;
+
+			// Loaded, reloaded or removed meanwhile
+			std::lock_guard lock(m_stateLock);
+			if (resourceDesc->GetGeneration() != generation || resourceDesc->state != ResourceState::Unloaded || !IsCompressionEnabled())
+				return;
+
+			m_compressedResources.InsertOrAssign(resourceDesc->id, compressed);
+			m_compressedMemoryUsage += compressed->data.size();
+			m_compressedPayloadSize += compressed->payloadSize;
+			m_demotions++;
+
+			PRLOG_INFO("Demoted resource path \"{0}\" with UUID {1}, {2} bytes compressed to {3}", path, resourceDesc->id, compressed->payloadSize, compressed->data.size());
+			TrimCompressedResources(m_compressedMemoryBudget);
+		});
+	m_loadJobs.push_back(demoteJob);
+}
+
+void ResourceDatabase::TrimCompressedResources(size_t p_targetUsage)
+{
+	if (m_compressedMemoryUsage <= p_targetUsage)
+		return;
+
+	// Least recently used copies are dropped first, the resources load from the files again
+	std::vector<std::pair<uint64_t, ResourceID>> candidates;
+	candidates.reserve(m_compressedResources.Size());
+	for (auto& [id, compressed] : m_compressedResources)
+		candidates.emplace_back(compressed->lastAccess, id);
+
+	std::sort(candidates.begin(), candidates.end());
+	for (auto& [_, id] : candidates)
+	{
+		if (m_compressedMemoryUsage <= p_targetUsage)
+			break;
+
+		TakeCompressedPrivate(id);
+	}
+}
+
+ResourceDatabase::CompressedResourcePtr ResourceDatabase::TakeCompressedPrivate(ResourceID p_id)
+{
+	auto foundCompressed = m_compressedResources.Find(p_id);
+	if (foundCompressed == nullptr)
+		return nullptr;
+
+	auto compressed = std::move(*foundCompressed);
+	m_compressedResources.Erase(p_id);
+	m_compressedMemoryUsage -= compressed->data.size();
+	m_compressedPayloadSize -= compressed->payloadSize;
+
+	return compressed;
+}
+
+void ResourceDatabase::DropCompressedPrivate(const ResourceDescPtr& p_resourceDesc)
+{
+	TakeCompressedPrivate(p_resourceDesc->id);
+
+	// Demotion in progress is dropped as well
+	if (p_resourceDesc->state == ResourceState::Unloaded)
+		p_resourceDesc->NextGeneration();
+}
+
+IResourceDataPtr ResourceDatabase::PromoteResourcePrivate(const PendingLoadPtr& p_pendingLoad)
+{
+	auto& compressed = *p_pendingLoad->compressed;
+	std::vector<uint8_t> payload(compressed.payloadSize);
+	if (!Utils::Decompress(compressed.data.data(), compressed.data.size(), payload.data(), payload.size()))
+	{
+		PRLOG_WARN("Cannot decompress resource path \"{0}\". Loading the file.", p_pendingLoad->path);
+		return nullptr;
+	}
+
+	auto resourceData = p_pendingLoad->loader->LoadCookedResource(p_pendingLoad->path, payload);
+	p_pendingLoad->promoted = resourceData != nullptr;
+	return resourceData;
+}
+
+IResourceStagingDataPtr ResourceDatabase::PromoteResourceAsyncPrivate(const PendingLoadPtr& p_pendingLoad)
+{
+	auto& compressed = *p_pendingLoad->compressed;
+	std::vector<uint8_t> payload(compressed.payloadSize);
+	if (!Utils::Decompress(compressed.data.data(), compressed.data.size(), payload.data(), payload.size()))
+	{
+		PRLOG_WARN("Cannot decompress resource path \"{0}\". Loading the file.", p_pendingLoad->path);
+		return nullptr;
+	}
+
+	auto stagingData = p_pendingLoad->loader->LoadCookedResourceAsync(p_pendingLoad->path, payload);
+	p_pendingLoad->promoted = stagingData != nullptr;
+	return stagingData;
+}
+
+void ResourceDatabase::RecordLoadTime(const PendingLoadPtr& p_pendingLoad)
+{
+	auto loadTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - p_pendingLoad->startTime);
+	if (p_pendingLoad->promoted)
+	{
+		m_promotions++;
+		m_promotionTime += loadTime;
+	}
+	else
+	{
+		m_fileLoads++;
+		m_fileLoadTime += loadTime;
+	}
+}
+
+void ResourceDatabase::Pin(ResourceID p_id)
+{
+	PR_ASSERT(p_id != InvalidID, "ResourceID is invalid.");
+
+	auto resourceDesc = ResourceByID(p_id);
+	if (resourceDesc == nullptr)
+	{
+		PRLOG_WARN("Cannot pin resource with ID {0}. Resource is not registered.", p_id);
+		return;
+	}
+
+	std::lock_guard lock(m_stateLock);
+	resourceDesc->pinCount++;
+}
+
+void ResourceDatabase::Unpin(ResourceID p_id)
+{
+	PR_ASSERT(p_id != InvalidID, "ResourceID is invalid.");
+
+	auto resourceDesc = ResourceByID(p_id);
+	if (resourceDesc == nullptr)
+	{
+		PRLOG_WARN("Cannot unpin resource with ID {0}. Resource is not registered.", p_id);
+		return;
+	}
+
+	std::lock_guard lock(m_stateLock);
+	PR_ASSERT(resourceDesc->pinCount > 0, "Resource is not pinned");
+	resourceDesc->pinCount--;
+}
+
 void ResourceDatabase::UnloadAll()
 {
-	for (auto& [_, resourceDesc] : m_resourcesPaths)
+	std::vector<PendingLoadPtr> cancelledLoads;
 	{
-		if (resourceDesc->origin == ResourceOrigin::File && resourceDesc->state == ResourceState::Loaded)
-			UnloadResourcePrivate(resourceDesc);
+		StateLock lock(m_stateLock);
+		for (auto& resourceDesc : SnapshotResources(m_resourcesPaths))
+		{
+			if (auto cancelledLoad = CancelLoadPrivate(lock, resourceDesc))
+				cancelledLoads.push_back(std::move(cancelledLoad));
+
+			DropCompressedPrivate(resourceDesc);
+			if (resourceDesc->origin == ResourceOrigin::File && resourceDesc->state == ResourceState::Loaded)
+				UnloadResourcePrivate(resourceDesc);
+		}
 	}
+
+	for (auto& cancelledLoad : cancelledLoads)
+		CallLoadCallbacks(cancelledLoad);
 }
 
 void ResourceDatabase::UnregisterLoader(const std::string& p_fileExtension)
 {
 	PR_ASSERT(!p_fileExtension.empty(), "File extension is empty");
-	auto lowerExt = PrCore::StringUtils::ToLower(p_fileExtension);
 
-	auto it = m_loaders.find(lowerExt);
-
-	if (it == m_loaders.end())
+	auto extensionHash = PathUtils::HashPath(p_fileExtension);
+	if (GetLoader(p_fileExtension) == nullptr)
 	{
-		PRLOG_WARN("Loader with extension \"{0}\" is not registered. Cannot unregister the loader.", lowerExt);
+		PRLOG_WARN("Loader with extension \"{0}\" is not registered. Cannot unregister the loader.", p_fileExtension);
 		return;
 	}
 
-	m_loaders.erase(it);
+	// Workers may still use the loader
+	WaitForAllLoadsPrivate();
+
+	std::unique_lock lock(m_loadersLock);
+	m_loaders.Erase(extensionHash);
 }
 
 void ResourceDatabase::RegisterLoader(const std::string& p_fileExtension, std::unique_ptr<IResourceDataLoader> p_loader)
@@ -452,44 +1388,73 @@ void ResourceDatabase::RegisterLoader(const std::string& p_fileExtension, std::u
 	PR_ASSERT(p_loader != nullptr, "Loader is nullptr");
 	PR_ASSERT(!p_fileExtension.empty(), "File extension is empty");
 
-	if (m_loaders.find(p_fileExtension) != m_loaders.end())
+	auto extensionHash = PathUtils::HashPath(p_fileExtension);
+	if (GetLoader(p_fileExtension) != nullptr)
+	{
 		PRLOG_WARN("Loader with extension \"{0}\" already registered. Replacing the loader.", p_fileExtension);
 
-	m_loaders.emplace(p_fileExtension, std::move(p_loader));
+		// Workers may still use the replaced loader
+		WaitForAllLoadsPrivate();
+	}
+
+	std::unique_lock lock(m_loadersLock);
+	m_loaders.InsertOrAssign(extensionHash, std::move(p_loader));
 }
 
 void ResourceDatabase::UnregisterAllLoaders()
 {
-	m_loaders.clear();
+	WaitForAllLoadsPrivate();
+
+	std::unique_lock lock(m_loadersLock);
+	m_loaders.Clear();
 }
 
 void PrCore::Resources::ResourceDatabase::UnloadResourcePrivate(const ResourceDescPtr& p_resourceDesc)
+{
+	ReleaseDataPrivate(p_resourceDesc, DetachDataPrivate(p_resourceDesc));
+}
+
+IResourceDataPtr ResourceDatabase::DetachDataPrivate(const ResourceDescPtr& p_resourceDesc)
 {
 	PR_ASSERT(p_resourceDesc, "Resource is nullptr");
 	PR_ASSERT(!p_resourceDesc->filePath.empty(), "Resource path is empty");
 
+	auto resourceData = p_resourceDesc->GetData();
+	ReleaseMemoryPrivate(p_resourceDesc);
+
+	p_resourceDesc->SetData(nullptr);
+	p_resourceDesc->size = 0;
+	p_resourceDesc->state = ResourceState::Unloaded;
+
+	return resourceData;
+}
+
+void ResourceDatabase::ReleaseDataPrivate(const ResourceDescPtr& p_resourceDesc, IResourceDataPtr p_resourceData)
+{
 	const std::string& path = p_resourceDesc->filePath;
-	auto customLoaderIt = m_customLoaders.find(p_resourceDesc->id);
-	if (customLoaderIt != m_customLoaders.end())
+
+	// Check if resource was loaded with custom loader, use default loader for extension otherwise
+	std::shared_ptr<IResourceDataLoader> customLoader;
+	IResourceDataLoader* loader = nullptr;
+	if (auto foundLoader = m_customLoaders.Find(p_resourceDesc->id))
 	{
-		// Check if resource was loaded with custom loader
-		customLoaderIt->second->UnloadResource(p_resourceDesc->data);
+		customLoader = *foundLoader;
+		loader = customLoader.get();
 	}
 	else
 	{
-		// Use default loader for extension
-		auto loaderIt = m_loaders.find(PathUtils::GetExtension(path));
-		PR_ASSERT(loaderIt != m_loaders.end(), "Cannot unload resource. Resource loader not registered.");
-
-		if (loaderIt != m_loaders.end())
-			loaderIt->second->UnloadResource(p_resourceDesc->data);
+		loader = LoaderByExtension(path);
+		PR_ASSERT(loader != nullptr, "Cannot unload resource. Resource loader not registered.");
 	}
 
-	m_memoryUsage -= p_resourceDesc->size;
-
-	p_resourceDesc->data = nullptr;
-	p_resourceDesc->size = 0;
-	p_resourceDesc->state = ResourceState::Unloaded;
+	if (loader != nullptr)
+	{
+		// Graphics objects and the like are released on the finalize thread
+		if (CanUseLoader(loader))
+			loader->UnloadResource(std::move(p_resourceData));
+		else
+			m_deferredUnloads.push_back({ std::move(p_resourceData), loader, std::move(customLoader) });
+	}
 
 	PRLOG_INFO("Unloaded resource path \"{0}\" with UUID {1}", path, p_resourceDesc->id);
 	FireUnloadedEvent(p_resourceDesc->id, path);
@@ -497,55 +1462,76 @@ void PrCore::Resources::ResourceDatabase::UnloadResourcePrivate(const ResourceDe
 
 PrCore::Resources::ResourceDescPtr ResourceDatabase::ResourceByID(ResourceID p_id)
 {
-	auto find = m_resourcesID.find(p_id);
+	auto& shard = ShardFor(m_resourcesID, p_id);
+	std::shared_lock lock(shard.lock);
+	if (auto resourceDesc = shard.resources.Find(p_id))
+		return *resourceDesc;
 
-	if (find != m_resourcesID.end())
-		return find->second;
+	return nullptr;
+}
+
+PrCore::Resources::ResourceDescPtr ResourceDatabase::ResourceByPath(std::string_view p_path)
+{
+	auto pathHash = PathUtils::HashPath(p_path);
+	auto& shard = ShardFor(m_resourcesPaths, pathHash);
+	std::shared_lock lock(shard.lock);
+	if (auto resourceDesc = shard.resources.Find(pathHash))
+	{
+		PR_ASSERT((*resourceDesc)->filePath == PathUtils::Sanitize(p_path), "Resource path hash collision");
+		return *resourceDesc;
+	}
 
 	return nullptr;
 }
 
-PrCore::Resources::ResourceDescPtr ResourceDatabase::ResourceByPath(const std::string& p_path)
+IResourceDataLoader* ResourceDatabase::LoaderByExtension(std::string_view p_path)
+{
+	std::shared_lock lock(m_loadersLock);
+	auto loader = m_loaders.Find(PathUtils::HashPath(PathUtils::GetExtensionInPlace(p_path)));
+	return loader ? loader->get() : nullptr;
+}
+
+std::shared_ptr<IResourceDataLoader> ResourceDatabase::FindCustomLoader(ResourceID p_id)
 {
-	auto find = m_resourcesPaths.find(p_path);
+	std::lock_guard lock(m_stateLock);
+	auto customLoader = m_customLoaders.Find(p_id);
+	return customLoader ? *customLoader : nullptr;
+}
 
-	if (find != m_resourcesPaths.end())
-		return find->second;
+std::vector<ResourceDescPtr> ResourceDatabase::SnapshotResources(ResourceShards& p_shards)
+{
+	std::vector<ResourceDescPtr> resources;
+	for (auto& shard : p_shards)
+	{
+		std::shared_lock lock(shard.lock);
+		for (auto& [_, resourceDesc] : shard.resources)
+			resources.push_back(resourceDesc);
+	}
 
-	return nullptr;
+	return resources;
 }
 
 void ResourceDatabase::FireBudgetExceeded(ResourceID p_id, const std::string& p_path, size_t p_usage, size_t p_budget)
 {
-	Events::EventPtr event =
-		std::make_shared<Events::BudgetExceededv2>(p_id, p_path, p_usage, p_budget);
-	Events::EventManager::GetInstance().QueueEvent(event);
+	Events::EventManager::GetInstance().QueueEvent<Events::BudgetExceededv2>(p_id, p_path, p_usage, p_budget);
 }
 
 void ResourceDatabase::FireCacheMiss(ResourceID p_id, const std::string& p_path)
 {
-	Events::EventPtr event =
-		std::make_shared<Events::CacheMissEventv2>(p_id, p_path);
-	Events::EventManager::GetInstance().QueueEvent(event);
+	Events::EventManager::GetInstance().QueueEvent<Events::CacheMissEventv2>(p_id, p_path);
 }
 
 void ResourceDatabase::FireCorruptedEvent(ResourceID p_id, const std::string& p_path)
 {
-	Events::EventPtr event =
-		std::make_shared<Events::ResourceCorruptedEventv2>(p_id, p_path);
-	Events::EventManager::GetInstance().QueueEvent(event);
+	Events::EventManager::GetInstance().QueueEvent<Events::ResourceCorruptedEventv2>(p_id, p_path);
 }
 
 void ResourceDatabase::FireLoadedEvent(ResourceID p_id, const std::string& p_path)
 {
-	Events::EventPtr event =
-		std::make_shared<Events::ResourceLoadedEventv2>(p_id, p_path);
-	Events::EventManager::GetInstance().QueueEvent(event);
+	Events::EventManager::GetInstance().QueueEvent<Events::ResourceLoadedEventv2>(p_id, p_path);
 }
 
 void ResourceDatabase::FireUnloadedEvent(ResourceID p_id, const std::string& p_path)
 {
-	Events::EventPtr event =
-		std::make_shared<Events::ResourceUnloadedEventv2>(p_id, p_path);
-	Events::EventManager::GetInstance().QueueEvent(event);
+	Events::EventManager::GetInstance().QueueEvent<Events::ResourceUnloadedEventv2>(p_id, p_path);
 }
@@ -1,9 +1,382 @@
 #include "Core/Common/pearl_pch.h"
 
 #include "Core/Resources/ResourceSystem.h"
+#include "Core/Resources/CookedAsset.h"
+#include "Core/Utils/PathUtils.h"
 
 using namespace PrCore::Resources;
 
+void ResourceSystem::Update(std::chrono::microseconds p_finalizeBudget /*= std::chrono::microseconds(2000)*/)
+{
+	// Files written since the last frame are reloaded together, the reloads are finalized with the loads
+	if (m_fileWatcher)
+	{
+		// Cooked files are written by the loaders, the other files are hashed by their reload jobs
+		auto changes = m_fileWatcher->PollChanges();
+		std::erase_if(changes, [](const File::FileChange& p_change) {
+			return CookedAsset::IsCookedPath(p_change.path);
+			});
+
+		if (!changes.empty())
+			ReloadPrivate(changes);
+	}
+
+	auto deadline = std::chrono::steady_clock::now() + p_finalizeBudget;
+	for (auto& [_, database] : m_resourceDatabaseTypes)
+		database->FinalizeLoads(deadline);
+}
+
+ResourcePreloadPtr ResourceSystem::Preload(const std::vector<ResourceDependency>& p_resources)
+{
+	auto preload = std::make_shared<ResourcePreload>();
+
+	auto dependencyQuery = [](IResourceDatabase* p_database, const ResourceDependency& p_resource) {
+		return p_database->GetDependencies(p_resource.path);
+	};
+
+	Utils::FlatHashMap<size_t> nodeIndices;
+	for (auto& resource : p_resources)
+		DiscoverPreloadNode(*preload, resource, nodeIndices, dependencyQuery);
+
+	StartPreload(preload);
+	return preload;
+}
+
+void ResourceSystem::WaitForPreload(const ResourcePreloadPtr& p_preload)
+{
+	while (true)
+	{
+		for (auto& [_, database] : m_resourceDatabaseTypes)
+		{
+			if (database->HasQueuedFinalizes())
+				database->FinalizeLoads(std::chrono::steady_clock::time_point::max());
+		}
+
+		std::unique_lock lock(m_preloadWaitLock);
+		m_preloadWaitCondition.wait(lock, [this, &p_preload]() {
+			return p_preload->IsDone() || HasQueuedFinalizes();
+			});
+
+		if (p_preload->IsDone())
+			return;
+	}
+}
+
+ResourcePreloadPtr ResourceSystem::Reload(const std::vector<std::string>& p_paths)
+{
+	std::vector<File::FileChange> changes;
+	changes.reserve(p_paths.size());
+	for (auto& path : p_paths)
+		changes.push_back({ path, std::string() });
+
+	return ReloadPrivate(changes);
+}
+
+ResourcePreloadPtr ResourceSystem::ReloadPrivate(const std::vector<File::FileChange>& p_changes)
+{
+	UpdateLoadedDependencies();
+
+	// Loaded resources of the paths, the path is not known to be of any type
+	std::vector<ResourceDependency> reloadResources;
+	Utils::FlatHashMap<bool>        reloadNodes;
+	Utils::FlatHashMap<std::shared_ptr<ResourcePreload::ChangedFile>> changedFiles;
+	for (auto& change : p_changes)
+	{
+		std::shared_ptr<ResourcePreload::ChangedFile> changedFile;
+		if (!change.nativePath.empty())
+		{
+			changedFile = std::make_shared<ResourcePreload::ChangedFile>();
+			changedFile->path = change.path;
+			changedFile->nativePath = change.nativePath;
+		}
+
+		bool loaded = false;
+		for (auto& [resourceType, _] : m_resourceDatabaseTypes)
+		{
+			ResourceDependency resource{ change.path, resourceType };
+			auto nodeKey = PreloadNodeKey(resource);
+			if (!m_loadedDependencies.Contains(nodeKey))
+				continue;
+
+			loaded = true;
+			if (reloadNodes.TryEmplace(nodeKey, true).second)
+			{
+				changedFiles.InsertOrAssign(nodeKey, changedFile);
+				reloadResources.push_back(std::move(resource));
+			}
+		}
+
+		// Nothing to reload, the next load hashes the file
+		if (changedFile && !loaded)
+			m_assetRegistry.InvalidateHash(change.path);
+	}
+
+	// Loaded dependents by the dependency node key
+	Utils::FlatHashMap<std::vector<ResourceDependency>> dependents;
+	for (auto& [_, loadedDependencies] : m_loadedDependencies)
+	{
+		for (auto& dependency : loadedDependencies.dependencies)
+			dependents[PreloadNodeKey(dependency)].push_back(loadedDependencies.resource);
+	}
+
+	// Dependents of the reloaded resources are reloaded too, reloadResources grows while iterated
+	for (size_t i = 0; i < reloadResources.size(); i++)
+	{
+		auto resourceDependents = dependents.Find(PreloadNodeKey(reloadResources[i]));
+		if (resourceDependents == nullptr)
+			continue;
+
+		for (auto& dependent : *resourceDependents)
+		{
+			if (reloadNodes.TryEmplace(PreloadNodeKey(dependent), true).second)
+				reloadResources.push_back(dependent);
+		}
+	}
+
+	auto preload = std::make_shared<ResourcePreload>();
+	preload->m_reload = true;
+
+	// Only the dependencies reloaded together order the reloads
+	auto dependencyQuery = [this, &reloadNodes](IResourceDatabase*, const ResourceDependency& p_resource) {
+		std::vector<ResourceDependency> dependencies;
+		if (auto loadedDependencies = m_loadedDependencies.Find(PreloadNodeKey(p_resource)))
+		{
+			for (auto& dependency : loadedDependencies->dependencies)
+			{
+				if (reloadNodes.Contains(PreloadNodeKey(dependency)))
+					dependencies.push_back(dependency);
+			}
+		}
+
+		return dependencies;
+	};
+
+	Utils::FlatHashMap<size_t> nodeIndices;
+	for (auto& resource : reloadResources)
+		DiscoverPreloadNode(*preload, resource, nodeIndices, dependencyQuery);
+
+	for (auto& node : preload->m_nodes)
+	{
+		if (auto changedFile = changedFiles.Find(PreloadNodeKey(node.resource)))
+			node.changedFile = *changedFile;
+		else
+			node.dependent = true;
+	}
+
+	if (!reloadResources.empty())
+		PRLOG_INFO("Reloading {0} resources for {1} changed files", reloadResources.size(), p_changes.size());
+
+	StartPreload(preload);
+	return preload;
+}
+
+void ResourceSystem::WatchDirectory(std::string_view p_dirPath, std::string_view p_mountPoint /*= "/"*/)
+{
+	if (m_fileWatcher == nullptr)
+		m_fileWatcher = std::make_unique<File::FileWatcher>();
+
+	m_fileWatcher->Watch(p_dirPath, p_mountPoint);
+}
+
+void ResourceSystem::UnwatchDirectory(std::string_view p_dirPath)
+{
+	if (m_fileWatcher == nullptr)
+	{
+		PRLOG_WARN("Cannot unwatch directory \"{0}\". No directory is watched.", p_dirPath);
+		return;
+	}
+
+	m_fileWatcher->Unwatch(p_dirPath);
+}
+
+uint64_t ResourceSystem::PreloadNodeKey(const ResourceDependency& p_resource)
+{
+	auto nodeKey = PathUtils::HashPath(p_resource.path) ^ (p_resource.resourceType * 0x9E3779B97F4A7C15ull);
+	return nodeKey != 0 ? nodeKey : 1;
+}
+
+size_t ResourceSystem::DiscoverPreloadNode(ResourcePreload& p_preload, const ResourceDependency& p_resource, Utils::FlatHashMap<size_t>& p_nodeIndices, const DependencyQuery& p_dependencyQuery)
+{
+	auto database = FindResourceDatabase(p_resource.resourceType);
+	if (database == nullptr)
+	{
+		PRLOG_WARN("Cannot preload resource \"{0}\". Resource database is not registered.", p_resource.path);
+		return s_invalidPreloadNode;
+	}
+
+	auto nodeKey = PreloadNodeKey(p_resource);
+	if (auto nodeIndex = p_nodeIndices.Find(nodeKey))
+		return *nodeIndex;
+
+	size_t nodeIndex = p_preload.m_nodes.size();
+	p_nodeIndices.InsertOrAssign(nodeKey, nodeIndex);
+	p_preload.m_nodes.emplace_back();
+	p_preload.m_nodes[nodeIndex].resource = p_resource;
+	p_preload.m_nodes[nodeIndex].database = database;
+
+	for (auto& dependency : p_dependencyQuery(database, p_resource))
+	{
+		auto dependencyIndex = DiscoverPreloadNode(p_preload, dependency, p_nodeIndices, p_dependencyQuery);
+		if (dependencyIndex == s_invalidPreloadNode)
+			continue;
+
+		// Dependency still being discovered closes a cycle, the loader loads it on its own
+		if (!p_preload.m_nodes[dependencyIndex].discovered)
+		{
+			PRLOG_WARN("Resource \"{0}\" has cyclic dependency \"{1}\". Loading without the dependency first.", p_resource.path, dependency.path);
+			continue;
+		}
+
+		p_preload.m_nodes[dependencyIndex].parents.push_back(nodeIndex);
+		p_preload.m_nodes[nodeIndex].dependencyCount++;
+	}
+
+	p_preload.m_nodes[nodeIndex].discovered = true;
+	return nodeIndex;
+}
+
+void ResourceSystem::StartPreload(const ResourcePreloadPtr& p_preload)
+{
+	auto nodeCount = p_preload->m_nodes.size();
+	p_preload->m_pendingDependencies = std::make_unique<std::atomic<size_t>[]>(nodeCount);
+	p_preload->m_dependencyReloaded = std::make_unique<std::atomic<bool>[]>(nodeCount);
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		p_preload->m_pendingDependencies[i] = p_preload->m_nodes[i].dependencyCount;
+		p_preload->m_dependencyReloaded[i] = false;
+	}
+	p_preload->m_pendingNodes = nodeCount;
+
+	// Leaves start together, the other nodes start from the callback of their last dependency
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		if (p_preload->m_nodes[i].dependencyCount == 0)
+			StartPreloadNode(p_preload, i);
+	}
+}
+
+void ResourceSystem::StartPreloadNode(const ResourcePreloadPtr& p_preload, size_t p_nodeIndex)
+{
+	// Databases may be removed after a cancel, do not touch them
+	if (p_preload->m_cancelled)
+	{
+		FinishPreloadNode(p_preload, p_nodeIndex);
+		return;
+	}
+
+	auto& node = p_preload->m_nodes[p_nodeIndex];
+	if (p_preload->m_reload)
+	{
+		// Dependents of the files saved without a change keep their data
+		bool dependencyReloaded = p_preload->m_dependencyReloaded[p_nodeIndex];
+		if (node.dependent && !dependencyReloaded)
+		{
+			FinishPreloadNode(p_preload, p_nodeIndex, false);
+			return;
+		}
+
+		// Written file is hashed on the worker, the new hash is recorded before the loader checks its cooked file against it
+		ResourceReloadCheck reloadCheck;
+		if (auto changedFile = node.changedFile)
+		{
+			reloadCheck = [this, changedFile, dependencyReloaded]() {
+				std::call_once(changedFile->hashed, [&]() {
+					changedFile->changed = m_assetRegistry.UpdateFromNativeFile(changedFile->path, changedFile->nativePath);
+					});
+				return changedFile->changed || dependencyReloaded;
+			};
+		}
+
+		// Resource removed meanwhile has nothing to reload
+		auto resourceDesc = node.database->Reload(node.resource.path, [this, p_preload, p_nodeIndex, dependencyReloaded](ResourceDescPtr) {
+			auto& changedFile = p_preload->m_nodes[p_nodeIndex].changedFile;
+			FinishPreloadNode(p_preload, p_nodeIndex, changedFile == nullptr || changedFile->changed || dependencyReloaded);
+			}, std::move(reloadCheck));
+		if (resourceDesc == nullptr)
+			FinishPreloadNode(p_preload, p_nodeIndex);
+		return;
+	}
+
+	// Callback is called right away for the loaded resources
+	node.database->LoadAsync(node.resource.path, [this, p_preload, p_nodeIndex](ResourceDescPtr p_resourceDesc) {
+		if (p_resourceDesc->state != ResourceState::Loaded && p_resourceDesc->state != ResourceState::Corrupted)
+			p_preload->m_cancelled = true;
+
+		FinishPreloadNode(p_preload, p_nodeIndex);
+		});
+}
+
+void ResourceSystem::FinishPreloadNode(const ResourcePreloadPtr& p_preload, size_t p_nodeIndex, bool p_reloaded /*= true*/)
+{
+	// Corrupted dependency does not block the parents, their loaders handle it
+	for (auto parentIndex : p_preload->m_nodes[p_nodeIndex].parents)
+	{
+		if (p_reloaded)
+			p_preload->m_dependencyReloaded[parentIndex] = true;
+
+		if (--p_preload->m_pendingDependencies[parentIndex] == 0)
+			StartPreloadNode(p_preload, parentIndex);
+	}
+
+	if (--p_preload->m_pendingNodes == 0)
+		NotifyPreloadWaiters();
+}
+
+void ResourceSystem::NotifyPreloadWaiters()
+{
+	// Taking the lock orders the change before the check of a waiter about to sleep
+	{
+		std::lock_guard lock(m_preloadWaitLock);
+	}
+	m_preloadWaitCondition.notify_all();
+}
+
+bool ResourceSystem::HasQueuedFinalizes() const
+{
+	for (auto& [_, database] : m_resourceDatabaseTypes)
+	{
+		if (database->HasQueuedFinalizes())
+			return true;
+	}
+
+	return false;
+}
+
+void ResourceSystem::UpdateLoadedDependencies()
+{
+	Utils::FlatHashMap<LoadedDependencies> loadedDependencies;
+	for (auto& [resourceType, database] : m_resourceDatabaseTypes)
+	{
+		database->ForEachResource([&, resourceType = resourceType, database = database.get()](ResourceDescConstPtr p_resourceDesc) {
+			if (p_resourceDesc->origin != ResourceOrigin::File || p_resourceDesc->state != ResourceState::Loaded)
+				return;
+
+			ResourceDependency resource{ p_resourceDesc->filePath, resourceType };
+			auto nodeKey = PreloadNodeKey(resource);
+			auto generation = p_resourceDesc->GetGeneration();
+
+			// Unchanged resource keeps the dependencies, the loader reads the file otherwise
+			auto cached = m_loadedDependencies.Find(nodeKey);
+			if (cached && cached->generation == generation)
+			{
+				loadedDependencies.InsertOrAssign(nodeKey, std::move(*cached));
+				return;
+			}
+
+			loadedDependencies.InsertOrAssign(nodeKey, LoadedDependencies{ std::move(resource), generation, database->GetDependencies(p_resourceDesc->filePath) });
+			});
+	}
+
+	// Resources unloaded since the last reload are dropped
+	m_loadedDependencies = std::move(loadedDependencies);
+}
+
+IResourceDatabase* ResourceSystem::FindResourceDatabase(size_t p_resourceType)
+{
+	auto database = m_resourceDatabaseTypes.find(p_resourceType);
+	return database != m_resourceDatabaseTypes.end() ? database->second.get() : nullptr;
+}
+
 void ResourceSystem::UnregisterDatabasesAll()
 {
 	m_resourceDatabaseTypes.clear();
@@ -11,5 +384,6 @@ void ResourceSystem::UnregisterDatabasesAll()
 
 ResourceSystem::~ResourceSystem()
 {
+	m_fileWatcher.reset();
 	UnregisterDatabasesAll();
 }
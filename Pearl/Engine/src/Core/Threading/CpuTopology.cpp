@@ -0,0 +1,425 @@
+#include "Core/Common/pearl_pch.h"
+
+#include "Core/Threading/CpuTopology.h"
+
+#include <fstream>
+
+#ifndef _WIN32
+	#include <sched.h>
+#endif
+
+using namespace PrCore::Threading;
+
+namespace {
+	// Cache domains are identified by their lowest processor, packages without cache information are tagged apart from them
+	constexpr uint32_t g_packageDomainTag = 0x80000000u;
+
+#ifdef _WIN32
+	bool DiscoverWindows(std::vector<LogicalProcessor>& p_processors)
+	{
+		DWORD length = 0;
+		::GetLogicalProcessorInformation(nullptr, &length);
+		if (::GetLastError() != ERROR_INSUFFICIENT_BUFFER)
+			return false;
+
+		std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> infos(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+		if (!::GetLogicalProcessorInformation(infos.data(), &length))
+			return false;
+
+		auto forEachBit = [](ULONG_PTR p_mask, auto&& p_function) {
+			for (uint32_t bit = 0; bit < sizeof(ULONG_PTR) * 8; bit++)
+			{
+				if (p_mask & (ULONG_PTR(1) << bit))
+					p_function(bit);
+			}
+		};
+
+		std::map<uint32_t, LogicalProcessor> processors;
+		uint32_t coreIndex = 0;
+		BYTE lastCacheLevel = 0;
+		for (auto& info : infos)
+		{
+			if (info.Relationship == RelationProcessorCore)
+			{
+				forEachBit(info.ProcessorMask, [&](uint32_t p_bit) {
+					processors[p_bit].id = p_bit;
+					processors[p_bit].coreId = coreIndex;
+					});
+				coreIndex++;
+			}
+			else if (info.Relationship == RelationCache)
+			{
+				lastCacheLevel = std::max(lastCacheLevel, info.Cache.Level);
+			}
+		}
+
+		uint32_t cacheIndex = 0;
+		for (auto& info : infos)
+		{
+			if (info.Relationship == RelationCache && info.Cache.Level == lastCacheLevel)
+			{
+				forEachBit(info.ProcessorMask, [&](uint32_t p_bit) {
+					processors[p_bit].cacheDomain = cacheIndex;
+					});
+				cacheIndex++;
+			}
+			else if (info.Relationship == RelationNumaNode)
+			{
+				forEachBit(info.ProcessorMask, [&](uint32_t p_bit) {
+					processors[p_bit].numaNode = info.NumaNode.NodeNumber;
+					});
+			}
+		}
+
+		for (auto& [id, processor] : processors)
+			p_processors.push_back(processor);
+
+		return !p_processors.empty();
+	}
+
+	// Processors of the process affinity, the first processor group only like the rest of the discovery
+	bool IsProcessorAllowed(uint32_t p_id)
+	{
+		DWORD_PTR processMask = 0;
+		DWORD_PTR systemMask = 0;
+		if (!::GetProcessAffinityMask(::GetCurrentProcess(), &processMask, &systemMask) || processMask == 0)
+			return true;
+
+		return p_id < sizeof(DWORD_PTR) * 8 && (processMask & (DWORD_PTR(1) << p_id));
+	}
+#else
+	bool ReadFileLine(const std::string& p_path, std::string& p_line)
+	{
+		std::ifstream file(p_path);
+		if (!file.is_open())
+			return false;
+
+		std::getline(file, p_line);
+		return !file.fail();
+	}
+
+	bool ReadFileValue(const std::string& p_path, uint32_t& p_value)
+	{
+		std::string line;
+		return ReadFileLine(p_path, line) && PrCore::StringUtils::FromString(line, p_value);
+	}
+
+	// Parses kernel lists like "0-3,8,10-11"
+	std::vector<uint32_t> ParseCpuList(std::string_view p_list)
+	{
+		std::vector<uint32_t> cpus;
+		while (!p_list.empty())
+		{
+			auto commaPos = p_list.find(',');
+			auto range = p_list.substr(0, commaPos);
+			p_list = commaPos == std::string_view::npos ? std::string_view{} : p_list.substr(commaPos + 1);
+
+			auto dashPos = range.find('-');
+			uint32_t first = 0;
+			uint32_t last = 0;
+			if (!PrCore::StringUtils::FromString(range.substr(0, dashPos), first))
+				continue;
+
+			last = first;
+			if (dashPos != std::string_view::npos)
+				PrCore::StringUtils::FromString(range.substr(dashPos + 1), last);
+
+			for (uint32_t cpu = first; cpu <= last; cpu++)
+				cpus.push_back(cpu);
+		}
+
+		return cpus;
+	}
+
+	bool DiscoverSysfs(std::vector<LogicalProcessor>& p_processors)
+	{
+		const std::string cpuRoot = "/sys/devices/system/cpu/";
+		const std::string nodeRoot = "/sys/devices/system/node/";
+
+		std::string onlineList;
+		if (!ReadFileLine(cpuRoot + "online", onlineList))
+			return false;
+
+		for (auto cpu : ParseCpuList(onlineList))
+		{
+			auto cpuPath = cpuRoot + "cpu" + PrCore::StringUtils::ToString(cpu);
+
+			// Core ids are unique only inside the package
+			uint32_t coreId = 0;
+			uint32_t packageId = 0;
+			if (!ReadFileValue(cpuPath + "/topology/core_id", coreId) ||
+				!ReadFileValue(cpuPath + "/topology/physical_package_id", packageId))
+				return false;
+
+			LogicalProcessor processor;
+			processor.id = cpu;
+			processor.coreId = (packageId << 16) | coreId;
+			processor.cacheDomain = g_packageDomainTag | packageId;
+
+			// Highest cache level is the domain, it is identified by its lowest processor
+			uint32_t lastCacheLevel = 0;
+			for (int index = 0; ; index++)
+			{
+				auto cachePath = cpuPath + "/cache/index" + PrCore::StringUtils::ToString(index);
+
+				uint32_t level = 0;
+				if (!ReadFileValue(cachePath + "/level", level))
+					break;
+
+				std::string sharedList;
+				if (level >= lastCacheLevel && ReadFileLine(cachePath + "/shared_cpu_list", sharedList))
+				{
+					auto sharedCpus = ParseCpuList(sharedList);
+					if (!sharedCpus.empty())
+					{
+						processor.cacheDomain = sharedCpus.front();
+						lastCacheLevel = level;
+					}
+				}
+			}
+
+			p_processors.push_back(processor);
+		}
+
+		// NUMA nodes are optional, kernels without NUMA support leave everything on node 0
+		std::string nodeList;
+		if (ReadFileLine(nodeRoot + "online", nodeList))
+		{
+			for (auto node : ParseCpuList(nodeList))
+			{
+				std::string nodeCpuList;
+				if (!ReadFileLine(nodeRoot + "node" + PrCore::StringUtils::ToString(node) + "/cpulist", nodeCpuList))
+					continue;
+
+				for (auto cpu : ParseCpuList(nodeCpuList))
+				{
+					auto it = std::find_if(p_processors.begin(), p_processors.end(), [&](const LogicalProcessor& p_processor) {
+						return p_processor.id == cpu;
+						});
+
+					if (it != p_processors.end())
+						it->numaNode = node;
+				}
+			}
+		}
+
+		return !p_processors.empty();
+	}
+
+	bool DiscoverCpuInfo(std::vector<LogicalProcessor>& p_processors)
+	{
+		std::ifstream file("/proc/cpuinfo");
+		if (!file.is_open())
+			return false;
+
+		// Blocks of "key : value" lines, one block per logical processor
+		LogicalProcessor processor;
+		uint32_t packageId = 0;
+		uint32_t coreId = 0;
+		bool hasProcessor = false;
+
+		auto pushProcessor = [&]() {
+			if (!hasProcessor)
+				return;
+
+			processor.coreId = (packageId << 16) | coreId;
+			processor.cacheDomain = packageId;
+			p_processors.push_back(processor);
+			hasProcessor = false;
+		};
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			auto colonPos = line.find(':');
+			if (colonPos == std::string::npos)
+			{
+				pushProcessor();
+				continue;
+			}
+
+			std::string_view key = std::string_view(line).substr(0, colonPos);
+			key = key.substr(0, key.find_last_not_of(" \t") + 1);
+
+			std::string_view value = std::string_view(line).substr(colonPos + 1);
+			auto valueStart = value.find_first_not_of(" \t");
+			value = valueStart == std::string_view::npos ? std::string_view{} : value.substr(valueStart);
+
+			if (key == "processor")
+			{
+				pushProcessor();
+				processor = LogicalProcessor{};
+				packageId = 0;
+				coreId = 0;
+				hasProcessor = PrCore::StringUtils::FromString(value, processor.id);
+				coreId = processor.id;
+			}
+			else if (key == "physical id")
+			{
+				PrCore::StringUtils::FromString(value, packageId);
+			}
+			else if (key == "core id")
+			{
+				PrCore::StringUtils::FromString(value, coreId);
+			}
+		}
+
+		pushProcessor();
+		return !p_processors.empty();
+	}
+
+	// Affinity of the process, it includes the cgroup cpuset restrictions of containers
+	// Set is at least the glibc default size, the kernel rejects sets smaller than its own
+	class AllowedProcessors {
+	public:
+		explicit AllowedProcessors(uint32_t p_maxId) :
+			m_size(CPU_ALLOC_SIZE(std::max<uint32_t>(p_maxId + 1, CPU_SETSIZE))),
+			m_set(CPU_ALLOC(std::max<uint32_t>(p_maxId + 1, CPU_SETSIZE)))
+		{
+			if (m_set && ::sched_getaffinity(0, m_size, m_set) != 0)
+			{
+				CPU_FREE(m_set);
+				m_set = nullptr;
+			}
+		}
+
+		~AllowedProcessors()
+		{
+			if (m_set)
+				CPU_FREE(m_set);
+		}
+
+		// Everything is allowed when the affinity is unknown
+		bool IsAllowed(uint32_t p_id) const
+		{
+			return m_set == nullptr || CPU_ISSET_S(p_id, m_size, m_set);
+		}
+
+	private:
+		size_t     m_size;
+		cpu_set_t* m_set;
+	};
+#endif
+
+	// Workers are sized and pinned only to the processors the process may run on
+	void RemoveDisallowedProcessors(std::vector<LogicalProcessor>& p_processors)
+	{
+		if (p_processors.empty())
+			return;
+
+#ifdef _WIN32
+		auto isAllowed = [](const LogicalProcessor& p_processor) { return IsProcessorAllowed(p_processor.id); };
+#else
+		uint32_t maxId = 0;
+		for (auto& processor : p_processors)
+			maxId = std::max(maxId, processor.id);
+
+		AllowedProcessors allowedProcessors(maxId);
+		auto isAllowed = [&](const LogicalProcessor& p_processor) { return allowedProcessors.IsAllowed(p_processor.id); };
+#endif
+
+		auto allowedEnd = std::stable_partition(p_processors.begin(), p_processors.end(), isAllowed);
+		if (allowedEnd == p_processors.begin())
+		{
+			PRLOG_WARN("CPU affinity excludes every discovered processor, it is ignored");
+			return;
+		}
+
+		size_t excludedNum = std::distance(allowedEnd, p_processors.end());
+		if (excludedNum > 0)
+			PRLOG_INFO("CPU affinity excludes {} of {} logical processors", excludedNum, p_processors.size());
+
+		p_processors.erase(allowedEnd, p_processors.end());
+	}
+}
+
+CpuTopology CpuTopology::Discover()
+{
+	CpuTopology topology;
+
+#ifdef _WIN32
+	bool discovered = DiscoverWindows(topology.m_processors);
+#else
+	bool discovered = DiscoverSysfs(topology.m_processors);
+	if (!discovered)
+	{
+		topology.m_processors.clear();
+		discovered = DiscoverCpuInfo(topology.m_processors);
+	}
+#endif
+
+	// Every hardware thread is treated as a separate core when the topology is unknown
+	if (!discovered)
+	{
+		topology.m_processors.clear();
+		uint32_t processorNum = std::max(1u, std::thread::hardware_concurrency());
+		for (uint32_t i = 0; i < processorNum; i++)
+		{
+			LogicalProcessor processor;
+			processor.id = i;
+			processor.coreId = i;
+			topology.m_processors.push_back(processor);
+		}
+
+		PRLOG_WARN("CPU topology discovery failed, assuming {} independent cores", processorNum);
+	}
+
+	RemoveDisallowedProcessors(topology.m_processors);
+	topology.Normalize();
+
+	PRLOG_INFO("CPU topology: {} logical processors, {} physical cores, {} cache domains, {} NUMA nodes",
+		topology.GetLogicalProcessorNum(), topology.GetPhysicalCoreNum(), topology.GetCacheDomainNum(), topology.GetNumaNodeNum());
+
+	return topology;
+}
+
+std::vector<LogicalProcessor> CpuTopology::GetCoreOrder() const
+{
+	// First SMT sibling stands for the whole core
+	std::vector<LogicalProcessor> cores;
+	std::vector<bool> coreTaken(m_physicalCoreNum, false);
+	for (auto& processor : m_processors)
+	{
+		if (coreTaken[processor.coreId])
+			continue;
+
+		coreTaken[processor.coreId] = true;
+		cores.push_back(processor);
+	}
+
+	std::stable_sort(cores.begin(), cores.end(), [](const LogicalProcessor& p_lhs, const LogicalProcessor& p_rhs) {
+		if (p_lhs.numaNode != p_rhs.numaNode)
+			return p_lhs.numaNode < p_rhs.numaNode;
+
+		return p_lhs.cacheDomain < p_rhs.cacheDomain;
+		});
+
+	return cores;
+}
+
+void CpuTopology::Normalize()
+{
+	std::sort(m_processors.begin(), m_processors.end(), [](const LogicalProcessor& p_lhs, const LogicalProcessor& p_rhs) {
+		return p_lhs.id < p_rhs.id;
+		});
+
+	// Dense indices in order of the first appearance
+	auto remap = [](std::map<uint32_t, uint32_t>& p_map, uint32_t& p_value) {
+		auto it = p_map.emplace(p_value, static_cast<uint32_t>(p_map.size())).first;
+		p_value = it->second;
+	};
+
+	std::map<uint32_t, uint32_t> cores;
+	std::map<uint32_t, uint32_t> cacheDomains;
+	std::map<uint32_t, uint32_t> numaNodes;
+	for (auto& processor : m_processors)
+	{
+		remap(cores, processor.coreId);
+		remap(cacheDomains, processor.cacheDomain);
+		remap(numaNodes, processor.numaNode);
+	}
+
+	m_physicalCoreNum = cores.size();
+	m_cacheDomainNum = cacheDomains.size();
+	m_numaNodeNum = numaNodes.size();
+}
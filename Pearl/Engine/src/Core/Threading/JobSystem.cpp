@@ -5,28 +5,82 @@
 
 using namespace PrCore::Threading;
 
-JobSystem::JobSystem(size_t p_workerNumber)
+// Waiting thread yields this many times with nothing to help before it parks
+constexpr size_t g_waitSpinCount = 64;
+// Parked waiter wakes up periodically to help with jobs scheduled in the meantime
+constexpr auto   g_waitParkTimeout = std::chrono::milliseconds(1);
+
+JobSystem::JobSystem(size_t p_workerNumber, size_t p_backgroundWorkerNumber) :
+	m_topology(CpuTopology::Discover())
 {
 	PR_ASSERT(p_workerNumber > 0, "Worker number is less than 1");
+	PR_ASSERT(p_backgroundWorkerNumber > 0, "Background worker number is less than 1");
+
+	// Explicit worker number may oversubscribe the cores so the workers are not pinned
+	CreateWorkers(p_workerNumber, p_backgroundWorkerNumber, false, 0);
+}
+
+JobSystem::JobSystem(const JobSystemSettings& p_settings) :
+	m_topology(CpuTopology::Discover())
+{
+	size_t coreNum = m_topology.GetPhysicalCoreNum();
+	size_t reservedThreads = std::min(p_settings.reservedThreads, coreNum - 1);
+
+	size_t workerNumber = p_settings.workerNumber;
+	if (workerNumber == 0)
+		workerNumber = coreNum - reservedThreads;
+
+	size_t backgroundWorkerNumber = p_settings.backgroundWorkerNumber;
+	if (backgroundWorkerNumber == 0)
+		backgroundWorkerNumber = std::max<size_t>(1, workerNumber / 4);
+
+	// Pinning more workers than free cores would stack them on the same core
+	bool pinWorkers = p_settings.pinWorkers && workerNumber + reservedThreads <= coreNum;
+	if (p_settings.pinWorkers && !pinWorkers)
+		PRLOG_WARN("JobSystem {} workers exceed {} free cores, workers are not pinned", workerNumber, coreNum - reservedThreads);
+
+	CreateWorkers(workerNumber, backgroundWorkerNumber, pinWorkers, reservedThreads);
+}
+
+void JobSystem::CreateWorkers(size_t p_workerNumber, size_t p_backgroundWorkerNumber, bool p_pinWorkers, size_t p_reservedThreads)
+{
+	m_nextWorker.store(0);
+	m_queuedJobs.store(0);
+	m_sleepingWorkers.store(0);
+	m_nextJobId.store(0);
+	m_paused.store(false);
+	m_backgroundJobCount.store(0);
+	m_runningBackgroundJobs.store(0);
+	m_backgroundWorkerNumber = std::min(p_backgroundWorkerNumber, p_workerNumber);
+
+	// Reserved cores come first in the order, neighbouring workers share caches
+	auto coreOrder = m_topology.GetCoreOrder();
+
+	for (size_t i = 0; i < p_workerNumber; i++)
+	{
+		auto& core = coreOrder[(p_reservedThreads + i) % coreOrder.size()];
+		auto worker = std::make_shared<JobWorker>("JobWorker_" + StringUtils::ToString(i), this, core.cacheDomain);
+		m_workers.push_back(std::move(worker));
+	}
+
+	// Share workers vector to steal jobs from, before the threads start iterating it
+	for (auto& worker : m_workers)
+		worker->SetStealWorkers(m_workers);
 
 	auto threadSystem = ThreadSystem::GetInstancePtr();
-	for (int i = 0; i < p_workerNumber; i++)
+	for (size_t i = 0; i < p_workerNumber; i++)
 	{
 		ThreadConfig config;
 		config.name = "JobWorker_" + StringUtils::ToString(i);
-		auto worker = std::make_shared<JobWorker>(config.name);
 
-		threadSystem->SpawnThread(worker, config);
-		m_workers.push_back(std::move(worker));
+		auto& core = coreOrder[(p_reservedThreads + i) % coreOrder.size()];
+		if (p_pinWorkers && core.id < 64)
+			config.affinityMask = uint64_t(1) << core.id;
+
+		threadSystem->SpawnThread(m_workers[i], config);
 	}
 
-	// Share workers vector to steal jobs from
-	for (auto& worker : m_workers)
-		worker->SetStealWorkers(m_workers);
-	
-	m_nextWorker.store(0);
-	m_nextJobId.store(0);
-	m_paused.store(false);
+	PRLOG_INFO("JobSystem created {} workers, {} background, pinned: {}", p_workerNumber, m_backgroundWorkerNumber, p_pinWorkers);
 }
 
 JobSystem::~JobSystem()
@@ -38,6 +92,16 @@ JobSystem::~JobSystem()
 		threadSystem->JoinThread(m_workers[i]);
 	}
 
+	// Workers may exit before the background queue is drained
+	while (!m_backgroundJobs.empty())
+	{
+		auto jobDesc = std::move(m_backgroundJobs.front());
+		m_backgroundJobs.pop_front();
+
+		jobDesc.functionPtr();
+		jobDesc.state->Decrement();
+	}
+
 	m_workers.clear();
 }
 
@@ -62,23 +126,236 @@ size_t JobSystem::GetWorkerNum()
 	return m_workers.size();
 }
 
+size_t JobSystem::GetBackgroundWorkerNum()
+{
+	return m_backgroundWorkerNumber;
+}
+
 void JobSystem::WaitAll()
 {
+	// Background jobs wait in the shared queue, workers go idle while the limited slots are taken
+	while (true)
+	{
+		for (auto& worker : m_workers)
+			worker->WaitForIdle();
+
+		// Paused workers do not pick background jobs up, the counter is read first as a popped job is already running
+		if (m_paused.load() || (m_backgroundJobCount.load() == 0 && m_runningBackgroundJobs.load() == 0))
+			return;
+
+		std::this_thread::sleep_for(g_waitParkTimeout);
+	}
+}
+
+bool JobSystem::TryExecuteJob()
+{
+	if (m_paused.load())
+		return false;
+
+	// Background jobs are never picked up here so a long load can not stall the waiting thread
+	auto currentWorker = JobWorker::GetCurrentWorker();
+	for (auto priority : { JobPriority::Critical, JobPriority::Normal })
+	{
+		// Worker drains its own queue first
+		if (currentWorker)
+		{
+			auto jobDesc = currentWorker->PopJob(priority);
+			if (jobDesc)
+			{
+				currentWorker->ProcessJob(*jobDesc);
+				return true;
+			}
+		}
+
+		for (auto& worker : m_workers)
+		{
+			if (worker.get() == currentWorker)
+				continue;
+
+			auto jobDesc = worker->StealJob(priority);
+			if (jobDesc)
+			{
+				auto executingWorker = currentWorker ? currentWorker : worker.get();
+				executingWorker->ProcessJob(*jobDesc);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::SubmitJob(JobDesc&& p_jobDesc)
+{
+	if (p_jobDesc.priority == JobPriority::Background)
+	{
+		{
+			std::lock_guard lock{ m_backgroundLock };
+			m_backgroundJobs.push_back(std::move(p_jobDesc));
+			m_backgroundJobCount++;
+		}
+
+		WakeSleepingWorker();
+		return;
+	}
+
+	// Busy target leaves the job to be stolen by a parked worker
+	auto& worker = m_workers[NextWorker()];
+	worker->AddJobRequest(std::move(p_jobDesc));
+	if (!worker->WakeIfSleeping())
+		WakeSleepingWorker();
+}
+
+void JobSystem::WakeSleepingWorker()
+{
+	if (m_sleepingWorkers.load() == 0)
+		return;
+
 	for (auto& worker : m_workers)
-		worker->WaitForIdle();
+	{
+		if (worker->WakeIfSleeping())
+			return;
+	}
+}
+
+size_t JobSystem::NextWorker()
+{
+	// acquire active queue and increment the value
+	size_t activeWorker = 0;
+	size_t nextActiveWorker = 0;
+	do {
+		activeWorker = m_nextWorker.load();
+		nextActiveWorker = (activeWorker + 1) % m_workers.size();
+
+	} while (!m_nextWorker.compare_exchange_weak(activeWorker, nextActiveWorker));
+
+	return activeWorker;
+}
+
+bool JobSystem::TryExecuteBackgroundJob(JobWorker& p_worker)
+{
+	// Reserve the slot before popping so the background limit is never exceeded
+	size_t runningJobs = m_runningBackgroundJobs.load();
+	do {
+		if (runningJobs >= m_backgroundWorkerNumber)
+			return false;
+
+	} while (!m_runningBackgroundJobs.compare_exchange_weak(runningJobs, runningJobs + 1));
+
+	std::optional<JobDesc> jobDesc;
+	{
+		std::lock_guard lock{ m_backgroundLock };
+		if (!m_backgroundJobs.empty())
+		{
+			jobDesc = std::move(m_backgroundJobs.front());
+			m_backgroundJobs.pop_front();
+			m_backgroundJobCount--;
+		}
+	}
+
+	if (jobDesc)
+		p_worker.ProcessJob(*jobDesc);
+
+	m_runningBackgroundJobs--;
+	return jobDesc.has_value();
+}
+
+bool JobSystem::HasRunnableBackgroundJob()
+{
+	return m_backgroundJobCount.load() > 0 && m_runningBackgroundJobs.load() < m_backgroundWorkerNumber;
+}
+
+void JobSystem::SubmitJobAfter(JobDesc&& p_jobDesc, const JobDependencies& p_dependencies)
+{
+	struct PendingJob
+	{
+		JobDesc             jobDesc;
+		std::atomic<size_t> pendingDependencies;
+	};
+
+	// Extra count holds the job back until all continuations are registered
+	auto pendingJob = std::make_shared<PendingJob>();
+	pendingJob->jobDesc = std::move(p_jobDesc);
+	pendingJob->pendingDependencies.store(p_dependencies.size() + 1);
+
+	auto releaseDependency = [this, pendingJob]() {
+		if (pendingJob->pendingDependencies.fetch_sub(1) == 1)
+			SubmitJob(std::move(pendingJob->jobDesc));
+	};
+
+	for (auto& dependency : p_dependencies)
+	{
+		PR_ASSERT(dependency, "Dependency is null");
+		dependency->AddContinuation(releaseDependency);
+	}
+
+	releaseDependency();
 }
 
 void JobState::Wait()
 {
-	if (m_isDone.load())
-		return;
+	// Help with pending jobs instead of sleeping, park only when there is nothing to run
+	auto jobSystem = JobSystem::GetInstancePtr();
+	size_t spinCount = 0;
+	while (!IsDone())
+	{
+		if (jobSystem->TryExecuteJob())
+		{
+			spinCount = 0;
+			continue;
+		}
 
-	std::unique_lock lock{ m_finishedLock };
-	m_finishedCondition.wait(lock, [this]() {return m_isDone.load(); });
+		if (spinCount++ < g_waitSpinCount)
+		{
+			std::this_thread::yield();
+			continue;
+		}
 
+		std::unique_lock lock{ m_finishedLock };
+		m_finishedCondition.wait_for(lock, g_waitParkTimeout, [this]() {return IsDone(); });
+		spinCount = 0;
+	}
 }
 
 bool JobState::IsDone()
 {
-	return m_isDone.load();
+	return m_pendingJobs.load() == 0;
+}
+
+void JobState::Increment()
+{
+	m_pendingJobs.fetch_add(1);
+}
+
+void JobState::Decrement()
+{
+	PR_ASSERT(m_pendingJobs.load() > 0, "JobState counter underflow");
+	if (m_pendingJobs.fetch_sub(1) != 1)
+		return;
+
+	// Taking the lock orders the notification after the waiters predicate check
+	std::vector<JobPtr> continuations;
+	{
+		std::lock_guard lock{ m_finishedLock };
+		continuations.swap(m_continuations);
+	}
+
+	m_finishedCondition.notify_all();
+
+	for (auto& continuation : continuations)
+		continuation();
+}
+
+void JobState::AddContinuation(JobPtr&& p_continuation)
+{
+	{
+		std::lock_guard lock{ m_finishedLock };
+		if (!IsDone())
+		{
+			m_continuations.push_back(std::move(p_continuation));
+			return;
+		}
+	}
+
+	p_continuation();
 }
@@ -1,17 +1,40 @@
 #include "Core/Common/pearl_pch.h"
 
 #include "Core/Threading/JobWorker.h"
+#include "Core/Threading/JobSystem.h"
+#include "Core/Threading/ThreadSystem.h"
 
 using namespace PrCore::Threading;
 
-JobWorker::JobWorker(std::string_view p_name) :
+namespace {
+	thread_local JobWorker* t_currentWorker = nullptr;
+
+	// Pause iterations spent spinning before yielding, the limit adapts between the bounds
+	constexpr size_t g_minSpinLimit = 64;
+	constexpr size_t g_maxSpinLimit = 16384;
+	// Yields before the worker parks on the condition variable
+	constexpr size_t g_yieldCount = 16;
+}
+
+JobWorker::JobWorker(std::string_view p_name, JobSystem* p_jobSystem, uint32_t p_cacheDomain) :
 	m_id(0),
-	m_name(p_name)
-{}
+	m_name(p_name),
+	m_jobSystem(p_jobSystem),
+	m_cacheDomain(p_cacheDomain),
+	m_sleeping(false),
+	m_isBusy(false),
+	m_pause(false),
+	m_terminate(false)
+{
+	// Spinning on a single hardware thread only delays the thread that produces the work
+	m_maxSpinLimit = std::thread::hardware_concurrency() > 1 ? g_maxSpinLimit : 0;
+	m_spinLimit = std::min(g_minSpinLimit * 16, m_maxSpinLimit);
+}
 
 int JobWorker::ThreadLoop()
 {
-	m_id = ::GetCurrentThreadId();
+	m_id = ThreadSystem::GetCurrentThreadId();
+	t_currentWorker = this;
 
 	while (!ShouldTerminate())
 	{
@@ -19,24 +42,20 @@ int JobWorker::ThreadLoop()
 		if (ShouldPause())
 		{
 			std::unique_lock lock{ m_workerLock };
-			m_isBusy.store(false);
+			NotifyIdle();
 			m_wakeCondition.wait(lock, [&]() {return !m_pause.load() || m_terminate.load(); });
 			m_isBusy.store(true);
 		}
 
-		// Try to get job from the buffer
+		// Drain higher priorities first, from the own buffer and then from other workers
 		bool jobProcessed = false;
-		if (!jobProcessed)
+		for (size_t queue = 0; queue < s_queueCount && !jobProcessed; queue++)
 		{
-			std::optional<JobDesc> jobDesc;
-			{
-				std::lock_guard lock{ m_workerLock };
-				if (m_jobBuffer.size() > 0)
-				{
-					jobDesc = m_jobBuffer.front();
-					m_jobBuffer.pop_front();
-				}
-			}
+			auto priority = static_cast<JobPriority>(queue);
+
+			auto jobDesc = PopJob(priority);
+			if (!jobDesc)
+				jobDesc = StealFromWorkers(priority);
 
 			if (jobDesc)
 			{
@@ -45,42 +64,31 @@ int JobWorker::ThreadLoop()
 			}
 		}
 
-		// Steal job from other workers
+		// Background jobs run only when there is no frame work left
 		if (!jobProcessed)
-		{
-			// Iterate workers and steal the job
-			for (auto& worker : m_stealWorkers)
-			{
-				auto sharedPtr = worker.lock();
-				if (sharedPtr)
-				{
-					auto jobDesc = sharedPtr->StealJob();
-					if (jobDesc)
-					{
-#if JOB_SYSTEM_DEBUG_LOG
-						PRLOG_INFO("Job stolen from {} <queue size: {}> by {} <queue size: {}> ", worker->m_name, worker->m_jobBuffer.size() + 1, m_name, m_jobBuffer.size());
-#endif
-						ProcessJob(*jobDesc);
-						jobProcessed = true;
-						break;
-					}
-				}
-			}
-		}
+			jobProcessed = m_jobSystem->TryExecuteBackgroundJob(*this);
+
+		// Short gaps between jobs are bridged by spinning instead of a kernel round trip
+		if (jobProcessed || SpinForWork())
+			continue;
 
 		// No job was processed and jobBuffer is empty
 		std::unique_lock lock{ m_workerLock };
-		if (!jobProcessed && m_jobBuffer.empty())
+		if (!HasJobs())
 		{
-			m_isBusy.store(false);
-
 			// Notify that no more work to do and go sleep
-			m_idleCondition.notify_all();
-		
+			NotifyIdle();
+
+			// Sleeper is published before the predicate check, submitters check it after publishing the job
+			m_sleeping.store(true);
+			m_jobSystem->m_sleepingWorkers++;
+
 			m_wakeCondition.wait(lock, [&]() {
-				return !m_jobBuffer.empty() || m_terminate.load() || m_pause.load();
+				return HasJobs() || m_terminate.load() || m_pause.load() || HasPendingWork();
 				});
 
+			m_jobSystem->m_sleepingWorkers--;
+			m_sleeping.store(false);
 			m_isBusy.store(true);
 		}
 	}
@@ -88,50 +96,172 @@ int JobWorker::ThreadLoop()
 	return 0;
 }
 
+bool JobWorker::SpinForWork()
+{
+	for (size_t i = 0; i < m_spinLimit; i++)
+	{
+		if (HasPendingWork())
+		{
+			m_spinLimit = std::min(m_spinLimit * 2, m_maxSpinLimit);
+			return true;
+		}
+
+		PR_CPU_PAUSE();
+	}
+
+	for (size_t i = 0; i < g_yieldCount; i++)
+	{
+		if (HasPendingWork())
+			return true;
+
+		std::this_thread::yield();
+	}
+
+	m_spinLimit = std::max(m_spinLimit / 2, std::min(g_minSpinLimit, m_maxSpinLimit));
+	return false;
+}
+
+bool JobWorker::HasPendingWork()
+{
+	return m_jobSystem->m_queuedJobs.load() > 0 || m_jobSystem->HasRunnableBackgroundJob() || m_pause.load() || m_terminate.load();
+}
+
 void JobWorker::SetPaused(bool isPaused)
 {
-	m_pause.store(isPaused);
+	// Flags are changed under the lock so the wake up is not lost between the predicate check and the wait
+	{
+		std::lock_guard lock{ m_workerLock };
+		m_pause.store(isPaused);
+
+		// Worker with pending jobs counts as busy straight away so WaitForIdle does not return too early
+		if (!isPaused && HasJobs())
+			m_isBusy.store(true);
+	}
+
 	m_wakeCondition.notify_one();
 }
 
 void JobWorker::Terminate()
 {
-	m_terminate.store(true);
+	{
+		std::lock_guard lock{ m_workerLock };
+		m_terminate.store(true);
+	}
+
 	m_wakeCondition.notify_one();
 }
 
 void JobWorker::AddJobRequest(JobDesc&& p_jobDesc)
 {
-	PR_ASSERT(GetCurrentThreadId() != m_id, "Recursive job request! Not supported!");
+	PR_ASSERT(p_jobDesc.priority != JobPriority::Background, "Background jobs are not queued in workers");
 
-	{
-		std::lock_guard lock{ m_workerLock };
-		m_jobBuffer.push_back(std::move(p_jobDesc));
-	}
+	std::lock_guard lock{ m_workerLock };
+	m_jobBuffers[static_cast<size_t>(p_jobDesc.priority)].push_back(std::move(p_jobDesc));
+	m_jobSystem->m_queuedJobs++;
 
-	m_wakeCondition.notify_one();
+	if (!m_pause.load())
+		m_isBusy.store(true);
+}
+
+std::optional<JobDesc> JobWorker::PopJob(JobPriority p_priority)
+{
+	std::lock_guard lock{ m_workerLock };
+	auto& jobBuffer = m_jobBuffers[static_cast<size_t>(p_priority)];
+	if (jobBuffer.empty())
+		return std::nullopt;
+
+	auto jobDesc = std::move(jobBuffer.front());
+	jobBuffer.pop_front();
+	m_jobSystem->m_queuedJobs--;
+	return jobDesc;
 }
 
-std::optional<JobDesc> JobWorker::StealJob()
+std::optional<JobDesc> JobWorker::StealJob(JobPriority p_priority)
 {
 	// Steal only if worker is busy
 	if (!IsBusy())
 		return std::nullopt;
 
 	std::lock_guard lock{ m_workerLock };
-	if (m_jobBuffer.empty())
+	auto& jobBuffer = m_jobBuffers[static_cast<size_t>(p_priority)];
+	if (jobBuffer.empty())
 		return std::nullopt;
 
-	auto jobDesc = std::move(m_jobBuffer.back());
-	m_jobBuffer.pop_back();
+	auto jobDesc = std::move(jobBuffer.back());
+	jobBuffer.pop_back();
+	m_jobSystem->m_queuedJobs--;
 	return jobDesc;
 }
 
+std::optional<JobDesc> JobWorker::StealFromWorkers(JobPriority p_priority)
+{
+	// Iterate workers and steal the job
+	for (auto& worker : m_stealWorkers)
+	{
+		auto sharedPtr = worker.lock();
+		if (sharedPtr)
+		{
+			auto jobDesc = sharedPtr->StealJob(p_priority);
+			if (jobDesc)
+			{
+#if JOB_SYSTEM_DEBUG_LOG
+				PRLOG_INFO("Job stolen from {} by {}", sharedPtr->m_name, m_name);
+#endif
+				return jobDesc;
+			}
+		}
+	}
+
+	return std::nullopt;
+}
+
+void JobWorker::Wake()
+{
+	// Lock orders the wake up after the sleeping predicate check
+	{
+		std::lock_guard lock{ m_workerLock };
+	}
+
+	m_wakeCondition.notify_one();
+}
+
+bool JobWorker::WakeIfSleeping()
+{
+	if (!m_sleeping.load())
+		return false;
+
+	Wake();
+	return true;
+}
+
+bool JobWorker::HasJobs()
+{
+	for (auto& jobBuffer : m_jobBuffers)
+	{
+		if (!jobBuffer.empty())
+			return true;
+	}
+
+	return false;
+}
+
 bool JobWorker::IsBusy()
 {
 	return m_isBusy.load();
 }
 
+void JobWorker::NotifyIdle()
+{
+	m_isBusy.store(false);
+
+	// Lock orders the notification after the WaitForIdle predicate check
+	{
+		std::lock_guard lock{ m_idleLock };
+	}
+
+	m_idleCondition.notify_all();
+}
+
 void JobWorker::WaitForIdle()
 {
 	std::unique_lock lock{ m_idleLock };
@@ -140,11 +270,27 @@ void JobWorker::WaitForIdle()
 
 void JobWorker::SetStealWorkers(const std::vector<std::shared_ptr<JobWorker>>& p_workers)
 {
-	for (auto& worker : p_workers)
+	auto selfIt = std::find_if(p_workers.begin(), p_workers.end(), [&](const std::shared_ptr<JobWorker>& p_worker) {
+		return p_worker.get() == this;
+		});
+	size_t selfIndex = selfIt == p_workers.end() ? 0 : std::distance(p_workers.begin(), selfIt);
+
+	// Start after itself so workers do not all hit the same victim first
+	std::vector<std::shared_ptr<JobWorker>> remoteWorkers;
+	m_stealWorkers.clear();
+	for (size_t i = 1; i <= p_workers.size(); i++)
 	{
-		if (worker->m_id != m_id)
+		auto& worker = p_workers[(selfIndex + i) % p_workers.size()];
+		if (worker.get() == this)
+			continue;
+
+		if (worker->GetCacheDomain() == m_cacheDomain)
 			m_stealWorkers.push_back(worker);
+		else
+			remoteWorkers.push_back(worker);
 	}
+
+	m_stealWorkers.insert(m_stealWorkers.end(), remoteWorkers.begin(), remoteWorkers.end());
 }
 
 void JobWorker::ProcessJob(const JobDesc& p_jobDesc)
@@ -153,24 +299,25 @@ void JobWorker::ProcessJob(const JobDesc& p_jobDesc)
 	PRLOG_INFO("JobWorker \"{}\" starting job: \"{}\"", m_name, p_jobDesc.name);
 #endif
 
-	auto jobState = p_jobDesc.state;
-	{
-		std::lock_guard lock{ jobState->m_finishedLock };
-		p_jobDesc.functionPtr();
-		jobState->m_isDone.store(true);
-	}
+	p_jobDesc.functionPtr();
 
-	jobState->m_finishedCondition.notify_all();
+	// Releases the waiters and runs continuations, they may schedule new jobs from this thread
+	p_jobDesc.state->Decrement();
+}
+
+JobWorker* JobWorker::GetCurrentWorker()
+{
+	return t_currentWorker;
 }
 
 bool JobWorker::ShouldTerminate()
 {
 	std::lock_guard lock{ m_workerLock };
-	return m_terminate.load() && m_jobBuffer.empty();
+	return m_terminate.load() && !HasJobs();
 }
 
 JobWorker::~JobWorker()
 {
-	PR_ASSERT(m_jobBuffer.empty(), "Job buffer must be emtry!");
+	PR_ASSERT(!HasJobs(), "Job buffer must be emtry!");
 	m_stealWorkers.clear();
 }
@@ -0,0 +1,11 @@
+#include "Core/Common/pearl_pch.h"
+
+#include "Core/Threading/Task.h"
+#include "Core/Threading/JobSystem.h"
+
+void PrCore::Threading::ResumeOnWorker(std::coroutine_handle<> p_handle, JobPriority p_priority)
+{
+	JobSystem::GetInstance().Schedule(p_priority, "TaskResume", [p_handle]() {
+		p_handle.resume();
+		});
+}
@@ -2,51 +2,94 @@
 
 #include "Core/Threading/ThreadSystem.h"
 
-#include <windows.h>
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <sched.h>
+#endif
 
 namespace PrCore::Threading {
+#ifdef _WIN32
 	DWORD WINAPI ThreadEntry(LPVOID p_thread)
 	{
 		auto threadPtr = *static_cast<IThreadPtr*>(p_thread);
 		int exitCode = threadPtr->ThreadLoop();
 
 		// Remove thread from the registry when terminated
-		{
-			auto threadSystem = ThreadSystem::GetInstancePtr();
-			std::lock_guard lock{ threadSystem->m_activeThreadLock };
-			auto it = threadSystem->m_activeThreads.find(threadPtr);
-			if (it == threadSystem->m_activeThreads.end())
-			{
-				PRLOG_WARN("Does not exist or already terminated");
-			}
-			else
-			{
-				PRLOG_INFO("Terminated thread id: {} name: {} with affinityMask {:b}", it->threadId, it->name, it->affinityMask);
-				threadSystem->m_activeThreads.erase(it);
-			}
-		}
+		ThreadSystem::GetInstancePtr()->UnregisterThread(threadPtr);
 
 		delete static_cast<IThreadPtr*>(p_thread);
 
 		return exitCode;
 	}
+#else
+	// Thread is created before it is registered, the gate holds the loop until SpawnThread is done
+	struct ThreadStartData
+	{
+		IThreadPtr              threadPtr;
+		std::mutex              gateLock;
+		std::condition_variable gateCondition;
+		bool                    gateOpen = false;
+	};
+
+	void* ThreadEntry(void* p_thread)
+	{
+		auto startData = static_cast<ThreadStartData*>(p_thread);
+		{
+			std::unique_lock lock{ startData->gateLock };
+			startData->gateCondition.wait(lock, [&]() {return startData->gateOpen; });
+		}
+
+		auto threadPtr = startData->threadPtr;
+		delete startData;
+
+		auto threadSystem = ThreadSystem::GetInstancePtr();
+		auto exitSignal = threadSystem->GetThreadExitSignal(threadPtr);
+
+		threadPtr->ThreadLoop();
+
+		// Remove thread from the registry when terminated
+		threadSystem->UnregisterThread(threadPtr);
+
+		if (exitSignal)
+		{
+			std::lock_guard lock{ exitSignal->exitLock };
+			exitSignal->exited = true;
+			exitSignal->exitCondition.notify_all();
+		}
+
+		return nullptr;
+	}
+#endif
 }
 
 using namespace PrCore::Threading;
 
 ThreadSystem::~ThreadSystem()
 {
-	// Terminate all threads
-	std::lock_guard lock{ m_activeThreadLock };
-	for (auto& threadDesc : m_activeThreads)
+	// Terminate all threads, the lock is released before waiting because exiting threads unregister themselves
+	std::vector<ThreadDesc> activeThreads;
+	{
+		std::lock_guard lock{ m_activeThreadLock };
+		activeThreads.assign(m_activeThreads.begin(), m_activeThreads.end());
+	}
+
+	for (auto& threadDesc : activeThreads)
 	{
+		PRLOG_INFO("Terminating thread id: {} name: {}", threadDesc.threadId, threadDesc.name);
+
 		threadDesc.threadPtr->Terminate();
+#ifdef _WIN32
 		::WaitForSingleObject(threadDesc.nativeHandle, INFINITE);
 		::CloseHandle(threadDesc.nativeHandle);
-
-		PRLOG_INFO("Terminating thread id: {} name: {}", threadDesc.threadId, threadDesc.name);
+#else
+		std::unique_lock lock{ threadDesc.exitSignal->exitLock };
+		threadDesc.exitSignal->exitCondition.wait(lock, [&]() {return threadDesc.exitSignal->exited; });
+#endif
 	}
 
+	std::lock_guard lock{ m_activeThreadLock };
 	m_activeThreads.clear();
 }
 
@@ -67,58 +110,151 @@ bool ThreadSystem::SpawnThread(IThreadPtr p_thread, const ThreadConfig& p_config
 	// Set paused before spawning the thread if should start paused
 	p_thread->SetPaused(p_config.startPaused);
 
+	ThreadDesc threadDesc;
+	threadDesc.threadPtr = p_thread;
+	threadDesc.name = p_config.name;
+	threadDesc.affinityMask = p_config.affinityMask;
+	threadDesc.stackSize = p_config.stackSize;
+
+#ifdef _WIN32
 	// Dynamically allocate the shared_ptr to avoid loosing the stack address, the thread is responsible for deleting the memory
 	std::shared_ptr<IThread>* heapSharedPtr = new std::shared_ptr<IThread>(p_thread);
-	
+
+	// Thread starts suspended so it is registered before its loop runs
 	DWORD threadId = 0;
 	HANDLE threadHandle = ::CreateThread(NULL,
 		p_config.stackSize * 1024,
 		PrCore::Threading::ThreadEntry,
 		heapSharedPtr,
-		0,
+		CREATE_SUSPENDED,
 		&threadId
 	);
 
 	if (threadHandle == NULL)
 	{
+		delete heapSharedPtr;
 		PR_ASSERT(threadHandle, "Failed to spawn the thread");
 		return false;
 	}
 
-	::SetThreadAffinityMask(threadHandle, p_config.affinityMask);
+	if (p_config.affinityMask != 0)
+		::SetThreadAffinityMask(threadHandle, p_config.affinityMask);
 	::SetThreadPriority(threadHandle, THREAD_PRIORITY_NORMAL);
 
 	std::wstring stemp = std::wstring(p_config.name.begin(), p_config.name.end());
 	LPCWSTR wstr = stemp.c_str();
 	::SetThreadDescription(threadHandle, wstr);
 
-	ThreadDesc threadDesc;
-	threadDesc.threadPtr = p_thread;
-	threadDesc.name = p_config.name;
-	threadDesc.affinityMask = p_config.affinityMask;
-	threadDesc.stackSize = p_config.stackSize;
 	threadDesc.nativeHandle = threadHandle;
 	threadDesc.threadId = threadId;
+#else
+	pthread_attr_t threadAttributes;
+	::pthread_attr_init(&threadAttributes);
+
+	// Stack size is given in KB same as on Windows, pthreads refuse sizes below PTHREAD_STACK_MIN
+	if (p_config.stackSize > 0)
+	{
+		size_t stackSize = std::max<size_t>(p_config.stackSize * 1024, PTHREAD_STACK_MIN);
+		if (::pthread_attr_setstacksize(&threadAttributes, stackSize) != 0)
+			PRLOG_WARN("Failed to set stack size {}KB for thread {}", p_config.stackSize, p_config.name);
+	}
+
+	auto startData = new ThreadStartData();
+	startData->threadPtr = p_thread;
+
+	pthread_t threadHandle;
+	int result = ::pthread_create(&threadHandle, &threadAttributes, PrCore::Threading::ThreadEntry, startData);
+	::pthread_attr_destroy(&threadAttributes);
+
+	if (result != 0)
+	{
+		delete startData;
+		PR_ASSERT(result == 0, "Failed to spawn the thread");
+		return false;
+	}
+
+	// Threads are never joined directly, JoinThread waits for the exit signal
+	::pthread_detach(threadHandle);
+
+	// Thread without a mask inherits the affinity of the process, processors above 63 included
+	if (p_config.affinityMask != 0)
+	{
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		for (size_t cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; cpu++)
+		{
+			if (p_config.affinityMask & (uint64_t(1) << cpu))
+				CPU_SET(cpu, &cpuSet);
+		}
+
+		if (::pthread_setaffinity_np(threadHandle, sizeof(cpu_set_t), &cpuSet) != 0)
+			PRLOG_WARN("Failed to set affinity mask 0x{:b} for thread {}", p_config.affinityMask, p_config.name);
+	}
+
+	// Linux limits thread names to 15 characters
+	auto nativeName = p_config.name.substr(0, 15);
+	::pthread_setname_np(threadHandle, nativeName.c_str());
+
+	threadDesc.exitSignal = std::make_shared<ThreadExitSignal>();
+	threadDesc.threadId = static_cast<uint64_t>(threadHandle);
+#endif
 
 	PRLOG_INFO("Created thread id: {} name: {} with mask 0x{:b}", threadDesc.threadId, threadDesc.name, threadDesc.affinityMask);
-	
+
 	// Insert thread into the register
 	{
 		std::lock_guard lock{ m_activeThreadLock };
 		m_activeThreads.insert(std::move(threadDesc));
 	}
 
+	// Open the start gate
+#ifdef _WIN32
+	::ResumeThread(threadHandle);
+#else
+	{
+		std::lock_guard lock{ startData->gateLock };
+		startData->gateOpen = true;
+		startData->gateCondition.notify_one();
+	}
+#endif
+
 	return true;
 }
 
 void ThreadSystem::JoinThread(IThreadPtr p_thread)
 {
+#ifdef _WIN32
 	HANDLE threadHandle = GetThreadHandle(p_thread);
-	
+
 	if(threadHandle)
 		::WaitForSingleObject(threadHandle, INFINITE);
+#else
+	auto exitSignal = GetThreadExitSignal(p_thread);
+
+	if (exitSignal)
+	{
+		std::unique_lock lock{ exitSignal->exitLock };
+		exitSignal->exitCondition.wait(lock, [&]() {return exitSignal->exited; });
+	}
+#endif
+}
+
+void ThreadSystem::UnregisterThread(const IThreadPtr& p_thread)
+{
+	std::lock_guard lock{ m_activeThreadLock };
+	auto it = m_activeThreads.find(p_thread);
+	if (it == m_activeThreads.end())
+	{
+		PRLOG_WARN("Does not exist or already terminated");
+	}
+	else
+	{
+		PRLOG_INFO("Terminated thread id: {} name: {} with affinityMask {:b}", it->threadId, it->name, it->affinityMask);
+		m_activeThreads.erase(it);
+	}
 }
 
+#ifdef _WIN32
 void* ThreadSystem::GetThreadHandle(IThreadPtr p_thread)
 {
 	std::shared_lock lock{ m_activeThreadLock };
@@ -133,6 +269,22 @@ void* ThreadSystem::GetThreadHandle(IThreadPtr p_thread)
 		return it->nativeHandle;
 	}
 }
+#else
+ThreadSystem::ThreadExitSignalPtr ThreadSystem::GetThreadExitSignal(IThreadPtr p_thread)
+{
+	std::shared_lock lock{ m_activeThreadLock };
+
+	auto it = m_activeThreads.find(p_thread);
+	if (it == m_activeThreads.end())
+	{
+		return nullptr;
+	}
+	else
+	{
+		return it->exitSignal;
+	}
+}
+#endif
 
 void ThreadSystem::PauseThread(IThreadPtr p_thread, bool p_pause)
 {
@@ -184,4 +336,13 @@ size_t ThreadSystem::GetThreadNum()
 {
 	std::shared_lock lock{ m_activeThreadLock };
 	return m_activeThreads.size();
-}
\ No newline at end of file
+}
+
+uint64_t ThreadSystem::GetCurrentThreadId()
+{
+#ifdef _WIN32
+	return ::GetCurrentThreadId();
+#else
+	return static_cast<uint64_t>(::pthread_self());
+#endif
+}
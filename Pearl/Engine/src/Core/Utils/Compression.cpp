@@ -0,0 +1,206 @@
+#include "Core/Common/pearl_pch.h"
+
+#include "Core/Utils/Compression.h"
+
+#include <cstring>
+
+namespace {
+	constexpr size_t   g_minMatch = 4;
+	constexpr size_t   g_lastLiterals = 5;   // Block ends with literals
+	constexpr size_t   g_matchSearchEnd = 12; // Last match starts before it
+	constexpr size_t   g_maxOffset = 65535;
+	constexpr uint32_t g_hashBits = 12;
+
+	inline uint32_t Read32(const uint8_t* p_data)
+	{
+		uint32_t value;
+		std::memcpy(&value, p_data, sizeof(value));
+		return value;
+	}
+
+	inline uint32_t HashSequence(uint32_t p_sequence)
+	{
+		return (p_sequence * 2654435761u) >> (32 - g_hashBits);
+	}
+
+	// Token nibble holds lengths below 15, longer ones continue in 255 steps
+	inline bool WriteLength(uint8_t*& p_dst, const uint8_t* p_dstEnd, size_t p_length)
+	{
+		for (; p_length >= 255; p_length -= 255)
+		{
+			if (p_dst >= p_dstEnd)
+				return false;
+			*p_dst++ = 255;
+		}
+
+		if (p_dst >= p_dstEnd)
+			return false;
+		*p_dst++ = static_cast<uint8_t>(p_length);
+		return true;
+	}
+
+	inline bool ReadLength(const uint8_t*& p_src, const uint8_t* p_srcEnd, size_t& p_length)
+	{
+		uint8_t byte;
+		do
+		{
+			if (p_src >= p_srcEnd)
+				return false;
+
+			byte = *p_src++;
+			p_length += byte;
+		} while (byte == 255);
+
+		return true;
+	}
+
+	bool WriteSequence(uint8_t*& p_dst, const uint8_t* p_dstEnd, const uint8_t* p_literals, size_t p_literalLength, size_t p_offset, size_t p_matchLength)
+	{
+		if (p_dst >= p_dstEnd)
+			return false;
+
+		uint8_t* token = p_dst++;
+		*token = static_cast<uint8_t>((p_literalLength < 15 ? p_literalLength : 15) << 4);
+		if (p_literalLength >= 15 && !WriteLength(p_dst, p_dstEnd, p_literalLength - 15))
+			return false;
+
+		if (static_cast<size_t>(p_dstEnd - p_dst) < p_literalLength)
+			return false;
+		if (p_literalLength > 0)
+			std::memcpy(p_dst, p_literals, p_literalLength);
+		p_dst += p_literalLength;
+
+		// Last sequence has literals only
+		if (p_matchLength == 0)
+			return true;
+
+		if (p_dstEnd - p_dst < 2)
+			return false;
+		*p_dst++ = static_cast<uint8_t>(p_offset);
+		*p_dst++ = static_cast<uint8_t>(p_offset >> 8);
+
+		size_t matchLength = p_matchLength - g_minMatch;
+		*token |= static_cast<uint8_t>(matchLength < 15 ? matchLength : 15);
+		if (matchLength >= 15 && !WriteLength(p_dst, p_dstEnd, matchLength - 15))
+			return false;
+
+		return true;
+	}
+}
+
+namespace PrCore::Utils {
+
+	size_t CompressBound(size_t p_size)
+	{
+		return p_size + p_size / 255 + 16;
+	}
+
+	size_t Compress(const void* p_src, size_t p_srcSize, void* p_dst, size_t p_dstCapacity)
+	{
+		auto src = static_cast<const uint8_t*>(p_src);
+		auto srcEnd = src + p_srcSize;
+		auto dst = static_cast<uint8_t*>(p_dst);
+		auto dstEnd = dst + p_dstCapacity;
+
+		auto anchor = src;
+		if (p_srcSize > g_matchSearchEnd)
+		{
+			// Positions of the last sequences by their hash, stale entries are rejected by the byte compare
+			uint32_t hashTable[1 << g_hashBits] = {};
+
+			auto searchEnd = srcEnd - g_matchSearchEnd;
+			auto matchEnd = srcEnd - g_lastLiterals;
+			auto current = src + 1;
+			size_t misses = 0;
+			while (current < searchEnd)
+			{
+				auto sequence = Read32(current);
+				auto& hashEntry = hashTable[HashSequence(sequence)];
+				auto candidate = src + hashEntry;
+				hashEntry = static_cast<uint32_t>(current - src);
+
+				if (candidate >= current || static_cast<size_t>(current - candidate) > g_maxOffset || Read32(candidate) != sequence)
+				{
+					// Incompressible data is skipped faster the longer it gets
+					current += 1 + (misses++ >> 6);
+					continue;
+				}
+				misses = 0;
+
+				while (current > anchor && candidate > src && current[-1] == candidate[-1])
+				{
+					current--;
+					candidate--;
+				}
+
+				size_t matchLength = g_minMatch;
+				while (current + matchLength < matchEnd && current[matchLength] == candidate[matchLength])
+					matchLength++;
+
+				if (!WriteSequence(dst, dstEnd, anchor, current - anchor, current - candidate, matchLength))
+					return 0;
+
+				current += matchLength;
+				anchor = current;
+				if (current < searchEnd)
+					hashTable[HashSequence(Read32(current - 2))] = static_cast<uint32_t>(current - 2 - src);
+			}
+		}
+
+		if (!WriteSequence(dst, dstEnd, anchor, srcEnd - anchor, 0, 0))
+			return 0;
+
+		return dst - static_cast<uint8_t*>(p_dst);
+	}
+
+	bool Decompress(const void* p_src, size_t p_srcSize, void* p_dst, size_t p_dstSize)
+	{
+		auto src = static_cast<const uint8_t*>(p_src);
+		auto srcEnd = src + p_srcSize;
+		auto dstBegin = static_cast<uint8_t*>(p_dst);
+		auto dst = dstBegin;
+		auto dstEnd = dstBegin + p_dstSize;
+
+		while (src < srcEnd)
+		{
+			uint8_t token = *src++;
+
+			size_t literalLength = token >> 4;
+			if (literalLength == 15 && !ReadLength(src, srcEnd, literalLength))
+				return false;
+
+			if (literalLength > static_cast<size_t>(srcEnd - src) || literalLength > static_cast<size_t>(dstEnd - dst))
+				return false;
+			if (literalLength > 0)
+				std::memcpy(dst, src, literalLength);
+			src += literalLength;
+			dst += literalLength;
+
+			if (src == srcEnd)
+				break;
+
+			if (srcEnd - src < 2)
+				return false;
+			size_t offset = src[0] | static_cast<size_t>(src[1]) << 8;
+			src += 2;
+			if (offset == 0 || offset > static_cast<size_t>(dst - dstBegin))
+				return false;
+
+			size_t matchLength = token & 15;
+			if (matchLength == 15 && !ReadLength(src, srcEnd, matchLength))
+				return false;
+			matchLength += g_minMatch;
+
+			if (matchLength > static_cast<size_t>(dstEnd - dst))
+				return false;
+
+			// Matches overlap their output when the offset is shorter than the length
+			auto match = dst - offset;
+			for (size_t i = 0; i < matchLength; i++)
+				dst[i] = match[i];
+			dst += matchLength;
+		}
+
+		return dst == dstEnd;
+	}
+}
@@ -0,0 +1,110 @@
+#include "Core/Common/pearl_pch.h"
+
+#include "Core/Utils/Hash.h"
+
+#include <cstring>
+
+namespace {
+	constexpr uint64_t g_prime1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t g_prime2 = 0xC2B2AE3D27D4EB4Full;
+	constexpr uint64_t g_prime3 = 0x165667B19E3779F9ull;
+	constexpr uint64_t g_prime4 = 0x85EBCA77C2B2AE63ull;
+	constexpr uint64_t g_prime5 = 0x27D4EB2F165667C5ull;
+
+	inline uint64_t RotateLeft(uint64_t p_value, int p_bits)
+	{
+		return (p_value << p_bits) | (p_value >> (64 - p_bits));
+	}
+
+	// Little endian reads, the engine platforms are little endian
+	inline uint64_t Read64(const uint8_t* p_data)
+	{
+		uint64_t value;
+		std::memcpy(&value, p_data, sizeof(value));
+		return value;
+	}
+
+	inline uint32_t Read32(const uint8_t* p_data)
+	{
+		uint32_t value;
+		std::memcpy(&value, p_data, sizeof(value));
+		return value;
+	}
+
+	inline uint64_t Round(uint64_t p_acc, uint64_t p_input)
+	{
+		p_acc += p_input * g_prime2;
+		p_acc = RotateLeft(p_acc, 31);
+		return p_acc * g_prime1;
+	}
+
+	inline uint64_t MergeRound(uint64_t p_acc, uint64_t p_value)
+	{
+		p_acc ^= Round(0, p_value);
+		return p_acc * g_prime1 + g_prime4;
+	}
+}
+
+uint64_t PrCore::Utils::Hash64(const void* p_data, size_t p_size, uint64_t p_seed /*= 0*/)
+{
+	auto data = static_cast<const uint8_t*>(p_data);
+	auto end = data + p_size;
+
+	uint64_t hash;
+	if (p_size >= 32)
+	{
+		uint64_t acc1 = p_seed + g_prime1 + g_prime2;
+		uint64_t acc2 = p_seed + g_prime2;
+		uint64_t acc3 = p_seed;
+		uint64_t acc4 = p_seed - g_prime1;
+
+		// Four independent lanes of 8 bytes
+		for (auto stripesEnd = end - 32; data <= stripesEnd; data += 32)
+		{
+			acc1 = Round(acc1, Read64(data));
+			acc2 = Round(acc2, Read64(data + 8));
+			acc3 = Round(acc3, Read64(data + 16));
+			acc4 = Round(acc4, Read64(data + 24));
+		}
+
+		hash = RotateLeft(acc1, 1) + RotateLeft(acc2, 7) + RotateLeft(acc3, 12) + RotateLeft(acc4, 18);
+		hash = MergeRound(hash, acc1);
+		hash = MergeRound(hash, acc2);
+		hash = MergeRound(hash, acc3);
+		hash = MergeRound(hash, acc4);
+	}
+	else
+	{
+		hash = p_seed + g_prime5;
+	}
+
+	hash += static_cast<uint64_t>(p_size);
+
+	for (; data + 8 <= end; data += 8)
+	{
+		hash ^= Round(0, Read64(data));
+		hash = RotateLeft(hash, 27) * g_prime1 + g_prime4;
+	}
+
+	if (data + 4 <= end)
+	{
+		hash ^= static_cast<uint64_t>(Read32(data)) * g_prime1;
+		hash = RotateLeft(hash, 23) * g_prime2 + g_prime3;
+		data += 4;
+	}
+
+	for (; data < end; data++)
+	{
+		hash ^= static_cast<uint64_t>(*data) * g_prime5;
+		hash = RotateLeft(hash, 11) * g_prime1;
+	}
+
+	// Avalanche
+	hash ^= hash >> 33;
+	hash *= g_prime2;
+	hash ^= hash >> 29;
+	hash *= g_prime3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
@@ -28,6 +28,24 @@ namespace PrCore::PathUtils
 		return retPath;
 	}
 
+	uint64_t HashPath(std::string_view p_path)
+	{
+		// FNV-1a of the characters as Sanitize writes them
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (char ch : p_path)
+		{
+			if (ch == '\\')
+				ch = '/';
+			else
+				ch = static_cast<char>(std::tolower(static_cast<unsigned int>(ch)));
+
+			hash ^= static_cast<uint8_t>(ch);
+			hash *= 0x100000001b3ull;
+		}
+
+		return hash != 0 ? hash : 1;
+	}
+
 	bool IsAbsolute(const char* p_path)
 	{
 		return !PathIsRelativeA(p_path);
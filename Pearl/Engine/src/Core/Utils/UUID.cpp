@@ -7,8 +7,8 @@
 using namespace PrCore::Utils;
 
 
-static std::random_device s_randomDevice;
-static std::mt19937_64 s_mt(s_randomDevice());
+// Engine per thread so IDs can be generated from job workers
+static thread_local std::mt19937_64 s_mt(std::random_device{}());
 
 PrCore::Utils::UUID UUIDGenerator::Generate() const
 {
@@ -149,8 +149,7 @@ void GLWindow::BindCallbacks()
 	//Close Window Callback
 	glfwSetWindowCloseCallback(m_window, [](GLFWwindow* p_window)
 		{
-			EventPtr event = std::make_shared<WindowCloseEvent>();
-			EventManager::GetInstance().QueueEvent(event);
+			EventManager::GetInstance().QueueEvent<WindowCloseEvent>();
 		});
 
 	//Resize Window Callback
@@ -160,16 +159,14 @@ void GLWindow::BindCallbacks()
 			windowSettings->width = p_width;
 			windowSettings->height = p_height;
 
-			EventPtr event = std::make_shared<WindowResizeEvent>(p_width, p_height);
-			EventManager::GetInstance().QueueEvent(event);
+			EventManager::GetInstance().QueueEvent<WindowResizeEvent>(p_width, p_height);
 		});
 
 	//Minimalize Window Callback
 	glfwSetWindowIconifyCallback(m_window, [](GLFWwindow* p_window, int p_iconified)
 		{
 
-			EventPtr event = std::make_shared<WindowMinimalizeEvent>(p_iconified);
-			EventManager::GetInstance().QueueEvent(event);
+			EventManager::GetInstance().QueueEvent<WindowMinimalizeEvent>(p_iconified);
 		});
 
 
@@ -178,13 +175,11 @@ void GLWindow::BindCallbacks()
 		{
 			if (p_action == GLFW_PRESS)
 			{
-				EventPtr event = std::make_shared<KeyPressedEvent>(p_key);
-				EventManager::GetInstance().QueueEvent(event);
+				EventManager::GetInstance().QueueEvent<KeyPressedEvent>(p_key);
 			}
 			else if (p_action == GLFW_RELEASE)
 			{
-				EventPtr event = std::make_shared<KeyReleasedEvent>(p_key);
-				EventManager::GetInstance().QueueEvent(event);
+				EventManager::GetInstance().QueueEvent<KeyReleasedEvent>(p_key);
 			}
 		});
 
@@ -193,26 +188,28 @@ void GLWindow::BindCallbacks()
 		{
 			if (p_action == GLFW_PRESS)
 			{
-				EventPtr event = std::make_shared<MouseButtonPressedEvent>(p_button);
-				EventManager::GetInstance().QueueEvent(event);
+				EventManager::GetInstance().QueueEvent<MouseButtonPressedEvent>(p_button);
 			}
 			else if (p_action == GLFW_RELEASE)
 			{
-				EventPtr event = std::make_shared<MouseButtonReleasedEvent>(p_button);
-				EventManager::GetInstance().QueueEvent(event);
+				EventManager::GetInstance().QueueEvent<MouseButtonReleasedEvent>(p_button);
 			}
 		});
 
 	//Mouse Position Callback
 	glfwSetCursorPosCallback(m_window, [](GLFWwindow* p_window, double p_xPos, double p_yPos)
 		{
-			EventPtr event = std::make_shared<MouseMovedEvent>(p_xPos, p_yPos);
-			EventManager::GetInstance().QueueEvent(event);
+			EventManager::GetInstance().QueueEvent<MouseMovedEvent>(p_xPos, p_yPos);
 		});
 
 	glfwSetScrollCallback(m_window, [](GLFWwindow* p_window, double p_xOffset, double p_yOffset)
 		{
-			EventPtr event = std::make_shared<MouseScrollEvent>(p_xOffset, p_yOffset);
-			EventManager::GetInstance().QueueEvent(event);
+			EventManager::GetInstance().QueueEvent<MouseScrollEvent>(p_xOffset, p_yOffset);
+		});
+
+	//Text Input Callback
+	glfwSetCharCallback(m_window, [](GLFWwindow* p_window, unsigned int p_codepoint)
+		{
+			EventManager::GetInstance().QueueEvent<CharInputEvent>(p_codepoint);
 		});
 }
@@ -359,7 +359,7 @@ namespace PrRenderer::Core
 
 	void DeferRenderBackend::OnWindowResize(PrCore::Events::EventPtr p_event)
 	{
-		auto windowResizeEvent = std::static_pointer_cast<PrCore::Events::WindowResizeEvent>(p_event);
+		auto windowResizeEvent = static_cast<PrCore::Events::WindowResizeEvent*>(p_event);
 		m_screenWidth = windowResizeEvent->m_width;
 		m_screenHeight = windowResizeEvent->m_height;
 
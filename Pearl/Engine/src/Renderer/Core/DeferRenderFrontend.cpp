@@ -4,6 +4,7 @@
 
 #include"Core/ECS/ECS.h"
 #include"Core/Utils/Clock.h"
+#include"Core/Memory/FrameAllocator.h"
 
 #include "Renderer/Core/DeferRenderBackend.h"
 #include "Renderer/Core/BoundingVolume.h"
@@ -137,19 +138,19 @@ void DeferRenderFrontend::SubmitMesh(ECS::Entity& p_entity)
 	PR_ASSERT(p_entity.HasComponent<ECS::TransformComponent>(), "FrontendRenderer: entity does not have a TransformComponent");
 
 	auto meshComponent = p_entity.GetComponent<ECS::MeshRendererComponent>();
-	auto mesh = meshComponent->mesh;
+	auto mesh = meshComponent->mesh.Get();
 	if (mesh == nullptr)
 		return;
 
 	auto transformComponent = p_entity.GetComponent<ECS::TransformComponent>();
 	auto worldMatrix = transformComponent->GetWorldMatrix();
-	auto shadowMesh = meshComponent->shadowMesh;
+	auto shadowMesh = meshComponent->shadowMesh.Get();
 	bool shouldCull = !mesh->GetBoxVolume().IsOnFrustrum(m_frustrum, worldMatrix);
 
 	// Create RenderObject for each submesh
 	for (int i = 0; i < mesh->GetSubmeshCount() && i < meshComponent->materials.size(); ++i)
 	{
-		auto material = meshComponent->materials[i];
+		const auto& material = meshComponent->materials[i];
 		if (material == nullptr)
 			continue;
 
@@ -334,7 +335,9 @@ void DeferRenderFrontend::SetDebugColor(const Color& p_color)
 
 size_t DeferRenderFrontend::InstanciateObjectsByMaterial(RenderObjectVector& p_renderObjects)
 {
-	RenderObjectVector instanciateCandidates;
+	// Temporary buffers live in the frame scratch memory
+	auto& frameAllocator = PrCore::Memory::FrameAllocator::GetInstance();
+	PrCore::Memory::FrameVector<RenderObjectPtr> instanciateCandidates(frameAllocator.GetStlAllocator<RenderObjectPtr>());
 	size_t instancedObjects = 0;
 
 	for(auto objIt = p_renderObjects.begin(); objIt != p_renderObjects.end();)
@@ -360,7 +363,7 @@ size_t DeferRenderFrontend::InstanciateObjectsByMaterial(RenderObjectVector& p_r
 			//Grab common data for all instances
 			const auto& instnaceFront = instanciateCandidates.front();
 
-			std::vector<PrCore::Math::mat4> matrices;
+			PrCore::Memory::FrameVector<PrCore::Math::mat4> matrices(frameAllocator.GetStlAllocator<PrCore::Math::mat4>());
 			matrices.reserve(MAX_INSTANCE_COUNT);
 			for (int i = 0; i < instancedCount; )
 			{
@@ -385,7 +388,7 @@ size_t DeferRenderFrontend::InstanciateObjectsByMaterial(RenderObjectVector& p_r
 				instncedObj->sortingHash = instnaceFront->sortingHash;
 				instncedObj->type = RenderObjectType::InstancedMesh;
 				instncedObj->instanceSize = matrices.size();
-				instncedObj->worldMatrices = matrices;
+				instncedObj->worldMatrices.assign(matrices.begin(), matrices.end());
 				instncedObj->wiredframe = object->wiredframe;
 
 				//Erase instanced objects from the buffer
@@ -408,7 +411,9 @@ size_t DeferRenderFrontend::InstanciateObjectsByMaterial(RenderObjectVector& p_r
 
 size_t DeferRenderFrontend::InstanciateObjectsByMesh(RenderObjectVector& p_renderObjects)
 {
-	RenderObjectVector instanciateCandidates;
+	// Temporary buffers live in the frame scratch memory
+	auto& frameAllocator = PrCore::Memory::FrameAllocator::GetInstance();
+	PrCore::Memory::FrameVector<RenderObjectPtr> instanciateCandidates(frameAllocator.GetStlAllocator<RenderObjectPtr>());
 	size_t instancedObjects = 0;
 
 	for (auto objIt = p_renderObjects.begin(); objIt != p_renderObjects.end();)
@@ -433,7 +438,7 @@ size_t DeferRenderFrontend::InstanciateObjectsByMesh(RenderObjectVector& p_rende
 			//Grab common data for all instances
 			const auto& instnaceFront = instanciateCandidates.front();
 
-			std::vector<PrCore::Math::mat4> matrices;
+			PrCore::Memory::FrameVector<PrCore::Math::mat4> matrices(frameAllocator.GetStlAllocator<PrCore::Math::mat4>());
 			matrices.reserve(MAX_INSTANCE_COUNT);
 			for (int i = 0; i < instancedCount; )
 			{
@@ -455,7 +460,7 @@ size_t DeferRenderFrontend::InstanciateObjectsByMesh(RenderObjectVector& p_rende
 				instncedObj->id = 0;
 				instncedObj->type = RenderObjectType::InstancedMesh;
 				instncedObj->instanceSize = matrices.size();
-				instncedObj->worldMatrices = matrices;
+				instncedObj->worldMatrices.assign(matrices.begin(), matrices.end());
 
 				//Erase instanced objects from the buffer
 				innerIt = p_renderObjects.erase(innerItBegin, innerIt);
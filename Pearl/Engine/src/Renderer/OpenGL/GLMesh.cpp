@@ -23,16 +23,20 @@ void GLMesh::Unbind()
 
 void GLMesh::RecalculateNormals()
 {
-	m_normals.clear();
 	m_normals = CalculateNormals();
 }
 
 void GLMesh::RecalculateTangents()
 {
-	m_tangents.clear();
 	m_tangents = CalculateTangents();
 }
 
+PrCore::Resources::IResourceDataPtr GLMesh::Clone() const
+{
+	// Streams and the vertex array are shared, the copy creates its own buffers once its streams change
+	return std::make_shared<GLMesh>(*this);
+}
+
 void GLMesh::UpdateBuffers()
 {
 	auto vertexBuffer = Buffers::VertexBuffer::Create();
@@ -43,78 +47,86 @@ void GLMesh::UpdateBuffers()
 	bufferLayout.AddElementBuffer({ "Vertex", Buffers::ShaderDataType::Float3 });
 
 	//Normals
-	if (m_normals.empty() && m_normals.size() > 2)
+	if (m_normals->empty() && m_normals->size() > 2)
 		m_normals = CalculateNormals();
 	bufferLayout.AddElementBuffer({ "Normals", Buffers::ShaderDataType::Float3 });
 
 	//Tangents
-	if (m_tangents.empty() && m_normals.size() > 2)
+	if (m_tangents->empty() && m_normals->size() > 2)
 		m_tangents = CalculateTangents();
 	bufferLayout.AddElementBuffer({ "Tangents", Buffers::ShaderDataType::Float4 });
 
 	//UVs
 	for (int i = 0; i < m_maxUVs; i++)
-		if (!m_UVs[i].empty())
+		if (!m_UVs[i]->empty())
 			bufferLayout.AddElementBuffer({ ("UV" + std::to_string(i)), Buffers::ShaderDataType::Float2 });
 
 	//Colors
-	if (!m_colors.empty())
+	if (!m_colors->empty())
 		bufferLayout.AddElementBuffer({ "Color", Buffers::ShaderDataType::Float4 });
 
 	//Create VertexBuffer
 	size_t bufferSize = bufferLayout.GetFloatStride() * m_verticesCount;
 	std::vector<float> bufferVector;
 
+	auto& vertices = *m_vertices;
+	auto& normals = *m_normals;
+	auto& tangents = *m_tangents;
+	auto& colors = *m_colors;
 	for (int i = 0; i < m_verticesCount; i++)
 	{
-		bufferVector.push_back(m_vertices[i].x);
-		bufferVector.push_back(m_vertices[i].y);
-		bufferVector.push_back(m_vertices[i].z);
+		bufferVector.push_back(vertices[i].x);
+		bufferVector.push_back(vertices[i].y);
+		bufferVector.push_back(vertices[i].z);
 
-		if (!m_normals.empty())
+		if (!normals.empty())
 		{
-			bufferVector.push_back(m_normals[i].x);
-			bufferVector.push_back(m_normals[i].y);
-			bufferVector.push_back(m_normals[i].z);
+			bufferVector.push_back(normals[i].x);
+			bufferVector.push_back(normals[i].y);
+			bufferVector.push_back(normals[i].z);
 		}
 
-		if (!m_tangents.empty())
+		if (!tangents.empty())
 		{
-			bufferVector.push_back(m_tangents[i].x);
-			bufferVector.push_back(m_tangents[i].y);
-			bufferVector.push_back(m_tangents[i].z);
-			bufferVector.push_back(m_tangents[i].w);
+			bufferVector.push_back(tangents[i].x);
+			bufferVector.push_back(tangents[i].y);
+			bufferVector.push_back(tangents[i].z);
+			bufferVector.push_back(tangents[i].w);
 		}
 
 		for (int j = 0; j < m_maxUVs; j++)
 		{
-			if (!m_UVs[j].empty())
+			if (!m_UVs[j]->empty())
 			{
-				bufferVector.push_back(m_UVs[j][i].x);
-				bufferVector.push_back(m_UVs[j][i].y);
+				bufferVector.push_back((*m_UVs[j])[i].x);
+				bufferVector.push_back((*m_UVs[j])[i].y);
 			}
 		}
 
 
-		if (!m_colors.empty())
+		if (!colors.empty())
 		{
-			bufferVector.push_back(m_colors[i].r);
-			bufferVector.push_back(m_colors[i].g);
-			bufferVector.push_back(m_colors[i].b);
-			bufferVector.push_back(m_colors[i].a);
+			bufferVector.push_back(colors[i].r);
+			bufferVector.push_back(colors[i].g);
+			bufferVector.push_back(colors[i].b);
+			bufferVector.push_back(colors[i].a);
 		}
 	}
 
 	//Pass Vertices to GPU
 	vertexBuffer->SetBufferLayout(bufferLayout);
 	vertexBuffer->SetData(static_cast<void*>(bufferVector.data()), bufferVector.size());
-	indexBuffer->SetIndeces(static_cast<void*>(m_indices.data()), m_indicesCount);
+	indexBuffer->SetIndeces(const_cast<unsigned int*>(m_indices->data()), m_indicesCount);
 
 	m_VA.reset(new GLVertexArray());
 	m_VA->SetIndexBuffer(indexBuffer);
 	m_VA->SetVertexBuffer(vertexBuffer);
 
-	m_boxVolume = Core::BoxVolume(m_vertices);
+	if (!m_hasBoxVolume)
+	{
+		m_boxVolume = Core::BoxVolume(*m_vertices);
+		m_hasBoxVolume = true;
+	}
 
 	// Submesh should always be at least 1 covering whole VertexArray
 	if (m_submeshes.size() == 0)
@@ -22,15 +22,15 @@ Material::Material(ShaderPtr p_shader)
 	m_renderType = RenderType::Opaque;
 	m_renderOrder = 0;
 
-	for (auto& unformPair : m_uniforms)
+	for (auto& unformPair : *m_uniforms)
 	{
 		auto& uniformName = unformPair.first;
 		auto& uniform = unformPair.second;
 
 		if (uniform.type == UniformType::Texture2D)
-			m_textures[uniformName] = Texture2D::CreateUnitTex(PrRenderer::Core::Color::Black);
+			m_textures.Write()[uniformName] = Texture2D::CreateUnitTex(PrRenderer::Core::Color::Black);
 		if(uniform.type == UniformType::Cubemap)
-			m_textures[uniformName] = nullptr;
+			m_textures.Write()[uniformName] = nullptr;
 	}
 
 	if (blackTexture == nullptr)
@@ -39,6 +39,7 @@ Material::Material(ShaderPtr p_shader)
 
 Material::Material(const Material& p_material)
 {
+	// Uniforms and textures are shared until one of the materials changes them
 	m_shader = p_material.m_shader;
 	m_uniforms = p_material.m_uniforms;
 
@@ -62,16 +63,15 @@ Material::Material(JSON::json& p_seralizedMat)
 
 void Material::SetColor(const Core::Color& p_color)
 {
-	auto find = m_uniforms.find(COLOR_UNIFORM);
-	if (find != m_uniforms.end())
-		find->second.value = std::make_any<PrCore::Math::vec4>(p_color);
+	if (auto uniform = WriteUniform(COLOR_UNIFORM))
+		uniform->value = std::make_any<PrCore::Math::vec4>(p_color);
 }
 
 const PrRenderer::Core::Color& Material::GetColor() const
 {
-	auto find = m_uniforms.find(COLOR_UNIFORM);
+	auto find = m_uniforms->find(COLOR_UNIFORM);
 
-	if (find != m_uniforms.end())
+	if (find != m_uniforms->end())
 	{
 		auto vec4 = std::any_cast<PrCore::Math::vec4>(find->second.value);
 		return Core::Color(vec4);
@@ -88,7 +88,7 @@ void Material::Bind()
 
 	//Bind Textures
 	int texSlot = 0;
-	for (auto& texture : m_textures)
+	for (auto& texture : *m_textures)
 	{
 		if (texture.second)
 		{
@@ -106,7 +106,7 @@ void Material::Bind()
 	}
 
 	//Bind Properties
-	for (auto& uniform : m_uniforms)
+	for (auto& uniform : *m_uniforms)
 	{
 		auto& uniformValue = uniform.second;
 		const auto& uniformName = uniform.first;
@@ -170,7 +170,7 @@ void Material::Unbind()
 	m_shader->Unbind();
 
 	unsigned int texSlot = 0;
-	for (auto& texture : m_textures)
+	for (auto& texture : *m_textures)
 	{
 		if(texture.second)
 			texture.second->Unbind(texSlot++);
@@ -180,18 +180,16 @@ void Material::Unbind()
 
 void Material::SetTexture(const std::string& p_name, TexturePtr p_texture)
 {
-	auto find = m_textures.find(p_name);
-	if (find != m_textures.end())
-	{
-		find->second = p_texture;
-	}
+	// Textures shared with the copies are detached only when the binding exists
+	if (m_textures->find(p_name) != m_textures->end())
+		m_textures.Write()[p_name] = p_texture;
 }
 
 TexturePtr Material::GetTexture(const std::string& p_name)
 {
-	auto find = m_textures.find(p_name);
+	auto find = m_textures->find(p_name);
 
-	if (find != m_textures.end())
+	if (find != m_textures->end())
 		return find->second;
 
 	PRLOG_WARN("Renderer: Material {0}, missing texture {1}", m_name, p_name);
@@ -200,23 +198,21 @@ TexturePtr Material::GetTexture(const std::string& p_name)
 
 void Material::SetTexScale(const std::string& p_name, const PrCore::Math::vec2& p_value)
 {
-	auto find = m_uniforms.find(p_name + TEXSCALE_UNIFORM);
-	if (find != m_uniforms.end())
-		find->second.value = std::make_any<PrCore::Math::vec2>(p_value);
+	if (auto uniform = WriteUniform(p_name + TEXSCALE_UNIFORM))
+		uniform->value = std::make_any<PrCore::Math::vec2>(p_value);
 }
 
 void Material::SetTexOffset(const std::string& p_name, const PrCore::Math::vec2& p_value)
 {
-	auto find = m_uniforms.find(p_name + TEXOFFSET_UNIFORM);
-	if (find != m_uniforms.end())
-		find->second.value = std::make_any<PrCore::Math::vec2>(p_value);
+	if (auto uniform = WriteUniform(p_name + TEXOFFSET_UNIFORM))
+		uniform->value = std::make_any<PrCore::Math::vec2>(p_value);
 }
 
 PrCore::Math::vec2 Material::GetTexScale(const std::string& p_name) const
 {
-	auto find = m_uniforms.find(p_name + TEXSCALE_UNIFORM);
+	auto find = m_uniforms->find(p_name + TEXSCALE_UNIFORM);
 
-	if (find != m_uniforms.end())
+	if (find != m_uniforms->end())
 		return std::any_cast<PrCore::Math::vec2>(find->second.value);
 
 	PRLOG_WARN("Renderer: Material {0}, missing uniform {1}", m_name, p_name);
@@ -225,9 +221,9 @@ PrCore::Math::vec2 Material::GetTexScale(const std::string& p_name) const
 
 PrCore::Math::vec2 Material::GetTexOffset(const std::string& p_name) const
 {
-	auto find = m_uniforms.find(p_name + TEXOFFSET_UNIFORM);
+	auto find = m_uniforms->find(p_name + TEXOFFSET_UNIFORM);
 
-	if (find != m_uniforms.end())
+	if (find != m_uniforms->end())
 		return std::any_cast<PrCore::Math::vec2>(find->second.value);
 
 	PRLOG_WARN("Renderer: Material {0}, missing uniform {1}", m_name, p_name);
@@ -236,7 +232,7 @@ PrCore::Math::vec2 Material::GetTexOffset(const std::string& p_name) const
 
 bool Material::HasProperty(const std::string& p_name) const
 {
-	return m_uniforms.find(p_name) != m_uniforms.end();
+	return m_uniforms->find(p_name) != m_uniforms->end();
 }
 
 void Material::CopyPropertiesFrom(const Material& p_material)
@@ -245,13 +241,14 @@ void Material::CopyPropertiesFrom(const Material& p_material)
 	m_renderOrder = p_material.GetRenderOrder();
 	m_textures = p_material.m_textures;
 
-	for (auto& uniformObject : p_material.m_uniforms)
+	auto& uniforms = m_uniforms.Write();
+	for (auto& uniformObject : *p_material.m_uniforms)
 	{
 		auto& uniformName = uniformObject.first;
 		auto& unform = uniformObject.second;
 
-		auto find = m_uniforms.find(uniformName);
-		if (find != m_uniforms.end() && find->second.type == unform.type)
+		auto find = uniforms.find(uniformName);
+		if (find != uniforms.end() && find->second.type == unform.type)
 			find->second.value = unform.value;
 	}
 }
@@ -279,7 +276,7 @@ bool Material::PopulateBasedOnShader(JSON::json& p_json)
 
 	m_uniforms = m_shader->GetAllUniforms();
 
-	for (auto& uniformPair : m_uniforms)
+	for (auto& uniformPair : m_uniforms.Write())
 	{
 		const auto& uniformName = uniformPair.first;
 		auto& uniform = uniformPair.second;
@@ -466,14 +463,14 @@ bool Material::PopulateBasedOnShader(JSON::json& p_json)
 						auto textureResource = PrCore::Resources::ResourceSystem::GetInstance().Load<Texture>(static_cast<std::string>(texturePath)).GetData();
 						if (textureResource != nullptr)
 						{
-							m_textures[uniformName] = textureResource;
+							m_textures.Write()[uniformName] = textureResource;
 							uniformExist = true;
 						}
 					}
 				}
 			}
 			if (!uniformExist)
-				m_textures[uniformName] = Texture2D::CreateUnitTex(PrRenderer::Core::Color::Black);
+				m_textures.Write()[uniformName] = Texture2D::CreateUnitTex(PrRenderer::Core::Color::Black);
 
 			break;
 		}
@@ -493,14 +490,14 @@ bool Material::PopulateBasedOnShader(JSON::json& p_json)
 						auto textureResource = PrCore::Resources::ResourceSystem::GetInstance().Load<Cubemap>(static_cast<std::string>(cubemapPath));
 						if (textureResource != nullptr)
 						{
-							m_textures[uniformName] = textureResource.GetData();
+							m_textures.Write()[uniformName] = textureResource.GetData();
 							uniformExist = true;
 						}
 					}
 				}
 			}
 			if (!uniformExist)
-				m_textures[uniformName] = Cubemap::CreateUnitTex(PrRenderer::Core::Color::Black);
+				m_textures.Write()[uniformName] = Cubemap::CreateUnitTex(PrRenderer::Core::Color::Black);
 
 			break;
 		}
@@ -515,7 +512,32 @@ bool Material::PopulateBasedOnShader(JSON::json& p_json)
 	return true;
 }
 
+Uniform* Material::WriteUniform(const std::string& p_name)
+{
+	// Uniforms shared with the copies are detached only when the uniform exists
+	if (m_uniforms->find(p_name) == m_uniforms->end())
+		return nullptr;
+
+	return &m_uniforms.Write().find(p_name)->second;
+}
+
 size_t Material::GetByteSize() const
 {
-	return sizeof(Material);
+	return sizeof(Material) + UniformsByteSize() + TexturesByteSize();
+}
+
+void Material::ForEachBlock(const BlockVisitor& p_visitor) const
+{
+	p_visitor(m_uniforms.GetBlock(), UniformsByteSize());
+	p_visitor(m_textures.GetBlock(), TexturesByteSize());
+}
+
+size_t Material::UniformsByteSize() const
+{
+	return m_uniforms->size() * sizeof(std::map<std::string, Uniform>::value_type);
+}
+
+size_t Material::TexturesByteSize() const
+{
+	return m_textures->size() * sizeof(std::map<std::string, TexturePtr>::value_type);
 }
@@ -3,28 +3,134 @@
 #include "Renderer/Resources/MaterialLoader.h"
 #include "Renderer/Resources/Material.h"
 
-#include "Core/File/FileSystem.h"
+#include "Core/Resources/CookedAsset.h"
 #include "Core/Utils/PathUtils.h"
 
 using namespace PrRenderer::Resources;
 using namespace PrCore::Utils;
 
+namespace {
+
+	constexpr uint32_t g_cookedMaterialType = PrCore::Resources::CookedAsset::MakeFourCC('M', 'A', 'T', 'L');
+	constexpr uint32_t g_cookedMaterialVersion = 1;
+
+	// Cooked material is the MessagePack of the material file, the material reads the same values without parsing the text
+	bool WriteCookedMaterial(const std::string& p_path, uint64_t p_sourceHash, const JSON::json& p_json)
+	{
+		return PrCore::Resources::CookedAsset::Write(p_path, g_cookedMaterialType, g_cookedMaterialVersion, p_sourceHash, JSON::json::to_msgpack(p_json));
+	}
+
+	bool ParseMaterialFile(const std::string& p_path, const std::vector<uint8_t>& p_source, JSON::json& p_json)
+	{
+		p_json = JSON::json::parse(p_source, nullptr, false);
+		if (p_json.is_discarded())
+		{
+			PRLOG_ERROR("Renderer: Cannot parse material file {0}", p_path);
+			return false;
+		}
+
+		return true;
+	}
+}
+
+static bool ReadMaterialFile(const std::string& p_path, JSON::json& p_json)
+{
+	using PrCore::Resources::CookedAsset;
+
+	std::vector<uint8_t> payload;
+	if (CookedAsset::Read(p_path, g_cookedMaterialType, g_cookedMaterialVersion, payload))
+	{
+		p_json = JSON::json::from_msgpack(payload, true, false);
+		if (!p_json.is_discarded())
+			return true;
+
+		PRLOG_WARN("Renderer: Cooked material {0} is invalid, loading the source", p_path);
+	}
+
+	std::vector<uint8_t> source;
+	uint64_t sourceHash = 0;
+	if (!CookedAsset::ReadSource(p_path, source, sourceHash) || !ParseMaterialFile(p_path, source, p_json))
+		return false;
+
+	if (CookedAsset::IsCookOnLoad())
+		WriteCookedMaterial(p_path, sourceHash, p_json);
+
+	return true;
+}
+
 PrCore::Resources::IResourceDataPtr MaterialLoader::LoadResource(const std::string& p_path)
 {
-	auto file = PrCore::File::FileSystem::GetInstance().OpenFileWrapper(p_path);
-	if (file == nullptr)
+	JSON::json json;
+	if (!ReadMaterialFile(p_path, json))
 		return nullptr;
 
-	char* data = new char[file->GetSize()];
-	file->Read(data, file->GetSize());
+	MaterialPtr mat = std::make_shared<Material>(json);
+
+	return mat;
+}
+
+std::vector<PrCore::Resources::ResourceDependency> MaterialLoader::GetDependencies(const std::string& p_path)
+{
+	using PrCore::Resources::ResourceDependency;
+
+	std::vector<ResourceDependency> dependencies;
+	JSON::json json;
+	if (!ReadMaterialFile(p_path, json))
+		return dependencies;
+
+	// Same keys and types the material loads with, see Material::PopulateBasedOnShader
+	auto shader = json.find("shader");
+	if (shader != json.end())
+		dependencies.push_back(ResourceDependency::Of<Shader>(shader.value().get<std::string>()));
+
+	auto gatherTextures = [&](const char* p_key, size_t p_resourceType) {
+		auto textures = json.find(p_key);
+		if (textures == json.end())
+			return;
+
+		for (auto& texture : textures.value().items())
+		{
+			auto texturePath = texture.value().find("texPath");
+			if (texturePath != texture.value().end())
+				dependencies.push_back({ texturePath.value().get<std::string>(), p_resourceType });
+		}
+	};
+	gatherTextures("textures", typeid(Texture).hash_code());
+	gatherTextures("cubemap", typeid(Cubemap).hash_code());
+
+	return dependencies;
+}
+
+bool MaterialLoader::CookResource(const std::string& p_path)
+{
+	using PrCore::Resources::CookedAsset;
+
+	std::vector<uint8_t> source;
+	uint64_t sourceHash = 0;
+	if (!CookedAsset::ReadSource(p_path, source, sourceHash))
+		return false;
 
-	std::vector<uint8_t> dataVector;
+	if (CookedAsset::IsUpToDate(p_path, g_cookedMaterialType, g_cookedMaterialVersion, sourceHash))
+		return true;
 
-	for (auto i = 0; i < file->GetSize(); i++)
-		dataVector.push_back(*(data + i));
-	delete[] data;
+	JSON::json json;
+	return ParseMaterialFile(p_path, source, json) && WriteCookedMaterial(p_path, sourceHash, json);
+}
+
+bool MaterialLoader::ReadCookedPayload(const std::string& p_path, std::vector<uint8_t>& p_payload)
+{
+	using PrCore::Resources::CookedAsset;
 
-	auto json = JSON::json::parse(dataVector);
+	// Sources without a cooked file are cooked for the next promotions
+	return CookedAsset::Read(p_path, g_cookedMaterialType, g_cookedMaterialVersion, p_payload) ||
+		(CookResource(p_path) && CookedAsset::Read(p_path, g_cookedMaterialType, g_cookedMaterialVersion, p_payload));
+}
+
+PrCore::Resources::IResourceDataPtr MaterialLoader::LoadCookedResource(const std::string& p_path, const std::vector<uint8_t>& p_payload)
+{
+	auto json = JSON::json::from_msgpack(p_payload, true, false);
+	if (json.is_discarded())
+		return nullptr;
 
 	MaterialPtr mat = std::make_shared<Material>(json);
 
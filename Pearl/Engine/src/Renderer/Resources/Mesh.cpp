@@ -14,15 +14,22 @@ using namespace PrRenderer::Resources;
 void Mesh::SetVertices(std::vector<PrCore::Math::vec3>&& p_vertices)
 {
 	m_vertices = std::move(p_vertices);
-	m_verticesCount = m_vertices.size();
+	m_verticesCount = m_vertices->size();
+	m_hasBoxVolume = false;
 
 	m_stateChanged = true;
 }
 
+void Mesh::SetBoxVolume(const Core::BoxVolume& p_boxVolume)
+{
+	m_boxVolume = p_boxVolume;
+	m_hasBoxVolume = true;
+}
+
 void Mesh::SetIndices(std::vector<unsigned int>&& p_indices)
 {
 	m_indices = std::move(p_indices);
-	m_indicesCount = m_indices.size();
+	m_indicesCount = m_indices->size();
 
 	m_stateChanged = true;
 }
@@ -121,21 +128,23 @@ std::vector<PrCore::Math::vec4> Mesh::CalculateTangents()
 {
 	std::vector<PrCore::Math::vec4> tangents(m_verticesCount);
 
-	if (m_vertices.empty())
+	if (m_vertices->empty())
 		return tangents;
 
-	if (m_UVs[0].empty())
+	if (m_UVs[0]->empty())
 		return tangents;
 
+	auto& indices = *m_indices;
+
 	for (int i = 0; i < m_indicesCount; i += 3)
 	{
 		auto tangentA = PrCore::Math::normalize(GenerateTangent(i, i + 1, i + 2));
 		auto tangentB = PrCore::Math::normalize(GenerateTangent(i + 1, i + 2, i));
 		auto tangentC = PrCore::Math::normalize(GenerateTangent(i + 2, i, i + 1));
 
-		tangents[m_indices[i + 0]] = tangentA;
-		tangents[m_indices[i + 1]] = tangentB;
-		tangents[m_indices[i + 2]] = tangentC;
+		tangents[indices[i + 0]] = tangentA;
+		tangents[indices[i + 1]] = tangentB;
+		tangents[indices[i + 2]] = tangentC;
 	}
 
 	return tangents;
@@ -145,14 +154,17 @@ std::vector<PrCore::Math::vec3> Mesh::CalculateNormals()
 {
 	std::vector<PrCore::Math::vec3> normals(m_verticesCount);
 
-	if (m_vertices.empty())
+	if (m_vertices->empty())
 		return normals;
 
+	auto& vertices = *m_vertices;
+	auto& indices = *m_indices;
+
 	for (int i = 0; i < m_indicesCount; i += 3)
 	{
-		auto A = m_vertices[m_indices[i + 0]];
-		auto B = m_vertices[m_indices[i + 1]];
-		auto C = m_vertices[m_indices[i + 2]];
+		auto A = vertices[indices[i + 0]];
+		auto B = vertices[indices[i + 1]];
+		auto C = vertices[indices[i + 2]];
 
 		auto AC = C - A;
 		auto AB = B - A;
@@ -167,9 +179,9 @@ std::vector<PrCore::Math::vec3> Mesh::CalculateNormals()
 		auto Bnormal = PrCore::Math::normalize(PrCore::Math::cross(BC, BA));
 		auto Cnormal = PrCore::Math::normalize(PrCore::Math::cross(CA, CB));
 
-		normals[m_indices[i + 0]] = Anormal;
-		normals[m_indices[i + 1]] = Bnormal;
-		normals[m_indices[i + 2]] = Cnormal;
+		normals[indices[i + 0]] = Anormal;
+		normals[indices[i + 1]] = Bnormal;
+		normals[indices[i + 2]] = Cnormal;
 	}
 
 	return normals;
@@ -177,13 +189,17 @@ std::vector<PrCore::Math::vec3> Mesh::CalculateNormals()
 
 PrCore::Math::vec4 Mesh::GenerateTangent(int a, int b, int c)
 {
-	auto A = m_vertices[m_indices[a]];
-	auto B = m_vertices[m_indices[b]];
-	auto C = m_vertices[m_indices[c]];
+	auto& vertices = *m_vertices;
+	auto& indices = *m_indices;
+	auto& UVs = *m_UVs[0];
+
+	auto A = vertices[indices[a]];
+	auto B = vertices[indices[b]];
+	auto C = vertices[indices[c]];
 
-	auto Auv = m_UVs[0][m_indices[a]];
-	auto Buv = m_UVs[0][m_indices[b]];
-	auto Cuv = m_UVs[0][m_indices[c]];
+	auto Auv = UVs[indices[a]];
+	auto Buv = UVs[indices[b]];
+	auto Cuv = UVs[indices[c]];
 
 	auto AC = C - A;
 	auto AB = B - A;
@@ -214,18 +230,18 @@ PrCore::Math::vec4 Mesh::GenerateTangent(int a, int b, int c)
 
 bool Mesh::ValidateBuffers()
 {
-	if (!m_colors.empty() && m_colors.size() != m_verticesCount)
+	if (!m_colors->empty() && m_colors->size() != m_verticesCount)
 		return false;
 
-	if (!m_normals.empty() && m_normals.size() != m_verticesCount)
+	if (!m_normals->empty() && m_normals->size() != m_verticesCount)
 		return false;
 
-	if (!m_tangents.empty() && m_tangents.size() != m_verticesCount)
+	if (!m_tangents->empty() && m_tangents->size() != m_verticesCount)
 		return false;
 
 	for (int i = 0; i < m_maxUVs; i++)
 	{
-		if (!m_UVs[i].empty() && m_UVs[i].size() != m_verticesCount)
+		if (!m_UVs[i]->empty() && m_UVs[i]->size() != m_verticesCount)
 			return false;
 	}
 
@@ -236,14 +252,32 @@ size_t Mesh::GetByteSize() const
 {
 	size_t size = sizeof(Mesh);
 
-	size += sizeof(unsigned int) * m_indices.size();
-	size += sizeof(PrCore::Math::vec3) * m_vertices.size();
-	size += sizeof(PrCore::Math::vec3) * m_normals.size();
-	size += sizeof(PrCore::Math::vec3) * m_tangents.size();
-	size += sizeof(PrCore::Math::vec4) * m_colors.size();
+	size += sizeof(unsigned int) * m_indices->size();
+	size += sizeof(PrCore::Math::vec3) * m_vertices->size();
+	size += sizeof(PrCore::Math::vec3) * m_normals->size();
+	size += sizeof(PrCore::Math::vec3) * m_tangents->size();
+	size += sizeof(PrCore::Math::vec4) * m_colors->size();
 
 	for (int i = 0; i < m_maxUVs; i++)
-		size += sizeof(PrCore::Math::vec2) * m_UVs[i].size();
+		size += sizeof(PrCore::Math::vec2) * m_UVs[i]->size();
 
 	return size;
 }
+
+void Mesh::ForEachBlock(const BlockVisitor& p_visitor) const
+{
+	// Sizes are counted like in GetByteSize, empty streams are not shared memory
+	auto visitStream = [&](const auto& p_stream, size_t p_elementSize) {
+		if (!p_stream->empty())
+			p_visitor(p_stream.GetBlock(), p_elementSize * p_stream->size());
+	};
+
+	visitStream(m_indices, sizeof(unsigned int));
+	visitStream(m_vertices, sizeof(PrCore::Math::vec3));
+	visitStream(m_normals, sizeof(PrCore::Math::vec3));
+	visitStream(m_tangents, sizeof(PrCore::Math::vec3));
+	visitStream(m_colors, sizeof(PrCore::Math::vec4));
+
+	for (int i = 0; i < m_maxUVs; i++)
+		visitStream(m_UVs[i], sizeof(PrCore::Math::vec2));
+}
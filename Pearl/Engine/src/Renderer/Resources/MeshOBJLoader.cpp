@@ -3,13 +3,14 @@
 #include "Renderer/Resources/MeshOBJLoader.h"
 #include "Renderer/Resources/Mesh.h"
 
-#include "Core/File/FileSystem.h"
+#include "Core/Resources/CookedAsset.h"
 #include "Core/Utils/PathUtils.h"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include"tinyObj/tiny_obj_loader.h"
 
 using namespace PrRenderer::Resources;
+using namespace PrCore::Resources;
 
 //Hash Function for map
 template <typename T, typename... Rest>
@@ -51,126 +52,271 @@ namespace std {
 	};
 }
 
-PrCore::Resources::IResourceDataPtr MeshOBJLoader::LoadResource(const std::string& p_path)
-{
-	auto file = PrCore::File::FileSystem::GetInstance().OpenFileWrapper(p_path);
-	if (file == nullptr)
-		return nullptr;
+namespace {
 
-	char* data = new char[file->GetSize()];
-	file->Read(data, file->GetSize());
-	std::string objFile = std::string(data, file->GetSize());
-	delete[] data;
+	constexpr uint32_t g_cookedMeshType = CookedAsset::MakeFourCC('M', 'E', 'S', 'H');
+	constexpr uint32_t g_cookedMeshVersion = 2;
 
-	tinyobj::ObjReader reader;
-
-	if (!reader.ParseFromString(objFile, std::string(), tinyobj::ObjReaderConfig()))
+	struct CookedSubMesh
 	{
-		PRLOG_ERROR("Renderer: Cannot open mesh file {0}", p_path);
-		return nullptr;
-	}
-
-	auto& attrib = reader.GetAttrib();
-	auto& shapes = reader.GetShapes();
-
-	std::unordered_map<Vertex, unsigned int> vertexMap;
+		uint32_t firstIndex = 0;
+		uint32_t indicesCount = 0;
+	};
 
-	std::vector<unsigned int> indices;
-	std::vector<PrCore::Math::vec3> vertices;
-	std::vector<PrCore::Math::vec3> normals;
-	std::vector<PrCore::Math::vec4> tangents;
-	std::vector<Core::Color> colors;
-	Mesh::UVArray UVs;
+	// Mesh streams decoded on a worker, the mesh and its buffers are created in FinalizeResource
+	class MeshStagingData : public IResourceStagingData {
+	public:
+		std::vector<unsigned int>            indices;
+		std::vector<PrCore::Math::vec3>      vertices;
+		std::vector<PrCore::Math::vec3>      normals;
+		std::vector<PrRenderer::Core::Color> colors;
+		std::vector<PrCore::Math::vec2>      UVs;
+		std::vector<CookedSubMesh>           submeshes;
+
+		PrCore::Math::vec3                   boundsMin{ 0.f };
+		PrCore::Math::vec3                   boundsMax{ 0.f };
+	};
 
-	for (const auto& shape : shapes)
+	bool ParseOBJ(const std::string& p_path, const std::vector<uint8_t>& p_source, MeshStagingData& p_mesh)
 	{
-		for (const auto& face : shape.mesh.num_face_vertices)
+		tinyobj::ObjReader reader;
+		if (!reader.ParseFromString(std::string(p_source.begin(), p_source.end()), std::string(), tinyobj::ObjReaderConfig()))
 		{
-			if (face != 3)
-			{
-				PRLOG_ERROR("Renderer: PearlEngine supports only triangle mesh error in mesh {0}", p_path);
-				return nullptr;
-			}
+			PRLOG_ERROR("Renderer: Cannot open mesh file {0}", p_path);
+			return false;
 		}
 
-		for (const auto& index : shape.mesh.indices)
-		{
-			Vertex vert;
+		auto& attrib = reader.GetAttrib();
+		auto& shapes = reader.GetShapes();
 
-			PrCore::Math::vec3 pos(0.f);
-			pos.x = attrib.vertices[3 * index.vertex_index + 0];
-			pos.y = attrib.vertices[3 * index.vertex_index + 1];
-			pos.z = attrib.vertices[3 * index.vertex_index + 2];
-			vert.pos = pos;
+		std::unordered_map<Vertex, unsigned int> vertexMap;
 
-			if (!attrib.texcoords.empty())
-			{
-				PrCore::Math::vec2 uvs(0.f);
-				uvs.x = attrib.texcoords[2 * index.texcoord_index + 0];
-				uvs.y = attrib.texcoords[2 * index.texcoord_index + 1];
-				vert.uv = uvs;
-			}
+		for (const auto& shape : shapes)
+		{
+			CookedSubMesh submesh;
+			submesh.firstIndex = (uint32_t)p_mesh.indices.size();
 
-			if (!attrib.normals.empty())
+			for (const auto& face : shape.mesh.num_face_vertices)
 			{
-				PrCore::Math::vec3 normal(0.f);
-				normal.x = attrib.normals[3 * index.normal_index + 0];
-				normal.y = attrib.normals[3 * index.normal_index + 1];
-				normal.z = attrib.normals[3 * index.normal_index + 2];
-				vert.normal = normal;
+				if (face != 3)
+				{
+					PRLOG_ERROR("Renderer: PearlEngine supports only triangle mesh error in mesh {0}", p_path);
+					return false;
+				}
 			}
 
-			PrRenderer::Core::Color color(PrRenderer::Core::Color::White);
-			if (!attrib.colors.empty())
+			for (const auto& index : shape.mesh.indices)
 			{
-				color.r = attrib.colors[3 * index.vertex_index + 0];
-				color.g = attrib.colors[3 * index.vertex_index + 1];
-				color.b = attrib.colors[3 * index.vertex_index + 2];
-			}
-			vert.color = color;
+				Vertex vert;
 
-			if (vertexMap.find(vert) == vertexMap.end())
-			{
-				vertices.push_back(vert.pos);
+				PrCore::Math::vec3 pos(0.f);
+				pos.x = attrib.vertices[3 * index.vertex_index + 0];
+				pos.y = attrib.vertices[3 * index.vertex_index + 1];
+				pos.z = attrib.vertices[3 * index.vertex_index + 2];
+				vert.pos = pos;
 
 				if (!attrib.texcoords.empty())
-					UVs[0].push_back(vert.uv);
+				{
+					PrCore::Math::vec2 uvs(0.f);
+					uvs.x = attrib.texcoords[2 * index.texcoord_index + 0];
+					uvs.y = attrib.texcoords[2 * index.texcoord_index + 1];
+					vert.uv = uvs;
+				}
 
 				if (!attrib.normals.empty())
-					normals.push_back(vert.normal);
-
+				{
+					PrCore::Math::vec3 normal(0.f);
+					normal.x = attrib.normals[3 * index.normal_index + 0];
+					normal.y = attrib.normals[3 * index.normal_index + 1];
+					normal.z = attrib.normals[3 * index.normal_index + 2];
+					vert.normal = normal;
+				}
+
+				PrRenderer::Core::Color color(PrRenderer::Core::Color::White);
 				if (!attrib.colors.empty())
-					colors.push_back(vert.color);
+				{
+					color.r = attrib.colors[3 * index.vertex_index + 0];
+					color.g = attrib.colors[3 * index.vertex_index + 1];
+					color.b = attrib.colors[3 * index.vertex_index + 2];
+				}
+				vert.color = color;
 
-				vertexMap[vert] = (unsigned int)vertices.size() - 1;
+				if (vertexMap.find(vert) == vertexMap.end())
+				{
+					p_mesh.vertices.push_back(vert.pos);
+
+					if (!attrib.texcoords.empty())
+						p_mesh.UVs.push_back(vert.uv);
+
+					if (!attrib.normals.empty())
+						p_mesh.normals.push_back(vert.normal);
+
+					if (!attrib.colors.empty())
+						p_mesh.colors.push_back(vert.color);
+
+					vertexMap[vert] = (unsigned int)p_mesh.vertices.size() - 1;
+				}
+
+				p_mesh.indices.push_back(vertexMap[vert]);
 			}
 
-			indices.push_back(vertexMap[vert]);
+			// Every OBJ shape is drawn as its own submesh
+			submesh.indicesCount = (uint32_t)p_mesh.indices.size() - submesh.firstIndex;
+			if (submesh.indicesCount > 0)
+				p_mesh.submeshes.push_back(submesh);
+		}
+
+		if (!p_mesh.vertices.empty())
+		{
+			p_mesh.boundsMin = p_mesh.vertices.front();
+			p_mesh.boundsMax = p_mesh.vertices.front();
+			for (auto& vertex : p_mesh.vertices)
+			{
+				p_mesh.boundsMin = PrCore::Math::min(p_mesh.boundsMin, vertex);
+				p_mesh.boundsMax = PrCore::Math::max(p_mesh.boundsMax, vertex);
+			}
 		}
+
+		return true;
 	}
 
+	// Streams are stored as the mesh takes them, the vertex buffer is interleaved by Mesh::UpdateBuffers
+	bool WriteCookedMesh(const std::string& p_path, uint64_t p_sourceHash, const MeshStagingData& p_mesh)
+	{
+		std::vector<uint8_t> payload;
+		CookedWriter writer(payload);
+		writer.Write(p_mesh.boundsMin);
+		writer.Write(p_mesh.boundsMax);
+		writer.WriteArray(p_mesh.submeshes);
+		writer.WriteArray(p_mesh.indices);
+		writer.WriteArray(p_mesh.vertices);
+		writer.WriteArray(p_mesh.normals);
+		writer.WriteArray(p_mesh.colors);
+		writer.WriteArray(p_mesh.UVs);
+
+		return CookedAsset::Write(p_path, g_cookedMeshType, g_cookedMeshVersion, p_sourceHash, payload);
+	}
+
+	bool ReadCookedMesh(const std::vector<uint8_t>& p_payload, MeshStagingData& p_mesh)
+	{
+		CookedReader reader(p_payload);
+		reader.Read(p_mesh.boundsMin);
+		reader.Read(p_mesh.boundsMax);
+		reader.ReadArray(p_mesh.submeshes);
+		reader.ReadArray(p_mesh.indices);
+		reader.ReadArray(p_mesh.vertices);
+		reader.ReadArray(p_mesh.normals);
+		reader.ReadArray(p_mesh.colors);
+		reader.ReadArray(p_mesh.UVs);
+
+		return reader.IsComplete();
+	}
+}
+
+PrCore::Resources::IResourceDataPtr MeshOBJLoader::LoadResource(const std::string& p_path)
+{
+	return FinalizeResource(LoadResourceAsync(p_path), p_path);
+}
+
+IResourceStagingDataPtr MeshOBJLoader::LoadResourceAsync(const std::string& p_path)
+{
+	auto stagingData = std::make_unique<MeshStagingData>();
+
+	std::vector<uint8_t> payload;
+	if (CookedAsset::Read(p_path, g_cookedMeshType, g_cookedMeshVersion, payload))
+	{
+		if (ReadCookedMesh(payload, *stagingData))
+			return stagingData;
+
+		PRLOG_WARN("Renderer: Cooked mesh {0} is invalid, loading the source", p_path);
+		stagingData = std::make_unique<MeshStagingData>();
+	}
+
+	std::vector<uint8_t> source;
+	uint64_t sourceHash = 0;
+	if (!CookedAsset::ReadSource(p_path, source, sourceHash) || !ParseOBJ(p_path, source, *stagingData))
+		return nullptr;
+
+	if (CookedAsset::IsCookOnLoad())
+		WriteCookedMesh(p_path, sourceHash, *stagingData);
+
+	return stagingData;
+}
+
+IResourceDataPtr MeshOBJLoader::FinalizeResource(IResourceStagingDataPtr p_stagingData, const std::string& p_path)
+{
+	if (p_stagingData == nullptr)
+		return nullptr;
+
+	auto stagingData = static_cast<MeshStagingData*>(p_stagingData.get());
+
 	MeshPtr mesh = Mesh::Create();
-	if (!indices.empty())
-		mesh->SetIndices(std::move(indices));
-	if (!vertices.empty())
-		mesh->SetVertices(std::move(vertices));
-	if(!normals.empty())
-		mesh->SetNormals(std::move(normals));
-	if (!colors.empty())
-		mesh->SetColors(std::move(colors));
-	if(!UVs[0].empty())
-		mesh->SetUVs(0, std::move(UVs[0]));
+	if (!stagingData->indices.empty())
+		mesh->SetIndices(std::move(stagingData->indices));
+	if (!stagingData->vertices.empty())
+	{
+		mesh->SetVertices(std::move(stagingData->vertices));
+		mesh->SetBoxVolume(PrRenderer::Core::BoxVolume(stagingData->boundsMin, stagingData->boundsMax));
+	}
+	if (!stagingData->normals.empty())
+		mesh->SetNormals(std::move(stagingData->normals));
+	if (!stagingData->colors.empty())
+		mesh->SetColors(std::move(stagingData->colors));
+	if (!stagingData->UVs.empty())
+		mesh->SetUVs(0, std::move(stagingData->UVs));
+
+	if (!stagingData->submeshes.empty())
+	{
+		mesh->SetSubmeshSize(stagingData->submeshes.size());
+		for (size_t i = 0; i < stagingData->submeshes.size(); i++)
+		{
+			SubMesh submesh;
+			submesh.firstIndex = stagingData->submeshes[i].firstIndex;
+			submesh.indicesCount = stagingData->submeshes[i].indicesCount;
+			mesh->SetSubmesh(i, submesh);
+		}
+	}
 
 	mesh->UpdateBuffers();
 	if (!mesh->ValidateBuffers())
 	{
-		PRLOG_ERROR("Renderer: Mesh {0} invalid", mesh->GetName());
+		PRLOG_ERROR("Renderer: Mesh {0} invalid", p_path);
 		return nullptr;
 	}
 
 	return mesh;
 }
 
+bool MeshOBJLoader::CookResource(const std::string& p_path)
+{
+	std::vector<uint8_t> source;
+	uint64_t sourceHash = 0;
+	if (!CookedAsset::ReadSource(p_path, source, sourceHash))
+		return false;
+
+	if (CookedAsset::IsUpToDate(p_path, g_cookedMeshType, g_cookedMeshVersion, sourceHash))
+		return true;
+
+	MeshStagingData stagingData;
+	return ParseOBJ(p_path, source, stagingData) && WriteCookedMesh(p_path, sourceHash, stagingData);
+}
+
+bool MeshOBJLoader::ReadCookedPayload(const std::string& p_path, std::vector<uint8_t>& p_payload)
+{
+	// Sources without a cooked file are cooked for the next promotions
+	return CookedAsset::Read(p_path, g_cookedMeshType, g_cookedMeshVersion, p_payload) ||
+		(CookResource(p_path) && CookedAsset::Read(p_path, g_cookedMeshType, g_cookedMeshVersion, p_payload));
+}
+
+IResourceStagingDataPtr MeshOBJLoader::LoadCookedResourceAsync(const std::string& p_path, const std::vector<uint8_t>& p_payload)
+{
+	auto stagingData = std::make_unique<MeshStagingData>();
+	if (!ReadCookedMesh(p_payload, *stagingData))
+		return nullptr;
+
+	return stagingData;
+}
+
 void MeshOBJLoader::UnloadResource(PrCore::Resources::IResourceDataPtr p_resourceData)
 {
 	p_resourceData.reset();
@@ -4,7 +4,7 @@
 #include "Renderer/Resources/Texture2D.h"
 #include "Renderer/OpenGL/GLUtils.h"
 
-#include "Core/File/FileSystem.h"
+#include "Core/Resources/CookedAsset.h"
 #include "Core/Utils/PathUtils.h"
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -18,75 +18,150 @@ Texture2DLoader::Texture2DLoader()
 	stbi_set_flip_vertically_on_load(true);
 }
 
-PrCore::Resources::IResourceDataPtr Texture2DLoader::LoadResource(const std::string& p_path)
-{
-	int width = 0;
-	int heigth = 0;
-	int channelsNumber = 0;
-	TextureFormat format = TextureFormat::None;
+namespace {
 
-	// Change that in future
-	auto file = PrCore::File::FileSystem::GetInstance().OpenFileWrapper(p_path);
-	if (file == nullptr)
-		return nullptr;
-
-	size_t fileSize = file->GetSize();
-	unsigned char* buffer = new unsigned char[fileSize];
-	file->Read(buffer, fileSize);
+	constexpr uint32_t g_cookedTextureType = CookedAsset::MakeFourCC('T', 'E', 'X', '2');
+	constexpr uint32_t g_cookedTextureVersion = 1;
 
-	unsigned char* data = stbi_load_from_memory(buffer, fileSize, &width, &heigth, &channelsNumber, 0);
-	
-	delete[] buffer;
-
-	if (!data)
-		return nullptr;
+	// Decoded pixels waiting for the upload
+	class Texture2DStagingData : public IResourceStagingData {
+	public:
+		int                        width = 0;
+		int                        heigth = 0;
+		int                        channels = 0;
+		TextureFormat              format = TextureFormat::None;
+		std::vector<unsigned char> pixels;
+	};
 
-	//HDR texture
-	if (PrCore::PathUtils::GetExtensionInPlace(p_path) == "hdr")
+	TextureFormat ChooseFormat(const std::string& p_path, int p_channelsNumber)
 	{
-		switch (channelsNumber)
+		//HDR texture
+		if (PrCore::PathUtils::GetExtensionInPlace(p_path) == "hdr")
 		{
-		case 3:
-			format = Resources::TextureFormat::RGB16F;
-			break;
-		case 4:
-			format = Resources::TextureFormat::RGBA16F;
-			break;
-		default:
-			PRLOG_WARN("Cannot specify texture {0} channel format", p_path);
-			break;
+			switch (p_channelsNumber)
+			{
+			case 3:
+				return Resources::TextureFormat::RGB16F;
+			case 4:
+				return Resources::TextureFormat::RGBA16F;
+			default:
+				PRLOG_WARN("Cannot specify texture {0} channel format", p_path);
+				return Resources::TextureFormat::None;
+			}
 		}
-	}
-	// Normal texture
-	else
-	{
-		switch (channelsNumber)
+
+		// Normal texture
+		switch (p_channelsNumber)
 		{
 		case 1:
-			format = Resources::TextureFormat::R8;
-			break;
+			return Resources::TextureFormat::R8;
 		case 2:
-			format = Resources::TextureFormat::RG16;
-			break;
+			return Resources::TextureFormat::RG16;
 		case 3:
-			format = Resources::TextureFormat::RGB24;
-			break;
+			return Resources::TextureFormat::RGB24;
 		case 4:
-			format = Resources::TextureFormat::RGBA32;
-			break;
+			return Resources::TextureFormat::RGBA32;
 		default:
 			PRLOG_WARN("Cannot specify texture {0} channel format", p_path);
-			break;
+			return Resources::TextureFormat::None;
 		}
 	}
 
+	// Decoded and flipped pixels of the first level, mip maps are generated on upload
+	bool WriteCookedTexture(const std::string& p_path, uint64_t p_sourceHash, const Texture2DStagingData& p_texture)
+	{
+		std::vector<uint8_t> payload;
+		CookedWriter writer(payload);
+		writer.Write(static_cast<int32_t>(p_texture.width));
+		writer.Write(static_cast<int32_t>(p_texture.heigth));
+		writer.Write(static_cast<int32_t>(p_texture.channels));
+		writer.Write(static_cast<uint32_t>(p_texture.format));
+		writer.WriteArray(p_texture.pixels);
+
+		return CookedAsset::Write(p_path, g_cookedTextureType, g_cookedTextureVersion, p_sourceHash, payload);
+	}
+
+	bool ReadCookedTexture(const std::vector<uint8_t>& p_payload, Texture2DStagingData& p_texture)
+	{
+		int32_t width = 0;
+		int32_t heigth = 0;
+		int32_t channels = 0;
+		uint32_t format = 0;
+
+		CookedReader reader(p_payload);
+		reader.Read(width);
+		reader.Read(heigth);
+		reader.Read(channels);
+		reader.Read(format);
+		reader.ReadArray(p_texture.pixels);
+		if (!reader.IsComplete() || p_texture.pixels.size() != static_cast<size_t>(width) * heigth * channels)
+			return false;
+
+		p_texture.width = width;
+		p_texture.heigth = heigth;
+		p_texture.channels = channels;
+		p_texture.format = static_cast<TextureFormat>(format);
+		return true;
+	}
+
+	bool DecodeTexture(const std::string& p_path, const std::vector<uint8_t>& p_source, Texture2DStagingData& p_texture)
+	{
+		unsigned char* data = stbi_load_from_memory(p_source.data(), p_source.size(), &p_texture.width, &p_texture.heigth, &p_texture.channels, 0);
+		if (!data)
+			return false;
+
+		p_texture.format = ChooseFormat(p_path, p_texture.channels);
+		p_texture.pixels.assign(data, data + static_cast<size_t>(p_texture.width) * p_texture.heigth * p_texture.channels);
+		stbi_image_free(data);
+
+		return true;
+	}
+}
+
+PrCore::Resources::IResourceDataPtr Texture2DLoader::LoadResource(const std::string& p_path)
+{
+	return FinalizeResource(LoadResourceAsync(p_path), p_path);
+}
+
+IResourceStagingDataPtr Texture2DLoader::LoadResourceAsync(const std::string& p_path)
+{
+	auto stagingData = std::make_unique<Texture2DStagingData>();
+
+	std::vector<uint8_t> payload;
+	if (CookedAsset::Read(p_path, g_cookedTextureType, g_cookedTextureVersion, payload))
+	{
+		if (ReadCookedTexture(payload, *stagingData))
+			return stagingData;
+
+		PRLOG_WARN("Cooked texture {0} is invalid, loading the source", p_path);
+		stagingData = std::make_unique<Texture2DStagingData>();
+	}
+
+	std::vector<uint8_t> source;
+	uint64_t sourceHash = 0;
+	if (!CookedAsset::ReadSource(p_path, source, sourceHash) || !DecodeTexture(p_path, source, *stagingData))
+		return nullptr;
+
+	if (CookedAsset::IsCookOnLoad())
+		WriteCookedTexture(p_path, sourceHash, *stagingData);
+
+	return stagingData;
+}
+
+IResourceDataPtr Texture2DLoader::FinalizeResource(IResourceStagingDataPtr p_stagingData, const std::string& p_path)
+{
+	if (p_stagingData == nullptr)
+		return nullptr;
+
+	auto stagingData = static_cast<Texture2DStagingData*>(p_stagingData.get());
+
 	// Create texture
 	auto texture = Texture2D::Create();
 
-	texture->SetFormat(format);
-	texture->SetWidth(width);
-	texture->SetHeight(heigth);
-	texture->SetData(data);
+	texture->SetFormat(stagingData->format);
+	texture->SetWidth(stagingData->width);
+	texture->SetHeight(stagingData->heigth);
+	texture->SetData(stagingData->pixels.data());
 
 	texture->SetReadable(false);
 	texture->SetMipMap(true);
@@ -94,11 +169,39 @@ PrCore::Resources::IResourceDataPtr Texture2DLoader::LoadResource(const std::str
 	texture->Apply();
 	texture->SetData(nullptr);
 
-	delete[] data;
-
 	return texture;
 }
 
+bool Texture2DLoader::CookResource(const std::string& p_path)
+{
+	std::vector<uint8_t> source;
+	uint64_t sourceHash = 0;
+	if (!CookedAsset::ReadSource(p_path, source, sourceHash))
+		return false;
+
+	if (CookedAsset::IsUpToDate(p_path, g_cookedTextureType, g_cookedTextureVersion, sourceHash))
+		return true;
+
+	Texture2DStagingData stagingData;
+	return DecodeTexture(p_path, source, stagingData) && WriteCookedTexture(p_path, sourceHash, stagingData);
+}
+
+bool Texture2DLoader::ReadCookedPayload(const std::string& p_path, std::vector<uint8_t>& p_payload)
+{
+	// Sources without a cooked file are cooked for the next promotions
+	return CookedAsset::Read(p_path, g_cookedTextureType, g_cookedTextureVersion, p_payload) ||
+		(CookResource(p_path) && CookedAsset::Read(p_path, g_cookedTextureType, g_cookedTextureVersion, p_payload));
+}
+
+IResourceStagingDataPtr Texture2DLoader::LoadCookedResourceAsync(const std::string& p_path, const std::vector<uint8_t>& p_payload)
+{
+	auto stagingData = std::make_unique<Texture2DStagingData>();
+	if (!ReadCookedTexture(p_payload, *stagingData))
+		return nullptr;
+
+	return stagingData;
+}
+
 IResourceDataPtr Texture2DLoader::LoadFromMemoryResource(const void* p_buffer, size_t p_size, int p_flags)
 {
 	int width = 0;
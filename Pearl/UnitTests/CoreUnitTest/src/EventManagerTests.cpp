@@ -0,0 +1,315 @@
+#include <CommonUnitTest/Common/common.h>
+
+#include "Core/Events/EventManager.h"
+#include "Core/Utils/Logger.h"
+
+using namespace PrCore::Events;
+
+class EventManagerTest : public ::testing::Test {
+public:
+	static void SetUpTestSuite()
+	{
+		PrCore::Utils::Logger::Init();
+		EventManager::Init();
+	}
+
+	static void TearDownTestSuite()
+	{
+		EventManager::Terminate();
+		PrCore::Utils::Logger::Terminate();
+	}
+};
+
+class TestSequenceEvent : public Event {
+public:
+	TestSequenceEvent(int p_producer, int p_sequence) :
+		m_producer(p_producer),
+		m_sequence(p_sequence)
+	{}
+
+	int m_producer;
+	int m_sequence;
+
+	DEFINE_EVENT_GUID(0x7e3a1c05);
+};
+
+class TestOtherEvent : public Event {
+public:
+	DEFINE_EVENT_GUID(0x4b0d92e1);
+};
+
+class TestSequenceListener {
+public:
+	void OnEvent(EventPtr p_event)
+	{
+		auto event = static_cast<TestSequenceEvent*>(p_event);
+		sequences[event->m_producer].push_back(event->m_sequence);
+
+		// Events queued during dispatch wait for the next update
+		if (requeue)
+		{
+			requeue = false;
+			EventManager::GetInstance().QueueEvent<TestSequenceEvent>(event->m_producer, event->m_sequence + 1);
+		}
+	}
+
+	std::map<int, std::vector<int>> sequences;
+	bool requeue = false;
+};
+
+TEST_F(EventManagerTest, TypeIndex)
+{
+	// Indices are dense and stable for the GUID
+	auto sequenceIndex = TestSequenceEvent::GetStaticTypeIndex();
+	auto otherIndex = TestOtherEvent::GetStaticTypeIndex();
+	EXPECT_NE(sequenceIndex, otherIndex);
+	EXPECT_EQ(RegisterEventType(TestSequenceEvent::s_type), sequenceIndex);
+
+	TestOtherEvent event;
+	EXPECT_EQ(event.GetTypeIndex(), otherIndex);
+}
+
+TEST_F(EventManagerTest, FireEvent)
+{
+	TestSequenceListener testListener;
+	EventListener listener;
+	listener.connect<&TestSequenceListener::OnEvent>(testListener);
+
+	TestSequenceEvent event(0, 7);
+	EXPECT_FALSE(EventManager::GetInstance().FireEvent(event));
+
+	EventManager::GetInstance().AddListener(listener, TestSequenceEvent::s_type);
+	EXPECT_FALSE(EventManager::GetInstance().AddListener(listener, TestSequenceEvent::s_type));
+
+	EXPECT_TRUE(EventManager::GetInstance().FireEvent(event));
+	EXPECT_EQ(testListener.sequences[0].size(), 1);
+	EXPECT_EQ(testListener.sequences[0][0], 7);
+
+	// Listener of other type is not called
+	TestOtherEvent otherEvent;
+	EXPECT_FALSE(EventManager::GetInstance().FireEvent(otherEvent));
+
+	EXPECT_TRUE(EventManager::GetInstance().RemoveListener(listener, TestSequenceEvent::s_type));
+	EXPECT_FALSE(EventManager::GetInstance().FireEvent(event));
+}
+
+TEST_F(EventManagerTest, QueueFromThreads)
+{
+	TestSequenceListener testListener;
+	EventListener listener;
+	listener.connect<&TestSequenceListener::OnEvent>(testListener);
+	EventManager::GetInstance().AddListener(listener, TestSequenceEvent::s_type);
+
+	// More events than a producer ring holds to go through the overflow as well
+	constexpr int producerNum = 4;
+	constexpr int eventNum = 3000;
+	std::vector<std::thread> producers;
+	for (int producer = 0; producer < producerNum; producer++)
+	{
+		producers.emplace_back([producer]() {
+			for (int i = 0; i < eventNum; i++)
+				EventManager::GetInstance().QueueEvent<TestSequenceEvent>(producer, i);
+			});
+	}
+
+	for (auto& producer : producers)
+		producer.join();
+
+	EventManager::GetInstance().Update();
+
+	EXPECT_EQ(testListener.sequences.size(), producerNum);
+	for (auto& [producer, sequence] : testListener.sequences)
+	{
+		EXPECT_EQ(sequence.size(), eventNum);
+		for (int i = 0; i < sequence.size(); i++)
+			EXPECT_EQ(sequence[i], i);
+	}
+
+	EventManager::GetInstance().RemoveListener(listener, TestSequenceEvent::s_type);
+}
+
+TEST_F(EventManagerTest, QueueDuringUpdate)
+{
+	TestSequenceListener testListener;
+	EventListener listener;
+	listener.connect<&TestSequenceListener::OnEvent>(testListener);
+	EventManager::GetInstance().AddListener(listener, TestSequenceEvent::s_type);
+
+	testListener.requeue = true;
+	EventManager::GetInstance().QueueEvent<TestSequenceEvent>(0, 0);
+
+	EventManager::GetInstance().Update();
+	EXPECT_EQ(testListener.sequences[0].size(), 1);
+
+	EventManager::GetInstance().Update();
+	EXPECT_EQ(testListener.sequences[0].size(), 2);
+	EXPECT_EQ(testListener.sequences[0][1], 1);
+
+	EventManager::GetInstance().RemoveListener(listener, TestSequenceEvent::s_type);
+}
+
+class TestPathEvent : public Event {
+public:
+	TestPathEvent(std::string_view p_path) :
+		m_path(EventQueue::CopyString(p_path))
+	{}
+
+	std::string_view m_path;
+
+	DEFINE_EVENT_GUID(0x2c5e8f13);
+};
+
+class TestPathListener {
+public:
+	void OnEvent(EventPtr p_event)
+	{
+		events.push_back(p_event);
+		paths.emplace_back(static_cast<TestPathEvent*>(p_event)->m_path);
+	}
+
+	std::vector<EventPtr>    events;
+	std::vector<std::string> paths;
+};
+
+TEST_F(EventManagerTest, QueuedEventMemory)
+{
+	TestPathListener testListener;
+	EventListener listener;
+	listener.connect<&TestPathListener::OnEvent>(testListener);
+	EventManager::GetInstance().AddListener(listener, TestPathEvent::s_type);
+
+	// Fired event keeps the string of the caller
+	std::string firedPath = "Fired";
+	TestPathEvent firedEvent(firedPath);
+	EXPECT_EQ(firedEvent.m_path.data(), firedPath.data());
+
+	// Queued event owns a copy, the source string can go away before the dispatch
+	{
+		std::string path = "Textures/Stone.png";
+		EventManager::GetInstance().QueueEvent<TestPathEvent>(path);
+		path = "Changed";
+	}
+	EventManager::GetInstance().Update();
+	ASSERT_EQ(testListener.paths.size(), 1);
+	EXPECT_EQ(testListener.paths[0], "Textures/Stone.png");
+
+	// Memory of the dispatched events is reused, the arenas alternate between the updates
+	for (int i = 0; i < 3; i++)
+	{
+		EventManager::GetInstance().QueueEvent<TestPathEvent>("Path");
+		EventManager::GetInstance().Update();
+	}
+	ASSERT_EQ(testListener.events.size(), 4);
+	EXPECT_EQ(testListener.events[0], testListener.events[2]);
+	EXPECT_EQ(testListener.events[1], testListener.events[3]);
+	EXPECT_NE(testListener.events[0], testListener.events[1]);
+
+	EventManager::GetInstance().RemoveListener(listener, TestPathEvent::s_type);
+}
+
+class TestLatestEvent : public Event {
+public:
+	TestLatestEvent(int p_value) :
+		m_value(p_value)
+	{}
+
+	int m_value;
+
+	DEFINE_EVENT_COALESCING(EventCoalescing::KeepLatest);
+	DEFINE_EVENT_GUID(0x1f6c3a27);
+};
+
+class TestDeltaEvent : public Event {
+public:
+	TestDeltaEvent(int p_delta) :
+		m_delta(p_delta)
+	{}
+
+	void Accumulate(const TestDeltaEvent& p_previous)
+	{
+		m_delta += p_previous.m_delta;
+	}
+
+	int m_delta;
+
+	DEFINE_EVENT_COALESCING(EventCoalescing::Accumulate);
+	DEFINE_EVENT_GUID(0x6a90e4d3);
+};
+
+class TestCoalescingListener {
+public:
+	void OnEvent(EventPtr p_event)
+	{
+		if (p_event->GetType() == TestLatestEvent::s_type)
+			values.push_back(static_cast<TestLatestEvent*>(p_event)->m_value);
+		else if (p_event->GetType() == TestDeltaEvent::s_type)
+			values.push_back(static_cast<TestDeltaEvent*>(p_event)->m_delta);
+		else
+			values.push_back(-1);
+	}
+
+	std::vector<int> values;
+};
+
+TEST_F(EventManagerTest, CoalesceKeepLatest)
+{
+	TestCoalescingListener testListener;
+	EventListener listener;
+	listener.connect<&TestCoalescingListener::OnEvent>(testListener);
+	EventManager::GetInstance().AddListener(listener, TestLatestEvent::s_type);
+	EventManager::GetInstance().AddListener(listener, TestOtherEvent::s_type);
+
+	// Latest value is dispatched at the position of the first coalesced event
+	EventManager::GetInstance().QueueEvent<TestOtherEvent>();
+	for (int i = 0; i < 100; i++)
+		EventManager::GetInstance().QueueEvent<TestLatestEvent>(i);
+	EventManager::GetInstance().QueueEvent<TestOtherEvent>();
+	EventManager::GetInstance().QueueEvent<TestLatestEvent>(100);
+
+	EventManager::GetInstance().Update();
+	EXPECT_EQ(testListener.values, std::vector<int>({ -1, 100, -1 }));
+
+	// Next frame starts a new event
+	EventManager::GetInstance().QueueEvent<TestLatestEvent>(5);
+	EventManager::GetInstance().Update();
+	EXPECT_EQ(testListener.values.size(), 4);
+	EXPECT_EQ(testListener.values.back(), 5);
+
+	EventManager::GetInstance().RemoveListener(listener, TestLatestEvent::s_type);
+	EventManager::GetInstance().RemoveListener(listener, TestOtherEvent::s_type);
+}
+
+TEST_F(EventManagerTest, CoalesceAccumulate)
+{
+	TestCoalescingListener testListener;
+	EventListener listener;
+	listener.connect<&TestCoalescingListener::OnEvent>(testListener);
+	EventManager::GetInstance().AddListener(listener, TestDeltaEvent::s_type);
+
+	for (int i = 1; i <= 10; i++)
+		EventManager::GetInstance().QueueEvent<TestDeltaEvent>(i);
+
+	EventManager::GetInstance().Update();
+	EXPECT_EQ(testListener.values, std::vector<int>({ 55 }));
+
+	// Delta is not lost when the producer races the consumer
+	constexpr int eventNum = 20000;
+	std::atomic<bool> done = false;
+	std::thread producer([&]() {
+		for (int i = 0; i < eventNum; i++)
+			EventManager::GetInstance().QueueEvent<TestDeltaEvent>(1);
+		done = true;
+		});
+
+	while (!done)
+		EventManager::GetInstance().Update();
+	producer.join();
+	EventManager::GetInstance().Update();
+
+	int sum = 0;
+	for (size_t i = 1; i < testListener.values.size(); i++)
+		sum += testListener.values[i];
+	EXPECT_EQ(sum, eventNum);
+
+	EventManager::GetInstance().RemoveListener(listener, TestDeltaEvent::s_type);
+}
@@ -1,9 +1,18 @@
 #include <CommonUnitTest/Common/common.h>
 
 #include "Core/File/FileSystem.h"
+#include "Core/File/FileWatcher.h"
+#include "Core/File/PackFile.h"
+#include "Core/Resources/CookedAsset.h"
+#include "Core/Resources/ResourceSystem.h"
 #include "Core/Utils/StringUtils.h"
 #include "Core/Utils/PathUtils.h"
 
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <thread>
+
 using namespace PrCore::File;
 
 const char* g_unitTestPath = "UnitTests";
@@ -349,7 +358,264 @@ TEST_F(FileSystemTest, MountPriority)
 }
 
 
-// For later when archive is supported
+TEST_F(FileSystemTest, PackFile)
+{
+	auto packPath = (std::filesystem::temp_directory_path() / "PackFileTest.prpak").string();
+
+	std::string text;
+	for (int i = 0; i < 100; i++)
+		text += "Compressible Text ";
+	std::vector<uint8_t> textData{ text.begin(), text.end() };
+	std::vector<uint8_t> shortData{ 'a', 'b', 'c' };
+
+	PackWriter packWriter;
+	packWriter.AddFile("textures/text.txt", textData);
+	packWriter.AddFile("textures/short.txt", shortData);
+	packWriter.AddFile("/Materials\\Empty.mat", {});
+	packWriter.AddFile("textures/short.txt", shortData, false);
+	EXPECT_EQ(packWriter.GetFileCount(), 3);
+	ASSERT_TRUE(packWriter.Write(packPath));
+
+	auto packFile = PackFile::Open(packPath);
+	ASSERT_NE(packFile, nullptr);
+	EXPECT_EQ(packFile->GetEntryCount(), 3);
+
+	// Paths are found like the engine sanitizes them
+	auto textEntry = packFile->Find("textures/text.txt");
+	ASSERT_NE(textEntry, nullptr);
+	EXPECT_EQ(packFile->Find("/Textures\\Text.txt"), textEntry);
+	EXPECT_EQ(packFile->GetEntryPath(*textEntry), "textures/text.txt");
+	EXPECT_EQ(packFile->Find("textures/missing.txt"), nullptr);
+	EXPECT_EQ(packFile->Find("textures"), nullptr);
+
+	std::vector<uint8_t> data;
+	EXPECT_TRUE(textEntry->flags & PackEntryCompressed);
+	EXPECT_LT(textEntry->storedSize, textEntry->size);
+	EXPECT_TRUE(packFile->Read(*textEntry, data));
+	EXPECT_EQ(data, textData);
+
+	// Stored entries are read in place from the mapping
+	auto shortEntry = packFile->Find("textures/short.txt");
+	ASSERT_NE(shortEntry, nullptr);
+	EXPECT_FALSE(shortEntry->flags & PackEntryCompressed);
+	EXPECT_EQ(shortEntry->dataOffset % 64, 0);
+	EXPECT_EQ(std::memcmp(packFile->GetData(*shortEntry), shortData.data(), shortData.size()), 0);
+
+	auto emptyEntry = packFile->Find("materials/empty.mat");
+	ASSERT_NE(emptyEntry, nullptr);
+	EXPECT_TRUE(packFile->Read(*emptyEntry, data));
+	EXPECT_TRUE(data.empty());
+
+	EXPECT_TRUE(packFile->IsDirectory(""));
+	EXPECT_TRUE(packFile->IsDirectory("textures"));
+	EXPECT_FALSE(packFile->IsDirectory("textures/text.txt"));
+	EXPECT_FALSE(packFile->IsDirectory("text"));
+	EXPECT_TRUE(packFile->IsDirectory("/MATERIALS/"));
+	EXPECT_EQ(packFile->EnumerateDirectory(""), (std::vector<std::string>{ "Materials", "textures" }));
+	EXPECT_EQ(packFile->EnumerateDirectory("textures"), (std::vector<std::string>{ "short.txt", "text.txt" }));
+	EXPECT_EQ(packFile->EnumerateDirectory("Textures/"), (std::vector<std::string>{ "short.txt", "text.txt" }));
+	EXPECT_TRUE(packFile->EnumerateDirectory("textures/text.txt").empty());
+	EXPECT_TRUE(packFile->EnumerateDirectory("missing").empty());
+	packFile.reset();
+
+	// Truncated pack fails to open
+	std::vector<uint8_t> packData;
+	{
+		std::ifstream packStream(packPath, std::ios::binary);
+		packData.assign(std::istreambuf_iterator<char>(packStream), std::istreambuf_iterator<char>());
+	}
+	EXPECT_NE(PackFile::OpenFromMemory(packData), nullptr);
+	packData.resize(packData.size() - 1);
+	EXPECT_EQ(PackFile::OpenFromMemory(packData), nullptr);
+
+	std::filesystem::remove(packPath);
+}
+
 TEST_F(FileSystemTest, OpenArchive)
 {
-}
\ No newline at end of file
+	auto fileSystem = FileSystem::GetInstancePtr();
+	auto packPath = PrCore::PathUtils::MakePath(fileSystem->GetExecutablePath(), "OpenArchiveTest.prpak");
+
+	const char* packedText = "Packed Text";
+	const char* looseText = "Loose Text";
+
+	PackWriter packWriter;
+	packWriter.AddFile("packed/file.txt", { packedText, packedText + strlen(packedText) });
+	packWriter.AddFile("packed/override.txt", { packedText, packedText + strlen(packedText) });
+	ASSERT_TRUE(packWriter.Write(packPath));
+
+	fileSystem->CreateDir("packed");
+	FileHandle handle = fileSystem->FileOpen("packed/override.txt", OpenMode::Write);
+	fileSystem->FileWrite(handle, looseText, strlen(looseText));
+	fileSystem->FileClose(handle);
+
+	auto readFile = [&](const char* p_path) {
+		auto file = fileSystem->OpenFileWrapper(p_path);
+		if (file == nullptr)
+			return std::string{};
+
+		std::string text(file->GetSize(), '\0');
+		file->Read(text.data(), text.size());
+		return text;
+	};
+
+	// Pack mounted after the directory, loose files override the packed ones
+	fileSystem->OpenArchive(packPath);
+	EXPECT_TRUE(fileSystem->IsFile("packed/file.txt"));
+	EXPECT_EQ(fileSystem->GetStat("packed/file.txt").fileSize, static_cast<int>(strlen(packedText)));
+	EXPECT_EQ(readFile("packed/file.txt"), packedText);
+	EXPECT_EQ(readFile("packed/override.txt"), looseText);
+
+	auto files = fileSystem->EnumerateFiles("packed");
+	EXPECT_EQ(std::set<std::string>(files.begin(), files.end()), (std::set<std::string>{ "file.txt", "override.txt" }));
+	fileSystem->CloseArchive(packPath);
+
+	// Pack mounted with the highest priority overrides the directory
+	fileSystem->OpenArchive(packPath, "/", true);
+	EXPECT_EQ(readFile("packed/override.txt"), packedText);
+	fileSystem->CloseArchive(packPath);
+
+	EXPECT_FALSE(fileSystem->FileExist("packed/file.txt"));
+
+	fileSystem->FileDelete("packed/override.txt");
+	fileSystem->DeleteDir("packed");
+	std::filesystem::remove(packPath);
+}
+
+TEST_F(FileSystemTest, CookedAsset)
+{
+	using namespace PrCore::Resources;
+
+	PrCore::Resources::ResourceSystem::Init();
+	auto fileSystem = FileSystem::GetInstancePtr();
+
+	auto writeSource = [&](const char* p_text) {
+		FileHandle handle = fileSystem->FileOpen("cookedsource.txt", OpenMode::Write);
+		fileSystem->FileWrite(handle, p_text, strlen(p_text));
+		fileSystem->FileClose(handle);
+	};
+	writeSource("Source");
+
+	constexpr uint32_t assetType = CookedAsset::MakeFourCC('T', 'E', 'S', 'T');
+	std::vector<uint8_t> source;
+	uint64_t sourceHash = 0;
+	ASSERT_TRUE(CookedAsset::ReadSource("cookedsource.txt", source, sourceHash));
+	EXPECT_EQ(source.size(), 6);
+
+	std::vector<uint8_t> payload;
+	EXPECT_FALSE(CookedAsset::Read("cookedsource.txt", assetType, 1, payload));
+
+	std::vector<uint8_t> cookedPayload;
+	CookedWriter writer(cookedPayload);
+	writer.Write(42);
+	writer.WriteArray(std::vector<float>{ 1.0f, 2.0f, 3.0f });
+	ASSERT_TRUE(CookedAsset::Write("cookedsource.txt", assetType, 1, sourceHash, cookedPayload));
+	EXPECT_TRUE(fileSystem->FileExist(CookedAsset::GetCookedPath("cookedsource.txt")));
+	EXPECT_TRUE(CookedAsset::IsCookedPath(CookedAsset::GetCookedPath("CookedSource.txt")));
+	EXPECT_FALSE(CookedAsset::IsCookedPath("cookedsource.txt"));
+	EXPECT_TRUE(CookedAsset::IsUpToDate("cookedsource.txt", assetType, 1, sourceHash));
+
+	ASSERT_TRUE(CookedAsset::Read("cookedsource.txt", assetType, 1, payload));
+	EXPECT_EQ(payload, cookedPayload);
+
+	// Next run trusts the recorded hash while the source keeps its size and modification time
+	auto& assetRegistry = PrCore::Resources::ResourceSystem::GetInstance().GetAssetRegistry();
+	nlohmann::json serialized;
+	assetRegistry.Serialize(serialized);
+	auto reopenRegistry = [&](uint64_t p_contentHash, int64_t p_fileSize) {
+		auto reopened = serialized;
+		for (auto& asset : reopened["assets"])
+		{
+			if (asset["path"] != "cookedsource.txt")
+				continue;
+			asset["contentHash"] = p_contentHash;
+			asset["fileSize"] = p_fileSize;
+		}
+		assetRegistry.Deserialize(reopened);
+	};
+
+	reopenRegistry(sourceHash, source.size());
+	EXPECT_TRUE(CookedAsset::Read("cookedsource.txt", assetType, 1, payload));
+
+	// Stale hash with a matching stamp is not hashed again
+	reopenRegistry(sourceHash + 1, source.size());
+	EXPECT_FALSE(CookedAsset::Read("cookedsource.txt", assetType, 1, payload));
+
+	// Changed stamp hashes the source
+	reopenRegistry(sourceHash + 1, source.size() + 1);
+	EXPECT_TRUE(CookedAsset::Read("cookedsource.txt", assetType, 1, payload));
+	EXPECT_EQ(payload, cookedPayload);
+
+	int value = 0;
+	std::vector<float> values;
+	CookedReader reader(payload);
+	EXPECT_TRUE(reader.Read(value));
+	EXPECT_TRUE(reader.ReadArray(values));
+	EXPECT_TRUE(reader.IsComplete());
+	EXPECT_EQ(value, 42);
+	EXPECT_EQ(values, (std::vector<float>{ 1.0f, 2.0f, 3.0f }));
+
+	// Truncated payload fails every read after the end
+	payload.pop_back();
+	CookedReader truncatedReader(payload);
+	EXPECT_TRUE(truncatedReader.Read(value));
+	EXPECT_FALSE(truncatedReader.ReadArray(values));
+	EXPECT_FALSE(truncatedReader.IsComplete());
+
+	// Other format and changed source are cooked again
+	EXPECT_FALSE(CookedAsset::Read("cookedsource.txt", assetType, 2, payload));
+	EXPECT_FALSE(CookedAsset::Read("cookedsource.txt", CookedAsset::MakeFourCC('M', 'E', 'S', 'H'), 1, payload));
+
+	writeSource("Changed");
+	EXPECT_TRUE(PrCore::Resources::ResourceSystem::GetInstance().GetAssetRegistry().UpdateFromFile("cookedsource.txt"));
+	EXPECT_FALSE(CookedAsset::Read("cookedsource.txt", assetType, 1, payload));
+	ASSERT_TRUE(CookedAsset::ReadSource("cookedsource.txt", source, sourceHash));
+	EXPECT_FALSE(CookedAsset::IsUpToDate("cookedsource.txt", assetType, 1, sourceHash));
+
+	fileSystem->FileDelete(CookedAsset::GetCookedPath("cookedsource.txt"));
+	fileSystem->DeleteDir("cooked");
+	fileSystem->FileDelete("cookedsource.txt");
+
+	PrCore::Resources::ResourceSystem::Terminate();
+}
+
+TEST(FileWatcherTest, WrittenFiles)
+{
+	PrCore::Utils::Logger::Init();
+
+	// Native notifications and the polling fallback report the same paths
+	for (bool forcePolling : { false, true })
+	{
+		auto watchedDir = std::filesystem::temp_directory_path() / "PearlFileWatcher";
+		std::filesystem::remove_all(watchedDir);
+		std::filesystem::create_directories(watchedDir);
+		std::ofstream(watchedDir / "old.txt") << "Old";
+
+		FileWatcher fileWatcher(forcePolling);
+		fileWatcher.SetPollInterval(std::chrono::milliseconds(0));
+		fileWatcher.Watch(watchedDir.string(), "/Assets");
+		EXPECT_TRUE(fileWatcher.PollChanges().empty());
+
+		std::ofstream(watchedDir / "written.txt") << "Test Text";
+		std::filesystem::create_directories(watchedDir / "SubFolder");
+		std::ofstream(watchedDir / "SubFolder" / "nested.txt") << "Test Text";
+
+		std::set<std::string> changes;
+		for (int i = 0; i < 100 && changes.size() < 2; i++)
+		{
+			for (auto& change : fileWatcher.PollChanges())
+				changes.insert(change.path);
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		EXPECT_EQ(changes, (std::set<std::string>{ "Assets/SubFolder/nested.txt", "Assets/written.txt" }));
+
+		fileWatcher.Unwatch(watchedDir.string());
+		std::ofstream(watchedDir / "written.txt") << "Unwatched";
+		EXPECT_TRUE(fileWatcher.PollChanges().empty());
+
+		std::filesystem::remove_all(watchedDir);
+	}
+
+	PrCore::Utils::Logger::Terminate();
+}
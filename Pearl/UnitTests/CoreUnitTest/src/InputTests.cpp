@@ -0,0 +1,71 @@
+#include <CommonUnitTest/Common/common.h>
+
+#include "Core/Input/InputStateTable.h"
+#include "Core/Input/PrKey.h"
+
+using namespace PrCore::Input;
+
+TEST(InputTest, StateTableEdges)
+{
+	InputStateTable<512> table;
+	auto key = table.ToIndex((int)PrKey::A);
+
+	table.Press(key);
+	EXPECT_TRUE(table.IsPressed(key));
+	EXPECT_TRUE(table.IsDown(key));
+	EXPECT_FALSE(table.IsReleased(key));
+	EXPECT_TRUE(table.IsAnyPressed());
+
+	// Held key has no edge in the next frame
+	table.NewFrame();
+	EXPECT_FALSE(table.IsPressed(key));
+	EXPECT_TRUE(table.IsDown(key));
+	EXPECT_FALSE(table.IsAnyPressed());
+	EXPECT_TRUE(table.IsAnyDown());
+
+	table.NewFrame();
+	table.Release(key);
+	EXPECT_TRUE(table.IsReleased(key));
+	EXPECT_FALSE(table.IsDown(key));
+
+	table.NewFrame();
+	EXPECT_FALSE(table.IsReleased(key));
+	EXPECT_FALSE(table.IsAnyDown());
+}
+
+TEST(InputTest, StateTableTap)
+{
+	InputStateTable<512> table;
+	auto key = table.ToIndex((int)PrKey::SPACE);
+
+	// Press and release within one frame is seen as a press and a release in the next frame
+	table.Press(key);
+	table.Release(key);
+	EXPECT_TRUE(table.IsPressed(key));
+
+	table.NewFrame();
+	EXPECT_TRUE(table.IsReleased(key));
+	EXPECT_FALSE(table.IsDown(key));
+
+	table.NewFrame();
+	EXPECT_FALSE(table.IsReleased(key));
+}
+
+TEST(InputTest, StateTableUnknownKey)
+{
+	InputStateTable<512> table;
+
+	// Out of range keys are rejected instead of aliasing a real key
+	auto unknown = table.ToIndex((int)PrKey::UNKNOWN);
+	EXPECT_EQ(unknown, InputStateTable<512>::InvalidIndex);
+	EXPECT_EQ(table.ToIndex(512), InputStateTable<512>::InvalidIndex);
+
+	table.Press(unknown);
+	EXPECT_FALSE(table.IsDown(unknown));
+	EXPECT_FALSE(table.IsPressed(unknown));
+	EXPECT_FALSE(table.IsDown(table.ToIndex(511)));
+	EXPECT_FALSE(table.IsAnyDown());
+
+	table.Release(unknown);
+	EXPECT_FALSE(table.IsReleased(unknown));
+}
@@ -2,11 +2,16 @@
 
 #include "Core/Threading/ThreadSystem.h"
 #include "Core/Threading/JobSystem.h"
+#include "Core/Threading/Task.h"
 #include "Core/Utils/Logger.h"
 #include "Core/Utils/StringUtils.h"
 
 #include <future>
 
+#ifndef _WIN32
+	#include <sched.h>
+#endif
+
 using namespace PrCore::Threading;
 
 class JobSystemTest : public ::testing::Test {
@@ -175,6 +180,386 @@ TEST_F(JobSystemTest, JobStealing)
 	EXPECT_EQ(value, 400);
 }
 
+TEST_F(JobSystemTest, JobDependencies)
+{
+	auto jobPtr = JobSystem::GetInstancePtr();
+
+	std::atomic<int> transformed = 0;
+	std::atomic<int> culled = 0;
+	std::atomic<bool> orderCorrect = true;
+
+	auto transformLambda = [&]() {
+		using namespace std::chrono_literals;
+		std::this_thread::sleep_for(10ms);
+		transformed++;
+	};
+
+	// Culling runs only when the all transforms are done
+	BatchJobState transformBatch;
+	for (int i = 0; i < 16; i++)
+		jobPtr->Schedule(transformBatch, "Transform", transformLambda);
+	transformBatch.Close();
+
+	auto cullState = jobPtr->ScheduleAfter("Culling", { transformBatch.GetState() }, [&]() {
+		if (transformed.load() != 16)
+			orderCorrect = false;
+		culled++;
+		});
+
+	// Continuation of the continuation
+	auto sortState = jobPtr->ScheduleAfter("Sort", { cullState }, [&]() {
+		if (culled.load() != 1)
+			orderCorrect = false;
+		});
+
+	EXPECT_FALSE(sortState->IsDone());
+	sortState->Wait();
+	EXPECT_TRUE(cullState->IsDone());
+	EXPECT_TRUE(orderCorrect);
+
+	// Dependency already done runs the job straight away
+	auto lateState = jobPtr->ScheduleAfter("Late", { sortState }, [&]() {
+		culled++;
+		});
+	lateState->Wait();
+	EXPECT_EQ(culled, 2);
+
+	// No dependencies
+	auto freeState = jobPtr->ScheduleAfter("Free", {}, [&]() {
+		culled++;
+		});
+	freeState->Wait();
+	EXPECT_EQ(culled, 3);
+}
+
+TEST_F(JobSystemTest, NestedSchedule)
+{
+	auto jobPtr = JobSystem::GetInstancePtr();
+
+	std::atomic<int> value = 0;
+	std::mutex stateLock;
+	std::vector<JobStatePtr> nestedStates;
+
+	BatchJobState batchState;
+	for (int i = 0; i < 16; i++)
+	{
+		batchState += jobPtr->Schedule("Parent", [&]() {
+			for (int j = 0; j < 8; j++)
+			{
+				auto state = jobPtr->Schedule("Child", [&]() {
+					value++;
+					});
+
+				std::lock_guard lock{ stateLock };
+				nestedStates.push_back(std::move(state));
+			}
+			});
+	}
+
+	batchState.Wait();
+	for (auto& state : nestedStates)
+		state->Wait();
+
+	EXPECT_EQ(value, 128);
+}
+
+TEST_F(JobSystemTest, BatchJobState)
+{
+	auto jobPtr = JobSystem::GetInstancePtr();
+
+	// Empty batch is done
+	BatchJobState emptyBatch;
+	EXPECT_TRUE(emptyBatch.IsDone());
+	emptyBatch.Wait();
+
+	std::atomic<int> value = 0;
+	auto lambda = [&]() {
+		using namespace std::chrono_literals;
+		std::this_thread::sleep_for(5ms);
+		value++;
+	};
+
+	BatchJobState batchState;
+	for (int i = 0; i < 32; i++)
+		jobPtr->Schedule(batchState, "BatchLambda", lambda);
+
+	for (int i = 0; i < 32; i++)
+		batchState += jobPtr->Schedule("AppendedLambda", lambda);
+
+	EXPECT_FALSE(batchState.IsDone());
+	batchState.Wait();
+	EXPECT_TRUE(batchState.IsDone());
+	EXPECT_EQ(value, 64);
+
+	// Job finishing before the next one is scheduled does not release the jobs after the batch
+	BatchJobState openBatch;
+	std::atomic<int> valueAfter = 0;
+	auto afterState = jobPtr->ScheduleAfter("After", { openBatch.GetState() }, [&]() {
+		valueAfter = value.load();
+		});
+
+	jobPtr->Schedule(openBatch, "First", [&]() {
+		value++;
+		});
+	while (!openBatch.IsDone())
+		std::this_thread::yield();
+	EXPECT_FALSE(afterState->IsDone());
+
+	jobPtr->Schedule(openBatch, "Second", lambda);
+	openBatch.Close();
+	afterState->Wait();
+	EXPECT_EQ(valueAfter, 66);
+}
+
+TEST_F(JobSystemTest, NestedWait)
+{
+	auto jobPtr = JobSystem::GetInstancePtr();
+
+	// Every worker waits on its own children, helping waits have to run them instead of parking
+	std::atomic<int> value = 0;
+	BatchJobState batchState;
+	for (int i = 0; i < 32; i++)
+	{
+		jobPtr->Schedule(batchState, "Parent", [&]() {
+			BatchJobState childState;
+			for (int j = 0; j < 8; j++)
+			{
+				jobPtr->Schedule(childState, "Child", [&]() {
+					value++;
+					});
+			}
+			childState.Wait();
+			});
+	}
+
+	batchState.Wait();
+	EXPECT_EQ(value, 256);
+}
+
+TEST_F(JobSystemTest, JobPriorities)
+{
+	// Single worker makes the execution order deterministic
+	PrCore::Threading::JobSystem::Terminate();
+	PrCore::Threading::JobSystem::Init(1, 1);
+
+	auto jobPtr = JobSystem::GetInstancePtr();
+	jobPtr->PauseWorkers(true);
+
+	std::mutex orderLock;
+	std::vector<JobPriority> order;
+	auto lambda = [&](JobPriority p_priority) {
+		std::lock_guard lock{ orderLock };
+		order.push_back(p_priority);
+	};
+
+	jobPtr->Schedule(JobPriority::Background, "Background", lambda, JobPriority::Background);
+	jobPtr->Schedule(JobPriority::Normal, "Normal", lambda, JobPriority::Normal);
+	jobPtr->Schedule(JobPriority::Critical, "Critical", lambda, JobPriority::Critical);
+	jobPtr->Schedule(JobPriority::Background, "Background", lambda, JobPriority::Background);
+	jobPtr->Schedule(JobPriority::Critical, "Critical", lambda, JobPriority::Critical);
+
+	jobPtr->PauseWorkers(false);
+	jobPtr->WaitAll();
+
+	std::vector<JobPriority> expectedOrder = {
+		JobPriority::Critical, JobPriority::Critical,
+		JobPriority::Normal,
+		JobPriority::Background, JobPriority::Background };
+	EXPECT_EQ(order, expectedOrder);
+
+	PrCore::Threading::JobSystem::Terminate();
+	PrCore::Threading::JobSystem::Init(8);
+}
+
+TEST_F(JobSystemTest, BackgroundWorkerLimit)
+{
+	PrCore::Threading::JobSystem::Terminate();
+	PrCore::Threading::JobSystem::Init(4, 2);
+
+	auto jobPtr = JobSystem::GetInstancePtr();
+	EXPECT_EQ(jobPtr->GetBackgroundWorkerNum(), 2);
+
+	std::atomic<int> runningJobs = 0;
+	std::atomic<int> maxRunningJobs = 0;
+	BatchJobState backgroundBatch;
+	for (int i = 0; i < 16; i++)
+	{
+		jobPtr->Schedule(JobPriority::Background, backgroundBatch, "Background", [&]() {
+			int running = ++runningJobs;
+			int maxRunning = maxRunningJobs.load();
+			while (running > maxRunning && !maxRunningJobs.compare_exchange_weak(maxRunning, running));
+
+			using namespace std::chrono_literals;
+			std::this_thread::sleep_for(10ms);
+			runningJobs--;
+			});
+	}
+
+	// Frame work still gets through while the background lanes are busy
+	BatchJobState criticalBatch;
+	std::atomic<int> value = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		jobPtr->Schedule(JobPriority::Critical, criticalBatch, "Critical", [&]() {
+			value++;
+			});
+	}
+
+	criticalBatch.Wait();
+	EXPECT_EQ(value, 16);
+	EXPECT_FALSE(backgroundBatch.IsDone());
+
+	backgroundBatch.Wait();
+	EXPECT_LE(maxRunningJobs, 2);
+
+	PrCore::Threading::JobSystem::Terminate();
+	PrCore::Threading::JobSystem::Init(8);
+}
+
+TEST_F(JobSystemTest, WaitAllBackgroundJobs)
+{
+	auto jobPtr = JobSystem::GetInstancePtr();
+	EXPECT_EQ(jobPtr->GetBackgroundWorkerNum(), 1);
+
+	// More jobs than background slots, most of them are still queued when the workers go idle
+	std::atomic<int> value = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		jobPtr->Schedule(JobPriority::Background, "Background", [&]() {
+			using namespace std::chrono_literals;
+			std::this_thread::sleep_for(10ms);
+			value++;
+			});
+	}
+
+	jobPtr->WaitAll();
+	EXPECT_EQ(value, 8);
+}
+
+Task<int> SquareTask(int p_value)
+{
+	co_return p_value * p_value;
+}
+
+Task<int> SumOfSquaresTask(int p_count)
+{
+	auto jobPtr = JobSystem::GetInstancePtr();
+
+	// Await the job without blocking the worker
+	std::atomic<int> jobValue = 0;
+	co_await jobPtr->Schedule("Job", [&]() {
+		jobValue = 1;
+		});
+
+	// Await the whole batch
+	BatchJobState batch;
+	for (int i = 0; i < 4; i++)
+	{
+		jobPtr->Schedule(batch, "Batch", [&]() {
+			jobValue++;
+			});
+	}
+	co_await batch;
+
+	int sum = 0;
+	for (int i = 1; i <= p_count; i++)
+		sum += co_await SquareTask(i);
+
+	co_return sum + jobValue - 5;
+}
+
+TEST_F(JobSystemTest, CoroutineTask)
+{
+	auto task = SumOfSquaresTask(4);
+	EXPECT_EQ(task.GetResult(), 1 + 4 + 9 + 16);
+	EXPECT_TRUE(task.IsDone());
+
+	// Task state works as a job dependency
+	auto squareTask = SquareTask(3);
+	std::atomic<int> value = 0;
+	auto state = JobSystem::GetInstance().ScheduleAfter("After", { squareTask.GetState() }, [&]() {
+		value = squareTask.GetResult();
+		});
+	state->Wait();
+	EXPECT_EQ(value, 9);
+}
+
+Task<std::string> AwaitCompletionTask(Task<std::string> p_completionTask, std::atomic<bool>& p_resumed)
+{
+	co_await ResumeOn(JobPriority::Background);
+
+	auto result = co_await p_completionTask;
+	p_resumed = true;
+	co_return result + "_done";
+}
+
+TEST_F(JobSystemTest, TaskCompletion)
+{
+	TaskCompletion<std::string> completion;
+	std::atomic<bool> resumed = false;
+	auto task = AwaitCompletionTask(completion.GetTask(), resumed);
+
+	using namespace std::chrono_literals;
+	std::this_thread::sleep_for(20ms);
+	EXPECT_FALSE(resumed);
+	EXPECT_FALSE(task.IsDone());
+
+	// Completion comes from a thread outside of the job system
+	std::thread ioThread([&]() {
+		completion.SetResult("io");
+		});
+	ioThread.join();
+
+	EXPECT_EQ(task.GetResult(), "io_done");
+	EXPECT_TRUE(resumed);
+}
+
+TEST_F(JobSystemTest, TopologyDefaults)
+{
+	PrCore::Threading::JobSystem::Terminate();
+	PrCore::Threading::JobSystem::Init(JobSystemSettings{});
+
+	auto jobPtr = JobSystem::GetInstancePtr();
+	auto& topology = jobPtr->GetTopology();
+	EXPECT_GE(topology.GetLogicalProcessorNum(), topology.GetPhysicalCoreNum());
+	EXPECT_GE(topology.GetPhysicalCoreNum(), topology.GetCacheDomainNum());
+	EXPECT_GE(topology.GetNumaNodeNum(), 1);
+
+	// One worker per physical core, one core stays reserved if there is more than one
+	auto coreOrder = topology.GetCoreOrder();
+	EXPECT_EQ(coreOrder.size(), topology.GetPhysicalCoreNum());
+	EXPECT_EQ(jobPtr->GetWorkerNum(), std::max<size_t>(1, coreOrder.size() - 1));
+	EXPECT_GE(jobPtr->GetBackgroundWorkerNum(), 1);
+
+	for (size_t i = 1; i < coreOrder.size(); i++)
+		EXPECT_LE(coreOrder[i - 1].numaNode, coreOrder[i].numaNode);
+
+#ifndef _WIN32
+	// Processors outside of the process affinity are never used
+	cpu_set_t allowedSet;
+	CPU_ZERO(&allowedSet);
+	ASSERT_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &allowedSet), 0);
+	EXPECT_LE(topology.GetLogicalProcessorNum(), CPU_COUNT(&allowedSet));
+	for (auto& processor : topology.GetLogicalProcessors())
+		EXPECT_TRUE(CPU_ISSET(processor.id, &allowedSet));
+#endif
+
+	BatchJobState batch;
+	std::atomic<int> value = 0;
+	for (int i = 0; i < 64; i++)
+	{
+		jobPtr->Schedule(batch, "lambda", [&]() {
+			value++;
+			});
+	}
+
+	batch.Wait();
+	EXPECT_EQ(value, 64);
+
+	PrCore::Threading::JobSystem::Terminate();
+	PrCore::Threading::JobSystem::Init(8);
+}
+
 TEST_F(JobSystemTest, TerminatePaused)
 {
 	auto jobPtr = JobSystem::GetInstancePtr();
@@ -0,0 +1,128 @@
+#include <CommonUnitTest/Common/common.h>
+
+#include "Core/Memory/LinearAllocator.h"
+#include "Core/Memory/FrameAllocator.h"
+#include "Core/Utils/Logger.h"
+
+using namespace PrCore::Memory;
+
+class MemoryTest : public ::testing::Test {
+public:
+	static void SetUpTestSuite()
+	{
+		PrCore::Utils::Logger::Init();
+	}
+
+	static void TearDownTestSuite()
+	{
+		PrCore::Utils::Logger::Terminate();
+	}
+};
+
+TEST_F(MemoryTest, LinearAllocate)
+{
+	LinearAllocator allocator(1024);
+
+	auto first = static_cast<uint8_t*>(allocator.Allocate(10, 1));
+	auto second = allocator.Allocate(sizeof(double), alignof(double));
+	auto third = allocator.Allocate(64, 64);
+
+	EXPECT_TRUE(allocator.Owns(first));
+	EXPECT_TRUE(allocator.Owns(second));
+	EXPECT_TRUE(allocator.Owns(third));
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % alignof(double), 0);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(third) % 64, 0);
+	EXPECT_GE(allocator.GetUsedSize(), 10 + sizeof(double) + 64);
+
+	// Memory is reused after reset
+	allocator.Reset();
+	EXPECT_EQ(allocator.GetUsedSize(), 0);
+	EXPECT_EQ(allocator.Allocate(10, 1), first);
+}
+
+TEST_F(MemoryTest, LinearOverflow)
+{
+	LinearAllocator allocator(64);
+
+	// Allocations that do not fit go to the heap and the capacity grows on reset
+	std::vector<void*> ptrs;
+	for (int i = 0; i < 16; i++)
+		ptrs.push_back(allocator.Allocate(32));
+
+	for (auto ptr : ptrs)
+		EXPECT_TRUE(allocator.Owns(ptr));
+
+	EXPECT_GE(allocator.GetUsedSize(), 16 * 32);
+
+	allocator.Reset();
+	EXPECT_GE(allocator.GetCapacity(), 16 * 32);
+}
+
+TEST_F(MemoryTest, LinearOverrunDetection)
+{
+	LinearAllocator allocator(1024);
+
+	auto data = static_cast<uint8_t*>(allocator.Allocate(16, 1));
+	std::memset(data, 0, 16);
+	allocator.Validate();
+
+#if PR_SCRATCH_DEBUG
+	data[16] = 0;
+	EXPECT_DEATH(allocator.Validate(), "");
+	data[16] = 0xFD;
+#endif
+}
+
+TEST_F(MemoryTest, LinearStlAdapter)
+{
+	LinearAllocator allocator(4096);
+
+	std::vector<int, LinearStlAllocator<int>> values{ LinearStlAllocator<int>(allocator) };
+	for (int i = 0; i < 100; i++)
+		values.push_back(i);
+
+	EXPECT_TRUE(allocator.Owns(values.data()));
+	EXPECT_EQ(values[99], 99);
+
+	std::map<int, int, std::less<int>, LinearStlAllocator<std::pair<const int, int>>> map{ LinearStlAllocator<std::pair<const int, int>>(allocator) };
+	map[1] = 2;
+	map[3] = 4;
+	EXPECT_EQ(map[3], 4);
+}
+
+TEST_F(MemoryTest, FrameRotation)
+{
+	FrameAllocator::Init(1024, 2);
+
+	auto& frameAllocator = FrameAllocator::GetInstance();
+
+	auto first = static_cast<int*>(frameAllocator.Allocate(sizeof(int), alignof(int)));
+	*first = 42;
+
+	// Previous frame is still valid in the double buffered setup
+	frameAllocator.NewFrame();
+	EXPECT_EQ(frameAllocator.GetFrameIndex(), 1);
+	EXPECT_EQ(*first, 42);
+
+	FrameVector<int> values(frameAllocator.GetStlAllocator<int>());
+	values.push_back(1);
+	EXPECT_FALSE(frameAllocator.GetThreadAllocator().Owns(first));
+	EXPECT_TRUE(frameAllocator.GetThreadAllocator().Owns(values.data()));
+
+	// Third frame reuses the memory of the first one
+	frameAllocator.NewFrame();
+	EXPECT_EQ(frameAllocator.GetFrameIndex(), 0);
+	EXPECT_EQ(frameAllocator.GetThreadAllocator().GetUsedSize(), 0);
+	EXPECT_EQ(frameAllocator.Allocate(sizeof(int), alignof(int)), first);
+
+	// Every thread gets its own memory
+	void* threadPtr = nullptr;
+	std::thread thread([&]() {
+		threadPtr = frameAllocator.Allocate(sizeof(int), alignof(int));
+		});
+	thread.join();
+
+	EXPECT_FALSE(frameAllocator.GetThreadAllocator().Owns(threadPtr));
+
+	FrameAllocator::Terminate();
+}
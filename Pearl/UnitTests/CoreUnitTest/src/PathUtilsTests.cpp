@@ -352,4 +352,13 @@ TEST(PathUtils, GetSubFolder)
 
 	subFolder = PrCore::PathUtils::GetSubFolder("foo/bar");
 	EXPECT_TRUE(subFolder == "foo");
-}
\ No newline at end of file
+}
+
+TEST(PathUtils, HashPath)
+{
+	auto hash = PrCore::PathUtils::HashPath("foo/bar.txt");
+	EXPECT_EQ(PrCore::PathUtils::HashPath("FOO\\Bar.TXT"), hash);
+	EXPECT_EQ(PrCore::PathUtils::HashPath(PrCore::PathUtils::Sanitize(std::string_view("Foo\\BAR.txt"))), hash);
+	EXPECT_NE(PrCore::PathUtils::HashPath("foo/bar.tx"), hash);
+	EXPECT_NE(PrCore::PathUtils::HashPath(""), 0);
+}
@@ -1,13 +1,23 @@
 #include <CommonUnitTest/Common/common.h>
 
+#include "Core/Resources/AssetRegistry.h"
 #include "Core/Resources/IResourceDataLoader.h"
 #include "Core/Resources/IResource.h"
 #include "Core/Resources/ResourceDatabase.h"
 #include "Core/Resources/ResourceSystem.h"
 
 #include"Core/Utils/UUID.h"
+#include "Core/Utils/Hash.h"
+#include "Core/Utils/CopyOnWrite.h"
 #include "Core/Utils/Logger.h"
 #include "Core/Events/EventManager.h"
+#include "Core/Memory/FrameAllocator.h"
+#include "Core/Threading/ThreadSystem.h"
+#include "Core/Threading/JobSystem.h"
+
+#include <filesystem>
+#include <fstream>
+#include <set>
 
 using namespace PrCore::Resources;
 
@@ -47,6 +57,8 @@ public:
 		p_resource.reset();
 	}
 
+	bool IsThreadSafe() const override { return true; }
+
 	// Mock Method to avoid saving on disk
 	MOCK_METHOD(bool, SaveResourceOnDisc, (IResourceDataPtr, const std::string&), (override));
 };
@@ -94,19 +106,271 @@ public:
 	MOCK_METHOD(bool, SaveResourceOnDisc, (IResourceDataPtr, const std::string&), (override));
 };
 
+class TestStagingData : public IResourceStagingData {
+public:
+	int value = 0;
+};
+
+// Decodes on a worker once the gate is open, no graphics context needed
+class AsyncTestLoader : public IResourceDataLoader {
+public:
+	IResourceDataPtr LoadResource(const std::string& p_path) override
+	{
+		return FinalizeResource(LoadResourceAsync(p_path), p_path);
+	}
+
+	void UnloadResource(IResourceDataPtr p_resource) override
+	{
+		p_resource.reset();
+	}
+
+	bool SupportsAsyncLoad() const override { return true; }
+	bool IsThreadSafe() const override { return threadSafe; }
+
+	IResourceStagingDataPtr LoadResourceAsync(const std::string& p_path) override
+	{
+		while (!gateOpen)
+			std::this_thread::yield();
+
+		asyncLoads++;
+		asyncThreadId = std::this_thread::get_id();
+		if (p_path.find("corrupted") != std::string::npos)
+			return nullptr;
+
+		auto stagingData = std::make_unique<TestStagingData>();
+		stagingData->value = 7;
+		return stagingData;
+	}
+
+	IResourceDataPtr FinalizeResource(IResourceStagingDataPtr p_stagingData, const std::string& p_path) override
+	{
+		finalizeThreadId = std::this_thread::get_id();
+		if (p_stagingData == nullptr)
+			return nullptr;
+
+		auto data = std::make_shared<TestResource>();
+		data->a = static_cast<TestStagingData*>(p_stagingData.get())->value;
+		data->b = 0;
+		data->c = 0;
+		return data;
+	}
+
+	MOCK_METHOD(bool, SaveResourceOnDisc, (IResourceDataPtr, const std::string&), (override));
+
+	std::atomic<bool> gateOpen = true;
+	std::atomic<bool> threadSafe = false;
+	std::atomic<int>  asyncLoads = 0;
+	std::thread::id   asyncThreadId;
+	std::thread::id   finalizeThreadId;
+};
+
+// Slow enough for the concurrent requests of one path to overlap
+class CountingTestLoader : public IResourceDataLoader {
+public:
+	IResourceDataPtr LoadResource(const std::string& p_path) override
+	{
+		loadCount++;
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+		auto data = std::make_shared<TestResource>();
+		data->a = 1;
+		return data;
+	}
+
+	void UnloadResource(IResourceDataPtr p_resource) override
+	{
+		p_resource.reset();
+	}
+
+	bool IsThreadSafe() const override { return true; }
+
+	// Mock Method to avoid saving on disk
+	MOCK_METHOD(bool, SaveResourceOnDisc, (IResourceDataPtr, const std::string&), (override));
+
+	std::atomic<int> loadCount = 0;
+};
+
+// Needs the finalize thread like the graphics loaders, records where the data is released
+class MainThreadTestLoader : public IResourceDataLoader {
+public:
+	IResourceDataPtr LoadResource(const std::string& p_path) override
+	{
+		auto data = std::make_shared<TestResource>();
+		data->a = 1;
+		return data;
+	}
+
+	void UnloadResource(IResourceDataPtr p_resource) override
+	{
+		unloadThreadId = std::this_thread::get_id();
+		unloadCount++;
+	}
+
+	MOCK_METHOD(bool, SaveResourceOnDisc, (IResourceDataPtr, const std::string&), (override));
+
+	std::atomic<int> unloadCount = 0;
+	std::thread::id  unloadThreadId;
+};
+
+// Reports the dependencies from the table, decodes on a worker and checks the dependencies are loaded first
+class DependencyTestLoader : public IResourceDataLoader {
+public:
+	IResourceDataPtr LoadResource(const std::string& p_path) override
+	{
+		return FinalizeResource(LoadResourceAsync(p_path), p_path);
+	}
+
+	void UnloadResource(IResourceDataPtr p_resource) override
+	{
+		p_resource.reset();
+	}
+
+	bool SupportsAsyncLoad() const override { return true; }
+
+	IResourceStagingDataPtr LoadResourceAsync(const std::string& p_path) override
+	{
+		{
+			std::lock_guard lock(decodeLock);
+			decodeCount[p_path]++;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		return std::make_unique<TestStagingData>();
+	}
+
+	IResourceDataPtr FinalizeResource(IResourceStagingDataPtr p_stagingData, const std::string& p_path) override
+	{
+		if (failing.count(p_path))
+			return nullptr;
+
+		for (auto& dependency : dependencies[p_path])
+		{
+			if (checkDependencies && PrCore::Resources::ResourceSystem::GetInstance().GetMetadata<TestResource>(dependency).GetState() != ResourceState::Loaded)
+				dependencyMissing = true;
+		}
+
+		finalizeOrder.push_back(p_path);
+		return std::make_shared<TestResource>();
+	}
+
+	std::vector<ResourceDependency> GetDependencies(const std::string& p_path) override
+	{
+		std::vector<ResourceDependency> resourceDependencies;
+		for (auto& dependency : dependencies[p_path])
+			resourceDependencies.push_back(ResourceDependency::Of<TestResource>(dependency));
+
+		return resourceDependencies;
+	}
+
+	MOCK_METHOD(bool, SaveResourceOnDisc, (IResourceDataPtr, const std::string&), (override));
+
+	std::map<std::string, std::vector<std::string>> dependencies;
+	std::vector<std::string>                        finalizeOrder;
+	bool                                            dependencyMissing = false;
+	bool                                            checkDependencies = true;
+	std::set<std::string>                           failing;
+
+	std::mutex                 decodeLock;
+	std::map<std::string, int> decodeCount;
+};
+
+// Cooked payload is the resource values, counts the loads from the file and from the payload
+class CookedTestLoader : public IResourceDataLoader {
+public:
+	IResourceDataPtr LoadResource(const std::string& p_path) override
+	{
+		fileLoads++;
+
+		auto data = std::make_shared<TestResource>();
+		data->a = static_cast<int>(p_path.size());
+		data->b = 2;
+		data->c = 3;
+		return data;
+	}
+
+	void UnloadResource(IResourceDataPtr p_resource) override
+	{
+		p_resource.reset();
+	}
+
+	bool ReadCookedPayload(const std::string& p_path, std::vector<uint8_t>& p_payload) override
+	{
+		// Repetitive like the vertex and pixel data
+		std::vector<int> values(256, static_cast<int>(p_path.size()));
+		p_payload.resize(values.size() * sizeof(int));
+		std::memcpy(p_payload.data(), values.data(), p_payload.size());
+		return true;
+	}
+
+	IResourceDataPtr LoadCookedResource(const std::string& p_path, const std::vector<uint8_t>& p_payload) override
+	{
+		cookedLoads++;
+
+		auto data = std::make_shared<TestResource>();
+		std::memcpy(&data->a, p_payload.data(), sizeof(int));
+		data->b = 2;
+		data->c = 3;
+		return data;
+	}
+
+	MOCK_METHOD(bool, SaveResourceOnDisc, (IResourceDataPtr, const std::string&), (override));
+
+	std::atomic<int> fileLoads = 0;
+	std::atomic<int> cookedLoads = 0;
+};
+
+class SharedTestResource : public IResourceData {
+public:
+	PrCore::Utils::CopyOnWrite<std::vector<int>> values;
+
+	size_t GetByteSize() const override
+	{
+		return sizeof(SharedTestResource) + values->size() * sizeof(int);
+	}
+
+	void ForEachBlock(const BlockVisitor& p_visitor) const override
+	{
+		p_visitor(values.GetBlock(), values->size() * sizeof(int));
+	}
+};
+REGISTRER_RESOURCE_HANDLE(SharedTestResource);
+
+class SharedTestLoader : public IResourceDataLoader {
+public:
+	IResourceDataPtr LoadResource(const std::string& p_path) override
+	{
+		auto data = std::make_shared<SharedTestResource>();
+		data->values = std::vector<int>(1000, 0);
+		return data;
+	}
+
+	void UnloadResource(IResourceDataPtr p_resource) override
+	{
+		p_resource.reset();
+	}
+
+	MOCK_METHOD(bool, SaveResourceOnDisc, (IResourceDataPtr, const std::string&), (override));
+};
+
 class ResourceSystemTest : public ::testing::Test {
 public:
 	static void SetUpTestSuite()
 	{
 		//This will be replaced with mocked versions in the future when I implement system localizer 
 		PrCore::Utils::Logger::Init();
+		PrCore::Memory::FrameAllocator::Init();
 		PrCore::Events::EventManager::Init();
+		PrCore::Threading::ThreadSystem::Init();
+		PrCore::Threading::JobSystem::Init(2);
 	}
 
 	static void TearDownTestSuite()
 	{
 		//This will be replaced with mocked versions in the future when I implement system localizer 
+		PrCore::Threading::JobSystem::Terminate();
+		PrCore::Threading::ThreadSystem::Terminate();
 		PrCore::Events::EventManager::Terminate();
+		PrCore::Memory::FrameAllocator::Terminate();
 		PrCore::Utils::Logger::Terminate();
 	}
 };
@@ -155,7 +419,7 @@ TEST_F(ResourceSystemTest, LoadFromFile)
 	EXPECT_TRUE(resource->state == ResourceState::Loaded);
 	// Check if LoadEvent was fired
 
-	TestResourcePtr resourceData = std::static_pointer_cast<TestResource>(resource->data);
+	TestResourcePtr resourceData = std::static_pointer_cast<TestResource>(resource->GetData());
 	EXPECT_EQ(resourceData->a, 1);
 	EXPECT_EQ(resourceData->b, 2);
 	EXPECT_EQ(resourceData->c, 3);
@@ -168,7 +432,7 @@ TEST_F(ResourceSystemTest, LoadFromFile)
 	EXPECT_TRUE(resource1->state == ResourceState::Loaded);
 	// Check if LoadEvent was fired
 
-	TestResourcePtr resourceData1 = std::static_pointer_cast<TestResource>(resource1->data);
+	TestResourcePtr resourceData1 = std::static_pointer_cast<TestResource>(resource1->GetData());
 	EXPECT_EQ(resourceData1->a, 4);
 	EXPECT_EQ(resourceData1->b, 5);
 	EXPECT_EQ(resourceData1->c, 6);
@@ -182,7 +446,7 @@ TEST_F(ResourceSystemTest, LoadFromFile)
 	EXPECT_TRUE(resource2->state == ResourceState::Loaded);
 	// Check if LoadEvent was fired
 
-	TestResourcePtr resourceData2 = std::static_pointer_cast<TestResource>(resource2->data);
+	TestResourcePtr resourceData2 = std::static_pointer_cast<TestResource>(resource2->GetData());
 	EXPECT_EQ(resourceData2->a, 10);
 	EXPECT_EQ(resourceData2->b, 20);
 	EXPECT_EQ(resourceData2->c, 30);
@@ -199,7 +463,7 @@ TEST_F(ResourceSystemTest, UnloadFromFile)
 	// Load and Unload
 	ResourceDescPtr resource = dataBase.Load("Foo.test");
 	dataBase.Unload("Foo.test");
-	EXPECT_TRUE(resource->data == nullptr);
+	EXPECT_TRUE(resource->GetData() == nullptr);
 	EXPECT_TRUE(resource->filePath == "foo.test");
 	EXPECT_TRUE(resource->origin == ResourceOrigin::File);
 	EXPECT_TRUE(resource->state == ResourceState::Unloaded);
@@ -212,7 +476,7 @@ TEST_F(ResourceSystemTest, UnloadFromFile)
 	EXPECT_TRUE(resource->origin == ResourceOrigin::File);
 	EXPECT_TRUE(resource->size == sizeof(TestResource));
 	EXPECT_TRUE(resource->state == ResourceState::Loaded);
-	EXPECT_TRUE(resource->data != nullptr);
+	EXPECT_TRUE(resource->GetData() != nullptr);
 	
 	//Unload by ID
 	dataBase.Unload(resource->id);
@@ -220,7 +484,7 @@ TEST_F(ResourceSystemTest, UnloadFromFile)
 	EXPECT_TRUE(resource->origin == ResourceOrigin::File);
 	EXPECT_TRUE(resource->size == 0);
 	EXPECT_TRUE(resource->state == ResourceState::Unloaded);
-	EXPECT_TRUE(resource->data == nullptr);
+	EXPECT_TRUE(resource->GetData() == nullptr);
 	// Check if UnloadEvent was fired
 	
 	// Unload unregistered, should trigger warning
@@ -236,13 +500,13 @@ TEST_F(ResourceSystemTest, UnloadFromFile)
 	ResourceDescPtr resource3 = dataBase.Load("Foo3.test");
 	// Check if CacheMissEvent triggered
 	dataBase.UnloadAll();
-	EXPECT_TRUE(resource->data == nullptr);
+	EXPECT_TRUE(resource->GetData() == nullptr);
 	EXPECT_TRUE(resource->state == ResourceState::Unloaded);
-	EXPECT_TRUE(resource1->data == nullptr);
+	EXPECT_TRUE(resource1->GetData() == nullptr);
 	EXPECT_TRUE(resource1->state == ResourceState::Unloaded);
-	EXPECT_TRUE(resource2->data == nullptr);
+	EXPECT_TRUE(resource2->GetData() == nullptr);
 	EXPECT_TRUE(resource2->state == ResourceState::Unloaded);
-	EXPECT_TRUE(resource3->data == nullptr);
+	EXPECT_TRUE(resource3->GetData() == nullptr);
 	EXPECT_TRUE(resource3->state == ResourceState::Unloaded);
 	// Check if UnloadEvent was fired 4 times
 
@@ -261,7 +525,7 @@ TEST_F(ResourceSystemTest, RegisterFromFile)
 	EXPECT_TRUE(resource->origin == ResourceOrigin::File);
 	EXPECT_TRUE(resource->size == 0);
 	EXPECT_TRUE(resource->state == ResourceState::Registered);
-	EXPECT_TRUE(resource->data == nullptr);
+	EXPECT_TRUE(resource->GetData() == nullptr);
 
 	// Load by ID
 	resource = dataBase.Load(resource->id);
@@ -274,7 +538,7 @@ TEST_F(ResourceSystemTest, RegisterFromFile)
 	EXPECT_TRUE(resource->origin == ResourceOrigin::File);
 	EXPECT_TRUE(resource->size == 0);
 	EXPECT_TRUE(resource->state == ResourceState::Unmanaged);
-	EXPECT_TRUE(resource->data == nullptr);
+	EXPECT_TRUE(resource->GetData() == nullptr);
 	// Check if UnloadEvent was fired
 
 	// Unregister with unloading first
@@ -286,7 +550,7 @@ TEST_F(ResourceSystemTest, RegisterFromFile)
 	EXPECT_TRUE(resource->origin == ResourceOrigin::File);
 	EXPECT_TRUE(resource->size == 0);
 	EXPECT_TRUE(resource->state == ResourceState::Unmanaged);
-	EXPECT_TRUE(resource->data == nullptr);
+	EXPECT_TRUE(resource->GetData() == nullptr);
 	// UnloadEvent should not be fired
 
 	// Register a lot and remove all
@@ -295,13 +559,13 @@ TEST_F(ResourceSystemTest, RegisterFromFile)
 	ResourceDescPtr resource2 = dataBase.Register("Foo2.test");
 	ResourceDescPtr resource3 = dataBase.Register("Foo3.test");
 	dataBase.RemoveAll();
-	EXPECT_TRUE(resource->data == nullptr);
+	EXPECT_TRUE(resource->GetData() == nullptr);
 	EXPECT_TRUE(resource->state == ResourceState::Unmanaged);
-	EXPECT_TRUE(resource1->data == nullptr);
+	EXPECT_TRUE(resource1->GetData() == nullptr);
 	EXPECT_TRUE(resource1->state == ResourceState::Unmanaged);
-	EXPECT_TRUE(resource2->data == nullptr);
+	EXPECT_TRUE(resource2->GetData() == nullptr);
 	EXPECT_TRUE(resource2->state == ResourceState::Unmanaged);
-	EXPECT_TRUE(resource3->data == nullptr);
+	EXPECT_TRUE(resource3->GetData() == nullptr);
 	EXPECT_TRUE(resource3->state == ResourceState::Unmanaged);
 
 	// Register the same, it should return the previously registered spelling should does not matter
@@ -330,14 +594,14 @@ TEST_F(ResourceSystemTest, GetFromFile)
 	EXPECT_TRUE(getResourceId->origin == ResourceOrigin::File);
 	EXPECT_TRUE(getResourceId->size == sizeof(TestResource));
 	EXPECT_TRUE(getResourceId->state == ResourceState::Loaded);
-	EXPECT_TRUE(getResourceId->data != nullptr);
+	EXPECT_TRUE(getResourceId->GetData() != nullptr);
 
 	auto getResourcePath = dataBase.Get("Foo.test");
 	EXPECT_TRUE(getResourcePath->filePath == "foo.test");
 	EXPECT_TRUE(getResourcePath->origin == ResourceOrigin::File);
 	EXPECT_TRUE(getResourcePath->size == sizeof(TestResource));
 	EXPECT_TRUE(getResourcePath->state == ResourceState::Loaded);
-	EXPECT_TRUE(getResourcePath->data != nullptr);
+	EXPECT_TRUE(getResourcePath->GetData() != nullptr);
 
 	
 	// Get without loading by ID and path
@@ -347,7 +611,7 @@ TEST_F(ResourceSystemTest, GetFromFile)
 	EXPECT_TRUE(getResourceId->origin == ResourceOrigin::File);
 	EXPECT_TRUE(getResourceId->size == sizeof(TestResource));
 	EXPECT_TRUE(getResourceId->state == ResourceState::Loaded);
-	EXPECT_TRUE(getResourceId->data != nullptr);
+	EXPECT_TRUE(getResourceId->GetData() != nullptr);
 	// Check if FireCacheMiss event was triggered
 
 	getResourcePath = dataBase.Get("Foo.test");
@@ -355,7 +619,7 @@ TEST_F(ResourceSystemTest, GetFromFile)
 	EXPECT_TRUE(getResourcePath->origin == ResourceOrigin::File);
 	EXPECT_TRUE(getResourcePath->size == sizeof(TestResource));
 	EXPECT_TRUE(getResourcePath->state == ResourceState::Loaded);
-	EXPECT_TRUE(getResourcePath->data != nullptr);
+	EXPECT_TRUE(getResourcePath->GetData() != nullptr);
 	// FireCacheMiss should not be triggered
 
 
@@ -385,7 +649,7 @@ TEST_F(ResourceSystemTest, ResourcesFromMemory)
 	EXPECT_TRUE(resource->origin == ResourceOrigin::Memory);
 	EXPECT_TRUE(resource->size == sizeof(TestResource));
 	EXPECT_TRUE(resource->state == ResourceState::Registered);
-	EXPECT_TRUE(resource->data == resourceData);
+	EXPECT_TRUE(resource->GetData() == resourceData);
 
 	// Try load and unload a resource from memory, it is not possible it returns resourceDesc instead
 	auto missingRes = dataBase.Load(resource->id);
@@ -393,7 +657,7 @@ TEST_F(ResourceSystemTest, ResourcesFromMemory)
 	EXPECT_TRUE(missingRes->origin == ResourceOrigin::Memory);
 	EXPECT_TRUE(missingRes->size == sizeof(TestResource));
 	EXPECT_TRUE(missingRes->state == ResourceState::Registered);
-	EXPECT_TRUE(missingRes->data == resourceData);
+	EXPECT_TRUE(missingRes->GetData() == resourceData);
 	// Check if warning triggered
 
 	dataBase.Unload(resource->id);
@@ -406,7 +670,7 @@ TEST_F(ResourceSystemTest, ResourcesFromMemory)
 	EXPECT_TRUE(getResource->origin == ResourceOrigin::Memory);
 	EXPECT_TRUE(getResource->size == sizeof(TestResource));
 	EXPECT_TRUE(getResource->state == ResourceState::Registered);
-	EXPECT_TRUE(getResource->data == resourceData);
+	EXPECT_TRUE(getResource->GetData() == resourceData);
 
 
 	// Unregister resource
@@ -415,7 +679,7 @@ TEST_F(ResourceSystemTest, ResourcesFromMemory)
 	EXPECT_TRUE(resource->origin == ResourceOrigin::Memory);
 	EXPECT_TRUE(resource->size == 0);
 	EXPECT_TRUE(resource->state == ResourceState::Unmanaged);
-	EXPECT_TRUE(resource->data == nullptr);
+	EXPECT_TRUE(resource->GetData() == nullptr);
 	// Data is still not deleted
 	EXPECT_TRUE(resourceData != nullptr);
 
@@ -426,13 +690,13 @@ TEST_F(ResourceSystemTest, ResourcesFromMemory)
 	ResourceDescPtr resource3 = dataBase.Register(std::make_shared<TestResource>());
 	// Check if CacheMissEvent triggered
 	dataBase.RemoveAll();
-	EXPECT_TRUE(resource->data == nullptr);
+	EXPECT_TRUE(resource->GetData() == nullptr);
 	EXPECT_TRUE(resource->state == ResourceState::Unmanaged);
-	EXPECT_TRUE(resource1->data == nullptr);
+	EXPECT_TRUE(resource1->GetData() == nullptr);
 	EXPECT_TRUE(resource1->state == ResourceState::Unmanaged);
-	EXPECT_TRUE(resource2->data == nullptr);
+	EXPECT_TRUE(resource2->GetData() == nullptr);
 	EXPECT_TRUE(resource2->state == ResourceState::Unmanaged);
-	EXPECT_TRUE(resource3->data == nullptr);
+	EXPECT_TRUE(resource3->GetData() == nullptr);
 	EXPECT_TRUE(resource3->state == ResourceState::Unmanaged);
 
 
@@ -446,7 +710,7 @@ TEST_F(ResourceSystemTest, ResourcesFromMemory)
 	EXPECT_TRUE(resourceSave->origin == ResourceOrigin::Memory);
 	EXPECT_TRUE(resourceSave->size == sizeof(TestResource));
 	EXPECT_TRUE(resourceSave->state == ResourceState::Registered);
-	EXPECT_TRUE(resourceSave->data == resourceData);
+	EXPECT_TRUE(resourceSave->GetData() == resourceData);
 
 	// Calling with wrong extension will break
 	EXPECT_DEATH(dataBase.SaveToFile(resourceSave->id, "save.shouldNotWork"), ".*");
@@ -608,3 +872,830 @@ TEST_F(ResourceSystemTest, GeneralResourceSystem)
 
 	PrCore::Resources::ResourceSystem::Terminate();
 }
+
+TEST_F(ResourceSystemTest, AsyncLoading)
+{
+	PrCore::Resources::ResourceSystem::Init();
+	auto resourceSystem = PrCore::Resources::ResourceSystem::GetInstancePtr();
+
+	auto dataBase = std::make_unique<ResourceDatabase>();
+	auto loader = std::make_unique<AsyncTestLoader>();
+	auto loaderPtr = loader.get();
+	dataBase->RegisterLoader(".async", std::move(loader));
+	dataBase->RegisterLoader(".test", std::make_unique<TestLoader>());
+	resourceSystem->RegisterDatabase<TestResource>(std::move(dataBase));
+
+	// Returns immediately in Loading state, the second request joins the first one
+	loaderPtr->gateOpen = false;
+	int callbackCount = 0;
+	auto callback = [&](TestResourceHandle p_handle) {
+		EXPECT_EQ(p_handle.GetState(), ResourceState::Loaded);
+		callbackCount++;
+	};
+
+	auto handle = resourceSystem->LoadAsync<TestResource>("Foo.async", callback);
+	auto handleJoined = resourceSystem->LoadAsync<TestResource>("foo.async", callback);
+	EXPECT_EQ(handle.GetState(), ResourceState::Loading);
+	EXPECT_EQ(handle.GetID(), handleJoined.GetID());
+	EXPECT_TRUE(handle == nullptr);
+
+	resourceSystem->Update();
+	EXPECT_EQ(handle.GetState(), ResourceState::Loading);
+	EXPECT_EQ(callbackCount, 0);
+
+	// Poll until the main thread step runs
+	loaderPtr->gateOpen = true;
+	while (handle.GetState() == ResourceState::Loading)
+		resourceSystem->Update();
+
+	EXPECT_EQ(handle.GetState(), ResourceState::Loaded);
+	EXPECT_EQ(handle->a, 7);
+	EXPECT_EQ(callbackCount, 2);
+	EXPECT_EQ(loaderPtr->asyncLoads, 1);
+	EXPECT_NE(loaderPtr->asyncThreadId, std::this_thread::get_id());
+	EXPECT_EQ(loaderPtr->finalizeThreadId, std::this_thread::get_id());
+	EXPECT_EQ(resourceSystem->GetMemoryUsage<TestResource>(), sizeof(TestResource));
+
+	// Loaded resource calls back immediately
+	resourceSystem->LoadAsync<TestResource>(handle.GetID(), callback);
+	EXPECT_EQ(callbackCount, 3);
+
+	// Wait finalizes without Update, Get waits the same way
+	auto handleWait = resourceSystem->LoadAsync<TestResource>("Bar.async");
+	resourceSystem->WaitForLoad(handleWait);
+	EXPECT_EQ(handleWait.GetState(), ResourceState::Loaded);
+	EXPECT_EQ(handleWait->a, 7);
+
+	auto handleGet = resourceSystem->LoadAsync<TestResource>("Baz.async");
+	EXPECT_EQ(resourceSystem->Get<TestResource>("baz.async")->a, 7);
+	EXPECT_EQ(handleGet.GetState(), ResourceState::Loaded);
+
+	// Loader without async support loads in the main thread step
+	auto handleSync = resourceSystem->LoadAsync<TestResource>("Foo.test");
+	EXPECT_EQ(handleSync.GetState(), ResourceState::Loading);
+	resourceSystem->Update();
+	EXPECT_EQ(handleSync.GetState(), ResourceState::Loaded);
+	EXPECT_EQ(handleSync->a, 1);
+
+	// Failed decode ends corrupted
+	auto handleCorrupted = resourceSystem->LoadAsync<TestResource>("Corrupted.async");
+	resourceSystem->WaitForLoad(handleCorrupted);
+	EXPECT_EQ(handleCorrupted.GetState(), ResourceState::Corrupted);
+
+	// Unload cancels the load, the decoded data is dropped
+	loaderPtr->gateOpen = false;
+	int cancelledCount = 0;
+	auto handleCancelled = resourceSystem->LoadAsync<TestResource>("Cancelled.async", [&](TestResourceHandle p_handle) {
+		EXPECT_EQ(p_handle.GetState(), ResourceState::Unloaded);
+		cancelledCount++;
+		});
+	resourceSystem->Unload<TestResource>(handleCancelled.GetID());
+	EXPECT_EQ(handleCancelled.GetState(), ResourceState::Unloaded);
+	EXPECT_EQ(cancelledCount, 1);
+
+	loaderPtr->gateOpen = true;
+	while (loaderPtr->asyncLoads < 5)
+		std::this_thread::yield();
+	resourceSystem->Update();
+	EXPECT_EQ(handleCancelled.GetState(), ResourceState::Unloaded);
+	EXPECT_EQ(cancelledCount, 1);
+
+	// Removing the database waits for the jobs still running
+	loaderPtr->gateOpen = false;
+	auto handleRemoved = resourceSystem->LoadAsync<TestResource>("Removed.async");
+	std::thread opener([loaderPtr]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		loaderPtr->gateOpen = true;
+		});
+	resourceSystem->UnregisterDatabase<TestResource>();
+	opener.join();
+	EXPECT_EQ(handleRemoved.GetState(), ResourceState::Unmanaged);
+
+	PrCore::Resources::ResourceSystem::Terminate();
+}
+
+TEST_F(ResourceSystemTest, EvictionLRU)
+{
+	ResourceDatabase dataBase;
+	dataBase.RegisterLoader(".test", std::make_unique<TestLoader>());
+
+	constexpr size_t resourceSize = sizeof(TestResource);
+	dataBase.SetMemoryBudget(4 * resourceSize);
+	dataBase.SetEvictionPolicy({ true, 1.0f, 0.5f });
+
+	// Descriptors are not held so the resources are not referenced
+	std::vector<ResourceID> ids;
+	for (int i = 0; i < 4; i++)
+		ids.push_back(dataBase.Load("Res" + std::to_string(i) + ".test")->id);
+	EXPECT_EQ(dataBase.GetMemoryUsage(), 4 * resourceSize);
+
+	dataBase.Get(ids[1]);
+	dataBase.Get(ids[0]);
+	dataBase.Get(ids[3]);
+	dataBase.Get(ids[2]);
+	dataBase.Pin(ids[1]);
+	auto heldResource = dataBase.Get(ids[0]);
+
+	// Passing the high watermark evicts least recently used towards the low watermark, pinned and held ones stay
+	dataBase.Load("Res4.test");
+	EXPECT_EQ(dataBase.GetMetadata(ids[0])->state, ResourceState::Loaded);
+	EXPECT_EQ(dataBase.GetMetadata(ids[1])->state, ResourceState::Loaded);
+	EXPECT_EQ(dataBase.GetMetadata(ids[2])->state, ResourceState::Unloaded);
+	EXPECT_EQ(dataBase.GetMetadata(ids[3])->state, ResourceState::Unloaded);
+	EXPECT_EQ(dataBase.GetMemoryUsage(), 3 * resourceSize);
+
+	// Evicted resource loads back on access
+	EXPECT_EQ(dataBase.Get(ids[3])->state, ResourceState::Loaded);
+	EXPECT_EQ(dataBase.GetMemoryUsage(), 4 * resourceSize);
+
+	heldResource = nullptr;
+	dataBase.Unpin(ids[1]);
+	dataBase.Load("Res5.test");
+	EXPECT_EQ(dataBase.GetMetadata(ids[0])->state, ResourceState::Unloaded);
+	EXPECT_EQ(dataBase.GetMetadata(ids[1])->state, ResourceState::Unloaded);
+	EXPECT_EQ(dataBase.GetMetadata("res4.test")->state, ResourceState::Unloaded);
+	EXPECT_EQ(dataBase.GetMetadata(ids[3])->state, ResourceState::Loaded);
+	EXPECT_EQ(dataBase.GetMetadata("res5.test")->state, ResourceState::Loaded);
+	EXPECT_EQ(dataBase.GetMemoryUsage(), 2 * resourceSize);
+
+	// Disabled policy only reports the budget
+	dataBase.SetEvictionPolicy({ false });
+	for (int i = 0; i < 4; i++)
+		dataBase.Load(ids[i]);
+	EXPECT_EQ(dataBase.GetMemoryUsage(), 5 * resourceSize);
+}
+
+TEST_F(ResourceSystemTest, EvictionOffFinalizeThread)
+{
+	using namespace PrCore::Threading;
+
+	ResourceDatabase dataBase;
+	auto loader = std::make_unique<MainThreadTestLoader>();
+	auto mainLoader = loader.get();
+	dataBase.RegisterLoader(".main", std::move(loader));
+	dataBase.RegisterLoader(".test", std::make_unique<TestLoader>());
+
+	constexpr size_t resourceSize = sizeof(TestResource);
+	dataBase.SetMemoryBudget(2 * resourceSize);
+	dataBase.SetEvictionPolicy({ true, 1.0f, 0.5f });
+
+	auto firstId = dataBase.Load("Res0.main")->id;
+	auto secondId = dataBase.Load("Res1.main")->id;
+
+	// Load on a job evicts both, their loader releases the data on the finalize thread
+	auto jobState = JobSystem::GetInstance().Schedule(JobPriority::Normal, "EvictOffFinalizeThread", [&]() {
+		dataBase.Load("Res2.test");
+		});
+	while (!jobState->IsDone())
+		std::this_thread::yield();
+
+	EXPECT_EQ(dataBase.GetMetadata(firstId)->state, ResourceState::Unloaded);
+	EXPECT_EQ(dataBase.GetMetadata(secondId)->state, ResourceState::Unloaded);
+	EXPECT_EQ(dataBase.GetMemoryUsage(), resourceSize);
+	EXPECT_EQ(mainLoader->unloadCount, 0);
+
+	dataBase.FinalizeLoads(std::chrono::steady_clock::time_point::max());
+	EXPECT_EQ(mainLoader->unloadCount, 2);
+	EXPECT_EQ(mainLoader->unloadThreadId, std::this_thread::get_id());
+
+	// Resource referenced meanwhile is skipped
+	auto heldDesc = dataBase.Load(firstId);
+	dataBase.Load(secondId);
+	dataBase.Load("Res3.test");
+	EXPECT_EQ(heldDesc->state, ResourceState::Loaded);
+	EXPECT_NE(heldDesc->GetData(), nullptr);
+}
+
+TEST_F(ResourceSystemTest, CompressedResidency)
+{
+	ResourceDatabase dataBase;
+	dataBase.RegisterLoader(".test", std::make_unique<CookedTestLoader>());
+	auto loader = static_cast<CookedTestLoader*>(dataBase.GetLoader(".test"));
+
+	constexpr size_t resourceSize = sizeof(TestResource);
+	dataBase.SetMemoryBudget(2 * resourceSize);
+	dataBase.SetCompressedMemoryBudget(1024);
+	dataBase.SetEvictionPolicy({ true, 1.0f, 0.5f, true });
+
+	auto waitForDemotions = [&](uint64_t p_demotions) {
+		for (int i = 0; i < 500 && dataBase.GetResidencyStats().demotions < p_demotions; i++)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	};
+
+	// Evicted resources are demoted to the compressed tier on a worker
+	std::vector<ResourceID> ids;
+	for (int i = 0; i < 3; i++)
+		ids.push_back(dataBase.Load("Res" + std::to_string(i) + ".test")->id);
+	waitForDemotions(2);
+
+	auto stats = dataBase.GetResidencyStats();
+	EXPECT_EQ(stats.residentCount, 1);
+	EXPECT_EQ(stats.residentBytes, resourceSize);
+	EXPECT_EQ(stats.compressedCount, 2);
+	EXPECT_EQ(stats.payloadBytes, 2 * 256 * sizeof(int));
+	EXPECT_GT(stats.compressedBytes, 0);
+	EXPECT_LT(stats.compressedBytes, stats.payloadBytes);
+	EXPECT_EQ(dataBase.GetCompressedMemoryUsage(), stats.compressedBytes);
+	EXPECT_EQ(stats.fileLoads, 3);
+	EXPECT_EQ(loader->fileLoads, 3);
+
+	// Loading again decompresses the copy instead of loading the file
+	auto promoted = dataBase.Get(ids[0]);
+	EXPECT_EQ(promoted->state, ResourceState::Loaded);
+	EXPECT_EQ(std::static_pointer_cast<TestResource>(promoted->GetData())->a, static_cast<int>(std::string("res0.test").size()));
+	EXPECT_EQ(loader->fileLoads, 3);
+	EXPECT_EQ(loader->cookedLoads, 1);
+	promoted = nullptr;
+
+	stats = dataBase.GetResidencyStats();
+	EXPECT_EQ(stats.promotions, 1);
+	EXPECT_EQ(stats.compressedCount, 1);
+
+	// Explicit unload drops the copy, the next load reads the file
+	dataBase.Unload(ids[1]);
+	EXPECT_EQ(dataBase.GetResidencyStats().compressedCount, 0);
+	dataBase.Load(ids[1]);
+	EXPECT_EQ(loader->fileLoads, 4);
+
+	// Shrinking the budget drops the least recently used copies
+	waitForDemotions(4);
+	EXPECT_EQ(dataBase.GetResidencyStats().compressedCount, 2);
+	dataBase.SetCompressedMemoryBudget(dataBase.GetCompressedMemoryUsage() - 1);
+	EXPECT_EQ(dataBase.GetResidencyStats().compressedCount, 1);
+	dataBase.SetEvictionPolicy({ true, 1.0f, 0.5f, false });
+	EXPECT_EQ(dataBase.GetCompressedMemoryUsage(), 0);
+}
+
+TEST_F(ResourceSystemTest, CopyOnWriteCopies)
+{
+	PrCore::Resources::ResourceSystem::Init();
+	auto resourceSystem = PrCore::Resources::ResourceSystem::GetInstancePtr();
+
+	auto dataBase = std::make_unique<ResourceDatabase>();
+	dataBase->RegisterLoader(".shared", std::make_unique<SharedTestLoader>());
+	resourceSystem->RegisterDatabase<SharedTestResource>(std::move(dataBase));
+
+	constexpr size_t valuesSize = 1000 * sizeof(int);
+	auto source = resourceSystem->Load<SharedTestResource>("Variant.shared");
+	EXPECT_EQ(resourceSystem->GetMemoryUsage<SharedTestResource>(), sizeof(SharedTestResource) + valuesSize);
+
+	// Copies share the values, the shared bytes are counted once
+	std::vector<SharedTestResourceHandle> variants;
+	for (int i = 0; i < 100; i++)
+		variants.push_back(resourceSystem->Register<SharedTestResource>(resourceSystem->Copy<SharedTestResource>("Variant.shared")));
+
+	EXPECT_TRUE(variants[0]->values.IsShared());
+	EXPECT_EQ(&variants[0]->values.Get(), &source->values.Get());
+	EXPECT_EQ(resourceSystem->GetMemoryUsage<SharedTestResource>(), 101 * sizeof(SharedTestResource) + valuesSize);
+
+	// First change detaches the copy, the source and the other copies keep the values
+	variants[0]->values.Write()[0] = 7;
+	EXPECT_NE(&variants[0]->values.Get(), &source->values.Get());
+	EXPECT_EQ(variants[0]->values.Get()[0], 7);
+	EXPECT_EQ(source->values.Get()[0], 0);
+	EXPECT_TRUE(variants[1]->values.IsShared());
+
+	// Detached values are counted once the change is notified
+	EXPECT_EQ(resourceSystem->GetMemoryUsage<SharedTestResource>(), 101 * sizeof(SharedTestResource) + valuesSize);
+	resourceSystem->NotifyChanged<SharedTestResource>(variants[0].GetID());
+	EXPECT_EQ(resourceSystem->GetMemoryUsage<SharedTestResource>(), 101 * sizeof(SharedTestResource) + 2 * valuesSize);
+
+	// Shared bytes stay counted until the last resource holding them is released
+	resourceSystem->Unload<SharedTestResource>(source.GetID());
+	EXPECT_EQ(resourceSystem->GetMemoryUsage<SharedTestResource>(), 100 * sizeof(SharedTestResource) + 2 * valuesSize);
+
+	// Every variant changed holds its own values
+	for (int i = 1; i < 100; i++)
+	{
+		variants[i]->values.Write()[0] = i;
+		resourceSystem->NotifyChanged<SharedTestResource>(variants[i].GetID());
+	}
+	EXPECT_EQ(resourceSystem->GetMemoryUsage<SharedTestResource>(), 100 * sizeof(SharedTestResource) + 100 * valuesSize);
+
+	for (auto& variant : variants)
+		resourceSystem->Remove<SharedTestResource>(variant.GetID());
+	EXPECT_EQ(resourceSystem->GetMemoryUsage<SharedTestResource>(), 0);
+
+	PrCore::Resources::ResourceSystem::Terminate();
+}
+
+TEST_F(ResourceSystemTest, HandleRawAccess)
+{
+	ResourceDatabase dataBase;
+	dataBase.RegisterLoader(".test", std::make_unique<TestLoader>());
+
+	TestResourceHandle handle = dataBase.Load("Foo.test");
+	auto data = handle.GetData();
+
+	// Dereferencing does not share the ownership
+	EXPECT_EQ(handle.Get(), data.get());
+	EXPECT_EQ(handle->a, 1);
+	EXPECT_EQ((*handle).b, 2);
+	EXPECT_EQ(data.use_count(), 2);
+
+	// Move leaves the source empty
+	TestResourceHandle movedHandle(std::move(handle));
+	EXPECT_FALSE(handle.IsValid());
+	EXPECT_TRUE(handle == nullptr);
+	EXPECT_TRUE(movedHandle == data);
+	data = nullptr;
+
+	// Generation changes with the data
+	auto generation = movedHandle.GetGeneration();
+	dataBase.Unload(movedHandle.GetID());
+	EXPECT_NE(movedHandle.GetGeneration(), generation);
+	EXPECT_TRUE(movedHandle == nullptr);
+
+	generation = movedHandle.GetGeneration();
+	dataBase.Load(movedHandle.GetID());
+	EXPECT_NE(movedHandle.GetGeneration(), generation);
+	EXPECT_TRUE(movedHandle != nullptr);
+	EXPECT_EQ(movedHandle->a, 1);
+
+	// Removed descriptor gives no data to the handles created before
+	TestResourceHandle copiedHandle = movedHandle;
+	dataBase.Remove(movedHandle.GetID());
+	EXPECT_TRUE(movedHandle == nullptr);
+	EXPECT_TRUE(copiedHandle == nullptr);
+}
+
+TEST_F(ResourceSystemTest, HandleAcrossReload)
+{
+	ResourceDatabase dataBase;
+	dataBase.RegisterLoader(".test", std::make_unique<TestLoader>());
+
+	TestResourceHandle handle = dataBase.Load("Foo.test");
+	TestResourceHandle heldHandle = handle;
+	auto previousData = handle.GetData();
+	auto generation = heldHandle.GetGeneration();
+
+	// Handle held across the reload is dereferenced without being created again
+	bool reloaded = false;
+	dataBase.Reload("Foo.test", [&](ResourceDescPtr) { reloaded = true; });
+	while (!reloaded)
+		dataBase.FinalizeLoads(std::chrono::steady_clock::time_point::max());
+
+	EXPECT_GT(heldHandle.GetGeneration(), generation);
+	EXPECT_EQ(heldHandle.GetState(), ResourceState::Loaded);
+	ASSERT_NE(heldHandle.Get(), nullptr);
+	EXPECT_NE(heldHandle.Get(), previousData.get());
+	EXPECT_EQ(heldHandle.Get(), handle.Get());
+	EXPECT_EQ(heldHandle->a, 1);
+	EXPECT_EQ((*heldHandle).c, 3);
+}
+
+TEST_F(ResourceSystemTest, HashedLookup)
+{
+	ResourceDatabase dataBase;
+	dataBase.RegisterLoader(".TEST", std::make_unique<TestLoader>());
+	EXPECT_NE(dataBase.GetLoader(".test"), nullptr);
+
+	constexpr int resourceNum = 100000;
+	std::vector<ResourceID> ids;
+	ids.reserve(resourceNum);
+	for (int i = 0; i < resourceNum; i++)
+		ids.push_back(dataBase.Register("Folder\\Resource" + std::to_string(i) + ".test")->id);
+
+	// Paths are normalized once, lookups ignore the case and separators
+	auto resourceDesc = dataBase.GetMetadata("FOLDER/resource777.TEST");
+	ASSERT_NE(resourceDesc, nullptr);
+	EXPECT_EQ(resourceDesc->filePath, "folder/resource777.test");
+	EXPECT_EQ(resourceDesc->id, ids[777]);
+
+	for (int i = 0; i < resourceNum; i += 97)
+		EXPECT_EQ(dataBase.GetMetadata(ids[i])->filePath, "folder/resource" + std::to_string(i) + ".test");
+
+	// Removing keeps the other entries reachable
+	for (int i = 0; i < resourceNum; i += 2)
+		EXPECT_TRUE(dataBase.Remove(ids[i]));
+
+	for (int i = 0; i < resourceNum; i++)
+	{
+		auto metadata = dataBase.GetMetadata(ids[i]);
+		if (i % 2 == 0)
+			EXPECT_EQ(metadata, nullptr);
+		else
+			ASSERT_NE(metadata, nullptr);
+	}
+	EXPECT_EQ(dataBase.GetMetadata("folder/resource1.test")->id, ids[1]);
+	EXPECT_EQ(dataBase.Load("folder/resource3.test")->state, ResourceState::Loaded);
+}
+
+TEST_F(ResourceSystemTest, ConcurrentAccess)
+{
+	using namespace PrCore::Threading;
+
+	ResourceDatabase dataBase;
+	auto loader = std::make_unique<CountingTestLoader>();
+	auto countingLoader = loader.get();
+	dataBase.RegisterLoader(".count", std::move(loader));
+	dataBase.SetMemoryBudget(std::numeric_limits<size_t>::max());
+
+	// Even paths are registered upfront and loaded by Get, odd ones are registered by the concurrent Load
+	constexpr int pathNum = 64;
+	constexpr int jobNum = 16;
+	std::vector<std::string> paths;
+	for (int i = 0; i < pathNum; i++)
+	{
+		paths.push_back("concurrent/resource" + std::to_string(i) + ".count");
+		if (i % 2 == 0)
+			dataBase.Register(paths.back());
+	}
+
+	// Every job requests every path in a different order, each path is loaded once
+	std::atomic<int> failures = 0;
+	std::vector<JobStatePtr> jobs;
+	for (int job = 0; job < jobNum; job++)
+	{
+		jobs.push_back(JobSystem::GetInstance().Schedule(JobPriority::Normal, "ConcurrentAccess", [&, job]() {
+			for (int i = 0; i < pathNum; i++)
+			{
+				int pathIndex = (i + job * 7) % pathNum;
+				ResourceDescPtr resourceDesc;
+				if (pathIndex % 2 == 0)
+					resourceDesc = job % 2 ? dataBase.Get(paths[pathIndex]) : dataBase.Get(dataBase.GetMetadata(paths[pathIndex])->id);
+				else
+					resourceDesc = dataBase.Load(paths[pathIndex]);
+
+				if (resourceDesc == nullptr || resourceDesc->state != ResourceState::Loaded || resourceDesc->GetData() == nullptr)
+					failures++;
+			}
+			}));
+	}
+
+	for (auto& job : jobs)
+		job->Wait();
+
+	EXPECT_EQ(failures, 0);
+	EXPECT_EQ(countingLoader->loadCount, pathNum);
+	EXPECT_EQ(dataBase.GetMemoryUsage(), pathNum * sizeof(TestResource));
+
+	// Unloads race the loads, the accounting matches the loaded resources afterwards
+	jobs.clear();
+	for (int job = 0; job < jobNum; job++)
+	{
+		jobs.push_back(JobSystem::GetInstance().Schedule(JobPriority::Normal, "ConcurrentUnload", [&, job]() {
+			for (int i = 0; i < pathNum; i++)
+			{
+				auto& path = paths[(i + job * 7) % pathNum];
+				if ((i + job) % 3 == 0)
+					dataBase.Unload(path);
+				else
+					dataBase.Load(path);
+			}
+			}));
+	}
+
+	for (auto& job : jobs)
+		job->Wait();
+
+	size_t loadedSize = 0;
+	dataBase.ForEachResource([&](ResourceDescConstPtr p_resourceDesc) {
+		if (p_resourceDesc->state == ResourceState::Loaded)
+			loadedSize += p_resourceDesc->size;
+		});
+	EXPECT_EQ(dataBase.GetMemoryUsage(), loadedSize);
+
+	for (auto& path : paths)
+		EXPECT_EQ(dataBase.Get(path)->state, ResourceState::Loaded);
+	EXPECT_EQ(dataBase.GetMemoryUsage(), pathNum * sizeof(TestResource));
+}
+
+TEST_F(ResourceSystemTest, ConcurrentDataAccess)
+{
+	using namespace PrCore::Threading;
+
+	ResourceDatabase dataBase;
+	dataBase.RegisterLoader(".test", std::make_unique<TestLoader>());
+
+	// Every load over two resources evicts the others, the readers do not keep them
+	constexpr int pathNum = 8;
+	dataBase.SetMemoryBudget(2 * sizeof(TestResource));
+	dataBase.SetEvictionPolicy({ true, 1.0f, 0.5f });
+
+	std::vector<std::string> paths;
+	for (int i = 0; i < pathNum; i++)
+	{
+		paths.push_back("race/resource" + std::to_string(i) + ".test");
+		dataBase.Register(paths.back());
+	}
+
+	// Readers dereference the data while the writer unloads and reloads and the loads evict
+	std::atomic<bool> running = true;
+	std::atomic<int> failures = 0;
+	std::atomic<int> reads = 0;
+	std::vector<JobStatePtr> jobs;
+	for (int job = 0; job < 2; job++)
+	{
+		jobs.push_back(JobSystem::GetInstance().Schedule(JobPriority::Normal, "ConcurrentRead", [&, job]() {
+			for (int i = 0; running; i++)
+			{
+				auto resourceDesc = dataBase.Get(paths[(i + job * 3) % pathNum]);
+
+				// Unloaded by another thread since Get returned
+				auto resourceData = std::static_pointer_cast<TestResource>(resourceDesc->GetData());
+				if (resourceData == nullptr)
+					continue;
+
+				if (resourceData->a != 1 || resourceData->b != 2 || resourceData->c != 3)
+					failures++;
+				reads++;
+			}
+			}));
+	}
+
+	std::atomic<bool> writerDone = false;
+	std::thread writer([&]() {
+		for (int i = 0; i < 2000; i++)
+		{
+			auto& path = paths[i % pathNum];
+			if (i % 3 == 0)
+				dataBase.Unload(path);
+			else if (i % 3 == 1)
+				dataBase.Load(path);
+			else
+				dataBase.Reload(path);
+		}
+		writerDone = true;
+		});
+
+	// Reloads are finalized here
+	while (!writerDone)
+		dataBase.FinalizeLoads(std::chrono::steady_clock::time_point::max());
+	writer.join();
+
+	running = false;
+	for (auto& job : jobs)
+		job->Wait();
+	dataBase.FinalizeLoads(std::chrono::steady_clock::time_point::max());
+
+	EXPECT_EQ(failures, 0);
+	EXPECT_GT(reads, 0);
+
+	size_t loadedSize = 0;
+	dataBase.ForEachResource([&](ResourceDescConstPtr p_resourceDesc) {
+		if (p_resourceDesc->state == ResourceState::Loaded)
+			loadedSize += p_resourceDesc->size;
+		});
+	EXPECT_EQ(dataBase.GetMemoryUsage(), loadedSize);
+}
+
+TEST_F(ResourceSystemTest, LoadOffFinalizeThread)
+{
+	using namespace PrCore::Threading;
+
+	ResourceDatabase dataBase;
+	auto loader = std::make_unique<AsyncTestLoader>();
+	auto asyncLoader = loader.get();
+	dataBase.RegisterLoader(".async", std::move(loader));
+	dataBase.RegisterLoader(".main", std::make_unique<Test1Loader>());
+
+	// The finalize thread does not finalize until the job is done, like when it waits for the job
+	auto runJob = [](JobPtr p_job) {
+		auto jobState = JobSystem::GetInstance().Schedule(JobPriority::Normal, "OffFinalizeThread", std::move(p_job));
+		while (!jobState->IsDone())
+			std::this_thread::yield();
+	};
+
+	// Async load of a loader needing the finalize thread is not waited for
+	auto pendingDesc = dataBase.LoadAsync("Pending.async");
+	std::atomic<ResourceState> jobState = ResourceState::Unmanaged;
+	runJob([&]() { jobState = dataBase.Get("pending.async")->state.load(); });
+	EXPECT_EQ(jobState, ResourceState::Loading);
+
+	dataBase.WaitForLoad(pendingDesc->id);
+	EXPECT_EQ(pendingDesc->state, ResourceState::Loaded);
+
+	// Loader needing the finalize thread does not load on the job, the load finishes in FinalizeLoads
+	runJob([&]() { jobState = dataBase.Get(dataBase.Register("Foo.main")->id)->state.load(); });
+	EXPECT_EQ(jobState, ResourceState::Loading);
+
+	dataBase.FinalizeLoads(std::chrono::steady_clock::time_point::max());
+	EXPECT_EQ(dataBase.GetMetadata("foo.main")->state, ResourceState::Loaded);
+	EXPECT_EQ(std::static_pointer_cast<TestResource>(dataBase.GetMetadata("foo.main")->GetData())->a, 4);
+
+	// Thread safe loader is finalized by the requesting thread
+	asyncLoader->threadSafe = true;
+	dataBase.LoadAsync("Shared.async");
+	std::thread::id jobThread;
+	runJob([&]() {
+		jobState = dataBase.Get("shared.async")->state.load();
+		jobThread = std::this_thread::get_id();
+		});
+	EXPECT_EQ(jobState, ResourceState::Loaded);
+	EXPECT_EQ(asyncLoader->finalizeThreadId, jobThread);
+}
+
+TEST_F(ResourceSystemTest, DependencyPreload)
+{
+	PrCore::Resources::ResourceSystem::Init();
+	auto resourceSystem = PrCore::Resources::ResourceSystem::GetInstancePtr();
+
+	auto dataBase = std::make_unique<ResourceDatabase>();
+	auto loader = std::make_unique<DependencyTestLoader>();
+	auto loaderPtr = loader.get();
+	dataBase->RegisterLoader(".dep", std::move(loader));
+	resourceSystem->RegisterDatabase<TestResource>(std::move(dataBase));
+
+	// Two parents share a leaf, the leaves decode in parallel
+	loaderPtr->dependencies = {
+		{ "scene.dep", { "a.dep", "b.dep" } },
+		{ "a.dep",     { "shared.dep", "texa.dep" } },
+		{ "b.dep",     { "shared.dep", "texb.dep" } },
+		{ "loop0.dep", { "loop1.dep" } },
+		{ "loop1.dep", { "loop0.dep" } }
+	};
+
+	auto preload = resourceSystem->Preload({ ResourceDependency::Of<TestResource>("Scene.dep"), ResourceDependency::Of<TestResource>("a.dep") });
+	EXPECT_EQ(preload->GetResourceCount(), 6);
+	EXPECT_FALSE(preload->IsDone());
+
+	resourceSystem->WaitForPreload(preload);
+	EXPECT_TRUE(preload->IsDone());
+	EXPECT_EQ(preload->GetPendingCount(), 0);
+	EXPECT_FALSE(loaderPtr->dependencyMissing);
+	EXPECT_EQ(loaderPtr->finalizeOrder.size(), 6);
+	EXPECT_EQ(loaderPtr->finalizeOrder.back(), "scene.dep");
+	for (auto& [path, count] : loaderPtr->decodeCount)
+	{
+		EXPECT_EQ(count, 1);
+		EXPECT_EQ(resourceSystem->GetMetadata<TestResource>(path).GetState(), ResourceState::Loaded);
+	}
+
+	// Loaded resources complete right away
+	auto loadedPreload = resourceSystem->Preload({ ResourceDependency::Of<TestResource>("scene.dep") });
+	EXPECT_TRUE(loadedPreload->IsDone());
+	EXPECT_EQ(loaderPtr->finalizeOrder.size(), 6);
+
+	// Cycle is broken, both resources load
+	loaderPtr->checkDependencies = false;
+	auto cyclicPreload = resourceSystem->Preload({ ResourceDependency::Of<TestResource>("loop0.dep") });
+	EXPECT_EQ(cyclicPreload->GetResourceCount(), 2);
+	resourceSystem->WaitForPreload(cyclicPreload);
+	EXPECT_EQ(resourceSystem->GetMetadata<TestResource>("loop0.dep").GetState(), ResourceState::Loaded);
+	EXPECT_EQ(resourceSystem->GetMetadata<TestResource>("loop1.dep").GetState(), ResourceState::Loaded);
+
+	// Unknown resource type is skipped
+	auto unknownPreload = resourceSystem->Preload({ ResourceDependency::Of<Test1Loader>("unknown.dep") });
+	EXPECT_EQ(unknownPreload->GetResourceCount(), 0);
+	EXPECT_TRUE(unknownPreload->IsDone());
+
+	PrCore::Resources::ResourceSystem::Terminate();
+}
+
+TEST_F(ResourceSystemTest, HotReload)
+{
+	PrCore::Resources::ResourceSystem::Init();
+	auto resourceSystem = PrCore::Resources::ResourceSystem::GetInstancePtr();
+
+	auto dataBase = std::make_unique<ResourceDatabase>();
+	auto loader = std::make_unique<DependencyTestLoader>();
+	auto loaderPtr = loader.get();
+	dataBase->RegisterLoader(".dep", std::move(loader));
+	resourceSystem->RegisterDatabase<TestResource>(std::move(dataBase));
+
+	loaderPtr->dependencies = {
+		{ "model.dep", { "mat.dep" } },
+		{ "mat.dep",   { "tex.dep", "shader.dep" } }
+	};
+	resourceSystem->WaitForPreload(resourceSystem->Preload({ ResourceDependency::Of<TestResource>("model.dep") }));
+	resourceSystem->Register<TestResource>("other.dep");
+
+	auto model = resourceSystem->GetMetadata<TestResource>("model.dep");
+	auto mat = resourceSystem->GetMetadata<TestResource>("mat.dep");
+	auto tex = resourceSystem->GetMetadata<TestResource>("tex.dep");
+	auto shader = resourceSystem->GetMetadata<TestResource>("shader.dep");
+
+	auto modelID = model.GetID();
+	auto modelData = model.Get();
+	auto matData = mat.Get();
+	auto texData = tex.Get();
+	auto shaderData = shader.Get();
+	auto texGeneration = tex.GetGeneration();
+
+	// Changed texture reloads its dependents after it, unrelated and unloaded resources stay
+	loaderPtr->finalizeOrder.clear();
+	auto reload = resourceSystem->Reload({ "Tex.dep", "other.dep", "missing.dep" });
+	EXPECT_EQ(reload->GetResourceCount(), 3);
+	EXPECT_EQ(tex.Get(), texData);
+
+	resourceSystem->WaitForPreload(reload);
+	EXPECT_FALSE(loaderPtr->dependencyMissing);
+	EXPECT_EQ(loaderPtr->finalizeOrder, (std::vector<std::string>{ "tex.dep", "mat.dep", "model.dep" }));
+
+	EXPECT_EQ(model.GetID(), modelID);
+	EXPECT_EQ(model.GetState(), ResourceState::Loaded);
+	EXPECT_GT(tex.GetGeneration(), texGeneration);
+
+	// Handles created before the reload see the new data
+	ASSERT_NE(tex.Get(), nullptr);
+	ASSERT_NE(mat.Get(), nullptr);
+	ASSERT_NE(model.Get(), nullptr);
+	EXPECT_NE(tex.Get(), texData);
+	EXPECT_NE(mat.Get(), matData);
+	EXPECT_NE(model.Get(), modelData);
+	EXPECT_EQ(shader.Get(), shaderData);
+	EXPECT_EQ(resourceSystem->GetMetadata<TestResource>("other.dep").GetState(), ResourceState::Registered);
+	EXPECT_EQ(resourceSystem->GetMemoryUsage<TestResource>(), 4 * sizeof(TestResource));
+
+	// Failed reload keeps the previous data
+	loaderPtr->failing.insert("shader.dep");
+	matData = mat.Get();
+	resourceSystem->WaitForPreload(resourceSystem->Reload({ "shader.dep" }));
+	EXPECT_EQ(shader.Get(), shaderData);
+	EXPECT_EQ(shader.GetState(), ResourceState::Loaded);
+	EXPECT_NE(mat.Get(), matData);
+	loaderPtr->failing.clear();
+
+	// Files written in the watched directory are reloaded in Update
+	auto watchedDir = std::filesystem::temp_directory_path() / "PearlHotReload";
+	std::filesystem::remove_all(watchedDir);
+	std::filesystem::create_directories(watchedDir);
+	resourceSystem->WatchDirectory(watchedDir.string());
+
+	texData = tex.Get();
+	matData = mat.Get();
+	std::ofstream(watchedDir / "tex.dep") << "Changed";
+	for (int i = 0; i < 500 && (tex.Get() == texData || mat.Get() == matData); i++)
+	{
+		resourceSystem->Update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	ASSERT_NE(tex.Get(), nullptr);
+	ASSERT_NE(mat.Get(), nullptr);
+	EXPECT_NE(tex.Get(), texData);
+	EXPECT_NE(mat.Get(), matData);
+
+	// Saving the same content again is not a change, the dependents keep their data too
+	texData = tex.Get();
+	matData = mat.Get();
+	std::ofstream(watchedDir / "tex.dep") << "Changed";
+	for (int i = 0; i < 20; i++)
+	{
+		resourceSystem->Update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	EXPECT_EQ(tex.Get(), texData);
+	EXPECT_EQ(mat.Get(), matData);
+
+	AssetRecord texRecord;
+	ASSERT_TRUE(resourceSystem->GetAssetRegistry().FindRecord("Tex.dep", texRecord));
+	EXPECT_EQ(texRecord.id, tex.GetID());
+	EXPECT_EQ(texRecord.contentHash, AssetRegistry::HashContent("Changed", 7));
+
+	resourceSystem->UnwatchDirectory(watchedDir.string());
+	std::filesystem::remove_all(watchedDir);
+
+	PrCore::Resources::ResourceSystem::Terminate();
+}
+
+TEST_F(ResourceSystemTest, AssetRegistry)
+{
+	// XXH64 reference values
+	EXPECT_EQ(PrCore::Utils::Hash64("", 0), 0xEF46DB3751D8E999ull);
+	EXPECT_EQ(PrCore::Utils::Hash64("a", 1), 0xD24EC4F1A98C6E5Bull);
+	EXPECT_EQ(PrCore::Utils::Hash64("Nobody inspects the spammish repetition", 39), 0xFBCEA83C8A378BF1ull);
+
+	// The same path has the same ID in every database and run
+	ResourceDatabase dataBase;
+	auto resourceID = dataBase.Register("Folder\\Resource.test")->id;
+	EXPECT_EQ(resourceID, AssetRegistry::MakeID("folder/resource.test"));
+	dataBase.Remove(resourceID);
+	EXPECT_EQ(dataBase.Register("folder/Resource.test")->id, resourceID);
+
+	AssetRegistry registry;
+	auto contentHash = AssetRegistry::HashContent("Content", 7);
+	EXPECT_TRUE(registry.UpdateContentHash("Folder/Resource.test", contentHash));
+	EXPECT_FALSE(registry.UpdateContentHash("folder/resource.test", contentHash));
+	EXPECT_TRUE(registry.IsDirty());
+
+	nlohmann::json settings{ { "generateMips", true } };
+	EXPECT_TRUE(registry.NeedsImport("folder/resource.test", contentHash, settings));
+	registry.RecordImport("folder/resource.test", contentHash, settings);
+	EXPECT_FALSE(registry.NeedsImport("folder/resource.test", contentHash, settings));
+	EXPECT_TRUE(registry.NeedsImport("folder/resource.test", contentHash + 1, settings));
+	EXPECT_TRUE(registry.NeedsImport("folder/resource.test", contentHash, nlohmann::json{ { "generateMips", false } }));
+
+	// Records survive the save, hashes opened from the file are checked again once
+	nlohmann::json serialized;
+	registry.Serialize(serialized);
+
+	AssetRegistry openedRegistry;
+	openedRegistry.Deserialize(serialized);
+	EXPECT_FALSE(openedRegistry.IsDirty());
+	ASSERT_EQ(openedRegistry.GetRecordCount(), 1);
+
+	AssetRecord record;
+	ASSERT_TRUE(openedRegistry.FindRecord("FOLDER/RESOURCE.TEST", record));
+	EXPECT_EQ(record.path, "folder/resource.test");
+	EXPECT_EQ(record.id, resourceID);
+	EXPECT_EQ(record.contentHash, contentHash);
+	EXPECT_EQ(record.importSettings, settings);
+	EXPECT_FALSE(openedRegistry.NeedsImport("folder/resource.test", contentHash, settings));
+	EXPECT_TRUE(openedRegistry.UpdateContentHash("folder/resource.test", contentHash));
+	EXPECT_FALSE(openedRegistry.UpdateContentHash("folder/resource.test", contentHash));
+
+	openedRegistry.RemoveRecord("folder/resource.test");
+	EXPECT_FALSE(openedRegistry.FindRecord("folder/resource.test", record));
+	EXPECT_TRUE(openedRegistry.IsDirty());
+}
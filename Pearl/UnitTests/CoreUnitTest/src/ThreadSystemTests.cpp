@@ -6,6 +6,11 @@
 
 #include <future>
 
+#ifndef _WIN32
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
 using namespace PrCore::Threading;
 
 class TestThread : public IThread
@@ -55,6 +60,24 @@ protected:
 	std::atomic<bool> m_shouldTerniate;
 };
 
+#ifndef _WIN32
+class AffinityTestThread : public TestThread
+{
+public:
+	int ThreadLoop() override
+	{
+		CPU_ZERO(&affinity);
+		pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &affinity);
+		recorded = true;
+
+		return TestThread::ThreadLoop();
+	}
+
+	cpu_set_t         affinity;
+	std::atomic<bool> recorded = false;
+};
+#endif
+
 class ThreadingSystemTest : public ::testing::Test {
 public:
 	static void SetUpTestSuite()
@@ -177,6 +200,66 @@ TEST_F(ThreadingSystemTest, ThreadInfo)
 	EXPECT_EQ(threadingSystem->GetThreadNum(), 0);
 }
 
+TEST_F(ThreadingSystemTest, ThreadConfig)
+{
+	auto threadingSystem = PrCore::Threading::ThreadSystem::GetInstancePtr();
+
+	auto thread = std::make_shared<TestThread>();
+	ThreadConfig config;
+	config.name = "ConfiguredTestThread";
+	config.affinityMask = 1;
+	config.stackSize = 256;
+	config.startPaused = true;
+
+	EXPECT_TRUE(threadingSystem->SpawnThread(thread, config));
+	EXPECT_TRUE(threadingSystem->IsThreadPaused(thread));
+
+	auto threadInfo = threadingSystem->GetThreadInfo(thread);
+	EXPECT_EQ(threadInfo.affinityMask, 1);
+	EXPECT_EQ(threadInfo.stackSize, 256);
+	EXPECT_STREQ(threadInfo.name.c_str(), "ConfiguredTestThread");
+	EXPECT_NE(threadInfo.threadId, PrCore::Threading::ThreadSystem::GetCurrentThreadId());
+
+	threadingSystem->PauseThread(thread, false);
+	EXPECT_FALSE(threadingSystem->IsThreadPaused(thread));
+
+	threadingSystem->TerminateThread(thread);
+	threadingSystem->JoinThread(thread);
+	EXPECT_EQ(threadingSystem->GetThreadNum(), 0);
+}
+
+TEST_F(ThreadingSystemTest, DefaultAffinity)
+{
+	auto threadingSystem = PrCore::Threading::ThreadSystem::GetInstancePtr();
+
+	// Thread without a mask is not pinned, it may run on every processor of the process
+	ThreadConfig config;
+	config.name = "DefaultAffinityThread";
+	EXPECT_EQ(config.affinityMask, 0);
+
+#ifdef _WIN32
+	auto thread = std::make_shared<TestThread>();
+	EXPECT_TRUE(threadingSystem->SpawnThread(thread, config));
+#else
+	auto thread = std::make_shared<AffinityTestThread>();
+	EXPECT_TRUE(threadingSystem->SpawnThread(thread, config));
+
+	while (!thread->recorded)
+		std::this_thread::yield();
+
+	cpu_set_t processAffinity;
+	CPU_ZERO(&processAffinity);
+	ASSERT_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &processAffinity), 0);
+	EXPECT_TRUE(CPU_EQUAL(&thread->affinity, &processAffinity));
+#endif
+
+	EXPECT_EQ(threadingSystem->GetThreadInfo(thread).affinityMask, 0);
+
+	threadingSystem->TerminateThread(thread);
+	threadingSystem->JoinThread(thread);
+	EXPECT_EQ(threadingSystem->GetThreadNum(), 0);
+}
+
 TEST_F(ThreadingSystemTest, StressTest)
 {
 	using namespace std::chrono_literals;